@@ -0,0 +1,58 @@
+/*!
+ * @file
+ * host_log_sink class header.
+ */
+
+/*
+ * Copyright (c) 2023, FAV Software Limited. All rights reserved.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * File:   host_log_sink.h
+ * Author: busdev
+ *
+ * Created on 19 October 2026
+ * Updated on 19 October 2026
+ */
+
+#ifndef __HOST_LOG_SINK_H__
+#define __HOST_LOG_SINK_H__
+
+#include "log_sink.h"
+
+/*!
+* \brief Log sink writing to a file descriptor on the host.
+*
+* The drain rate can be limited to that of a UART (10 bits per byte at
+* baud_rate) so that overflow and latency behave as on the device.
+* A baud_rate of 0 drains everything on each poll().
+*/
+
+class Host_Log_Sink : public Log_Sink
+{
+ public:
+  Host_Log_Sink(int fd, uint32_t baud_rate);
+  ~Host_Log_Sink();
+
+  void poll(void);
+
+ private:
+  int fd;
+  uint32_t baud_rate;
+  uint64_t last_poll_us;
+  uint64_t byte_credit_x1m;   // Bytes allowed to be drained, times 1000000.
+};
+
+#endif
@@ -0,0 +1,83 @@
+/*!
+ * @file
+ * host lwIP functions header and associated constants.
+ */
+
+/*
+ * Copyright (c) 2023, FAV Software Limited. All rights reserved.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * File:   host_lwip.h
+ * Author: busdev
+ *
+ * Created on 19 October 2026
+ * Updated on 19 October 2026
+ */
+
+#ifndef __HOST_LWIP_H__
+#define __HOST_LWIP_H__
+
+// Host lwIP stand-in.
+//
+// Just enough of the lwIP UDP, pbuf and ARP API to run dhcpserver.c on
+// the host. There is no network: host_lwip_deliver() hands a datagram to
+// the pcb bound to the port, as lwIP's udp_input() would, and everything
+// passed to udp_sendto() goes to the send hook. cyw43_hal_ticks_ms() is a
+// fake clock the harness sets.
+//
+// Every pbuf is tracked (host_pbuf.h), so leaks, double frees and sends
+// of a freed pbuf are caught (the last two abort).
+
+#include "lwip/udp.h"
+#include "lwip/etharp.h"
+
+#define HOST_LWIP_MAX_DATAGRAM 1472     // UDP payload in a 1500 byte MTU.
+
+struct host_lwip_datagram
+{
+ uint32_t dest_ip;                      // Host byte order.
+ uint16_t dest_port;
+ bool has_static_arp;                   // Sent while a static ARP entry for dest_ip existed.
+ uint8_t static_arp_mac[6];
+ uint16_t len;
+ uint8_t data[HOST_LWIP_MAX_DATAGRAM];
+};
+
+struct host_lwip_stats
+{
+ uint32_t pbufs_allocated;              // Since host_lwip_reset_stats().
+ uint32_t pbufs_live;                   // Now.
+ uint32_t static_arp_entries;           // Now.
+ uint32_t datagrams_sent;
+};
+
+typedef void (*host_lwip_send_fn)(const struct host_lwip_datagram *datagram, void *arg);
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+void host_lwip_set_ticks_ms(uint32_t ms);
+void host_lwip_set_send_hook(host_lwip_send_fn fn, void *arg);
+int host_lwip_deliver(const uint8_t *data, uint16_t len, uint32_t src_ip, uint16_t src_port, uint16_t dest_port, uint16_t split);
+struct host_lwip_stats host_lwip_get_stats(void);
+void host_lwip_reset_stats(void);
+
+#ifdef __cplusplus
+ }
+#endif
+
+#endif
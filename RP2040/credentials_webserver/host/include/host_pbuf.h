@@ -0,0 +1,54 @@
+/*!
+ * @file
+ * host pbuf functions header.
+ */
+
+/*
+ * Copyright (c) 2023, FAV Software Limited. All rights reserved.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * File:   host_pbuf.h
+ * Author: busdev
+ *
+ * Created on 19 October 2026
+ * Updated on 19 October 2026
+ */
+
+#ifndef __HOST_PBUF_H__
+#define __HOST_PBUF_H__
+
+// Host pbufs.
+//
+// pbuf_alloc() and friends (lwip/pbuf.h) on the C heap, shared by the
+// lwIP stand-ins (host_lwip.cpp, socket_lwip.cpp). Every live pbuf is
+// tracked: freeing or using one that is not allocated aborts, and the
+// counts show leaks.
+
+#include "lwip/pbuf.h"
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+void host_pbuf_check_live(const struct pbuf *p, const char *what);
+uint32_t host_pbuf_live_count(void);
+uint32_t host_pbuf_allocated_count(void);
+
+#ifdef __cplusplus
+ }
+#endif
+
+#endif
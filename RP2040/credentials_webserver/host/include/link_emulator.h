@@ -0,0 +1,97 @@
+/*!
+ * @file
+ * Link_Emulator class header.
+ */
+
+/*
+ * Copyright (c) 2023, FAV Software Limited. All rights reserved.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * File:   link_emulator.h
+ * Author: busdev
+ *
+ * Created on 19 October 2026
+ * Updated on 19 October 2026
+ */
+
+#ifndef __LINK_EMULATOR_H__
+#define __LINK_EMULATOR_H__
+
+// One direction of an impaired link, for the host benchmarks.
+//
+// A packet handed to send() waits for the link (bandwidth), is dropped if
+// queue_packets are already waiting (drop tail, the AP or driver queue),
+// may be lost, duplicated or reordered, and arrives latency +/- jitter
+// after it has been sent. Losses follow a two state (Gilbert-Elliott)
+// model in time: with burst_ms > 0 the link goes bad, losing everything,
+// for burst_ms on average, often enough that a fraction loss of the time
+// is bad, as interference on 2.4 GHz does. With burst_ms 0 losses are
+// independent.
+//
+// The caller owns the clock: send() returns the arrival times.
+
+#include <cstdint>
+#include <deque>
+#include <random>
+
+#define LINK_HEADER_BYTES 40    // IPv4 and TCP headers, counted against the bandwidth.
+#define LINK_MAX_COPIES   2     // A duplicated packet arrives twice.
+
+struct link_config
+{
+ double loss;                   // Mean loss probability, 0..1.
+ uint32_t burst_ms;             // Mean loss burst length, 0: independent losses.
+ double reorder;                // Probability a packet is held back by reorder_ms.
+ double duplicate;              // Probability a packet is delivered twice.
+ uint32_t latency_ms;           // One way propagation delay.
+ uint32_t jitter_ms;            // Uniform +/- jitter_ms.
+ uint32_t reorder_ms;
+ uint32_t bandwidth_kbps;       // 0: no limit.
+ uint32_t queue_packets;        // Packets waiting for the link, 0: no limit.
+};
+
+struct link_stats
+{
+ uint64_t sent;
+ uint64_t lost;
+ uint64_t queue_drops;
+ uint64_t duplicated;
+ uint64_t reordered;
+};
+
+class Link_Emulator
+{
+ public:
+  Link_Emulator(const struct link_config *config, uint32_t seed);
+
+  int send(uint64_t now_us, uint32_t payload_bytes, uint64_t arrival_us[LINK_MAX_COPIES]);
+  const struct link_stats *get_stats(void);
+
+ private:
+  bool is_lost(uint64_t now_us);
+  uint64_t period_us(bool bad);
+  double random(void);
+
+  struct link_config config;
+  struct link_stats stats;
+  std::mt19937 rng;
+  std::deque<uint64_t> departures;   // Departure times of the packets queued or on the link.
+  uint64_t link_free_us;
+  bool is_bad;                       // Gilbert-Elliott model state...
+ uint64_t state_end_us;             // ...until then.
+};
+
+#endif
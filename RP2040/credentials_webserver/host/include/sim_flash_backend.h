@@ -0,0 +1,90 @@
+/*!
+ * @file
+ * sim_flash_backend class header and associated constants.
+ */
+
+/*
+ * Copyright (c) 2023, FAV Software Limited. All rights reserved.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * File:   sim_flash_backend.h
+ * Author: busdev
+ *
+ * Created on 19 October 2026
+ * Updated on 19 October 2026
+ */
+
+#ifndef __SIM_FLASH_BACKEND_H__
+#define __SIM_FLASH_BACKEND_H__
+
+// Timing model, W25Q16JV typical values (datasheet section 9.6).
+
+#define SIM_FLASH_SECTOR_ERASE_US 45000   // tSE, 4KB sector erase.
+#define SIM_FLASH_PAGE_PROGRAM_US 400     // tPP, 256B page program.
+#define SIM_FLASH_CLK_MHZ         125     // RP2040 default system clock.
+
+#define SIM_FLASH_ERASED_BYTE 0xff
+#define SIM_FLASH_NO_POWER_CUT 0xffffffff
+
+#include "flash_backend.h"
+
+// Per sector wear and timing counters.
+
+struct sim_flash_sector_stats
+{
+ uint32_t erase_count;
+ uint32_t program_count;    // Pages programmed.
+ uint32_t nor_violations;   // Programs that tried to set an erased bit.
+ uint64_t busy_cycles;      // System clock cycles spent erasing and programming.
+};
+
+class Sim_Flash_Backend : public Flash_Backend
+{
+ public:
+  Sim_Flash_Backend(const char *image_path, uint32_t size_bytes);
+  ~Sim_Flash_Backend();
+
+  int read(uint32_t offset, uint8_t *data, uint32_t count);
+  int erase(uint32_t offset, uint32_t count);
+  int program(uint32_t offset, const uint8_t *data, uint32_t count);
+
+  void set_realtime(bool is_realtime);
+  void schedule_power_cut(uint32_t bytes_until_cut);
+  void power_cycle(void);
+  bool get_is_powered(void);
+
+  uint32_t get_sector_count(void);
+  struct sim_flash_sector_stats get_sector_stats(uint32_t sector);
+  uint64_t get_total_busy_cycles(void);
+  void reset_stats(void);
+
+ private:
+  bool consume_power_budget(uint32_t *count);
+  void account_busy_time(uint32_t sector, uint32_t busy_us);
+
+  uint8_t *image;
+  uint32_t size_bytes;
+  int image_fd;
+
+  bool is_realtime;
+  bool is_powered;
+  uint32_t bytes_until_cut;
+
+  struct sim_flash_sector_stats *sector_stats;
+  uint64_t total_busy_cycles;
+};
+
+#endif
@@ -0,0 +1,23 @@
+/*
+ * Host shim for cyw43_config.h.
+ *
+ * Only the millisecond tick is used (by the DHCP server). On the host it
+ * is a fake clock, set by the harness through host_lwip.h.
+ */
+
+#ifndef _HOST_SHIM_CYW43_CONFIG_H
+#define _HOST_SHIM_CYW43_CONFIG_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+uint32_t cyw43_hal_ticks_ms(void);
+
+#ifdef __cplusplus
+ }
+#endif
+
+#endif
@@ -0,0 +1,19 @@
+/*
+ * Host shim for hardware/flash.h.
+ *
+ * Flash geometry of the Pico-W (W25Q16JV). There are no flash_range_*
+ * functions on the host, use a Flash_Backend instead.
+ */
+
+#ifndef _HOST_SHIM_HARDWARE_FLASH_H
+#define _HOST_SHIM_HARDWARE_FLASH_H
+
+#include "pico/stdlib.h"
+
+#define XIP_BASE              0x10000000
+#define PICO_FLASH_SIZE_BYTES (2 * 1024 * 1024)
+#define FLASH_PAGE_SIZE       (1u << 8)
+#define FLASH_SECTOR_SIZE     (1u << 12)
+#define FLASH_BLOCK_SIZE      (1u << 16)
+
+#endif
@@ -0,0 +1,57 @@
+/*
+ * Host shim for hardware/gpio.h.
+ *
+ * There are no pins. gpio_get() reads SIM_GPIO<n> from the environment,
+ * "1" for high, and is low otherwise; GPIO15 low starts the access point.
+ * Interrupt handlers are accepted and never called.
+ */
+
+#ifndef _HOST_SHIM_HARDWARE_GPIO_H
+#define _HOST_SHIM_HARDWARE_GPIO_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pico/stdlib.h"
+
+#define GPIO_IRQ_LEVEL_HIGH 0x2u
+#define PICO_SHARED_IRQ_HANDLER_HIGHEST_ORDER_PRIORITY 0xff
+
+typedef void (*irq_handler_t)(void);
+
+static inline void gpio_init(unsigned gpio)
+{
+ (void)gpio;
+}
+
+static inline void gpio_pull_up(unsigned gpio)
+{
+ (void)gpio;
+}
+
+static inline bool gpio_get(unsigned gpio)
+{
+ char name[16];
+ const char *value;
+
+ snprintf(name, sizeof(name), "SIM_GPIO%u", gpio);
+ value = getenv(name);
+
+ return (value != NULL) && (strcmp(value, "1") == 0);
+}
+
+static inline uint32_t gpio_get_irq_event_mask(unsigned gpio)
+{
+ (void)gpio;
+ return 0;
+}
+
+static inline void gpio_add_raw_irq_handler_with_order_priority(unsigned gpio, irq_handler_t handler, uint8_t order_priority)
+{
+ (void)gpio;
+ (void)handler;
+ (void)order_priority;
+}
+
+#endif
@@ -0,0 +1,25 @@
+/*
+ * Host shim for hardware/structs/xip_ctrl.h.
+ *
+ * There is no XIP cache: the counters stay at 0.
+ */
+
+#ifndef _HOST_SHIM_HARDWARE_STRUCTS_XIP_CTRL_H
+#define _HOST_SHIM_HARDWARE_STRUCTS_XIP_CTRL_H
+
+#include <stdint.h>
+
+typedef struct
+{
+ volatile uint32_t ctrl;
+ volatile uint32_t flush;
+ volatile uint32_t stat;
+ volatile uint32_t ctr_hit;
+ volatile uint32_t ctr_acc;
+} xip_ctrl_hw_t;
+
+static xip_ctrl_hw_t host_xip_ctrl;
+
+#define xip_ctrl_hw (&host_xip_ctrl)
+
+#endif
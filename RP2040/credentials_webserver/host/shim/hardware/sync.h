@@ -0,0 +1,22 @@
+/*
+ * Host shim for hardware/sync.h.
+ *
+ * There are no interrupts to mask on the host.
+ */
+
+#ifndef _HOST_SHIM_HARDWARE_SYNC_H
+#define _HOST_SHIM_HARDWARE_SYNC_H
+
+#include "pico/stdlib.h"
+
+static inline uint32_t save_and_disable_interrupts(void)
+{
+ return 0;
+}
+
+static inline void restore_interrupts(uint32_t status)
+{
+ (void)status;
+}
+
+#endif
@@ -0,0 +1,52 @@
+/*
+ * Host shim for lwip/def.h.
+ *
+ * Also carries the lwIP integer types and LWIP_ASSERT, which lwIP takes
+ * from arch.h and debug.h. Assertions are always checked on the host.
+ */
+
+#ifndef _HOST_SHIM_LWIP_DEF_H
+#define _HOST_SHIM_LWIP_DEF_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+typedef uint8_t u8_t;
+typedef uint16_t u16_t;
+typedef uint32_t u32_t;
+typedef int8_t s8_t;
+typedef int16_t s16_t;
+typedef int32_t s32_t;
+
+#define LWIP_MIN(x, y) (((x) < (y)) ? (x) : (y))
+#define LWIP_MAX(x, y) (((x) > (y)) ? (x) : (y))
+
+#define LWIP_MAKEU32(a, b, c, d) (((u32_t)((a) & 0xff) << 24) | ((u32_t)((b) & 0xff) << 16) | \
+                                  ((u32_t)((c) & 0xff) << 8) | (u32_t)((d) & 0xff))
+
+#define LWIP_ASSERT(message, assertion) do { if (!(assertion)) { \
+  fprintf(stderr, "Assertion \"%s\" failed at %s:%d\n", message, __FILE__, __LINE__); abort(); } } while (0)
+
+static inline u32_t lwip_htonl(u32_t x)
+{
+ return __builtin_bswap32(x);
+}
+
+static inline u32_t lwip_ntohl(u32_t x)
+{
+ return __builtin_bswap32(x);
+}
+
+static inline u16_t lwip_htons(u16_t x)
+{
+ return __builtin_bswap16(x);
+}
+
+static inline u16_t lwip_ntohs(u16_t x)
+{
+ return __builtin_bswap16(x);
+}
+
+#endif
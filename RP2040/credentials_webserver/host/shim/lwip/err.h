@@ -0,0 +1,21 @@
+/*
+ * Host shim for lwip/err.h.
+ */
+
+#ifndef _HOST_SHIM_LWIP_ERR_H
+#define _HOST_SHIM_LWIP_ERR_H
+
+#include <stdint.h>
+
+typedef int8_t err_t;
+
+#define ERR_OK   0
+#define ERR_MEM  -1
+#define ERR_BUF  -2
+#define ERR_VAL  -6
+#define ERR_USE  -8
+#define ERR_CONN -11
+#define ERR_RST  -14
+#define ERR_ARG  -16
+
+#endif
@@ -0,0 +1,29 @@
+/*
+ * Host shim for lwip/etharp.h, static entries only.
+ */
+
+#ifndef _HOST_SHIM_LWIP_ETHARP_H
+#define _HOST_SHIM_LWIP_ETHARP_H
+
+#include "lwip/ip_addr.h"
+#include "lwip/err.h"
+
+#define ETHARP_SUPPORT_STATIC_ENTRIES 1
+
+struct eth_addr
+{
+ u8_t addr[6];
+};
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+err_t etharp_add_static_entry(const ip4_addr_t *ipaddr, struct eth_addr *ethaddr);
+err_t etharp_remove_static_entry(const ip4_addr_t *ipaddr);
+
+#ifdef __cplusplus
+ }
+#endif
+
+#endif
@@ -0,0 +1,26 @@
+/*
+ * Host shim for lwip/ip_addr.h, IPv4 only.
+ *
+ * Addresses are held in network byte order, as in lwIP.
+ */
+
+#ifndef _HOST_SHIM_LWIP_IP_ADDR_H
+#define _HOST_SHIM_LWIP_IP_ADDR_H
+
+#include "lwip/def.h"
+
+typedef struct ip4_addr
+{
+ u32_t addr;
+} ip4_addr_t;
+
+typedef ip4_addr_t ip_addr_t;
+
+static const ip_addr_t ip_addr_any = { 0 };
+
+#define IP_ADDR_ANY (&ip_addr_any)
+#define IP4_ADDR(ipaddr, a, b, c, d) ((ipaddr)->addr = lwip_htonl(LWIP_MAKEU32(a, b, c, d)))
+#define ip4_addr_get_u32(src_ipaddr) ((src_ipaddr)->addr)
+#define ip_addr_copy(dest, src) ((dest) = (src))
+
+#endif
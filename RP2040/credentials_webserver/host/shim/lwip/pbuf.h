@@ -0,0 +1,51 @@
+/*
+ * Host shim for lwip/pbuf.h.
+ *
+ * PBUF_RAM buffers on the heap, with the header room of the layer in
+ * front of the payload. Implemented in host/src/host_pbuf.cpp, which
+ * also checks for leaks and double frees.
+ */
+
+#ifndef _HOST_SHIM_LWIP_PBUF_H
+#define _HOST_SHIM_LWIP_PBUF_H
+
+#include "lwip/def.h"
+#include "lwip/err.h"
+
+typedef enum
+{
+ PBUF_TRANSPORT = 14 + 20 + 8,   // Ethernet, IPv4 and UDP headers.
+ PBUF_IP = 14 + 20,
+ PBUF_LINK = 14,
+ PBUF_RAW = 0
+} pbuf_layer;
+
+typedef enum
+{
+ PBUF_RAM,
+ PBUF_POOL
+} pbuf_type;
+
+struct pbuf
+{
+ struct pbuf *next;
+ void *payload;
+ u16_t tot_len;
+ u16_t len;
+ u16_t ref;
+};
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+struct pbuf *pbuf_alloc(pbuf_layer layer, u16_t length, pbuf_type type);
+u8_t pbuf_free(struct pbuf *p);
+void pbuf_realloc(struct pbuf *p, u16_t new_len);
+u16_t pbuf_copy_partial(const struct pbuf *p, void *dataptr, u16_t len, u16_t offset);
+
+#ifdef __cplusplus
+ }
+#endif
+
+#endif
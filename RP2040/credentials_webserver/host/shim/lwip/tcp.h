@@ -0,0 +1,83 @@
+/*
+ * Host shim for lwip/tcp.h, the raw API as the web server uses it.
+ *
+ * Implemented over POSIX sockets by host/src/socket_lwip.cpp. Buffer and
+ * window sizes are the device's, from lwipopts.h, so tcp_sndbuf() and
+ * tcp_recved() behave as on the device.
+ */
+
+#ifndef _HOST_SHIM_LWIP_TCP_H
+#define _HOST_SHIM_LWIP_TCP_H
+
+#include "lwipopts.h"
+#include "lwip/ip_addr.h"
+#include "lwip/pbuf.h"
+
+#define TCP_WRITE_FLAG_COPY 0x01
+#define TCP_WRITE_FLAG_MORE 0x02
+
+enum tcp_state
+{
+ CLOSED = 0,
+ LISTEN = 1,
+ SYN_SENT = 2,
+ SYN_RCVD = 3,
+ ESTABLISHED = 4,
+ FIN_WAIT_1 = 5,
+ FIN_WAIT_2 = 6,
+ CLOSE_WAIT = 7,
+ CLOSING = 8,
+ LAST_ACK = 9,
+ TIME_WAIT = 10
+};
+
+struct tcp_pcb;
+
+typedef err_t (*tcp_accept_fn)(void *arg, struct tcp_pcb *newpcb, err_t err);
+typedef err_t (*tcp_recv_fn)(void *arg, struct tcp_pcb *tpcb, struct pbuf *p, err_t err);
+typedef err_t (*tcp_sent_fn)(void *arg, struct tcp_pcb *tpcb, u16_t len);
+typedef void (*tcp_err_fn)(void *arg, err_t err);
+
+struct tcp_pcb
+{
+ enum tcp_state state;
+ void *callback_arg;
+
+// Socket bridge.
+
+ int fd;
+ u16_t local_port;
+ bool is_closing;               // tcp_close() called, sending what is left.
+ tcp_accept_fn accept;
+ tcp_recv_fn recv;
+ tcp_sent_fn sent;
+ tcp_err_fn errf;
+ u32_t rcv_wnd;                 // Bytes that may be delivered before tcp_recved().
+ u32_t snd_queued;              // Bytes in snd_buf not yet taken by the socket.
+ u8_t snd_buf[TCP_SND_BUF];
+};
+
+#define tcp_sndbuf(pcb) ((u16_t)(TCP_SND_BUF - (pcb)->snd_queued))
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+struct tcp_pcb *tcp_new(void);
+err_t tcp_bind(struct tcp_pcb *pcb, const ip_addr_t *ipaddr, u16_t port);
+struct tcp_pcb *tcp_listen(struct tcp_pcb *pcb);
+void tcp_arg(struct tcp_pcb *pcb, void *arg);
+void tcp_accept(struct tcp_pcb *pcb, tcp_accept_fn accept);
+void tcp_recv(struct tcp_pcb *pcb, tcp_recv_fn recv);
+void tcp_sent(struct tcp_pcb *pcb, tcp_sent_fn sent);
+void tcp_err(struct tcp_pcb *pcb, tcp_err_fn err);
+void tcp_recved(struct tcp_pcb *pcb, u16_t len);
+err_t tcp_write(struct tcp_pcb *pcb, const void *dataptr, u16_t len, u8_t apiflags);
+err_t tcp_output(struct tcp_pcb *pcb);
+err_t tcp_close(struct tcp_pcb *pcb);
+
+#ifdef __cplusplus
+ }
+#endif
+
+#endif
@@ -0,0 +1,31 @@
+/*
+ * Host shim for lwip/udp.h.
+ *
+ * Datagrams are delivered and captured by the harness, see host_lwip.h.
+ */
+
+#ifndef _HOST_SHIM_LWIP_UDP_H
+#define _HOST_SHIM_LWIP_UDP_H
+
+#include "lwip/ip_addr.h"
+#include "lwip/pbuf.h"
+
+struct udp_pcb;
+
+typedef void (*udp_recv_fn)(void *arg, struct udp_pcb *pcb, struct pbuf *p, const ip_addr_t *addr, u16_t port);
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+struct udp_pcb *udp_new(void);
+void udp_remove(struct udp_pcb *pcb);
+void udp_recv(struct udp_pcb *pcb, udp_recv_fn recv, void *recv_arg);
+err_t udp_bind(struct udp_pcb *pcb, const ip_addr_t *ipaddr, u16_t port);
+err_t udp_sendto(struct udp_pcb *pcb, struct pbuf *p, const ip_addr_t *dst_ip, u16_t dst_port);
+
+#ifdef __cplusplus
+ }
+#endif
+
+#endif
@@ -0,0 +1,46 @@
+/*
+ * Host shim for pico/cyw43_arch.h.
+ *
+ * There is no radio: the access point is the host's network, reached
+ * through the socket bridge in host/src/socket_lwip.cpp, and
+ * cyw43_arch_poll() runs the bridge.
+ */
+
+#ifndef _HOST_SHIM_PICO_CYW43_ARCH_H
+#define _HOST_SHIM_PICO_CYW43_ARCH_H
+
+#include "pico/stdlib.h"
+#include "lwip/ip_addr.h"
+#include "lwip/tcp.h"
+#include "lwip/udp.h"
+
+#define CYW43_WL_GPIO_LED_PIN   0
+#define CYW43_PIN_WL_HOST_WAKE  24
+#define CYW43_AUTH_WPA2_AES_PSK 0x00400004
+#define CYW43_NO_POWERSAVE_MODE 0
+
+#define cyw43_pm_value(pm_mode, pm2_sleep_ret_ms, li_beacon_period, li_dtim_period, li_assoc) 0
+
+typedef struct _cyw43_t
+{
+ int itf_state;
+} cyw43_t;
+
+extern cyw43_t cyw43_state;
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+int cyw43_arch_init(void);
+void cyw43_arch_deinit(void);
+void cyw43_arch_poll(void);
+void cyw43_arch_gpio_put(unsigned wl_gpio, bool value);
+void cyw43_arch_enable_ap_mode(const char *ssid, const char *password, uint32_t auth);
+int cyw43_wifi_pm(cyw43_t *self, uint32_t pm);
+
+#ifdef __cplusplus
+ }
+#endif
+
+#endif
@@ -0,0 +1,80 @@
+/*
+ * Host shim for pico/stdlib.h.
+ *
+ * Provides the small subset of the Pico SDK used by the credentials
+ * webserver sources so that they can be compiled and run on Linux.
+ */
+
+#ifndef _HOST_SHIM_PICO_STDLIB_H
+#define _HOST_SHIM_PICO_STDLIB_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <time.h>
+#include <poll.h>
+#include <unistd.h>
+
+#define PICO_ERROR_TIMEOUT -1
+
+static inline uint64_t time_us_64(void)
+{
+ struct timespec ts;
+
+ clock_gettime(CLOCK_MONOTONIC, &ts);
+ return ((uint64_t)ts.tv_sec * 1000000u) + ((uint64_t)ts.tv_nsec / 1000u);
+}
+
+static inline uint32_t time_us_32(void)
+{
+ return (uint32_t)time_us_64();
+}
+
+static inline void sleep_us(uint64_t us)
+{
+ usleep((useconds_t)us);
+}
+
+static inline void sleep_ms(uint32_t ms)
+{
+ usleep((useconds_t)ms * 1000u);
+}
+
+static inline bool stdio_init_all(void)
+{
+ setvbuf(stdout, NULL, _IOLBF, 0);   // Output shows up while the simulator runs.
+ return true;
+}
+
+// Console input, for the UART report keys and provisioning. The timeout
+// is rounded down to milliseconds; at the end of input it is waited out.
+
+static inline int getchar_timeout_us(uint32_t timeout_us)
+{
+ struct pollfd fds = { STDIN_FILENO, POLLIN, 0 };
+ unsigned char c;
+
+ if (poll(&fds, 1, (int)(timeout_us / 1000)) != 1)
+  return PICO_ERROR_TIMEOUT;
+
+ if (read(STDIN_FILENO, &c, 1) != 1)
+ {
+  usleep(timeout_us);
+  return PICO_ERROR_TIMEOUT;
+ }
+
+ return c;
+}
+
+static inline void putchar_raw(int c)
+{
+ putchar(c);
+}
+
+static inline void stdio_flush(void)
+{
+ fflush(stdout);
+}
+
+#endif
@@ -0,0 +1,243 @@
+/*
+ * Copyright (c) 2023, FAV Software Limited. All rights reserved.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * File:   cws_config.cpp
+ * Author: busdev
+ *
+ * Created on 19 October 2026
+ * Updated on 19 October 2026
+ *
+ * Description
+ * -----------
+ * Provisioning client for the /api/v1/config endpoint. Without
+ * settings it prints the device's settings; with -s, -p and -u it
+ * replaces them, in one request, and prints the settings the device
+ * saved. The JSON is written with the device's own writer (json.cpp).
+ *
+ * The target is a device (the default, 192.168.4.1:80) or the
+ * simulator (127.0.0.1:8080). Empty values clear a setting.
+ *
+ * Usage: cws_config [-s ssid -p password -u url] [-t timeout_ms] [host[:port]]
+ * Returns 0 if the device accepted the request, 1 if it answered with
+ * an error (printed, e.g. {"error":"password"}), 2 if it could not be
+ * reached.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <strings.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "json.h"
+
+#define DEFAULT_HOST       "192.168.4.1"
+#define DEFAULT_PORT       "80"
+#define DEFAULT_TIMEOUT_MS 5000
+#define CONFIG_PATH        "/api/v1/config"
+#define BODY_SIZE          4096     // Larger than the device accepts.
+
+/*!
+* \brief Connects to host[:port].
+*
+* \return int. File descriptor, or -1.
+*/
+
+static int open_connection(const std::string &target, int timeout_ms)
+{
+ std::string host = target;
+ std::string port = DEFAULT_PORT;
+ size_t colon = host.rfind(':');
+ struct timeval tv = { timeout_ms / 1000, (timeout_ms % 1000) * 1000 };
+ struct addrinfo hints;
+ struct addrinfo *res;
+ int fd;
+
+ if (colon != std::string::npos)
+ {
+  port = host.substr(colon + 1);
+  host = host.substr(0, colon);
+ }
+
+ memset(&hints, 0, sizeof(hints));
+ hints.ai_family = AF_INET;
+ hints.ai_socktype = SOCK_STREAM;
+
+ if (getaddrinfo(host.c_str(), port.c_str(), &hints, &res) != 0)
+  return -1;
+
+ fd = socket(res->ai_family, SOCK_STREAM, 0);
+
+ if (fd >= 0)
+ {
+  setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+  setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+
+  if (connect(fd, res->ai_addr, res->ai_addrlen) != 0)
+  {
+   close(fd);
+   fd = -1;
+  }
+ }
+
+ freeaddrinfo(res);
+
+ return fd;
+}
+
+/*!
+* \brief Sends a request and reads the response.
+*
+* The device sends a Content-length; the body ends there, or at the
+* close.
+*
+* \return bool. false on a connection error.
+*/
+
+static bool exchange(int fd, const std::string &request, std::string *response)
+{
+ char buf[2048];
+ ssize_t n;
+
+ if (send(fd, request.data(), request.length(), MSG_NOSIGNAL) != (ssize_t)request.length())
+  return false;
+
+ while ((n = recv(fd, buf, sizeof(buf), 0)) > 0)
+ {
+  response->append(buf, n);
+
+  size_t header_end = response->find("\r\n\r\n");
+  const char *length = strcasestr(response->c_str(), "\r\nContent-length:");
+
+  if ((header_end != std::string::npos) && (length != NULL) && (length < response->c_str() + header_end) &&
+      (response->length() >= header_end + 4 + strtoul(length + 17, NULL, 10)))
+   return true;
+ }
+
+ return (n == 0);
+}
+
+int main(int argc, char **argv)
+{
+ const char *ssid = NULL;
+ const char *password = NULL;
+ const char *url = NULL;
+ int timeout_ms = DEFAULT_TIMEOUT_MS;
+ int opt;
+
+ while ((opt = getopt(argc, argv, "s:p:u:t:")) != -1)
+ {
+  switch (opt)
+  {
+   case 's':
+    ssid = optarg;
+    break;
+
+   case 'p':
+    password = optarg;
+    break;
+
+   case 'u':
+    url = optarg;
+    break;
+
+   case 't':
+    timeout_ms = atoi(optarg);
+    break;
+
+   default:
+    ssid = password = url = NULL;
+    optind = argc + 1;
+    break;
+  }
+ }
+
+ bool is_put = (ssid != NULL) || (password != NULL) || (url != NULL);
+
+ if ((optind > argc) || (argc - optind > 1) || ((is_put == true) && ((!ssid) || (!password) || (!url))))
+ {
+  fprintf(stderr, "Usage: cws_config [-s ssid -p password -u url] [-t timeout_ms] [host[:port]]\n");
+  return 2;
+ }
+
+ std::string target = (optind < argc) ? argv[optind] : DEFAULT_HOST;
+ std::string request;
+
+ if (is_put == true)
+ {
+  struct json_writer writer;
+  char body[BODY_SIZE];
+
+  json_begin_object(&writer, body, sizeof(body));
+  json_add_string(&writer, "ssid", ssid, strlen(ssid));
+  json_add_string(&writer, "password", password, strlen(password));
+  json_add_string(&writer, "url", url, strlen(url));
+
+  int len = json_end_object(&writer);
+
+  if (len < 0)
+  {
+   fprintf(stderr, "Settings longer than %d bytes\n", BODY_SIZE);
+   return 2;
+  }
+
+  request = "PUT " CONFIG_PATH " HTTP/1.1\r\nHost: " + target + "\r\nConnection: close\r\n"
+            "Content-Type: application/json\r\nContent-Length: " + std::to_string(len) + "\r\n\r\n" + body;
+ }
+ else
+ {
+  request = "GET " CONFIG_PATH " HTTP/1.1\r\nHost: " + target + "\r\nConnection: close\r\n\r\n";
+ }
+
+ std::string response;
+ int fd = open_connection(target, timeout_ms);
+
+ if ((fd < 0) || (exchange(fd, request, &response) == false))
+ {
+  fprintf(stderr, "No response from %s\n", target.c_str());
+
+  if (fd >= 0)
+   close(fd);
+
+  return 2;
+ }
+
+ close(fd);
+
+ size_t body_start = response.find("\r\n\r\n");
+ int status = 0;
+
+ if ((body_start == std::string::npos) || (sscanf(response.c_str(), "HTTP/1.%*d %d", &status) != 1))
+ {
+  fprintf(stderr, "Not an HTTP response from %s\n", target.c_str());
+  return 2;
+ }
+
+ printf("%s\n", response.c_str() + body_start + 4);
+
+ if (status != 200)
+ {
+  fprintf(stderr, "%s answered %d\n", target.c_str(), status);
+  return 1;
+ }
+
+ return 0;
+}
@@ -0,0 +1,577 @@
+/*
+ * Copyright (c) 2023, FAV Software Limited. All rights reserved.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * File:   cws_provision.cpp
+ * Author: busdev
+ *
+ * Created on 19 October 2026
+ * Updated on 19 October 2026
+ *
+ * Description
+ * -----------
+ * Factory provisioning client for the binary protocol of
+ * provisioning_frame.h, over a serial port (the UART or USB CDC) or a
+ * pty. For each unit it sends PROV_OP_INFO until the unit answers in
+ * its provisioning window after boot, then one batch:
+ *
+ *   SET_SSID, SET_PASSWORD, SET_URL, COMMIT, INFO, GET_SSID,
+ *   GET_PASSWORD, GET_URL
+ *
+ * and checks that every command succeeded, that the storage state is
+ * "set" and that the settings read back are the ones sent. A lost reply
+ * is recovered by sending the same batch again; the unit answers it
+ * from its last reply. Last, PROV_OP_EXIT lets the unit carry on
+ * booting. Without settings it only reads them.
+ *
+ * With -e the command is started on a pty for each unit, e.g.
+ * "build_host/cws_sim": each start is a new unit with blank flash. With
+ * a device name, each unit is the next one to be reset or plugged in.
+ * -n provisions that many units and reports the time per unit, from
+ * opening the port to the verified settings, and units per minute.
+ *
+ * Usage: cws_provision [-s ssid -p password -u url] [-n units]
+ *                      [-t timeout_ms] (-e command | device)
+ * Returns 0 if every unit was provisioned and verified, 1 if one was
+ * not, 2 if the port or command could not be opened.
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <poll.h>
+#include <pty.h>
+#include <sys/wait.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "provisioning_frame.h"
+
+#define DEFAULT_TIMEOUT_MS 10000    // To reset a unit by hand.
+#define HELLO_INTERVAL_MS  20       // Well inside PROVISIONING_WINDOW_MS.
+#define REPLY_TIMEOUT_MS   2000     // A commit erases and programs a sector.
+#define BATCH_ATTEMPTS     3
+#define EXIT_TIMEOUT_MS    2000     // For a started command to exit.
+
+#define SEQUENCE_HELLO 1
+#define SEQUENCE_BATCH 2
+#define SEQUENCE_EXIT  3
+
+#define EPD_STORE_CREDENTIALS_SET 4  // storage_handler.h
+
+struct settings
+{
+ const char *ssid;
+ const char *password;
+ const char *url;
+};
+
+struct unit_result
+{
+ bool is_verified;
+ double total_ms;
+ double hello_ms;
+ double batch_ms;
+ int attempts;
+ uint64_t bytes_sent;
+ uint64_t bytes_received;
+};
+
+struct port
+{
+ int fd;
+ pid_t pid;                    // Started command, or -1.
+ struct prov_decoder decoder;
+ uint64_t bytes_sent;
+ uint64_t bytes_received;
+};
+
+static const char *status_names[] =
+{
+ "ok", "format", "op", "value", "storage", "verify", "size", "skipped"
+};
+
+static uint64_t now_us(void)
+{
+ return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static const char *status_name(uint8_t status)
+{
+ return (status < sizeof(status_names) / sizeof(status_names[0])) ? status_names[status] : "unknown";
+}
+
+/*!
+* \brief Sets a terminal to raw bytes, no echo or line editing.
+*/
+
+static bool make_raw(int fd, bool is_serial)
+{
+ struct termios tio;
+
+ if (tcgetattr(fd, &tio) != 0)
+  return false;
+
+ cfmakeraw(&tio);
+
+ if (is_serial == true)
+ {
+  cfsetispeed(&tio, B115200);
+  cfsetospeed(&tio, B115200);
+  tio.c_cflag |= CLOCAL | CREAD;
+ }
+
+ return tcsetattr(fd, TCSANOW, &tio) == 0;
+}
+
+/*!
+* \brief Opens a serial device, or starts a command on a pty.
+*
+* \return bool. false if it could not be opened.
+*/
+
+static bool open_port(struct port *p, const char *device, const char *command)
+{
+ p->pid = -1;
+ p->bytes_sent = 0;
+ p->bytes_received = 0;
+ prov_decoder_init(&p->decoder);
+
+ if (command == NULL)
+ {
+  p->fd = open(device, O_RDWR | O_NOCTTY);
+  return (p->fd >= 0) && (make_raw(p->fd, true) == true);
+ }
+
+ int slave;
+
+ if (openpty(&p->fd, &slave, NULL, NULL, NULL) != 0)
+  return false;
+
+ make_raw(slave, false);  // Before the command can write to it.
+
+ p->pid = fork();
+
+ if (p->pid == 0)
+ {
+  setsid();
+  dup2(slave, STDIN_FILENO);
+  dup2(slave, STDOUT_FILENO);
+  close(slave);
+  close(p->fd);
+  execl("/bin/sh", "sh", "-c", command, (char *)NULL);
+  _exit(127);
+ }
+
+ close(slave);
+
+ return p->pid > 0;
+}
+
+/*!
+* \brief Closes the port; a started command is given EXIT_TIMEOUT_MS to exit.
+*/
+
+static void close_port(struct port *p)
+{
+ if (p->pid > 0)
+ {
+  uint64_t end_us = now_us() + (EXIT_TIMEOUT_MS * 1000);
+  char drain[256];
+
+  while ((waitpid(p->pid, NULL, WNOHANG) == 0) && (now_us() < end_us))
+  {
+   if (read(p->fd, drain, sizeof(drain)) <= 0)  // Keep the pty from filling.
+    usleep(1000);
+  }
+
+  if (kill(p->pid, 0) == 0)
+  {
+   kill(p->pid, SIGTERM);
+   waitpid(p->pid, NULL, 0);
+  }
+ }
+
+ if (p->fd >= 0)
+  close(p->fd);
+
+ p->fd = -1;
+}
+
+/*!
+* \brief Frames and sends a payload.
+*/
+
+static bool send_payload(struct port *p, const uint8_t *payload, int len)
+{
+ static uint8_t frame[PROV_MAX_FRAME];
+ int frame_len = prov_encode(frame, sizeof(frame), payload, len);
+
+ if (frame_len < 0)
+  return false;
+
+ for (int sent = 0; sent < frame_len; )
+ {
+  ssize_t n = write(p->fd, frame + sent, frame_len - sent);
+
+  if ((n < 0) && (errno != EINTR) && (errno != EAGAIN))
+   return false;
+
+  if (n > 0)
+   sent += n;
+ }
+
+ p->bytes_sent += frame_len;
+
+ return true;
+}
+
+/*!
+* \brief Waits for the reply with a sequence number.
+*
+* Other bytes on the line, log text for example, are skipped.
+*
+* \return bool. true when the reply is in p->decoder.payload.
+*/
+
+static bool receive_reply(struct port *p, uint8_t sequence, int timeout_ms)
+{
+ uint64_t end_us = now_us() + ((uint64_t)timeout_ms * 1000);
+ uint8_t buf[512];
+
+ for (;;)
+ {
+  int64_t left_us = (int64_t)(end_us - now_us());
+  struct pollfd fds = { p->fd, POLLIN, 0 };
+
+  if (left_us <= 0)
+   return false;
+
+  if (poll(&fds, 1, (int)((left_us + 999) / 1000)) <= 0)
+   continue;
+
+  ssize_t n = read(p->fd, buf, sizeof(buf));
+
+  if (n <= 0)
+   return false;  // The command exited, or the device went away.
+
+  p->bytes_received += n;
+
+  for (ssize_t i = 0; i < n; i++)
+  {
+   if ((prov_decode(&p->decoder, buf[i]) == PROV_DECODE_FRAME) && (p->decoder.payload[0] == sequence))
+    return true;  // The rest of buf is after the reply, nothing is expected.
+  }
+ }
+}
+
+/*!
+* \brief Builds the batch: set and commit the settings, then read them back.
+*
+* \return int. Length of the payload, or -1.
+*/
+
+static int build_batch(uint8_t *payload, int size, const struct settings *s)
+{
+ int len = 1;
+
+ payload[0] = SEQUENCE_BATCH;
+
+ if (s->ssid != NULL)
+ {
+  len = prov_add_record(payload, size, len, PROV_OP_SET_SSID, 0, s->ssid, strlen(s->ssid));
+  len = prov_add_record(payload, size, len, PROV_OP_SET_PASSWORD, 0, s->password, strlen(s->password));
+  len = prov_add_record(payload, size, len, PROV_OP_SET_URL, 0, s->url, strlen(s->url));
+  len = prov_add_record(payload, size, len, PROV_OP_COMMIT, 0, NULL, 0);
+ }
+
+ len = prov_add_record(payload, size, len, PROV_OP_INFO, 0, NULL, 0);
+ len = prov_add_record(payload, size, len, PROV_OP_GET_SSID, 0, NULL, 0);
+ len = prov_add_record(payload, size, len, PROV_OP_GET_PASSWORD, 0, NULL, 0);
+ len = prov_add_record(payload, size, len, PROV_OP_GET_URL, 0, NULL, 0);
+
+ return len;
+}
+
+/*!
+* \brief Checks the reply to the batch, printing the settings read back.
+*
+* \return bool. true if every command succeeded and, when settings were
+* sent, they read back unchanged and the storage state is set.
+*/
+
+static bool check_reply(const uint8_t *payload, int len, const struct settings *s)
+{
+ struct prov_record record;
+ int cursor = 1;
+ int result;
+ int records = 0;
+ bool is_ok = true;
+ std::string value;
+
+ while ((result = prov_next_record(payload, len, &cursor, &record)) == PROV_RECORD)
+ {
+  const char *expected = NULL;
+
+  records++;
+  value.assign((const char *)record.value, record.value_len);
+
+  if (record.status != PROV_OK)
+  {
+   fprintf(stderr, "  op 0x%02x: %s\n", record.op, status_name(record.status));
+   is_ok = false;
+   continue;
+  }
+
+  switch (record.op)
+  {
+   case PROV_OP_INFO:
+    if (record.value_len >= 2)
+    {
+     printf("  version %u, storage state %u\n", record.value[0], record.value[1]);
+
+     if ((s->ssid != NULL) && (record.value[1] != EPD_STORE_CREDENTIALS_SET))
+     {
+      fprintf(stderr, "  storage state not set\n");
+      is_ok = false;
+     }
+    }
+    break;
+
+   case PROV_OP_GET_SSID:
+    printf("  ssid     \"%s\"\n", value.c_str());
+    expected = s->ssid;
+    break;
+
+   case PROV_OP_GET_PASSWORD:
+    printf("  password \"%s\"\n", value.c_str());
+    expected = s->password;
+    break;
+
+   case PROV_OP_GET_URL:
+    printf("  url      \"%s\"\n", value.c_str());
+    expected = s->url;
+    break;
+  }
+
+  if ((expected != NULL) && (value != expected))
+  {
+   fprintf(stderr, "  op 0x%02x read back differs\n", record.op);
+   is_ok = false;
+  }
+ }
+
+ if ((result == PROV_ERROR) || (records != ((s->ssid != NULL) ? 8 : 4)))
+ {
+  fprintf(stderr, "  malformed reply, %d results\n", records);
+  is_ok = false;
+ }
+
+ return is_ok;
+}
+
+/*!
+* \brief Provisions, or reads, one unit.
+*/
+
+static void run_unit(const char *device, const char *command, const struct settings *s, int timeout_ms, struct unit_result *r)
+{
+ static struct port p;
+ static uint8_t payload[PROV_MAX_PAYLOAD];
+ uint8_t hello[1 + PROV_RECORD_HEADER];
+ uint8_t bye[1 + PROV_RECORD_HEADER];
+ uint64_t start_us = now_us();
+ uint64_t end_us = start_us + ((uint64_t)timeout_ms * 1000);
+ bool is_open = false;
+ int len;
+
+ memset(r, 0, sizeof(*r));
+
+ if (open_port(&p, device, command) == false)
+ {
+  fprintf(stderr, "Cannot open %s\n", (command != NULL) ? command : device);
+  close_port(&p);
+  exit(2);
+ }
+
+// Knock until the unit is in its provisioning window.
+
+ hello[0] = SEQUENCE_HELLO;
+ prov_add_record(hello, sizeof(hello), 1, PROV_OP_INFO, 0, NULL, 0);
+
+ while ((is_open == false) && (now_us() < end_us))
+ {
+  send_payload(&p, hello, sizeof(hello));
+  is_open = receive_reply(&p, SEQUENCE_HELLO, HELLO_INTERVAL_MS);
+ }
+
+ r->hello_ms = (now_us() - start_us) / 1e3;
+
+ if (is_open == false)
+ {
+  fprintf(stderr, "  no answer\n");
+  close_port(&p);
+  return;
+ }
+
+// One batch, sent again if its reply is lost.
+
+ uint64_t batch_us = now_us();
+ bool is_answered = false;
+
+ len = build_batch(payload, sizeof(payload), s);
+
+ if (len < 0)
+ {
+  fprintf(stderr, "  settings do not fit a batch\n");
+  close_port(&p);
+  return;
+ }
+
+ while ((is_answered == false) && (r->attempts < BATCH_ATTEMPTS))
+ {
+  r->attempts++;
+  is_answered = (send_payload(&p, payload, len) == true) && (receive_reply(&p, SEQUENCE_BATCH, REPLY_TIMEOUT_MS) == true);
+ }
+
+ r->batch_ms = (now_us() - batch_us) / 1e3;
+
+ if (is_answered == true)
+  r->is_verified = check_reply(p.decoder.payload, p.decoder.length, s);
+ else
+  fprintf(stderr, "  no answer to the batch\n");
+
+ r->total_ms = (now_us() - start_us) / 1e3;
+
+// Let the unit carry on, whatever happened; it ends the session itself otherwise.
+
+ bye[0] = SEQUENCE_EXIT;
+ prov_add_record(bye, sizeof(bye), 1, PROV_OP_EXIT, 0, NULL, 0);
+ send_payload(&p, bye, sizeof(bye));
+ receive_reply(&p, SEQUENCE_EXIT, REPLY_TIMEOUT_MS);
+
+ r->bytes_sent = p.bytes_sent;
+ r->bytes_received = p.bytes_received;
+
+ close_port(&p);
+}
+
+static double percentile(std::vector<double> v, double p)
+{
+ if (v.empty())
+  return 0;
+
+ std::sort(v.begin(), v.end());
+
+ return v[std::min(v.size() - 1, (size_t)(p * v.size()))];
+}
+
+int main(int argc, char **argv)
+{
+ struct settings s = { NULL, NULL, NULL };
+ const char *command = NULL;
+ int timeout_ms = DEFAULT_TIMEOUT_MS;
+ int units = 1;
+ int opt;
+
+ while ((opt = getopt(argc, argv, "s:p:u:n:t:e:")) != -1)
+ {
+  switch (opt)
+  {
+   case 's':
+    s.ssid = optarg;
+    break;
+
+   case 'p':
+    s.password = optarg;
+    break;
+
+   case 'u':
+    s.url = optarg;
+    break;
+
+   case 'n':
+    units = std::max(1, atoi(optarg));
+    break;
+
+   case 't':
+    timeout_ms = atoi(optarg);
+    break;
+
+   case 'e':
+    command = optarg;
+    break;
+
+   default:
+    optind = argc + 1;
+    break;
+  }
+ }
+
+ bool is_set = (s.ssid != NULL) || (s.password != NULL) || (s.url != NULL);
+ const char *device = (optind < argc) ? argv[optind] : NULL;
+
+ if ((optind > argc) || (argc - optind > 1) || ((command == NULL) == (device == NULL)) ||
+     ((is_set == true) && ((!s.ssid) || (!s.password) || (!s.url))))
+ {
+  fprintf(stderr, "Usage: cws_provision [-s ssid -p password -u url] [-n units] [-t timeout_ms] (-e command | device)\n");
+  return 2;
+ }
+
+ std::vector<double> times;
+ uint64_t start_us = now_us();
+ int failures = 0;
+
+ for (int i = 1; i <= units; i++)
+ {
+  struct unit_result r;
+
+  printf("Unit %d\n", i);
+  fflush(stdout);
+
+  run_unit(device, command, &s, timeout_ms, &r);
+
+  if (r.is_verified == true)
+  {
+   times.push_back(r.total_ms);
+   printf("  %s in %.1f ms (window %.1f ms, batch %.1f ms, %d attempt%s), %llu bytes sent, %llu received\n",
+          is_set ? "provisioned and verified" : "read", r.total_ms, r.hello_ms, r.batch_ms, r.attempts,
+          (r.attempts == 1) ? "" : "s", (unsigned long long)r.bytes_sent, (unsigned long long)r.bytes_received);
+  }
+  else
+  {
+   failures++;
+   printf("  FAILED\n");
+  }
+ }
+
+ if (units > 1)
+ {
+  double elapsed_s = (now_us() - start_us) / 1e6;
+
+  printf("\n%d units, %d failed, %.1f s, %.1f units per minute\n", units, failures, elapsed_s, units / elapsed_s * 60);
+  printf("Per unit: p50 %.1f ms, p99 %.1f ms, max %.1f ms\n", percentile(times, 0.5), percentile(times, 0.99), percentile(times, 1.0));
+ }
+
+ return (failures == 0) ? 0 : 1;
+}
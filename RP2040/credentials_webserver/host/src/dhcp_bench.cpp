@@ -0,0 +1,945 @@
+/*
+ * Copyright (c) 2023, FAV Software Limited. All rights reserved.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * File:   dhcp_bench.cpp
+ * Author: busdev
+ *
+ * Created on 19 October 2026
+ * Updated on 19 October 2026
+ *
+ * Description
+ * -----------
+ * Host benchmark and replay harness for the DHCP server (dhcpserver.c),
+ * run against the lwIP stand-in in host_lwip.cpp and a fake tick.
+ *
+ * Every reply is checked: transaction id and client MAC, server id, an
+ * address from the pool, an ACK for the address requested, no address
+ * given to two clients while a lease is current, and the destination
+ * (RFC 2131 4.1: NAK and broadcast flag broadcast, ciaddr when set,
+ * otherwise unicast to yiaddr through a static ARP entry for chaddr).
+ * No pbuf or ARP entry may be left behind.
+ *
+ * With no capture files it runs:
+ *
+ * 1. Storm: clients DISCOVER, REQUEST and RELEASE in waves of the pool
+ *    size, half of them asking for broadcast replies and every 8th
+ *    packet in a chained pbuf. Reports packets per second.
+ * 2. Exhaustion: pool size + 8 clients. Expects the pool to be handed
+ *    out, the extra DISCOVERs ignored, their REQUESTs for bound
+ *    addresses NAKed, and addresses again once the leases run out.
+ * 3. Wraparound: the same lease expiry and offer hold checks with the
+ *    tick wrapping from 0xffffffff to 0 half way through.
+ *
+ * Capture files (pcap, Ethernet, Linux cooked or raw IPv4) are replayed
+ * instead, packets to UDP port 67 only, at their captured times. -w
+ * writes the storm to a pcap file, to replay here or with tcpreplay.
+ *
+ * Usage: dhcp_bench [-c clients] [-s server_ip] [-t start_tick_ms]
+ *                   [-w storm.pcap] [capture.pcap ...]
+ * Returns non-zero if any check failed.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <vector>
+#include <arpa/inet.h>
+#include <unistd.h>
+
+#include "pico/stdlib.h"
+#include "dhcpserver.h"
+#include "host_lwip.h"
+#include "metrics.h"
+
+#define DEFAULT_CLIENTS      10000
+#define DEFAULT_SERVER_IP    0xc0a80401     // 192.168.4.1, as in main.cpp.
+#define DEFAULT_NETMASK      0xffffff00
+#define DEFAULT_START_TICK   0xffffd8f0     // Wraps 10 s in.
+#define EXTRA_CLIENTS        8
+#define SPLIT_EVERY          8              // Every nth packet delivered in a chain.
+#define SPLIT_AT             100
+
+#define DHCP_SERVER_PORT     67
+#define DHCP_CLIENT_PORT     68
+#define DHCP_REQUEST_SIZE    300            // BOOTP minimum, as most clients send.
+#define DHCP_MAGIC           0x63825363
+
+#define DHCPDISCOVER         1
+#define DHCPOFFER            2
+#define DHCPREQUEST          3
+#define DHCPDECLINE          4
+#define DHCPACK              5
+#define DHCPNAK              6
+#define DHCPRELEASE          7
+#define DHCPINFORM           8
+
+#define OPT_REQUESTED_IP     50
+#define OPT_LEASE_TIME       51
+#define OPT_MSG_TYPE         53
+#define OPT_SERVER_ID        54
+#define OPT_END              255
+
+#define PCAP_MAGIC           0xa1b2c3d4
+#define PCAP_MAGIC_NS        0xa1b23c4d
+#define LINKTYPE_ETHERNET    1
+#define LINKTYPE_RAW         101
+#define LINKTYPE_LINUX_SLL   113
+#define LINKTYPE_IPV4        228
+
+struct dhcp_packet
+{
+ uint8_t type;                  // Option 53, 0 if missing.
+ uint32_t xid;
+ bool broadcast;
+ uint32_t ciaddr;               // Host byte order, as the rest.
+ uint32_t yiaddr;
+ uint8_t chaddr[6];
+ uint32_t requested_ip;         // Option 50, 0 if missing.
+ uint32_t server_id;            // Option 54, 0 if missing.
+ uint32_t lease_s;              // Option 51, 0 if missing.
+};
+
+struct binding
+{
+ uint32_t ip;
+ uint32_t expiry_ms;
+};
+
+struct bench_counts
+{
+ uint32_t packets;
+ uint32_t replies[DHCPNAK + 1];
+ uint32_t ignored;
+ uint32_t errors;
+ uint32_t pbufs_delivered;      // Request pbufs, the rest were allocated by the server.
+ uint64_t server_us;            // Time in the server, delivery to return.
+};
+
+struct capture_packet
+{
+ uint64_t time_us;
+ std::vector<uint8_t> data;
+};
+
+static dhcp_server_t server;
+static uint32_t server_ip = DEFAULT_SERVER_IP;
+static uint32_t now_ms;
+static struct host_lwip_datagram reply;
+static int reply_count;
+static struct bench_counts counts;
+static std::map<uint64_t, struct binding> bindings;    // Current leases by MAC, from the ACKs.
+static FILE *pcap_out;
+
+static const char *type_names[DHCPNAK + 1] = { "", "DISCOVER", "OFFER", "REQUEST", "DECLINE", "ACK", "NAK" };
+
+/*!
+* \brief Reports a failed check.
+*/
+
+static void check_failed(const struct dhcp_packet *request, const char *what)
+{
+ if (counts.errors < 20)
+ {
+  printf(" FAIL at tick %u, %s from %02x:%02x:%02x:%02x:%02x:%02x: %s\n", now_ms,
+         (request->type <= DHCPNAK) ? type_names[request->type] : "?",
+         request->chaddr[0], request->chaddr[1], request->chaddr[2], request->chaddr[3], request->chaddr[4], request->chaddr[5], what);
+ }
+
+ counts.errors++;
+}
+
+static uint64_t mac_key(const uint8_t *mac)
+{
+ uint64_t key = 0;
+
+ for (int i = 0; i < 6; i++)
+  key = (key << 8) | mac[i];
+
+ return key;
+}
+
+static uint32_t get_u32(const uint8_t *p)
+{
+ return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+static void put_u32(uint8_t *p, uint32_t value)
+{
+ p[0] = value >> 24;
+ p[1] = value >> 16;
+ p[2] = value >> 8;
+ p[3] = value;
+}
+
+static void put_u16(uint8_t *p, uint16_t value)
+{
+ p[0] = value >> 8;
+ p[1] = value;
+}
+
+/*!
+* \brief Parses the fields of a DHCP message the checks need.
+*
+* \return bool. false if it is not a DHCP message.
+*/
+
+static bool parse_dhcp(const uint8_t *data, int len, struct dhcp_packet *packet)
+{
+ memset(packet, 0, sizeof(*packet));
+
+ if ((len < 240) || (get_u32(&data[236]) != DHCP_MAGIC))
+  return false;
+
+ packet->xid = get_u32(&data[4]);
+ packet->broadcast = (data[10] & 0x80) != 0;
+ packet->ciaddr = get_u32(&data[12]);
+ packet->yiaddr = get_u32(&data[16]);
+ memcpy(packet->chaddr, &data[28], 6);
+
+ for (int i = 240; (i < len) && (data[i] != OPT_END); )
+ {
+  if (data[i] == 0)
+  {
+   i++;
+   continue;
+  }
+
+  if ((i + 2 > len) || (i + 2 + data[i + 1] > len))
+   return false;
+
+  const uint8_t *value = &data[i + 2];
+
+  if ((data[i] == OPT_MSG_TYPE) && (data[i + 1] == 1))
+   packet->type = value[0];
+  else if ((data[i] == OPT_REQUESTED_IP) && (data[i + 1] == 4))
+   packet->requested_ip = get_u32(value);
+  else if ((data[i] == OPT_SERVER_ID) && (data[i + 1] == 4))
+   packet->server_id = get_u32(value);
+  else if ((data[i] == OPT_LEASE_TIME) && (data[i + 1] == 4))
+   packet->lease_s = get_u32(value);
+
+  i += 2 + data[i + 1];
+ }
+
+ return true;
+}
+
+/*!
+* \brief Builds a client message, padded to the BOOTP minimum.
+*
+* \return int. Length.
+*/
+
+static int build_request(uint8_t *buf, uint8_t type, const uint8_t *mac, uint32_t xid, uint32_t requested_ip, uint32_t ciaddr, bool broadcast)
+{
+ uint8_t *opt = &buf[240];
+
+ memset(buf, 0, DHCP_REQUEST_SIZE);
+ buf[0] = 1;                    // BOOTREQUEST
+ buf[1] = 1;                    // Ethernet
+ buf[2] = 6;
+ put_u32(&buf[4], xid);
+ buf[10] = broadcast ? 0x80 : 0;
+ put_u32(&buf[12], ciaddr);
+ memcpy(&buf[28], mac, 6);
+ put_u32(&buf[236], DHCP_MAGIC);
+
+ *opt++ = OPT_MSG_TYPE;
+ *opt++ = 1;
+ *opt++ = type;
+
+ if (requested_ip != 0)
+ {
+  *opt++ = OPT_REQUESTED_IP;
+  *opt++ = 4;
+  put_u32(opt, requested_ip);
+  opt += 4;
+ }
+
+ if ((type == DHCPREQUEST) || (type == DHCPRELEASE) || (type == DHCPDECLINE))
+ {
+  *opt++ = OPT_SERVER_ID;
+  *opt++ = 4;
+  put_u32(opt, server_ip);
+  opt += 4;
+ }
+
+ *opt = OPT_END;
+
+ return DHCP_REQUEST_SIZE;
+}
+
+// pcap files.
+
+/*!
+* \brief Writes a client message to the storm capture as an Ethernet
+* frame, 0.0.0.0:68 (or ciaddr) to 255.255.255.255:67.
+*/
+
+static void write_pcap_frame(const uint8_t *data, int len)
+{
+ uint8_t frame[14 + 20 + 8 + DHCP_REQUEST_SIZE];
+ uint8_t *ip = &frame[14];
+ uint8_t *udp = &frame[34];
+ uint32_t record[4] = { now_ms / 1000, (now_ms % 1000) * 1000, (uint32_t)(42 + len), (uint32_t)(42 + len) };
+ uint32_t sum = 0;
+
+ if ((pcap_out == NULL) || (len > DHCP_REQUEST_SIZE))
+  return;
+
+ memset(frame, 0xff, 6);
+ memcpy(&frame[6], &data[28], 6);
+ put_u16(&frame[12], 0x0800);
+
+ memset(ip, 0, 20);
+ ip[0] = 0x45;
+ put_u16(&ip[2], 20 + 8 + len);
+ ip[8] = 64;
+ ip[9] = 17;
+ memcpy(&ip[12], &data[12], 4);
+ put_u32(&ip[16], 0xffffffff);
+
+ for (int i = 0; i < 20; i += 2)
+  sum += (ip[i] << 8) | ip[i + 1];
+
+ while (sum >> 16)
+  sum = (sum & 0xffff) + (sum >> 16);
+
+ put_u16(&ip[10], ~sum);
+
+ put_u16(&udp[0], DHCP_CLIENT_PORT);
+ put_u16(&udp[2], DHCP_SERVER_PORT);
+ put_u16(&udp[4], 8 + len);
+ put_u16(&udp[6], 0);          // No checksum.
+ memcpy(&udp[8], data, len);
+
+ fwrite(record, sizeof(record), 1, pcap_out);
+ fwrite(frame, 42 + len, 1, pcap_out);
+}
+
+static FILE *open_pcap_out(const char *path)
+{
+ uint32_t header[6] = { PCAP_MAGIC, 0x00040002, 0, 0, 65535, LINKTYPE_ETHERNET };
+ FILE *f = fopen(path, "wb");
+
+ if (f != NULL)
+  fwrite(header, sizeof(header), 1, f);
+
+ return f;
+}
+
+/*!
+* \brief Reads the UDP port 67 payloads of a capture.
+*
+* \return bool. false if the file cannot be read or is not a pcap file.
+*/
+
+static bool read_pcap(const char *path, std::vector<struct capture_packet> &packets)
+{
+ FILE *f = fopen(path, "rb");
+ uint32_t header[6];
+ uint32_t record[4];
+ std::vector<uint8_t> frame;
+
+ if (f == NULL)
+  return false;
+
+ if (fread(header, sizeof(header), 1, f) != 1)
+ {
+  fclose(f);
+  return false;
+ }
+
+ bool swapped = (header[0] == __builtin_bswap32(PCAP_MAGIC)) || (header[0] == __builtin_bswap32(PCAP_MAGIC_NS));
+ uint32_t magic = swapped ? __builtin_bswap32(header[0]) : header[0];
+ uint32_t linktype = swapped ? __builtin_bswap32(header[5]) : header[5];
+
+ if ((magic != PCAP_MAGIC) && (magic != PCAP_MAGIC_NS))
+ {
+  fclose(f);
+  return false;
+ }
+
+ while (fread(record, sizeof(record), 1, f) == 1)
+ {
+  for (int i = 0; (i < 4) && (swapped == true); i++)
+   record[i] = __builtin_bswap32(record[i]);
+
+  frame.resize(record[2]);
+
+  if ((record[2] > 0) && (fread(frame.data(), record[2], 1, f) != 1))
+   break;
+
+// Find the IPv4 header.
+
+  size_t offset;
+  uint16_t ethertype = 0x0800;
+
+  if (linktype == LINKTYPE_ETHERNET)
+  {
+   offset = 14;
+   ethertype = (frame.size() >= 14) ? ((frame[12] << 8) | frame[13]) : 0;
+
+   if ((ethertype == 0x8100) && (frame.size() >= 18))
+   {
+    offset = 18;
+    ethertype = (frame[16] << 8) | frame[17];
+   }
+  }
+  else if (linktype == LINKTYPE_LINUX_SLL)
+  {
+   offset = 16;
+   ethertype = (frame.size() >= 16) ? ((frame[14] << 8) | frame[15]) : 0;
+  }
+  else if ((linktype == LINKTYPE_RAW) || (linktype == LINKTYPE_IPV4))
+   offset = 0;
+  else
+   break;
+
+  if ((ethertype != 0x0800) || (frame.size() < offset + 20))
+   continue;
+
+  const uint8_t *ip = &frame[offset];
+  size_t ip_len = (ip[0] & 0x0f) * 4;
+
+  if (((ip[0] >> 4) != 4) || (ip[9] != 17) || ((((ip[6] << 8) | ip[7]) & 0x3fff) != 0))
+   continue;                    // Not UDP, or a fragment.
+
+  if (frame.size() < offset + ip_len + 8)
+   continue;
+
+  const uint8_t *udp = ip + ip_len;
+  size_t udp_len = (udp[4] << 8) | udp[5];
+
+  if ((((udp[2] << 8) | udp[3]) != DHCP_SERVER_PORT) || (udp_len < 8))
+   continue;
+
+  udp_len = std::min(udp_len - 8, frame.size() - (offset + ip_len + 8));
+
+  struct capture_packet packet;
+  packet.time_us = (uint64_t)record[0] * 1000000 + ((magic == PCAP_MAGIC_NS) ? (record[1] / 1000) : record[1]);
+  packet.data.assign(udp + 8, udp + 8 + udp_len);
+  packets.push_back(packet);
+ }
+
+ fclose(f);
+ return true;
+}
+
+// Server and checks.
+
+static void capture_reply(const struct host_lwip_datagram *datagram, void *arg)
+{
+ (void)arg;
+ reply = *datagram;
+ reply_count++;
+}
+
+static void restart_server(uint32_t tick_ms)
+{
+ ip_addr_t ip;
+ ip_addr_t nm;
+
+ dhcp_server_deinit(&server);
+ now_ms = tick_ms;
+ host_lwip_set_ticks_ms(now_ms);
+ IP4_ADDR(&ip, server_ip >> 24, server_ip >> 16, server_ip >> 8, server_ip);
+ IP4_ADDR(&nm, DEFAULT_NETMASK >> 24, DEFAULT_NETMASK >> 16, DEFAULT_NETMASK >> 8, DEFAULT_NETMASK);
+ dhcp_server_init(&server, &ip, &nm);
+ bindings.clear();
+}
+
+static void set_tick(uint32_t tick_ms)
+{
+ now_ms = tick_ms;
+ host_lwip_set_ticks_ms(now_ms);
+}
+
+static bool in_pool(uint32_t ip)
+{
+ return ((ip & DEFAULT_NETMASK) == (server_ip & DEFAULT_NETMASK)) &&
+        ((ip & 0xff) >= DHCPS_BASE_IP) && ((ip & 0xff) < DHCPS_BASE_IP + DHCPS_MAX_IP);
+}
+
+/*!
+* \brief Checks a reply against the request and the leases seen so far.
+*/
+
+static void check_reply(const struct dhcp_packet *request)
+{
+ struct dhcp_packet answer;
+
+ if (reply_count > 1)
+  check_failed(request, "more than one reply");
+
+ if ((reply.dest_port != DHCP_CLIENT_PORT) || (parse_dhcp(reply.data, reply.len, &answer) == false) || (answer.type == 0))
+ {
+  check_failed(request, "reply is not a DHCP message");
+  return;
+ }
+
+ if (answer.type <= DHCPNAK)
+  counts.replies[answer.type]++;
+
+ if ((answer.xid != request->xid) || (memcmp(answer.chaddr, request->chaddr, 6) != 0))
+  check_failed(request, "reply xid or chaddr differs from the request");
+
+ if (answer.server_id != server_ip)
+  check_failed(request, "reply server id is not the server address");
+
+ if ((answer.type == DHCPOFFER) || ((answer.type == DHCPACK) && (request->type != DHCPINFORM)))
+ {
+  if (in_pool(answer.yiaddr) == false)
+   check_failed(request, "address is not from the pool");
+
+  for (auto &entry : bindings)
+  {
+   if ((entry.second.ip == answer.yiaddr) && (entry.first != mac_key(request->chaddr)) && ((int32_t)(entry.second.expiry_ms - now_ms) > 0))
+    check_failed(request, "address is leased to another client");
+  }
+ }
+
+ if (answer.type == DHCPACK)
+ {
+  uint32_t wanted = (request->requested_ip != 0) ? request->requested_ip : request->ciaddr;
+
+  if ((request->type == DHCPREQUEST) && (answer.yiaddr != wanted))
+   check_failed(request, "ACK for a different address than requested");
+
+  if ((request->type == DHCPREQUEST) && (answer.lease_s == 0))
+   check_failed(request, "ACK without a lease time");
+
+  if (answer.yiaddr != 0)
+   bindings[mac_key(request->chaddr)] = { answer.yiaddr, now_ms + answer.lease_s * 1000 };
+ }
+
+// Destination, RFC 2131 4.1.
+
+ if ((answer.type == DHCPNAK) || ((request->ciaddr == 0) && (request->broadcast == true)))
+ {
+  if (reply.dest_ip != 0xffffffff)
+   check_failed(request, "reply not broadcast");
+ }
+ else if (request->ciaddr != 0)
+ {
+  if (reply.dest_ip != request->ciaddr)
+   check_failed(request, "reply not sent to ciaddr");
+ }
+ else if ((reply.dest_ip != answer.yiaddr) || (reply.has_static_arp == false) || (memcmp(reply.static_arp_mac, request->chaddr, 6) != 0))
+  check_failed(request, "reply not unicast to yiaddr at chaddr");
+}
+
+/*!
+* \brief Delivers a client message to the server and checks the outcome.
+*
+* \param split Length of the first pbuf of a chain, 0 for a single pbuf.
+* \param answer Set to the reply, if not NULL.
+* \return uint8_t. Reply type, 0 if there was no reply.
+*/
+
+static uint8_t send_request(const uint8_t *data, int len, uint16_t split, struct dhcp_packet *answer)
+{
+ struct dhcp_packet request;
+ bool is_dhcp = parse_dhcp(data, len, &request);
+
+ reply_count = 0;
+ counts.packets++;
+ counts.pbufs_delivered += ((split > 0) && (split < len)) ? 2 : 1;
+ write_pcap_frame(data, len);
+
+ uint64_t t0 = time_us_64();
+ host_lwip_deliver(data, len, request.ciaddr, DHCP_CLIENT_PORT, DHCP_SERVER_PORT, split);
+ counts.server_us += time_us_64() - t0;
+
+ struct host_lwip_stats stats = host_lwip_get_stats();
+
+ if (stats.pbufs_live != 0)
+  check_failed(&request, "pbuf leaked");
+
+ if (stats.static_arp_entries != 0)
+  check_failed(&request, "static ARP entry left behind");
+
+ if ((is_dhcp == true) && (request.type == DHCPRELEASE))
+  bindings.erase(mac_key(request.chaddr));
+
+ if (reply_count == 0)
+ {
+  counts.ignored++;
+  return 0;
+ }
+
+ if (is_dhcp == false)
+ {
+  check_failed(&request, "reply to a message that is not DHCP");
+  return 0;
+ }
+
+ check_reply(&request);
+
+ struct dhcp_packet parsed;
+
+ if (answer == NULL)
+  answer = &parsed;
+
+ parse_dhcp(reply.data, reply.len, answer);
+
+ return answer->type;
+}
+
+// Scenarios.
+
+struct client
+{
+ uint8_t mac[6];
+ uint32_t xid;
+ bool broadcast;
+ uint32_t ip;                   // Last address offered or acknowledged.
+};
+
+static void make_client(struct client *c, uint32_t number)
+{
+ c->mac[0] = 0x02;              // Locally administered.
+ c->mac[1] = 0x00;
+ put_u32(&c->mac[2], number);
+ c->xid = number * 2654435761u;
+ c->broadcast = (number & 1) != 0;
+ c->ip = 0;
+}
+
+/*!
+* \brief Sends a message from a simulated client, 1 ms after the last.
+*
+* \return uint8_t. Reply type, 0 if there was no reply.
+*/
+
+static uint8_t client_send(struct client *c, uint8_t type, uint32_t requested_ip, uint32_t ciaddr)
+{
+ uint8_t buf[DHCP_REQUEST_SIZE];
+ struct dhcp_packet answer;
+ int len = build_request(buf, type, c->mac, c->xid++, requested_ip, ciaddr, c->broadcast);
+ uint16_t split = ((counts.packets % SPLIT_EVERY) == SPLIT_EVERY - 1) ? SPLIT_AT : 0;
+
+ set_tick(now_ms + 1);
+ uint8_t reply_type = send_request(buf, len, split, &answer);
+
+ if ((reply_type == DHCPOFFER) || (reply_type == DHCPACK))
+  c->ip = answer.yiaddr;
+
+ return reply_type;
+}
+
+static void expect(bool condition, const char *what)
+{
+ if (condition == false)
+ {
+  printf(" FAIL: %s\n", what);
+  counts.errors++;
+ }
+}
+
+static void begin_scenario(const char *name, int clients)
+{
+ memset(&counts, 0, sizeof(counts));
+ host_lwip_reset_stats();
+ if (clients > 0)
+  printf("%s (%d clients, pool %d)\n", name, clients, DHCPS_MAX_IP);
+ else
+  printf("%s (pool %d)\n", name, DHCPS_MAX_IP);
+}
+
+static int end_scenario(void)
+{
+ printf(" Packets:          %u\n", counts.packets);
+ printf(" Replies:          OFFER %u, ACK %u, NAK %u\n", counts.replies[DHCPOFFER], counts.replies[DHCPACK], counts.replies[DHCPNAK]);
+ printf(" Ignored:          %u\n", counts.ignored);
+ printf(" Server pbufs:     %u allocated\n", host_lwip_get_stats().pbufs_allocated - counts.pbufs_delivered);
+ printf(" Server time:      %llu us, %.0f packets/s\n", (unsigned long long)counts.server_us,
+        counts.server_us ? (counts.packets * 1e6 / counts.server_us) : 0.0);
+ printf(" Checks failed:    %u\n\n", counts.errors);
+
+ return counts.errors;
+}
+
+/*!
+* \brief Clients DISCOVER, REQUEST and RELEASE in waves of the pool size.
+*/
+
+static int run_storm(int clients, uint32_t start_tick)
+{
+ std::vector<struct client> wave(DHCPS_MAX_IP);
+
+ begin_scenario("Storm", clients);
+ restart_server(start_tick);
+
+ for (int first = 0; first < clients; first += DHCPS_MAX_IP)
+ {
+  int n = std::min(DHCPS_MAX_IP, clients - first);
+
+  for (int i = 0; i < n; i++)
+  {
+   make_client(&wave[i], first + i);
+   expect(client_send(&wave[i], DHCPDISCOVER, 0, 0) == DHCPOFFER, "DISCOVER not offered an address");
+  }
+
+  for (int i = 0; i < n; i++)
+   expect(client_send(&wave[i], DHCPREQUEST, wave[i].ip, 0) == DHCPACK, "REQUEST for the offer not ACKed");
+
+  for (int i = 0; i < n; i++)
+   client_send(&wave[i], DHCPRELEASE, 0, wave[i].ip);
+ }
+
+ return end_scenario();
+}
+
+/*!
+* \brief More clients than addresses: the pool runs out, and recovers
+* once the leases expire.
+*/
+
+static int run_exhaustion(uint32_t start_tick)
+{
+ int n = DHCPS_MAX_IP + EXTRA_CLIENTS;
+ std::vector<struct client> clients(n);
+ uint32_t lease_end = start_tick;
+
+ begin_scenario("Exhaustion", n);
+ restart_server(start_tick);
+
+ for (int i = 0; i < n; i++)
+ {
+  make_client(&clients[i], i);
+  client_send(&clients[i], DHCPDISCOVER, 0, 0);
+ }
+
+ expect(counts.replies[DHCPOFFER] == DHCPS_MAX_IP, "offers differ from the pool size");
+ expect(counts.ignored == EXTRA_CLIENTS, "DISCOVERs ignored differ from the clients over the pool size");
+
+ for (int i = 0; i < DHCPS_MAX_IP; i++)
+  expect(client_send(&clients[i], DHCPREQUEST, clients[i].ip, 0) == DHCPACK, "REQUEST for the offer not ACKed");
+
+ for (auto &entry : bindings)
+ {
+  if ((int32_t)(entry.second.expiry_ms - lease_end) > 0)
+   lease_end = entry.second.expiry_ms;
+ }
+
+// The clients left over ask for a bound address.
+
+ for (int i = DHCPS_MAX_IP; i < n; i++)
+  expect(client_send(&clients[i], DHCPREQUEST, clients[i - DHCPS_MAX_IP].ip, 0) == DHCPNAK, "REQUEST for a bound address not NAKed");
+
+ uint32_t old_ip = clients[0].ip;
+ expect((client_send(&clients[0], DHCPDISCOVER, 0, 0) == DHCPOFFER) && (clients[0].ip == old_ip), "bound client not offered its own address");
+
+// Once the leases have run out the pool is available again.
+
+ set_tick(lease_end + 2 * DHCP_WHEEL_TICK_MS);
+
+ for (int i = DHCPS_MAX_IP; i < n; i++)
+  expect(client_send(&clients[i], DHCPDISCOVER, 0, 0) == DHCPOFFER, "no address after the leases expired");
+
+ return end_scenario();
+}
+
+/*!
+* \brief Lease expiry and offer hold with the tick wrapping to 0.
+*/
+
+static int run_wraparound(void)
+{
+ std::vector<struct client> clients(DHCPS_MAX_IP + 1);
+ struct client *newcomer = &clients[DHCPS_MAX_IP];
+
+ begin_scenario("Wraparound", DHCPS_MAX_IP + 1);
+
+// Find the lease time.
+
+ restart_server(0);
+ make_client(newcomer, DHCPS_MAX_IP);
+ client_send(newcomer, DHCPDISCOVER, 0, 0);
+ client_send(newcomer, DHCPREQUEST, newcomer->ip, 0);
+
+ uint32_t lease_ms = bindings.empty() ? 0 : (bindings.begin()->second.expiry_ms - now_ms);
+ expect(lease_ms > 0, "no lease time");
+
+// Leases bound half a lease before the wrap.
+
+ restart_server(0u - lease_ms / 2);
+
+ for (int i = 0; i < DHCPS_MAX_IP; i++)
+ {
+  make_client(&clients[i], i);
+  client_send(&clients[i], DHCPDISCOVER, 0, 0);
+  expect(client_send(&clients[i], DHCPREQUEST, clients[i].ip, 0) == DHCPACK, "REQUEST for the offer not ACKed");
+ }
+
+ uint32_t bound_at = now_ms;
+ make_client(newcomer, DHCPS_MAX_IP);
+
+ set_tick(bound_at + lease_ms - DHCP_WHEEL_TICK_MS);
+ expect(client_send(newcomer, DHCPDISCOVER, 0, 0) == 0, "lease expired early after the wrap");
+
+ set_tick(bound_at + lease_ms + 2 * DHCP_WHEEL_TICK_MS);
+ expect(client_send(newcomer, DHCPDISCOVER, 0, 0) == DHCPOFFER, "lease not expired after the wrap");
+
+// Offers made 10 s before the wrap are held across it.
+
+ uint32_t offered_at = 0u - 10000;
+ restart_server(offered_at);
+
+ for (int i = 0; i < DHCPS_MAX_IP; i++)
+ {
+  make_client(&clients[i], i);
+  client_send(&clients[i], DHCPDISCOVER, 0, 0);
+ }
+
+ make_client(newcomer, DHCPS_MAX_IP);
+
+ set_tick(offered_at + DHCP_OFFER_HOLD_MS - DHCP_WHEEL_TICK_MS);
+ expect(client_send(newcomer, DHCPDISCOVER, 0, 0) == 0, "offer released early after the wrap");
+ expect(client_send(&clients[0], DHCPREQUEST, clients[0].ip, 0) == DHCPACK, "REQUEST for a held offer not ACKed");
+
+ set_tick(offered_at + DHCP_OFFER_HOLD_MS + 2 * DHCP_WHEEL_TICK_MS);
+ expect(client_send(newcomer, DHCPDISCOVER, 0, 0) == DHCPOFFER, "offer not released after the wrap");
+
+ return end_scenario();
+}
+
+/*!
+* \brief Replays the client messages of a capture at their captured times.
+*/
+
+static int run_replay(const char *path, uint32_t start_tick)
+{
+ std::vector<struct capture_packet> packets;
+
+ if (read_pcap(path, packets) == false)
+ {
+  printf("%s: not a readable pcap file\n", path);
+  return 1;
+ }
+
+ begin_scenario(path, 0);
+ restart_server(start_tick);
+
+ for (struct capture_packet &packet : packets)
+ {
+  set_tick(start_tick + (uint32_t)((packet.time_us - packets[0].time_us) / 1000));
+  send_request(packet.data.data(), packet.data.size(), 0, NULL);
+ }
+
+ return end_scenario();
+}
+
+static void print_dhcp_metrics(void)
+{
+ char buf[512];
+ uint32_t cursor = 0;
+
+ printf("Server metrics:\n");
+
+ while (cursor != METRICS_RENDER_DONE)
+ {
+  int len = metrics_render(buf, sizeof(buf) - 1, &cursor);
+  buf[len] = '\0';
+
+  for (char *line = strtok(buf, "\n"); line != NULL; line = strtok(NULL, "\n"))
+  {
+   if (strncmp(line, "cws_dhcp", 8) == 0)
+    printf(" %s\n", line);
+  }
+ }
+}
+
+int main(int argc, char **argv)
+{
+ int clients = DEFAULT_CLIENTS;
+ uint32_t start_tick = DEFAULT_START_TICK;
+ const char *pcap_path = NULL;
+ struct in_addr addr;
+ int errors = 0;
+ int opt;
+
+ while ((opt = getopt(argc, argv, "c:s:t:w:")) != -1)
+ {
+  switch (opt)
+  {
+   case 'c':
+    clients = atoi(optarg);
+    break;
+
+   case 's':
+    if (inet_pton(AF_INET, optarg, &addr) != 1)
+    {
+     fprintf(stderr, "Bad server address %s\n", optarg);
+     return 2;
+    }
+    server_ip = ntohl(addr.s_addr);
+    break;
+
+   case 't':
+    start_tick = strtoul(optarg, NULL, 0);
+    break;
+
+   case 'w':
+    pcap_path = optarg;
+    break;
+
+   default:
+    fprintf(stderr, "Usage: dhcp_bench [-c clients] [-s server_ip] [-t start_tick_ms] [-w storm.pcap] [capture.pcap ...]\n");
+    return 2;
+  }
+ }
+
+ host_lwip_set_send_hook(capture_reply, NULL);
+
+ if (optind < argc)
+ {
+  for (int i = optind; i < argc; i++)
+   errors += run_replay(argv[i], start_tick);
+ }
+ else
+ {
+  if (pcap_path != NULL)
+  {
+   pcap_out = open_pcap_out(pcap_path);
+
+   if (pcap_out == NULL)
+   {
+    fprintf(stderr, "Cannot write %s\n", pcap_path);
+    return 2;
+   }
+  }
+
+  errors += run_storm(clients, start_tick);
+
+  if (pcap_out != NULL)
+  {
+   fclose(pcap_out);
+   pcap_out = NULL;
+  }
+
+  errors += run_exhaustion(start_tick);
+  errors += run_wraparound();
+ }
+
+ print_dhcp_metrics();
+ dhcp_server_deinit(&server);
+
+ return (errors == 0) ? 0 : 1;
+}
@@ -0,0 +1,168 @@
+/*
+ * Copyright (c) 2023, FAV Software Limited. All rights reserved.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * File:   flash_bench.cpp
+ * Author: busdev
+ *
+ * Created on 19 October 2026
+ * Updated on 19 October 2026
+ *
+ * Description
+ * -----------
+ * Host benchmark for the Storage_Handler running on the simulated flash.
+ *
+ * 1. Commits the credentials a number of times and reports the modelled
+ *    flash time per commit and the wear of the storage sector.
+ * 2. Sweeps a power cut across every page boundary of one commit, then
+ *    "reboots" the Storage_Handler and reports what state the store
+ *    came back in (old credentials, new credentials or re-formatted).
+ *
+ * Usage: flash_bench [commits]
+ * Returns non-zero if any power cut left the store with mixed or
+ * corrupted credentials, or if a commit violated NOR semantics.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "sim_flash_backend.h"
+#include "storage_handler.h"
+
+#define DEFAULT_COMMITS 100
+
+#define OLD_SSID "old_network"
+#define OLD_PASS "old_password"
+#define OLD_URL  "http://old.example.com/images"
+#define NEW_SSID "new_network"
+#define NEW_PASS "new_password"
+#define NEW_URL  "http://new.example.com/images"
+
+enum cut_outcome { CUT_OLD_DATA, CUT_NEW_DATA, CUT_REFORMATTED, CUT_CORRUPTED, CUT_OUTCOMES };
+
+static const char *cut_outcome_names[CUT_OUTCOMES] = { "old data", "new data", "re-formatted", "corrupted" };
+
+/*!
+* \brief Stores a set of credentials and commits them to flash.
+*
+* \return int. Result of write_data_to_store().
+*/
+
+static int commit_credentials(Storage_Handler *sh, const char *ssid, const char *pass, const char *url)
+{
+ sh->set_wifi_ssid(ssid);
+ sh->set_wifi_password(pass);
+ sh->set_image_server_url(url);
+ sh->set_epd_status(EPD_STORE_CREDENTIALS_SET);
+
+ return sh->write_data_to_store();
+}
+
+/*!
+* \brief Classifies the store contents after a power cut and reboot.
+*/
+
+static enum cut_outcome classify_store(Storage_Handler *sh)
+{
+ if (sh->get_epd_status() == EPD_STORE_DEFAULT_VALUES)
+  return CUT_REFORMATTED;
+
+ if ((strcmp(sh->get_wifi_ssid(), OLD_SSID) == 0) && (strcmp(sh->get_wifi_password(), OLD_PASS) == 0) && (strcmp(sh->get_image_server_url(), OLD_URL) == 0))
+  return CUT_OLD_DATA;
+
+ if ((strcmp(sh->get_wifi_ssid(), NEW_SSID) == 0) && (strcmp(sh->get_wifi_password(), NEW_PASS) == 0) && (strcmp(sh->get_image_server_url(), NEW_URL) == 0))
+  return CUT_NEW_DATA;
+
+ return CUT_CORRUPTED;
+}
+
+int main(int argc, char **argv)
+{
+ int commits = (argc > 1) ? atoi(argv[1]) : DEFAULT_COMMITS;
+ uint32_t storage_sector = STORAGE_OFFSET / FLASH_SECTOR_SIZE;
+ uint32_t commit_bytes = FLASH_SECTOR_SIZE + STORAGE_SIZE;
+ uint32_t outcomes[CUT_OUTCOMES] = { 0 };
+ int errors = 0;
+
+// Commit throughput and wear.
+
+ Sim_Flash_Backend *flash = new Sim_Flash_Backend(NULL, PICO_FLASH_SIZE_BYTES);
+ Storage_Handler *sh = new Storage_Handler(flash);
+
+ flash->reset_stats();
+
+ for (int i = 0; i < commits; i++)
+ {
+  if (commit_credentials(sh, (i & 1) ? NEW_SSID : OLD_SSID, OLD_PASS, OLD_URL) != SH_OK)
+   errors++;
+ }
+
+ struct sim_flash_sector_stats stats = flash->get_sector_stats(storage_sector);
+
+ printf("Commits:                %d\n", commits);
+ printf("Failed commits:         %d\n", errors);
+ printf("Storage sector:         %u\n", storage_sector);
+ printf("Sector erases:          %u\n", stats.erase_count);
+ printf("Pages programmed:       %u\n", stats.program_count);
+ printf("NOR violations:         %u\n", stats.nor_violations);
+ printf("Busy cycles per commit: %llu\n", (unsigned long long)(stats.busy_cycles / (commits ? commits : 1)));
+ printf("Busy time per commit:   %llu us (interrupts disabled)\n",
+        (unsigned long long)(stats.busy_cycles / (commits ? commits : 1) / SIM_FLASH_CLK_MHZ));
+ printf("Sector life at 100k erase cycles: %u commits\n", (stats.erase_count ? (100000u * commits / stats.erase_count) : 0));
+
+ errors += stats.nor_violations;
+
+ delete sh;
+ delete flash;
+
+// Power cut sweep across one commit (sector erase followed by page programs).
+
+ for (uint32_t cut = 0; cut <= commit_bytes; cut += FLASH_PAGE_SIZE)
+ {
+  flash = new Sim_Flash_Backend(NULL, PICO_FLASH_SIZE_BYTES);
+  sh = new Storage_Handler(flash);
+  commit_credentials(sh, OLD_SSID, OLD_PASS, OLD_URL);
+
+  flash->schedule_power_cut(cut);
+  commit_credentials(sh, NEW_SSID, NEW_PASS, NEW_URL);
+  flash->power_cycle();
+  delete sh;
+
+  sh = new Storage_Handler(flash);  // Reboot.
+
+  enum cut_outcome outcome = classify_store(sh);
+  outcomes[outcome]++;
+
+  if (outcome == CUT_CORRUPTED)
+  {
+   printf("Power cut after %u bytes left the store corrupted.\n", cut);
+   errors++;
+  }
+
+  delete sh;
+  delete flash;
+ }
+
+ printf("\nPower cut sweep, %u bytes per commit:\n", commit_bytes);
+
+ for (int i = 0; i < CUT_OUTCOMES; i++)
+ {
+  printf(" %-14s %u\n", cut_outcome_names[i], outcomes[i]);
+ }
+
+ return (errors == 0) ? 0 : 1;
+}
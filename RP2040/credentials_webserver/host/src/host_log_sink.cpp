@@ -0,0 +1,87 @@
+/*!
+ * @file
+ * host_log_sink class.
+ */
+
+/*
+ * Copyright (c) 2023, FAV Software Limited. All rights reserved.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * File:   host_log_sink.cpp
+ * Author: busdev
+ *
+ * Created on 19 October 2026
+ * Updated on 19 October 2026
+ */
+
+#include "host_log_sink.h"
+
+#define UART_BITS_PER_BYTE 10   // Start bit, 8 data bits, stop bit.
+
+Host_Log_Sink::Host_Log_Sink(int fd, uint32_t baud_rate):
+ fd(fd),
+ baud_rate(baud_rate),
+ last_poll_us(time_us_64()),
+ byte_credit_x1m(0)
+ { }
+
+Host_Log_Sink::~Host_Log_Sink()
+{
+ baud_rate = 0;
+ poll();
+}
+
+/*!
+* \brief Writes pending bytes to the file descriptor.
+*
+* With a baud rate set, only the bytes a UART could have sent since the
+* last poll are written.
+*/
+
+void Host_Log_Sink::poll(void)
+{
+ const uint8_t *data;
+ uint64_t now_us = time_us_64();
+ int count;
+ ssize_t written;
+
+ byte_credit_x1m += (now_us - last_poll_us) * (baud_rate / UART_BITS_PER_BYTE);
+ last_poll_us = now_us;
+
+ while ((count = get_pending(&data)) > 0)
+ {
+  if (baud_rate != 0)
+  {
+   if ((uint64_t)count * 1000000 > byte_credit_x1m)
+    count = (int)(byte_credit_x1m / 1000000);
+
+   if (count == 0)
+    break;
+
+   byte_credit_x1m -= (uint64_t)count * 1000000;
+  }
+
+  written = ::write(fd, data, count);
+
+  if (written <= 0)
+   break;
+
+  consume((int)written);
+ }
+
+ if (is_empty())
+  byte_credit_x1m = 0;  // An idle UART does not bank time.
+}
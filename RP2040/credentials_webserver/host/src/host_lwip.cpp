@@ -0,0 +1,213 @@
+/*!
+ * @file
+ * host lwIP functions.
+ */
+
+/*
+ * Copyright (c) 2023, FAV Software Limited. All rights reserved.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * File:   host_lwip.cpp
+ * Author: busdev
+ *
+ * Created on 19 October 2026
+ * Updated on 19 October 2026
+ */
+
+#include <cstring>
+#include <map>
+#include <vector>
+
+#include "cyw43_config.h"
+#include "host_lwip.h"
+#include "host_pbuf.h"
+
+struct udp_pcb
+{
+ udp_recv_fn recv;
+ void *recv_arg;
+ u16_t port;                    // 0 until bound.
+};
+
+static uint32_t ticks_ms;
+static host_lwip_send_fn send_hook;
+static void *send_hook_arg;
+static struct host_lwip_stats stats;
+static uint32_t pbufs_allocated_base;
+static std::vector<struct udp_pcb *> pcbs;
+static std::map<uint32_t, struct eth_addr> static_arp;   // Keyed by address in network byte order.
+
+uint32_t cyw43_hal_ticks_ms(void)
+{
+ return ticks_ms;
+}
+
+void host_lwip_set_ticks_ms(uint32_t ms)
+{
+ ticks_ms = ms;
+}
+
+void host_lwip_set_send_hook(host_lwip_send_fn fn, void *arg)
+{
+ send_hook = fn;
+ send_hook_arg = arg;
+}
+
+struct host_lwip_stats host_lwip_get_stats(void)
+{
+ stats.pbufs_allocated = host_pbuf_allocated_count() - pbufs_allocated_base;
+ stats.pbufs_live = host_pbuf_live_count();
+ stats.static_arp_entries = static_arp.size();
+ return stats;
+}
+
+void host_lwip_reset_stats(void)
+{
+ pbufs_allocated_base = host_pbuf_allocated_count();
+ stats.datagrams_sent = 0;
+}
+
+// UDP.
+
+struct udp_pcb *udp_new(void)
+{
+ struct udp_pcb *pcb = new udp_pcb();
+
+ pcbs.push_back(pcb);
+ return pcb;
+}
+
+void udp_remove(struct udp_pcb *pcb)
+{
+ for (size_t i = 0; i < pcbs.size(); i++)
+ {
+  if (pcbs[i] == pcb)
+  {
+   pcbs.erase(pcbs.begin() + i);
+   break;
+  }
+ }
+
+ delete pcb;
+}
+
+void udp_recv(struct udp_pcb *pcb, udp_recv_fn recv, void *recv_arg)
+{
+ pcb->recv = recv;
+ pcb->recv_arg = recv_arg;
+}
+
+err_t udp_bind(struct udp_pcb *pcb, const ip_addr_t *ipaddr, u16_t port)
+{
+ (void)ipaddr;
+
+ for (struct udp_pcb *other : pcbs)
+ {
+  if ((other != pcb) && (other->port == port))
+   return ERR_USE;
+ }
+
+ pcb->port = port;
+ return ERR_OK;
+}
+
+err_t udp_sendto(struct udp_pcb *pcb, struct pbuf *p, const ip_addr_t *dst_ip, u16_t dst_port)
+{
+ (void)pcb;
+ host_pbuf_check_live(p, "udp_sendto");
+
+ if (p->tot_len > HOST_LWIP_MAX_DATAGRAM)
+  return ERR_VAL;
+
+ struct host_lwip_datagram datagram;
+ auto arp = static_arp.find(dst_ip->addr);
+
+ datagram.dest_ip = lwip_ntohl(dst_ip->addr);
+ datagram.dest_port = dst_port;
+ datagram.has_static_arp = (arp != static_arp.end());
+
+ if (datagram.has_static_arp == true)
+  memcpy(datagram.static_arp_mac, arp->second.addr, sizeof(datagram.static_arp_mac));
+
+ datagram.len = pbuf_copy_partial(p, datagram.data, p->tot_len, 0);
+ stats.datagrams_sent++;
+
+ if (send_hook != NULL)
+  send_hook(&datagram, send_hook_arg);
+
+ return ERR_OK;
+}
+
+/*!
+* \brief Delivers a datagram to the pcb bound to dest_port.
+*
+* The payload is put in a new pbuf, or in a chain of two when split is
+* between 0 and len, which the receive callback then owns.
+*
+* \param data UDP payload.
+* \param len Length of data.
+* \param src_ip Source address, host byte order.
+* \param src_port Source port.
+* \param dest_port Destination port.
+* \param split Length of the first pbuf of a chain, 0 for a single pbuf.
+* \return int. 0, or -1 if no pcb is bound to dest_port.
+*/
+
+int host_lwip_deliver(const uint8_t *data, uint16_t len, uint32_t src_ip, uint16_t src_port, uint16_t dest_port, uint16_t split)
+{
+ struct udp_pcb *pcb = NULL;
+
+ for (struct udp_pcb *candidate : pcbs)
+ {
+  if ((candidate->port == dest_port) && (candidate->recv != NULL))
+   pcb = candidate;
+ }
+
+ if (pcb == NULL)
+  return -1;
+
+ if ((split == 0) || (split >= len))
+  split = len;
+
+ struct pbuf *p = pbuf_alloc(PBUF_TRANSPORT, split, PBUF_POOL);
+ memcpy(p->payload, data, split);
+
+ if (split < len)
+ {
+  p->next = pbuf_alloc(PBUF_RAW, len - split, PBUF_POOL);
+  memcpy(p->next->payload, data + split, len - split);
+  p->tot_len = len;
+ }
+
+ ip_addr_t src;
+ src.addr = lwip_htonl(src_ip);
+ pcb->recv(pcb->recv_arg, pcb, p, &src, src_port);
+
+ return 0;
+}
+
+// ARP.
+
+err_t etharp_add_static_entry(const ip4_addr_t *ipaddr, struct eth_addr *ethaddr)
+{
+ static_arp[ipaddr->addr] = *ethaddr;
+ return ERR_OK;
+}
+
+err_t etharp_remove_static_entry(const ip4_addr_t *ipaddr)
+{
+ return (static_arp.erase(ipaddr->addr) > 0) ? ERR_OK : ERR_ARG;
+}
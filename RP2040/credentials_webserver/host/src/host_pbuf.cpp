@@ -0,0 +1,158 @@
+/*!
+ * @file
+ * host pbuf functions.
+ */
+
+/*
+ * Copyright (c) 2023, FAV Software Limited. All rights reserved.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * File:   host_pbuf.cpp
+ * Author: busdev
+ *
+ * Created on 19 October 2026
+ * Updated on 19 October 2026
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <unordered_set>
+
+#include "host_pbuf.h"
+
+static std::unordered_set<struct pbuf *> live_pbufs;
+static uint32_t allocated_count;
+
+/*!
+* \brief Aborts if p is not a live pbuf.
+*
+* \param p pbuf.
+* \param what Caller, for the message.
+*/
+
+void host_pbuf_check_live(const struct pbuf *p, const char *what)
+{
+ if (live_pbufs.count((struct pbuf *)p) == 0)
+ {
+  fprintf(stderr, "%s: pbuf %p is not allocated (freed twice, or used after free)\n", what, (const void *)p);
+  abort();
+ }
+}
+
+struct pbuf *pbuf_alloc(pbuf_layer layer, u16_t length, pbuf_type type)
+{
+ (void)type;
+ struct pbuf *p = (struct pbuf *)malloc(sizeof(struct pbuf) + layer + length);
+
+ if (p == NULL)
+  return NULL;
+
+ p->next = NULL;
+ p->payload = (uint8_t *)(p + 1) + layer;
+ p->tot_len = length;
+ p->len = length;
+ p->ref = 1;
+
+ live_pbufs.insert(p);
+ allocated_count++;
+
+ return p;
+}
+
+u8_t pbuf_free(struct pbuf *p)
+{
+ u8_t count = 0;
+
+ host_pbuf_check_live(p, "pbuf_free");
+
+ while (p != NULL)
+ {
+  p->ref--;
+
+  if (p->ref > 0)
+   break;
+
+  struct pbuf *next = p->next;
+  live_pbufs.erase(p);
+  free(p);
+  count++;
+  p = next;
+ }
+
+ return count;
+}
+
+void pbuf_realloc(struct pbuf *p, u16_t new_len)
+{
+ host_pbuf_check_live(p, "pbuf_realloc");
+
+ if (new_len >= p->tot_len)
+  return;
+
+ u16_t shrink = p->tot_len - new_len;
+ u16_t rem_len = new_len;
+ struct pbuf *q = p;
+
+ while (rem_len > q->len)
+ {
+  rem_len -= q->len;
+  q->tot_len -= shrink;
+  q = q->next;
+ }
+
+ q->len = rem_len;
+ q->tot_len = rem_len;
+
+ if (q->next != NULL)
+  pbuf_free(q->next);
+
+ q->next = NULL;
+}
+
+u16_t pbuf_copy_partial(const struct pbuf *p, void *dataptr, u16_t len, u16_t offset)
+{
+ u16_t copied = 0;
+
+ host_pbuf_check_live(p, "pbuf_copy_partial");
+
+ for (; (p != NULL) && (len > 0); p = p->next)
+ {
+  if (offset >= p->len)
+  {
+   offset -= p->len;
+   continue;
+  }
+
+  u16_t n = LWIP_MIN((u16_t)(p->len - offset), len);
+  memcpy((uint8_t *)dataptr + copied, (const uint8_t *)p->payload + offset, n);
+  copied += n;
+  len -= n;
+  offset = 0;
+ }
+
+ return copied;
+}
+
+uint32_t host_pbuf_live_count(void)
+{
+ return live_pbufs.size();
+}
+
+uint32_t host_pbuf_allocated_count(void)
+{
+ return allocated_count;
+}
@@ -0,0 +1,614 @@
+/*
+ * Copyright (c) 2023, FAV Software Limited. All rights reserved.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * File:   http_bench.cpp
+ * Author: busdev
+ *
+ * Created on 19 October 2026
+ * Updated on 19 October 2026
+ *
+ * Description
+ * -----------
+ * HTTP load generator for the configuration workflow. Each client runs
+ * the user journey in a loop:
+ *
+ *   GET  /
+ *   GET  /setup/imageserver
+ *   POST /setup/imageservercredentials  (networkname, password, serverURL)
+ *   GET  /setup/home                    (following the 303)
+ *   GET  /setup/display
+ *
+ * or, with -a, the single page UI's:
+ *
+ *   GET  /app                           (gzipped bundle)
+ *   GET  /api/v1/config
+ *   PUT  /api/v1/config                 (JSON ssid, password and url)
+ *
+ * against the simulator (cws_sim, the default target 127.0.0.1:8080) or
+ * a device (192.168.4.1:80). The same credentials are posted every time,
+ * so flash is written once, on the first journey.
+ *
+ * Reports requests per second and, per step and overall, p50, p99 and
+ * p999 latency (connect to last byte), connection errors (connect, send,
+ * receive, timeout or a short body), HTTP errors (status 400 and up) and
+ * bytes per page. Requests accept gzip, as a browser does, and the
+ * bytes are as sent. -o saves the results as JSON, for comparing runs.
+ *
+ * With -k the requests ask for keep-alive and a connection is reused
+ * while the server allows it (a Content-Length and no
+ * "Connection: close"). -b pads each form POST body to at least the
+ * given size with a pad= argument.
+ *
+ * Usage: http_bench [-a] [-c clients] [-n journeys] [-d seconds] [-k]
+ *                   [-b post_bytes] [-t timeout_ms] [-l label]
+ *                   [-o results.json] [host[:port]]
+ * Returns non-zero if any request failed.
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <strings.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#define DEFAULT_HOST       "127.0.0.1"
+#define DEFAULT_PORT       "8080"          // cws_sim with the default SIM_PORT_OFFSET.
+#define DEFAULT_CLIENTS    1
+#define DEFAULT_JOURNEYS   100
+#define DEFAULT_TIMEOUT_MS 5000
+#define MAX_HEADER_BYTES   4096
+
+#define BENCH_SSID         "BenchNet"
+#define BENCH_PASSWORD     "benchpassword"
+#define BENCH_SERVER_URL   "http%3A%2F%2F192.168.1.10%2Fimage.bmp"
+#define BENCH_SERVER_JSON  "http://192.168.1.10/image.bmp"
+
+#define CONTENT_TYPE_FORM  "application/x-www-form-urlencoded"
+#define CONTENT_TYPE_JSON  "application/json"
+#define MAX_JOURNEY_STEPS  5
+
+struct step
+{
+ const char *name;
+ const char *method;
+ const char *path;
+ const char *content_type;
+ const char *body;                  // NULL for a GET.
+};
+
+static const struct step page_journey[] =
+{
+ { "home", "GET", "/", NULL, NULL },
+ { "imageserver", "GET", "/setup/imageserver", NULL, NULL },
+ { "imageservercredentials", "POST", "/setup/imageservercredentials", CONTENT_TYPE_FORM,
+   "networkname=" BENCH_SSID "&password=" BENCH_PASSWORD "&serverURL=" BENCH_SERVER_URL },
+ { "saved", "GET", "/setup/home", NULL, NULL },
+ { "display", "GET", "/setup/display", NULL, NULL },
+};
+
+static const struct step app_journey[] =
+{
+ { "app", "GET", "/app", NULL, NULL },
+ { "config", "GET", "/api/v1/config", NULL, NULL },
+ { "config_put", "PUT", "/api/v1/config", CONTENT_TYPE_JSON,
+   "{\"ssid\":\"" BENCH_SSID "\",\"password\":\"" BENCH_PASSWORD "\",\"url\":\"" BENCH_SERVER_JSON "\"}" },
+};
+
+static const char *journey_name = "pages";
+static const struct step *journey = page_journey;
+static size_t journey_steps = sizeof(page_journey) / sizeof(page_journey[0]);
+
+// Per step results, one set per client, merged at the end.
+
+struct step_stats
+{
+ std::vector<uint32_t> latency_us;
+ uint64_t requests = 0;
+ uint64_t connection_errors = 0;
+ uint64_t http_errors = 0;
+ uint64_t response_bytes = 0;
+};
+
+struct client_stats
+{
+ struct step_stats steps[MAX_JOURNEY_STEPS];
+ uint64_t connections = 0;
+ uint64_t reused = 0;
+};
+
+struct options
+{
+ struct sockaddr_storage addr;
+ socklen_t addr_len = 0;
+ std::string target;
+ int clients = DEFAULT_CLIENTS;
+ long journeys = DEFAULT_JOURNEYS;
+ double seconds = 0;
+ bool keep_alive = false;
+ int post_bytes = 0;
+ int timeout_ms = DEFAULT_TIMEOUT_MS;
+ const char *label = "";
+};
+
+static struct options options;
+
+static uint64_t now_us(void)
+{
+ return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/*!
+* \brief Opens a connection to the target.
+*
+* \return int. File descriptor, or -1.
+*/
+
+static int open_connection(void)
+{
+ struct timeval tv = { options.timeout_ms / 1000, (options.timeout_ms % 1000) * 1000 };
+ int one = 1;
+ int fd = socket(options.addr.ss_family, SOCK_STREAM, 0);
+
+ if (fd < 0)
+  return -1;
+
+ setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+ setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+ setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+ if (connect(fd, (struct sockaddr *)&options.addr, options.addr_len) != 0)
+ {
+  close(fd);
+  return -1;
+ }
+
+ return fd;
+}
+
+/*!
+* \brief Builds the request for a journey step.
+*/
+
+static std::string build_request(const struct step *s)
+{
+ std::string request = std::string(s->method) + " " + s->path + " HTTP/1.1\r\nHost: " + options.target + "\r\n";
+
+ request += options.keep_alive ? "Connection: keep-alive\r\n" : "Connection: close\r\n";
+ request += "Accept-Encoding: gzip\r\n";
+
+ if (s->body != NULL)
+ {
+  std::string body = s->body;
+
+  if (((int)body.length() < options.post_bytes) && (strcmp(s->content_type, CONTENT_TYPE_FORM) == 0))
+  {
+   body += body.empty() ? "pad=" : "&pad=";
+   body.append(std::max(0, options.post_bytes - (int)body.length()), 'x');
+  }
+
+  request += std::string("Content-Type: ") + s->content_type + "\r\nContent-Length: " + std::to_string(body.length()) + "\r\n\r\n" + body;
+ }
+ else
+ {
+  request += "\r\n";
+ }
+
+ return request;
+}
+
+/*!
+* \brief Finds a header value, case-insensitively.
+*
+* \return const char*. Start of the value, or NULL.
+*/
+
+static const char *find_header(const std::string &headers, const char *name)
+{
+ size_t name_len = strlen(name);
+
+ for (size_t pos = headers.find("\r\n"); pos != std::string::npos; pos = headers.find("\r\n", pos + 2))
+ {
+  const char *line = headers.c_str() + pos + 2;
+
+  if ((strncasecmp(line, name, name_len) == 0) && (line[name_len] == ':'))
+  {
+   line += name_len + 1;
+
+   while (*line == ' ')
+    line++;
+
+   return line;
+  }
+ }
+
+ return NULL;
+}
+
+/*!
+* \brief Sends a request and reads the whole response.
+*
+* \param fd Connection.
+* \param request Request to send.
+* \param status Set to the HTTP status.
+* \param bytes Set to the response size, headers and body.
+* \param can_reuse Set if the server keeps the connection open.
+* \return bool. false on a connection error.
+*/
+
+static bool exchange(int fd, const std::string &request, int *status, uint64_t *bytes, bool *can_reuse)
+{
+ std::string response;
+ char buf[2048];
+ size_t header_end;
+ ssize_t n;
+
+ if (send(fd, request.data(), request.length(), MSG_NOSIGNAL) != (ssize_t)request.length())
+  return false;
+
+// Headers.
+
+ while ((header_end = response.find("\r\n\r\n")) == std::string::npos)
+ {
+  if (response.length() > MAX_HEADER_BYTES)
+   return false;
+
+  n = recv(fd, buf, sizeof(buf), 0);
+
+  if (n <= 0)
+   return false;
+
+  response.append(buf, n);
+ }
+
+ std::string headers = response.substr(0, header_end + 2);
+ const char *content_length = find_header(headers, "Content-Length");
+ const char *connection = find_header(headers, "Connection");
+ size_t body_len = response.length() - (header_end + 4);
+
+ if (sscanf(headers.c_str(), "HTTP/1.%*d %d", status) != 1)
+  return false;
+
+ *can_reuse = options.keep_alive && (content_length != NULL) &&
+              ((connection == NULL) || (strncasecmp(connection, "close", 5) != 0));
+
+// Body: Content-Length bytes, or up to the close.
+
+ if (content_length != NULL)
+ {
+  size_t expected = strtoul(content_length, NULL, 10);
+
+  while (body_len < expected)
+  {
+   n = recv(fd, buf, sizeof(buf), 0);
+
+   if (n <= 0)
+    return false;
+
+   body_len += n;
+  }
+ }
+ else
+ {
+  while ((n = recv(fd, buf, sizeof(buf), 0)) > 0)
+   body_len += n;
+
+  if (n < 0)
+   return false;
+ }
+
+ *bytes = header_end + 4 + body_len;
+
+ return true;
+}
+
+/*!
+* \brief Runs journeys until the count or time is reached.
+*/
+
+static void run_client(struct client_stats *stats, uint64_t end_us)
+{
+ std::string requests[MAX_JOURNEY_STEPS];
+ int fd = -1;
+
+ for (size_t i = 0; i < journey_steps; i++)
+  requests[i] = build_request(&journey[i]);
+
+ for (long j = 0; (options.journeys == 0) || (j < options.journeys); j++)
+ {
+  if ((end_us != 0) && (now_us() >= end_us))
+   break;
+
+  for (size_t i = 0; i < journey_steps; i++)
+  {
+   struct step_stats *s = &stats->steps[i];
+   uint64_t start_us = now_us();
+   uint64_t bytes = 0;
+   bool can_reuse = false;
+   int status = 0;
+
+   s->requests++;
+
+   if (fd < 0)
+   {
+    fd = open_connection();
+    stats->connections++;
+   }
+   else
+   {
+    stats->reused++;
+   }
+
+   if ((fd < 0) || (exchange(fd, requests[i], &status, &bytes, &can_reuse) == false))
+   {
+    s->connection_errors++;
+
+    if (fd >= 0)
+     close(fd);
+
+    fd = -1;
+    break;  // Start the journey again.
+   }
+
+   s->latency_us.push_back((uint32_t)(now_us() - start_us));
+   s->response_bytes += bytes;
+
+   if (status >= 400)
+    s->http_errors++;
+
+   if (can_reuse == false)
+   {
+    close(fd);
+    fd = -1;
+   }
+  }
+ }
+
+ if (fd >= 0)
+  close(fd);
+}
+
+/*!
+* \brief Returns a percentile of sorted latencies.
+*/
+
+static uint32_t percentile(const std::vector<uint32_t> &sorted, double p)
+{
+ if (sorted.empty() == true)
+  return 0;
+
+ size_t rank = (size_t)(p * sorted.size() + 0.999999);
+
+ return sorted[std::min(std::max(rank, (size_t)1), sorted.size()) - 1];
+}
+
+/*!
+* \brief Prints a result line and appends its JSON object.
+*/
+
+static void report_step(const char *name, struct step_stats *s, std::string *json)
+{
+ std::vector<uint32_t> &l = s->latency_us;
+ uint64_t ok = l.size();
+ char line[512];
+
+ std::sort(l.begin(), l.end());
+
+ printf("%-24s %8llu %6llu %6llu %8llu %8u %8u %8u\n", name,
+        (unsigned long long)s->requests, (unsigned long long)s->connection_errors, (unsigned long long)s->http_errors,
+        (unsigned long long)((ok > 0) ? s->response_bytes / ok : 0),
+        percentile(l, 0.50), percentile(l, 0.99), percentile(l, 0.999));
+
+ snprintf(line, sizeof(line),
+          "{\"name\": \"%s\", \"requests\": %llu, \"connection_errors\": %llu, \"http_errors\": %llu, "
+          "\"bytes_per_page\": %llu, \"latency_us\": {\"p50\": %u, \"p99\": %u, \"p999\": %u, \"max\": %u}}",
+          name, (unsigned long long)s->requests, (unsigned long long)s->connection_errors,
+          (unsigned long long)s->http_errors, (unsigned long long)((ok > 0) ? s->response_bytes / ok : 0),
+          percentile(l, 0.50), percentile(l, 0.99), percentile(l, 0.999), l.empty() ? 0 : l.back());
+ *json += line;
+}
+
+/*!
+* \brief Resolves host[:port] into options.addr.
+*/
+
+static bool resolve_target(const char *arg)
+{
+ std::string host = arg;
+ std::string port = DEFAULT_PORT;
+ size_t colon = host.rfind(':');
+ struct addrinfo hints;
+ struct addrinfo *res;
+
+ if (colon != std::string::npos)
+ {
+  port = host.substr(colon + 1);
+  host = host.substr(0, colon);
+ }
+
+ memset(&hints, 0, sizeof(hints));
+ hints.ai_family = AF_INET;
+ hints.ai_socktype = SOCK_STREAM;
+
+ if (getaddrinfo(host.c_str(), port.c_str(), &hints, &res) != 0)
+  return false;
+
+ memcpy(&options.addr, res->ai_addr, res->ai_addrlen);
+ options.addr_len = res->ai_addrlen;
+ options.target = host + ":" + port;
+ freeaddrinfo(res);
+
+ return true;
+}
+
+int main(int argc, char **argv)
+{
+ const char *json_path = NULL;
+ bool is_count_given = false;
+ int opt;
+
+ while ((opt = getopt(argc, argv, "ac:n:d:kb:t:l:o:")) != -1)
+ {
+  switch (opt)
+  {
+   case 'a':
+    journey_name = "app";
+    journey = app_journey;
+    journey_steps = sizeof(app_journey) / sizeof(app_journey[0]);
+    break;
+
+   case 'c':
+    options.clients = std::max(1, atoi(optarg));
+    break;
+
+   case 'n':
+    options.journeys = atol(optarg);
+    is_count_given = true;
+    break;
+
+   case 'd':
+    options.seconds = atof(optarg);
+    break;
+
+   case 'k':
+    options.keep_alive = true;
+    break;
+
+   case 'b':
+    options.post_bytes = atoi(optarg);
+    break;
+
+   case 't':
+    options.timeout_ms = atoi(optarg);
+    break;
+
+   case 'l':
+    options.label = optarg;
+    break;
+
+   case 'o':
+    json_path = optarg;
+    break;
+
+   default:
+    fprintf(stderr, "Usage: http_bench [-a] [-c clients] [-n journeys] [-d seconds] [-k] [-b post_bytes] [-t timeout_ms] [-l label] [-o results.json] [host[:port]]\n");
+    return 2;
+  }
+ }
+
+// A duration alone runs until it is up.
+
+ if ((options.seconds > 0) && (is_count_given == false))
+  options.journeys = 0;
+
+ if (resolve_target((optind < argc) ? argv[optind] : DEFAULT_HOST) == false)
+ {
+  fprintf(stderr, "Cannot resolve %s\n", (optind < argc) ? argv[optind] : DEFAULT_HOST);
+  return 2;
+ }
+
+ std::vector<struct client_stats> stats(options.clients);
+ std::vector<std::thread> threads;
+ uint64_t start_us = now_us();
+ uint64_t end_us = (options.seconds > 0) ? start_us + (uint64_t)(options.seconds * 1e6) : 0;
+
+ for (int i = 0; i < options.clients; i++)
+  threads.emplace_back(run_client, &stats[i], end_us);
+
+ for (std::thread &t : threads)
+  t.join();
+
+ double elapsed_s = (now_us() - start_us) / 1e6;
+
+// Merge the clients.
+
+ struct step_stats total;
+ struct step_stats steps[MAX_JOURNEY_STEPS];
+ uint64_t connections = 0;
+ uint64_t reused = 0;
+
+ for (struct client_stats &c : stats)
+ {
+  connections += c.connections;
+  reused += c.reused;
+
+  for (size_t i = 0; i < journey_steps; i++)
+  {
+   struct step_stats *from = &c.steps[i];
+
+   for (struct step_stats *to : { &steps[i], &total })
+   {
+    to->latency_us.insert(to->latency_us.end(), from->latency_us.begin(), from->latency_us.end());
+    to->requests += from->requests;
+    to->connection_errors += from->connection_errors;
+    to->http_errors += from->http_errors;
+    to->response_bytes += from->response_bytes;
+   }
+  }
+ }
+
+ double rps = total.latency_us.size() / elapsed_s;
+ uint64_t failures = total.connection_errors + total.http_errors;
+ char line[512];
+ std::string json;
+
+ printf("Target %s, %s journey, %d clients, keep-alive %s, POST bodies >= %d bytes, %.2f s\n",
+        options.target.c_str(), journey_name, options.clients, options.keep_alive ? "on" : "off", options.post_bytes, elapsed_s);
+ printf("Requests per second %.1f, connections %llu, reused %llu\n\n", rps, (unsigned long long)connections, (unsigned long long)reused);
+ printf("%-24s %8s %6s %6s %8s %8s %8s %8s\n", "Step", "Requests", "Conn", "HTTP", "Bytes", "p50 us", "p99 us", "p999 us");
+
+ snprintf(line, sizeof(line),
+          "{\n \"label\": \"%s\",\n \"target\": \"%s\",\n \"journey\": \"%s\",\n \"clients\": %d,\n \"journeys_per_client\": %ld,\n"
+          " \"keep_alive\": %s,\n \"post_bytes\": %d,\n \"duration_s\": %.3f,\n \"requests_per_second\": %.1f,\n"
+          " \"connections\": %llu,\n \"connections_reused\": %llu,\n \"steps\": [\n  ",
+          options.label, options.target.c_str(), journey_name, options.clients, options.journeys,
+          options.keep_alive ? "true" : "false", options.post_bytes, elapsed_s, rps,
+          (unsigned long long)connections, (unsigned long long)reused);
+ json = line;
+
+ for (size_t i = 0; i < journey_steps; i++)
+ {
+  report_step(journey[i].name, &steps[i], &json);
+  json += (i + 1 < journey_steps) ? ",\n  " : "\n ],\n \"total\": ";
+ }
+
+ report_step("total", &total, &json);
+ json += "\n}\n";
+
+ if (json_path != NULL)
+ {
+  FILE *f = fopen(json_path, "w");
+
+  if ((f == NULL) || (fputs(json.c_str(), f) < 0) || (fclose(f) != 0))
+  {
+   fprintf(stderr, "Cannot write %s\n", json_path);
+   return 2;
+  }
+ }
+
+ return (failures == 0) ? 0 : 1;
+}
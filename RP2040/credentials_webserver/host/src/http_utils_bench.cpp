@@ -0,0 +1,678 @@
+/*
+ * Copyright (c) 2023, FAV Software Limited. All rights reserved.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * File:   http_utils_bench.cpp
+ * Author: busdev
+ *
+ * Created on 19 October 2026
+ * Updated on 19 October 2026
+ *
+ * Description
+ * -----------
+ * Host microbenchmark of the request parsing, form value decoding and
+ * validation helpers (http_utils.cpp) and of the page rendering in the
+ * Credentials_Webserver handlers, with realistic and adversarial inputs
+ * (2 KB URLs, heavily percent-encoded values, lowercase and invalid
+ * escapes). The form value decoding is checked against known results
+ * before anything is timed.
+ *
+ * Each case runs for at least -t milliseconds and reports ns/op and heap
+ * allocations/op (malloc, calloc and realloc, which includes new).
+ * Cases that work in place copy their input first; the copy is part of
+ * the time. Pages are rendered through Credentials_Webserver::
+ * generate_response() into a connection that is never flushed, so they
+ * include request dispatch and the copy into the send buffer; each
+ * response is acknowledged before the next. page/home_304 revalidates
+ * the home page with If-None-Match. Page cases also report the size of
+ * the response, header included.
+ *
+ * -o saves the results as JSON; -c compares them with a saved baseline
+ * and fails if a case allocates more than it did, or (with -r) runs more
+ * than that percentage slower.
+ *
+ * Usage: http_utils_bench [-t min_ms] [-f filter] [-o results.json]
+ *                         [-c baseline.json [-r max_slowdown_pct]]
+ * Returns non-zero if a case regressed against the baseline.
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+#include "http_utils.h"
+#include "json.h"
+#include "credentials_webserver.h"
+#include "storage_handler.h"
+#include "log.h"
+
+#define DEFAULT_MIN_MS  200
+#define LARGE_SIZE      2048            // "2 KB" inputs.
+#define REQUEST_SIZE    (MAX_CONTENTS_LENGTH + 1)
+
+extern "C" void *__libc_malloc(size_t size);
+extern "C" void *__libc_calloc(size_t n, size_t size);
+extern "C" void *__libc_realloc(void *ptr, size_t size);
+
+static uint64_t allocations = 0;
+
+// Counted allocations: these replace the C library's for the whole program.
+
+extern "C" void *malloc(size_t size)
+{
+ allocations++;
+ return __libc_malloc(size);
+}
+
+extern "C" void *calloc(size_t n, size_t size)
+{
+ allocations++;
+ return __libc_calloc(n, size);
+}
+
+extern "C" void *realloc(void *ptr, size_t size)
+{
+ allocations++;
+ return __libc_realloc(ptr, size);
+}
+
+struct bench_case
+{
+ const char *name;
+ void (*run)(void);
+};
+
+struct result
+{
+ double ns_per_op;
+ double allocs_per_op;
+};
+
+static volatile int sink;               // Keeps results from being optimised away.
+static int response_bytes;              // Size of the last page case's response.
+
+// Inputs, built in make_inputs().
+
+static std::string get_home;
+static std::string get_home_conditional;
+static std::string get_long_url;
+static std::string get_probe;
+static std::string form_typical;
+static std::string form_large;
+static std::string value_typical;
+static std::string value_encoded;
+static std::string value_bad_escapes;
+static std::string value_lower_escapes;
+static std::string value_mixed_escapes;
+static std::string url_large;
+static std::string json_config;
+
+static char work[REQUEST_SIZE + 1];     // Copy of the input for in-place cases.
+static char path[MAX_URL_LENGTH];
+
+static Credentials_Webserver *webserver;
+static struct tcp_pcb *pcb;
+
+/*!
+* \brief Builds a request with the headers a browser sends.
+*/
+
+static std::string browser_request(const char *method, const std::string &target, const std::string &body)
+{
+ std::string req = std::string(method) + " " + target + " HTTP/1.1\r\n"
+                   "Host: 192.168.4.1\r\n"
+                   "User-Agent: Mozilla/5.0 (X11; Linux x86_64; rv:128.0) Gecko/20100101 Firefox/128.0\r\n"
+                   "Accept: text/html,application/xhtml+xml,application/xml;q=0.9,*/*;q=0.8\r\n"
+                   "Accept-Language: en-GB,en;q=0.5\r\n"
+                   "Accept-Encoding: gzip, deflate\r\n"
+                   "Connection: keep-alive\r\n";
+
+ if (body.empty() == false)
+  req += "Content-Type: application/x-www-form-urlencoded\r\nContent-Length: " + std::to_string(body.length()) + "\r\n";
+
+ return req + "\r\n" + body;
+}
+
+static void make_inputs(void)
+{
+ value_typical = "My+Home+Network%21";
+ url_large = "http://images.example.com/";
+ url_large.append(LARGE_SIZE - url_large.length(), 'a');
+
+ for (int i = 0; i < LARGE_SIZE / 3; i++)
+ {
+  value_encoded += "%41";
+  value_bad_escapes += "%zz";
+  value_lower_escapes += "%2f";
+ }
+
+// Valid, lowercase and invalid escapes, and a '%' at the end.
+
+ while (value_mixed_escapes.length() < LARGE_SIZE - 16)
+  value_mixed_escapes += "%41%4g%%2F%2fa+";
+
+ value_mixed_escapes += "%";
+
+ form_typical = "networkname=My+Home+Network&password=correct+horse+battery+staple"
+                "&serverURL=http%3A%2F%2F192.168.1.10%2Fimages%2Fdisplay.bmp";
+
+// The argument the parser looks for last, after 1.9 KB of encoded URL.
+
+ form_large = "serverURL=" + value_encoded.substr(0, LARGE_SIZE - 100) + "&password=correct+horse&networkname=Net";
+
+ json_config = "{\"ssid\":\"My Home Network\",\"password\":\"correct horse \\\"battery\\\" staple\","
+               "\"url\":\"http:\\/\\/192.168.1.10\\/images\\/display.bmp\",\"status\":\"set\"}";
+
+ get_home = browser_request("GET", "/", "");
+ get_probe = browser_request("GET", "/generate_204", "");
+ get_long_url = "GET /" + url_large + " HTTP/1.1\r\nHost: 192.168.4.1\r\n\r\n";
+}
+
+// Parsing.
+
+static void bench_decode_request(void)
+{
+ sink = decode_http_request(get_home.c_str());
+}
+
+static void bench_path_home(void)
+{
+ extract_path(path, get_home.c_str(), get_home.length(), HTTP_GET_OFFSET);
+ sink = path[0];
+}
+
+static void bench_path_probe(void)
+{
+ extract_path(path, get_probe.c_str(), get_probe.length(), HTTP_GET_OFFSET);
+ sink = path[0];
+}
+
+static void bench_path_2k_url(void)
+{
+ extract_path(path, get_long_url.c_str(), get_long_url.length(), HTTP_GET_OFFSET);
+ sink = path[0];
+}
+
+static void bench_header_if_none_match(void)
+{
+ const char *value;
+
+ sink = find_http_header(get_home_conditional.c_str(), get_home_conditional.length(), "If-None-Match", &value);
+}
+
+static void bench_etag_listed(void)
+{
+ static const char list[] = "W/\"0badf00d\", \"1f2f1b73\", \"cafef00d\"";
+
+ sink = is_etag_listed(list, sizeof(list) - 1, 0xcafef00d);
+}
+
+static void bench_etag_page(void)
+{
+ sink = http_etag(url_large.c_str(), url_large.length());
+}
+
+static void bench_argument_typical(void)
+{
+ const char *value;
+
+ sink = extract_argument(form_typical.c_str(), form_typical.length(), SERVER_URL_ARGUMENT, &value);
+}
+
+static void bench_argument_2k_last(void)
+{
+ const char *value;
+
+ sink = extract_argument(form_large.c_str(), form_large.length(), NETWORK_NAME_ARGUMENT, &value);
+}
+
+// Decoding, in place on a copy.
+
+static void decode_copy(const std::string &value)
+{
+ memcpy(work, value.c_str(), value.length() + 1);
+ sink = replace_special_html_characters(work, value.length());
+}
+
+static void bench_decode_typical(void)
+{
+ decode_copy(value_typical);
+}
+
+static void bench_decode_2k_encoded(void)
+{
+ decode_copy(value_encoded);
+}
+
+static void bench_decode_2k_bad_escapes(void)
+{
+ decode_copy(value_bad_escapes);
+}
+
+static void bench_decode_2k_lower_escapes(void)
+{
+ decode_copy(value_lower_escapes);
+}
+
+static void bench_decode_2k_mixed_escapes(void)
+{
+ decode_copy(value_mixed_escapes);
+}
+
+/*!
+* \brief Checks replace_special_html_characters() on known values.
+*
+* Hex digits are decoded in either case; a '%' not followed by two hex
+* digits is kept, as are the characters after it.
+*
+* \return bool. false, after printing the value, if one decodes wrongly.
+*/
+
+static bool check_decoding(void)
+{
+ static const struct
+ {
+  const char *value;
+  const char *decoded;
+ } checks[] =
+ {
+  { "My+Home+Network%21", "My Home Network!" },
+  { "http%3A%2F%2Fx", "http://x" },
+  { "http%3a%2f%2fx", "http://x" },
+  { "%zz", "%zz" },
+  { "%4g%g4", "%4g%g4" },
+  { "%%41", "%A" },
+  { "100%", "100%" },
+  { "%4", "%4" },
+  { "%41", "A" }
+ };
+
+ for (const auto &check : checks)
+ {
+  int len = strlen(check.value);
+
+  memcpy(work, check.value, len + 1);
+  len = replace_special_html_characters(work, len);
+
+  if ((len != (int)strlen(check.decoded)) || (memcmp(work, check.decoded, len) != 0))
+  {
+   fprintf(stderr, "Decoding \"%s\" gave \"%.*s\", expected \"%s\"\n", check.value, len, work, check.decoded);
+   return false;
+  }
+ }
+
+ return true;
+}
+
+// Validation, of decoded values.
+
+static void bench_ssid_valid(void)
+{
+ sink = is_valid_wifi_ssid("My Home Network", 15);
+}
+
+static void bench_ssid_trailing_space(void)
+{
+ sink = is_valid_wifi_ssid("My Home Network ", 16);
+}
+
+static void bench_password_63(void)
+{
+ sink = is_valid_wifi_password("correct horse battery staple correct horse battery staple abcde", 63);
+}
+
+static void bench_url_2k(void)
+{
+ sink = is_valid_image_server_url(url_large.c_str(), url_large.length());
+}
+
+static void bench_url_2k_encoded(void)
+{
+ decode_copy(value_encoded);
+ sink = is_valid_image_server_url(work, sink);
+}
+
+// JSON, the provisioning API's reader and writer.
+
+static void bench_json_parse_config(void)
+{
+ struct json_member member;
+ int cursor = 0;
+
+ sink = 0;
+
+ while (json_next_member(json_config.c_str(), json_config.length(), &cursor, &member) == JSON_MEMBER)
+  sink += json_unescape(work, sizeof(work), member.value, member.value_len);
+}
+
+static void bench_json_write_config(void)
+{
+ struct json_writer writer;
+
+ json_begin_object(&writer, work, sizeof(work));
+ json_add_string(&writer, "ssid", "My Home Network", 15);
+ json_add_string(&writer, "password", "correct horse \"battery\" staple", 31);
+ json_add_string(&writer, "url", "http://192.168.1.10/images/display.bmp", 38);
+ json_add_string(&writer, "status", "set", 3);
+ sink = json_end_object(&writer);
+}
+
+// Pages, through the request dispatch.
+
+static void respond(const std::string &req)
+{
+ memcpy(work, req.c_str(), req.length() + 1);
+
+ pcb->state = ESTABLISHED;
+ pcb->is_closing = false;
+ pcb->snd_queued = 0;
+ webserver->http_sent_callback(NULL, pcb, 0);  // The last response was acknowledged.
+
+ sink = webserver->generate_response(pcb, work, req.length());
+ response_bytes = pcb->snd_queued;
+}
+
+#define PAGE_CASE(fn) \
+ static std::string fn##_req; \
+ static void fn(void) { respond(fn##_req); }
+
+PAGE_CASE(bench_page_home)
+PAGE_CASE(bench_page_home_not_modified)
+PAGE_CASE(bench_page_probe)
+PAGE_CASE(bench_page_stylesheet)
+PAGE_CASE(bench_page_app)
+PAGE_CASE(bench_page_not_found)
+PAGE_CASE(bench_page_imageserver)
+PAGE_CASE(bench_page_deviceid)
+PAGE_CASE(bench_page_masterreset)
+PAGE_CASE(bench_page_display)
+PAGE_CASE(bench_page_credentials)
+PAGE_CASE(bench_page_credentials_2k)
+PAGE_CASE(bench_page_credentials_error)
+PAGE_CASE(bench_page_config_get)
+PAGE_CASE(bench_page_config_put)
+
+/*!
+* \brief Returns the ETag header value of the response to a request.
+*/
+
+static std::string response_etag(const std::string &req)
+{
+ respond(req);
+
+ std::string response((const char *)pcb->snd_buf, pcb->snd_queued);
+ size_t start = response.find("ETag: ");
+
+ if (start == std::string::npos)
+  return "";
+
+ start += 6;
+
+ return response.substr(start, response.find("\r\n", start) - start);
+}
+
+static void make_page_requests(void)
+{
+ bench_page_home_req = get_home;
+ bench_page_probe_req = get_probe;
+ bench_page_not_found_req = browser_request("GET", "/setup/nothere", "");
+ bench_page_stylesheet_req = browser_request("GET", "/" STYLESHEET_PATH, "");
+ bench_page_app_req = browser_request("GET", "/" UI_APP_PATH, "");
+ bench_page_imageserver_req = browser_request("GET", "/setup/imageserver", "");
+ bench_page_deviceid_req = browser_request("GET", "/setup/deviceid", "");
+ bench_page_masterreset_req = browser_request("GET", "/setup/masterreset", "");
+ bench_page_display_req = browser_request("GET", "/setup/display", "");
+ bench_page_credentials_req = browser_request("POST", "/setup/imageservercredentials", form_typical);
+ bench_page_credentials_2k_req = "POST /setup/imageservercredentials HTTP/1.1\r\n\r\n"
+                                 "networkname=Net&password=correct+horse&serverURL=" + value_encoded.substr(0, 1800);
+ bench_page_credentials_error_req = browser_request("POST", "/setup/imageservercredentials",
+                                                    "networkname=%21Bad&password=correct+horse&serverURL=http%3A%2F%2Fx");
+ bench_page_config_get_req = browser_request("GET", "/api/v1/config", "");
+ bench_page_config_put_req = browser_request("PUT", "/api/v1/config", json_config);
+}
+
+static const struct bench_case cases[] =
+{
+ { "decode_http_request", bench_decode_request },
+ { "extract_path/home", bench_path_home },
+ { "extract_path/probe", bench_path_probe },
+ { "extract_path/2k_url", bench_path_2k_url },
+ { "find_header/if_none_match", bench_header_if_none_match },
+ { "etag/listed", bench_etag_listed },
+ { "etag/2k_page", bench_etag_page },
+ { "extract_argument/typical", bench_argument_typical },
+ { "extract_argument/2k_last", bench_argument_2k_last },
+ { "decode_value/typical", bench_decode_typical },
+ { "decode_value/2k_encoded", bench_decode_2k_encoded },
+ { "decode_value/2k_bad_escapes", bench_decode_2k_bad_escapes },
+ { "decode_value/2k_lower_escapes", bench_decode_2k_lower_escapes },
+ { "decode_value/2k_mixed_escapes", bench_decode_2k_mixed_escapes },
+ { "check_ssid/valid", bench_ssid_valid },
+ { "check_ssid/trailing_space", bench_ssid_trailing_space },
+ { "check_password/63", bench_password_63 },
+ { "check_url/2k", bench_url_2k },
+ { "check_url/2k_encoded", bench_url_2k_encoded },
+ { "json/parse_config", bench_json_parse_config },
+ { "json/write_config", bench_json_write_config },
+ { "page/home", bench_page_home },
+ { "page/home_304", bench_page_home_not_modified },
+ { "page/probe_redirect", bench_page_probe },
+ { "page/not_found", bench_page_not_found },
+ { "page/stylesheet", bench_page_stylesheet },
+ { "page/app", bench_page_app },
+ { "page/imageserver", bench_page_imageserver },
+ { "page/deviceid", bench_page_deviceid },
+ { "page/masterreset", bench_page_masterreset },
+ { "page/display", bench_page_display },
+ { "page/credentials", bench_page_credentials },
+ { "page/credentials_2k_url", bench_page_credentials_2k },
+ { "page/credentials_error", bench_page_credentials_error },
+ { "page/api_config_get", bench_page_config_get },
+ { "page/api_config_put", bench_page_config_put },
+};
+
+#define CASES (sizeof(cases) / sizeof(cases[0]))
+
+static uint64_t now_ns(void)
+{
+ return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/*!
+* \brief Runs a case in growing batches for at least min_ms.
+*/
+
+static struct result measure(const struct bench_case *c, int min_ms)
+{
+ uint64_t iterations = 0;
+ uint64_t batch = 1;
+ uint64_t start_allocations;
+ uint64_t start_ns;
+ uint64_t elapsed_ns;
+
+ for (int i = 0; i < 100; i++)  // Warm up, and the first credentials commit.
+  c->run();
+
+ start_allocations = allocations;
+ start_ns = now_ns();
+
+ do
+ {
+  for (uint64_t i = 0; i < batch; i++)
+   c->run();
+
+  iterations += batch;
+  batch *= 2;
+  elapsed_ns = now_ns() - start_ns;
+ }
+ while (elapsed_ns < (uint64_t)min_ms * 1000000);
+
+ return { (double)elapsed_ns / iterations, (double)(allocations - start_allocations) / iterations };
+}
+
+/*!
+* \brief Reads the results saved with -o.
+*/
+
+static bool read_baseline(const char *file_name, std::map<std::string, struct result> *baseline)
+{
+ FILE *f = fopen(file_name, "r");
+ char line[256];
+ char name[128];
+ struct result r;
+
+ if (f == NULL)
+  return false;
+
+ while (fgets(line, sizeof(line), f) != NULL)
+ {
+  if (sscanf(line, " {\"name\": \"%127[^\"]\", \"ns_per_op\": %lf, \"allocs_per_op\": %lf", name, &r.ns_per_op, &r.allocs_per_op) == 3)
+   (*baseline)[name] = r;
+ }
+
+ fclose(f);
+
+ return true;
+}
+
+int main(int argc, char **argv)
+{
+ std::map<std::string, struct result> baseline;
+ const char *json_path = NULL;
+ const char *baseline_path = NULL;
+ const char *filter = NULL;
+ double max_slowdown_pct = 0;
+ int min_ms = DEFAULT_MIN_MS;
+ int regressions = 0;
+ std::string json = "{\n \"cases\": [\n";
+ int opt;
+
+ while ((opt = getopt(argc, argv, "t:f:o:c:r:")) != -1)
+ {
+  switch (opt)
+  {
+   case 't':
+    min_ms = atoi(optarg);
+    break;
+
+   case 'f':
+    filter = optarg;
+    break;
+
+   case 'o':
+    json_path = optarg;
+    break;
+
+   case 'c':
+    baseline_path = optarg;
+    break;
+
+   case 'r':
+    max_slowdown_pct = atof(optarg);
+    break;
+
+   default:
+    fprintf(stderr, "Usage: http_utils_bench [-t min_ms] [-f filter] [-o results.json] [-c baseline.json [-r max_slowdown_pct]]\n");
+    return 2;
+  }
+ }
+
+ if ((baseline_path != NULL) && (read_baseline(baseline_path, &baseline) == false))
+ {
+  fprintf(stderr, "Cannot read %s\n", baseline_path);
+  return 2;
+ }
+
+ make_inputs();
+ make_page_requests();
+
+ if (check_decoding() == false)
+  return 1;
+
+ webserver = new Credentials_Webserver(new Storage_Handler(create_flash_backend()), new Log(false));
+ pcb = tcp_new();
+
+// Revalidate the home page as rendered from the initial settings.
+
+ get_home_conditional = get_home.substr(0, get_home.length() - 2) + "If-None-Match: " + response_etag(get_home) + "\r\n\r\n";
+ bench_page_home_not_modified_req = get_home_conditional;
+
+ printf("%-30s %10s %10s %8s", "Case", "ns/op", "allocs/op", "bytes");
+
+ if (baseline.empty() == false)
+  printf(" %10s %10s", "base ns", "change");
+
+ printf("\n");
+
+ for (size_t i = 0; i < CASES; i++)
+ {
+  const struct bench_case *c = &cases[i];
+
+  if ((filter != NULL) && (strstr(c->name, filter) == NULL))
+   continue;
+
+  response_bytes = 0;
+
+  struct result r = measure(c, min_ms);
+  char line[256];
+
+  printf("%-30s %10.1f %10.2f %8d", c->name, r.ns_per_op, r.allocs_per_op, response_bytes);
+
+  auto base = baseline.find(c->name);
+
+  if (base != baseline.end())
+  {
+   double change_pct = 100.0 * (r.ns_per_op - base->second.ns_per_op) / base->second.ns_per_op;
+   bool is_regression = (r.allocs_per_op > base->second.allocs_per_op + 0.005) ||
+                        ((max_slowdown_pct > 0) && (change_pct > max_slowdown_pct));
+
+   printf(" %10.1f %+9.1f%%%s", base->second.ns_per_op, change_pct, is_regression ? "  REGRESSED" : "");
+   regressions += is_regression;
+  }
+
+  printf("\n");
+
+  snprintf(line, sizeof(line), "  {\"name\": \"%s\", \"ns_per_op\": %.1f, \"allocs_per_op\": %.2f, \"bytes\": %d},\n",
+           c->name, r.ns_per_op, r.allocs_per_op, response_bytes);
+  json += line;
+ }
+
+ if (json[json.length() - 2] == ',')  // No comma after the last case.
+  json.erase(json.length() - 2, 1);
+
+ json += " ]\n}\n";
+
+ if (json_path != NULL)
+ {
+  FILE *f = fopen(json_path, "w");
+
+  if ((f == NULL) || (fputs(json.c_str(), f) < 0) || (fclose(f) != 0))
+  {
+   fprintf(stderr, "Cannot write %s\n", json_path);
+   return 2;
+  }
+ }
+
+ if (regressions > 0)
+  printf("\n%d case(s) regressed against %s\n", regressions, baseline_path);
+
+ return (regressions == 0) ? 0 : 1;
+}
@@ -0,0 +1,1158 @@
+/*
+ * Copyright (c) 2023, FAV Software Limited. All rights reserved.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * File:   link_bench.cpp
+ * Author: busdev
+ *
+ * Created on 19 October 2026
+ * Updated on 19 October 2026
+ *
+ * Description
+ * -----------
+ * Page completion time and retransmissions over a lossy link, for
+ * choosing the lwIP TCP settings in lwipopts.h (TCP_MSS, TCP_WND,
+ * TCP_SND_BUF, TCP_SND_QUEUELEN).
+ *
+ * Each trial is one HTTP exchange, simulated packet by packet: a client
+ * (Linux like TCP: 1 s initial and 200 ms minimum RTO, initial window of
+ * 10 segments, ACKs every segment) connects to the device, sends the
+ * request, and the device answers as Credentials_Webserver does:
+ *
+ *   home      a 1.2 KB page: header and page in two tcp_write()s, the
+ *             connection closed if they do not fit tcp_sndbuf().
+ *   page_2k   the largest page, MAX_CONTENTS_LENGTH.
+ *   metrics   a 12 KB /metrics stream, one chunk of up to
+ *             STREAM_CHUNK_SIZE per sent callback.
+ *
+ * The device side follows lwIP's TCP: 500 ms slow timer ticks for the
+ * retransmission timer, 3 s initial RTO with coarse RTT estimation and
+ * its backoff table, 3 duplicate ACKs for fast retransmit, go-back-N
+ * after a timeout, an initial window of min(4 * MSS, max(2 * MSS,
+ * 4380)), delayed ACKs on the 250 ms fast timer, and TCP_SND_QUEUELEN
+ * counted in pbufs. Both directions go through a Link_Emulator (loss,
+ * loss bursts, reordering, duplication, latency, jitter, bandwidth,
+ * queue).
+ *
+ * Every workload runs for each link condition and settings profile and
+ * the results show the p50 and p99 completion time, retransmissions and
+ * timeouts per exchange, and failed exchanges (send buffer too small,
+ * retries exhausted, or over 60 s). The summary names the profile with
+ * the lowest p99 for each condition.
+ *
+ * Usage: link_bench [-n trials] [-s seed] [-w workload] [-o results.json]
+ *                   [-p name:mss:wnd:snd_buf[:queuelen] ...]
+ *                   [-L loss_pct] [-B burst_ms] [-R reorder_pct] [-D dup_pct]
+ *                   [-l latency_ms] [-j jitter_ms] [-b kbps] [-q queue]
+ * -p adds a profile (sizes in bytes). Any of -L ... -q runs that one
+ * link condition instead of the built-in set.
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <queue>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+#include "link_emulator.h"
+#include "lwipopts.h"
+
+#define DEFAULT_TRIALS          300
+#define DEFAULT_SEED            1
+#define TRIAL_LIMIT_US          60000000ull
+
+// lwIP (tcp_priv.h, tcp.c, tcp_in.c).
+
+#define LWIP_SLOW_TICK_US       500000     // TCP_SLOW_INTERVAL.
+#define LWIP_FAST_TICK_US       250000     // TCP_FAST_INTERVAL, delayed ACK.
+#define LWIP_INITIAL_RTO_TICKS  6          // 3000 ms.
+#define LWIP_MAXRTX             12
+#define LWIP_SYNMAXRTX          6
+
+static const uint8_t lwip_backoff[] = { 1, 2, 3, 4, 5, 6, 7, 7, 7, 7, 7, 7, 7 };
+
+// Client (Linux defaults).
+
+#define CLIENT_INITIAL_RTO_US   1000000
+#define CLIENT_MIN_RTO_US       200000
+#define CLIENT_MAX_RTO_US       60000000
+#define CLIENT_MAX_RETRIES      15
+#define CLIENT_INITIAL_CWND     10         // Segments.
+#define CLIENT_MSS              1460
+#define CLIENT_WINDOW           65535
+
+// Credentials_Webserver.
+
+#define HTTP_HEADER_BYTES       90         // send_page()'s "HTTP/1.1 200 OK..." header.
+#define STREAM_CHUNK_BYTES      1024       // STREAM_CHUNK_SIZE.
+#define MAX_PAGE_BYTES          2048       // MAX_CONTENTS_LENGTH.
+
+struct tcp_profile
+{
+ std::string name;
+ uint32_t mss;
+ uint32_t wnd;
+ uint32_t snd_buf;
+ uint32_t snd_queuelen;
+};
+
+struct workload
+{
+ const char *name;
+ uint32_t request_bytes;
+ uint32_t body_bytes;
+ bool is_stream;
+};
+
+static const struct workload workloads[] =
+{
+ { "home", 450, 1180, false },
+ { "page_2k", 700, MAX_PAGE_BYTES, false },
+ { "metrics", 450, 12 * 1024, true },
+};
+
+#define WORKLOADS (sizeof(workloads) / sizeof(workloads[0]))
+
+struct condition
+{
+ const char *name;
+ struct link_config link;
+};
+
+// Base link: a CYW43 AP a few metres away, then more and more noise.
+//               loss  burst reorder dup   lat jit reo  kbps  queue
+//                     ms
+
+static const struct condition conditions[] =
+{
+ { "clean",    { 0.00, 0, 0.00, 0.00, 3, 1, 0,  6000, 32 } },
+ { "loss_1",   { 0.01, 0, 0.00, 0.00, 3, 1, 0,  6000, 32 } },
+ { "loss_5",   { 0.05, 0, 0.00, 0.00, 3, 1, 0,  6000, 32 } },
+ { "loss_10",  { 0.10, 0, 0.00, 0.00, 3, 1, 0,  6000, 32 } },
+ { "bursty_5", { 0.05, 20, 0.00, 0.00, 3, 1, 0,  6000, 32 } },
+ { "noisy",    { 0.05, 10, 0.02, 0.01, 5, 10, 20, 2000, 8 } },
+};
+
+#define CONDITIONS (sizeof(conditions) / sizeof(conditions[0]))
+
+enum failure { FAIL_NONE, FAIL_SNDBUF, FAIL_RETRIES, FAIL_TIMEOUT };
+
+struct segment
+{
+ bool is_syn;
+ uint32_t seq;
+ uint32_t len;
+ uint32_t ack;
+ uint32_t wnd;
+};
+
+// One end of the connection: the device (lwIP) or the client.
+
+struct tcp_end
+{
+ bool is_lwip;
+ uint32_t mss;
+ uint32_t rcv_wnd;
+ uint32_t snd_buf;
+ uint32_t snd_queuelen;
+ bool is_established;
+
+// Send.
+
+ uint32_t snd_una;
+ uint32_t snd_nxt;
+ uint32_t snd_max;                 // Highest sequence number sent.
+ uint32_t written;                 // Bytes written by the application.
+ uint32_t peer_wnd;
+ uint32_t cwnd;
+ uint32_t ssthresh;
+ uint32_t bytes_acked;
+ int dupacks;
+ bool in_fast_recovery;
+ int nrtx;
+ std::deque<std::pair<uint32_t, uint32_t>> writes;   // End offset and pbufs of each tcp_write().
+ uint32_t queued_pbufs;
+
+// RTT estimation and retransmission timer.
+
+ bool is_timing;
+ uint32_t rtt_seq;
+ uint64_t rtt_start_us;
+ int sa;                           // lwIP, in slow ticks.
+ int sv;
+ int rto_ticks;
+ bool has_rtt;                     // Client, RFC 6298.
+ double srtt_us;
+ double rttvar_us;
+ uint64_t rto_us;
+ uint32_t rto_generation;
+ bool is_rto_running;
+
+// Receive.
+
+ uint32_t rcv_nxt;
+ std::map<uint32_t, uint32_t> out_of_order;
+ int unacked_segments;
+ uint32_t delack_generation;
+ bool is_delack_pending;
+
+// Counters.
+
+ uint32_t retransmits;
+ uint32_t timeouts;
+ uint32_t fast_retransmits;
+};
+
+struct event
+{
+ uint64_t time_us;
+ uint64_t order;
+ bool is_timer;
+ int end;                          // Receiving end, or timer owner.
+ int timer;                        // TIMER_RTO or TIMER_DELACK.
+ uint32_t generation;
+ struct segment seg;
+
+ bool operator>(const struct event &other) const
+ {
+  return (time_us != other.time_us) ? (time_us > other.time_us) : (order > other.order);
+ }
+};
+
+#define END_CLIENT   0
+#define END_DEVICE   1
+#define TIMER_RTO    0
+#define TIMER_DELACK 1
+
+struct trial_result
+{
+ uint64_t completion_us;
+ uint32_t retransmits;
+ uint32_t timeouts;
+ uint32_t fast_retransmits;
+ enum failure failure;
+};
+
+class Tcp_Trial
+{
+ public:
+  Tcp_Trial(const struct tcp_profile *profile, const struct workload *work, const struct link_config *link, uint32_t seed);
+  struct trial_result run(void);
+
+ private:
+  void schedule(const struct event &e);
+  void start_timer(int end, int timer, uint64_t deadline_us);
+  uint64_t next_tick_us(uint64_t period_us);
+  uint64_t slow_ticks(uint64_t time_us);
+  void transmit(int end, const struct segment &seg);
+  void send_ack(int end);
+  void send_syn(int end);
+  int output(int end);
+  void write(int end, uint32_t len);
+  void sent_callback(uint32_t len);
+  void update_rtt(struct tcp_end *t);
+  void arm_rto(int end);
+  void on_segment(int end, const struct segment &seg);
+  void on_ack(int end, const struct segment &seg);
+  void on_data(int end, const struct segment &seg);
+  void on_rto(int end);
+  void on_delack(int end);
+  void establish(int end);
+
+  struct tcp_end ends[2];
+  Link_Emulator links[2];          // Towards the client, towards the device.
+  const struct workload *work;
+  std::priority_queue<struct event, std::vector<struct event>, std::greater<struct event>> events;
+  uint64_t order;
+  uint64_t now_us;
+  uint64_t tick_phase_us;          // lwIP's timers are not in step with the connection.
+  uint64_t done_us;
+  uint32_t response_bytes;
+  uint32_t stream_left;
+  bool is_responding;
+  enum failure failure;
+};
+
+Tcp_Trial::Tcp_Trial(const struct tcp_profile *profile, const struct workload *work, const struct link_config *link, uint32_t seed):
+ links{ Link_Emulator(link, seed * 2 + 1), Link_Emulator(link, seed * 2 + 2) },
+ work(work),
+ order(0),
+ now_us(0),
+ tick_phase_us(((uint64_t)seed * 7919) % LWIP_SLOW_TICK_US),
+ done_us(0),
+ response_bytes(HTTP_HEADER_BYTES + work->body_bytes),
+ stream_left(work->is_stream ? work->body_bytes : 0),
+ is_responding(false),
+ failure(FAIL_NONE)
+{
+ for (int i = 0; i < 2; i++)
+ {
+  struct tcp_end *t = &ends[i];
+
+  *t = tcp_end();
+  t->is_lwip = (i == END_DEVICE);
+  t->mss = t->is_lwip ? profile->mss : CLIENT_MSS;
+  t->rcv_wnd = t->is_lwip ? profile->wnd : CLIENT_WINDOW;
+  t->snd_buf = t->is_lwip ? profile->snd_buf : UINT32_MAX;
+  t->snd_queuelen = t->is_lwip ? profile->snd_queuelen : UINT32_MAX;
+  t->ssthresh = t->is_lwip ? profile->snd_buf : UINT32_MAX;
+  t->sv = LWIP_INITIAL_RTO_TICKS;
+  t->rto_ticks = LWIP_INITIAL_RTO_TICKS;
+  t->rto_us = CLIENT_INITIAL_RTO_US;
+ }
+
+// Both ends use the smaller MSS, as the SYN options agree.
+
+ ends[END_CLIENT].mss = ends[END_DEVICE].mss = std::min(profile->mss, (uint32_t)CLIENT_MSS);
+}
+
+void Tcp_Trial::schedule(const struct event &e)
+{
+ struct event ordered = e;
+
+ ordered.order = order++;
+ events.push(ordered);
+}
+
+/*!
+* \brief Returns the first lwIP timer tick of the given period after now.
+*/
+
+uint64_t Tcp_Trial::next_tick_us(uint64_t period_us)
+{
+ uint64_t since = (now_us + period_us - (tick_phase_us % period_us)) % period_us;
+
+ return now_us + (period_us - since);
+}
+
+/*!
+* \brief Returns lwIP's tcp_ticks at a time.
+*/
+
+uint64_t Tcp_Trial::slow_ticks(uint64_t time_us)
+{
+ return (time_us + LWIP_SLOW_TICK_US - tick_phase_us) / LWIP_SLOW_TICK_US;
+}
+
+void Tcp_Trial::start_timer(int end, int timer, uint64_t deadline_us)
+{
+ struct tcp_end *t = &ends[end];
+ struct event e = event();
+
+ e.time_us = deadline_us;
+ e.is_timer = true;
+ e.end = end;
+ e.timer = timer;
+ e.generation = (timer == TIMER_RTO) ? ++t->rto_generation : ++t->delack_generation;
+
+ schedule(e);
+}
+
+/*!
+* \brief (Re)starts the retransmission timer.
+*
+* lwIP counts slow ticks since the last (re)transmission or new ACK and
+* retransmits once the count reaches the RTO.
+*/
+
+void Tcp_Trial::arm_rto(int end)
+{
+ struct tcp_end *t = &ends[end];
+
+ t->is_rto_running = true;
+
+ if (t->is_lwip == true)
+  start_timer(end, TIMER_RTO, next_tick_us(LWIP_SLOW_TICK_US) + (uint64_t)(std::max(t->rto_ticks, 1) - 1) * LWIP_SLOW_TICK_US);
+ else
+  start_timer(end, TIMER_RTO, now_us + t->rto_us);
+}
+
+void Tcp_Trial::transmit(int end, const struct segment &seg)
+{
+ uint64_t arrival_us[LINK_MAX_COPIES];
+ int copies = links[end].send(now_us, seg.len, arrival_us);
+
+ for (int i = 0; i < copies; i++)
+ {
+  struct event e = event();
+
+  e.time_us = arrival_us[i];
+  e.end = 1 - end;
+  e.seg = seg;
+  schedule(e);
+ }
+
+// Anything sent carries the ACK.
+
+ ends[end].unacked_segments = 0;
+ ends[end].is_delack_pending = false;
+}
+
+void Tcp_Trial::send_ack(int end)
+{
+ struct tcp_end *t = &ends[end];
+ struct segment seg = { false, t->snd_nxt, 0, t->rcv_nxt, t->rcv_wnd };
+
+ transmit(end, seg);
+}
+
+void Tcp_Trial::send_syn(int end)
+{
+ struct tcp_end *t = &ends[end];
+ struct segment seg = { true, 0, 0, 0, t->rcv_wnd };
+
+ transmit(end, seg);
+}
+
+/*!
+* \brief Sends what the congestion and peer windows allow.
+*
+* \return int. Segments sent.
+*/
+
+int Tcp_Trial::output(int end)
+{
+ if ((end != END_CLIENT) && (end != END_DEVICE))
+  return 0;
+
+ struct tcp_end *t = &ends[end];
+ int sent = 0;
+
+ if (t->is_established == false)
+  return 0;
+
+ uint32_t wnd = std::min(t->cwnd, t->peer_wnd);
+
+ while (t->snd_nxt < t->written)
+ {
+  uint32_t len = std::min(t->mss, t->written - t->snd_nxt);
+
+  if ((t->snd_nxt + len - t->snd_una > wnd) && (t->snd_nxt > t->snd_una))
+   break;
+
+  struct segment seg = { false, t->snd_nxt, len, t->rcv_nxt, t->rcv_wnd };
+
+  if (t->snd_nxt < t->snd_max)
+  {
+   t->retransmits++;
+  }
+  else if (t->is_timing == false)
+  {
+   t->is_timing = true;
+   t->rtt_seq = t->snd_nxt;
+   t->rtt_start_us = now_us;
+  }
+
+  transmit(end, seg);
+  t->snd_nxt += len;
+  t->snd_max = std::max(t->snd_max, t->snd_nxt);
+  sent++;
+
+  if (t->is_rto_running == false)
+   arm_rto(end);
+ }
+
+ return sent;
+}
+
+/*!
+* \brief tcp_write(): queues len bytes, or fails as lwIP does when they
+* do not fit tcp_sndbuf() or TCP_SND_QUEUELEN.
+*/
+
+void Tcp_Trial::write(int end, uint32_t len)
+{
+ struct tcp_end *t = &ends[end];
+ uint32_t pbufs = (len + t->mss - 1) / t->mss;
+
+ if ((len > t->snd_buf - (t->written - t->snd_una)) || (t->queued_pbufs + pbufs > t->snd_queuelen))
+ {
+  failure = FAIL_SNDBUF;
+  return;
+ }
+
+ t->written += len;
+ t->queued_pbufs += pbufs;
+ t->writes.push_back(std::make_pair(t->written, pbufs));
+}
+
+/*!
+* \brief The device's sent callback: the next chunk of a stream.
+*/
+
+void Tcp_Trial::sent_callback(uint32_t len)
+{
+ struct tcp_end *t = &ends[END_DEVICE];
+ uint32_t size = std::min((uint32_t)STREAM_CHUNK_BYTES, t->snd_buf - (t->written - t->snd_una));
+
+ (void)len;
+
+ if ((stream_left == 0) || (failure != FAIL_NONE))
+  return;
+
+ size = std::min(size, stream_left);
+
+ if (size > 0)
+ {
+  write(END_DEVICE, size);
+  stream_left -= size;
+ }
+}
+
+/*!
+* \brief Takes an RTT sample.
+*/
+
+void Tcp_Trial::update_rtt(struct tcp_end *t)
+{
+ if (t->is_lwip == true)
+ {
+// tcp_receive(): in slow ticks, so a fast link measures 0 or 1.
+
+  int m = (int)(slow_ticks(now_us) - slow_ticks(t->rtt_start_us));
+
+  m = m - (t->sa >> 3);
+  t->sa += m;
+
+  if (m < 0)
+   m = -m;
+
+  m = m - (t->sv >> 2);
+  t->sv += m;
+  t->rto_ticks = (t->sa >> 3) + t->sv;
+ }
+ else
+ {
+  double r = (double)(now_us - t->rtt_start_us);
+
+  if (t->has_rtt == false)
+  {
+   t->srtt_us = r;
+   t->rttvar_us = r / 2;
+   t->has_rtt = true;
+  }
+  else
+  {
+   t->rttvar_us = 0.75 * t->rttvar_us + 0.25 * std::abs(t->srtt_us - r);
+   t->srtt_us = 0.875 * t->srtt_us + 0.125 * r;
+  }
+
+  t->rto_us = std::max((uint64_t)CLIENT_MIN_RTO_US, (uint64_t)(t->srtt_us + 4 * t->rttvar_us));
+ }
+
+ t->is_timing = false;
+}
+
+void Tcp_Trial::establish(int end)
+{
+ struct tcp_end *t = &ends[end];
+
+ t->is_established = true;
+ t->nrtx = 0;
+ t->is_rto_running = false;
+ t->rto_generation++;
+
+ if (t->is_lwip == true)
+  t->cwnd = std::min(4 * t->mss, std::max(2 * t->mss, (uint32_t)4380));   // LWIP_TCP_CALC_INITIAL_CWND.
+ else
+  t->cwnd = CLIENT_INITIAL_CWND * t->mss;
+}
+
+void Tcp_Trial::on_ack(int end, const struct segment &seg)
+{
+ struct tcp_end *t = &ends[end];
+
+ if (seg.ack > t->snd_una)
+ {
+  uint32_t acked = seg.ack - t->snd_una;
+
+  t->snd_una = seg.ack;
+  t->snd_nxt = std::max(t->snd_nxt, t->snd_una);
+
+  if ((t->is_timing == true) && (seg.ack > t->rtt_seq))
+   update_rtt(t);
+
+// Congestion window: Reno, with lwIP's byte counting.
+
+  if (t->in_fast_recovery == true)
+  {
+   t->cwnd = t->ssthresh;
+   t->in_fast_recovery = false;
+  }
+  else if (t->cwnd < t->ssthresh)
+  {
+   t->cwnd += std::min(acked, ((t->nrtx > 0) ? 1 : 2) * t->mss);
+  }
+  else
+  {
+   t->bytes_acked += acked;
+
+   if (t->bytes_acked >= t->cwnd)
+   {
+    t->bytes_acked -= t->cwnd;
+    t->cwnd += t->mss;
+   }
+  }
+
+  t->dupacks = 0;
+  t->nrtx = 0;
+
+  if (t->is_lwip == true)
+   t->rto_ticks = (t->sa >> 3) + t->sv;
+
+  while ((t->writes.empty() == false) && (t->writes.front().first <= t->snd_una))
+  {
+   t->queued_pbufs -= t->writes.front().second;
+   t->writes.pop_front();
+  }
+
+  if (t->snd_una >= t->snd_max)
+  {
+   t->is_rto_running = false;
+   t->rto_generation++;
+  }
+  else
+  {
+   arm_rto(end);
+  }
+
+  t->peer_wnd = seg.wnd;
+
+  if (end == END_DEVICE)
+   sent_callback(acked);
+ }
+ else if ((seg.ack == t->snd_una) && (seg.len == 0) && (t->snd_max > t->snd_una) && (seg.wnd == t->peer_wnd))
+ {
+// Duplicate ACK.
+
+  t->dupacks++;
+
+  if (t->dupacks == 3)
+  {
+   struct segment rexmit = { false, t->snd_una, std::min(t->mss, t->snd_max - t->snd_una), t->rcv_nxt, t->rcv_wnd };
+
+   t->ssthresh = std::max(std::min(t->cwnd, t->peer_wnd) / 2, 2 * t->mss);
+   t->cwnd = t->ssthresh + 3 * t->mss;
+   t->in_fast_recovery = true;
+   t->is_timing = false;
+   t->fast_retransmits++;
+   t->retransmits++;
+   transmit(end, rexmit);
+  }
+  else if (t->dupacks > 3)
+  {
+   t->cwnd += t->mss;
+  }
+ }
+ else
+ {
+  t->peer_wnd = seg.wnd;
+ }
+}
+
+void Tcp_Trial::on_data(int end, const struct segment &seg)
+{
+ struct tcp_end *t = &ends[end];
+ bool is_ack_now = true;
+
+ if (seg.seq == t->rcv_nxt)
+ {
+  bool had_hole = (t->out_of_order.empty() == false);
+
+  t->rcv_nxt += seg.len;
+
+  for (auto it = t->out_of_order.begin(); (it != t->out_of_order.end()) && (it->first <= t->rcv_nxt); it = t->out_of_order.erase(it))
+   t->rcv_nxt = std::max(t->rcv_nxt, it->first + it->second);
+
+// lwIP delays the ACK of every other segment to its fast timer; the
+// client ACKs every segment, as Linux does early in a connection.
+
+  if ((t->is_lwip == true) && (had_hole == false) && (++t->unacked_segments < 2))
+   is_ack_now = false;
+ }
+ else if (seg.seq > t->rcv_nxt)
+ {
+  uint32_t &len = t->out_of_order[seg.seq];
+
+  len = std::max(len, seg.len);
+ }
+
+// The application.
+
+ if ((end == END_DEVICE) && (is_responding == false) && (t->rcv_nxt >= work->request_bytes))
+ {
+  is_responding = true;
+
+  if (work->is_stream == true)
+  {
+   write(END_DEVICE, HTTP_HEADER_BYTES);
+   sent_callback(0);
+  }
+  else
+  {
+   write(END_DEVICE, HTTP_HEADER_BYTES);
+
+   if (failure == FAIL_NONE)
+    write(END_DEVICE, work->body_bytes);
+  }
+ }
+
+ if ((end == END_CLIENT) && (done_us == 0) && (t->rcv_nxt >= response_bytes))
+  done_us = now_us;
+
+ if (output(end) > 0)
+  return;   // The ACK went with the data.
+
+ if (is_ack_now == true)
+ {
+  send_ack(end);
+ }
+ else if (t->is_delack_pending == false)
+ {
+  t->is_delack_pending = true;
+  start_timer(end, TIMER_DELACK, next_tick_us(LWIP_FAST_TICK_US));
+ }
+}
+
+void Tcp_Trial::on_segment(int end, const struct segment &seg)
+{
+ struct tcp_end *t = &ends[end];
+
+ if (seg.is_syn == true)
+ {
+  if (end == END_DEVICE)
+  {
+// SYN: answered with a SYN-ACK each time, retransmitted on the timer.
+
+   if (t->is_established == false)
+   {
+    t->peer_wnd = seg.wnd;
+    send_syn(end);
+
+    if (t->is_rto_running == false)
+     arm_rto(end);
+   }
+  }
+  else if (t->is_established == false)
+  {
+   establish(end);
+   t->peer_wnd = seg.wnd;
+   t->written = work->request_bytes;
+   output(end);
+  }
+  else
+  {
+   send_ack(end);   // Our ACK was lost.
+  }
+
+  return;
+ }
+
+ if ((end == END_DEVICE) && (t->is_established == false))
+  establish(end);
+
+ if (t->is_established == false)
+  return;
+
+ on_ack(end, seg);
+
+ if (seg.len > 0)
+  on_data(end, seg);
+ else
+  output(end);
+}
+
+void Tcp_Trial::on_rto(int end)
+{
+ struct tcp_end *t = &ends[end];
+
+ t->is_rto_running = false;
+ t->nrtx++;
+ t->timeouts++;
+
+ if (t->is_lwip == true)
+ {
+  if (t->nrtx > ((t->is_established == true) ? LWIP_MAXRTX : LWIP_SYNMAXRTX))
+  {
+   failure = FAIL_RETRIES;
+   return;
+  }
+
+  t->rto_ticks = ((t->sa >> 3) + t->sv) << lwip_backoff[std::min(t->nrtx, (int)sizeof(lwip_backoff) - 1)];
+ }
+ else
+ {
+  if (t->nrtx > CLIENT_MAX_RETRIES)
+  {
+   failure = FAIL_RETRIES;
+   return;
+  }
+
+  t->rto_us = std::min((uint64_t)CLIENT_MAX_RTO_US, t->rto_us * 2);
+ }
+
+ if (t->is_established == false)
+ {
+  t->retransmits++;
+  send_syn(end);
+  arm_rto(end);
+  return;
+ }
+
+ if (t->snd_una >= t->snd_max)
+  return;
+
+// Go back N from the first unacknowledged byte.
+
+ t->ssthresh = std::max(std::min(t->cwnd, t->peer_wnd) / 2, 2 * t->mss);
+ t->cwnd = t->mss;
+ t->snd_nxt = t->snd_una;
+ t->in_fast_recovery = false;
+ t->dupacks = 0;
+ t->is_timing = false;
+
+ output(end);
+ arm_rto(end);
+}
+
+void Tcp_Trial::on_delack(int end)
+{
+ struct tcp_end *t = &ends[end];
+
+ if (t->is_delack_pending == true)
+  send_ack(end);
+}
+
+struct trial_result Tcp_Trial::run(void)
+{
+ struct tcp_end *client = &ends[END_CLIENT];
+ struct trial_result result;
+
+ send_syn(END_CLIENT);
+ arm_rto(END_CLIENT);
+
+ while ((events.empty() == false) && (done_us == 0) && (failure == FAIL_NONE))
+ {
+  struct event e = events.top();
+
+  events.pop();
+  now_us = e.time_us;
+
+  if (now_us > TRIAL_LIMIT_US)
+  {
+   failure = FAIL_TIMEOUT;
+   break;
+  }
+
+  if (e.is_timer == false)
+  {
+   on_segment(e.end, e.seg);
+  }
+  else if ((e.timer == TIMER_RTO) && (e.generation == ends[e.end].rto_generation) && (ends[e.end].is_rto_running == true))
+  {
+   on_rto(e.end);
+  }
+  else if ((e.timer == TIMER_DELACK) && (e.generation == ends[e.end].delack_generation))
+  {
+   on_delack(e.end);
+  }
+ }
+
+ if ((done_us == 0) && (failure == FAIL_NONE))
+  failure = FAIL_TIMEOUT;
+
+ result.completion_us = done_us;
+ result.retransmits = client->retransmits + ends[END_DEVICE].retransmits;
+ result.timeouts = client->timeouts + ends[END_DEVICE].timeouts;
+ result.fast_retransmits = client->fast_retransmits + ends[END_DEVICE].fast_retransmits;
+ result.failure = failure;
+
+ return result;
+}
+
+// Results.
+
+struct summary
+{
+ std::string condition;
+ std::string profile;
+ const char *workload;
+ double p50_ms;
+ double p99_ms;
+ double retransmits;
+ double timeouts;
+ double fast_retransmits;
+ uint32_t failures;
+ uint32_t sndbuf_failures;
+};
+
+static double percentile_ms(std::vector<uint64_t> &sorted, double p)
+{
+ if (sorted.empty() == true)
+  return 0;
+
+ size_t rank = (size_t)(p * sorted.size() + 0.999999);
+
+ return sorted[std::min(std::max(rank, (size_t)1), sorted.size()) - 1] / 1000.0;
+}
+
+static struct summary run_trials(const struct condition *c, const struct tcp_profile *profile, const struct workload *w, int trials, uint32_t seed)
+{
+ std::vector<uint64_t> completion;
+ struct summary s = summary();
+
+ s.condition = c->name;
+ s.profile = profile->name;
+ s.workload = w->name;
+
+ for (int i = 0; i < trials; i++)
+ {
+  Tcp_Trial trial(profile, w, &c->link, seed + i);
+  struct trial_result r = trial.run();
+
+  s.retransmits += r.retransmits;
+  s.timeouts += r.timeouts;
+  s.fast_retransmits += r.fast_retransmits;
+
+  if (r.failure == FAIL_NONE)
+   completion.push_back(r.completion_us);
+  else
+   s.failures++;
+
+  if (r.failure == FAIL_SNDBUF)
+   s.sndbuf_failures++;
+ }
+
+ std::sort(completion.begin(), completion.end());
+
+ s.p50_ms = percentile_ms(completion, 0.50);
+ s.p99_ms = percentile_ms(completion, 0.99);
+ s.retransmits /= trials;
+ s.timeouts /= trials;
+ s.fast_retransmits /= trials;
+
+ return s;
+}
+
+/*!
+* \brief Returns true if a is the better profile: fewer failures, then
+* lower p99, then lower p50.
+*/
+
+static bool is_better(const struct summary &a, const struct summary &b)
+{
+ if (a.failures != b.failures)
+  return a.failures < b.failures;
+
+ if (a.p99_ms != b.p99_ms)
+  return a.p99_ms < b.p99_ms;
+
+ return a.p50_ms < b.p50_ms;
+}
+
+static struct tcp_profile make_profile(const char *name, uint32_t mss, uint32_t wnd, uint32_t snd_buf, uint32_t snd_queuelen)
+{
+ if (snd_queuelen == 0)
+  snd_queuelen = (4 * snd_buf + (mss - 1)) / mss;   // As lwipopts.h.
+
+ return { name, mss, wnd, snd_buf, snd_queuelen };
+}
+
+int main(int argc, char **argv)
+{
+ std::vector<struct tcp_profile> profiles;
+ std::vector<struct condition> run_conditions(conditions, conditions + CONDITIONS);
+ struct condition custom = { "custom", conditions[0].link };
+ bool is_custom_link = false;
+ const char *json_path = NULL;
+ const char *workload_filter = NULL;
+ int trials = DEFAULT_TRIALS;
+ uint32_t seed = DEFAULT_SEED;
+ int opt;
+
+ profiles.push_back(make_profile("lwipopts.h", TCP_MSS, TCP_WND, TCP_SND_BUF, TCP_SND_QUEUELEN));
+ profiles.push_back(make_profile("2xMSS", TCP_MSS, 2 * TCP_MSS, 2 * TCP_MSS, 0));
+ profiles.push_back(make_profile("4xMSS", TCP_MSS, 4 * TCP_MSS, 4 * TCP_MSS, 0));
+ profiles.push_back(make_profile("16xMSS", TCP_MSS, 16 * TCP_MSS, 16 * TCP_MSS, 0));
+ profiles.push_back(make_profile("MSS536_8x", 536, 8 * 536, 8 * 536, 0));
+ profiles.push_back(make_profile("queuelen4", TCP_MSS, TCP_WND, TCP_SND_BUF, 4));
+
+ while ((opt = getopt(argc, argv, "n:s:w:o:p:L:B:R:D:l:j:b:q:")) != -1)
+ {
+  switch (opt)
+  {
+   case 'n':
+    trials = std::max(1, atoi(optarg));
+    break;
+
+   case 's':
+    seed = strtoul(optarg, NULL, 0);
+    break;
+
+   case 'w':
+    workload_filter = optarg;
+    break;
+
+   case 'o':
+    json_path = optarg;
+    break;
+
+   case 'p':
+   {
+    char name[64];
+    unsigned mss, wnd, snd_buf, queuelen = 0;
+
+    if (sscanf(optarg, "%63[^:]:%u:%u:%u:%u", name, &mss, &wnd, &snd_buf, &queuelen) < 4)
+    {
+     fprintf(stderr, "Bad profile %s, expected name:mss:wnd:snd_buf[:queuelen]\n", optarg);
+     return 2;
+    }
+
+    profiles.push_back(make_profile(name, mss, wnd, snd_buf, queuelen));
+    break;
+   }
+
+   case 'L':
+    custom.link.loss = atof(optarg) / 100;
+    is_custom_link = true;
+    break;
+
+   case 'B':
+    custom.link.burst_ms = atoi(optarg);
+    is_custom_link = true;
+    break;
+
+   case 'R':
+    custom.link.reorder = atof(optarg) / 100;
+    custom.link.reorder_ms = std::max(custom.link.reorder_ms, (uint32_t)20);
+    is_custom_link = true;
+    break;
+
+   case 'D':
+    custom.link.duplicate = atof(optarg) / 100;
+    is_custom_link = true;
+    break;
+
+   case 'l':
+    custom.link.latency_ms = atoi(optarg);
+    is_custom_link = true;
+    break;
+
+   case 'j':
+    custom.link.jitter_ms = atoi(optarg);
+    is_custom_link = true;
+    break;
+
+   case 'b':
+    custom.link.bandwidth_kbps = atoi(optarg);
+    is_custom_link = true;
+    break;
+
+   case 'q':
+    custom.link.queue_packets = atoi(optarg);
+    is_custom_link = true;
+    break;
+
+   default:
+    fprintf(stderr, "Usage: link_bench [-n trials] [-s seed] [-w workload] [-o results.json] [-p name:mss:wnd:snd_buf[:queuelen] ...]\n"
+                    "                  [-L loss_pct] [-B burst_ms] [-R reorder_pct] [-D dup_pct] [-l latency_ms] [-j jitter_ms] [-b kbps] [-q queue]\n");
+    return 2;
+  }
+ }
+
+ if (is_custom_link == true)
+  run_conditions.assign(1, custom);
+
+ std::vector<struct summary> results;
+ std::string best_lines;
+
+ printf("%d trials per row. Profiles (MSS/TCP_WND/TCP_SND_BUF/TCP_SND_QUEUELEN):\n", trials);
+
+ for (const struct tcp_profile &p : profiles)
+  printf(" %-12s %5u %6u %6u %4u\n", p.name.c_str(), p.mss, p.wnd, p.snd_buf, p.snd_queuelen);
+
+ for (const struct condition &c : run_conditions)
+ {
+  printf("\n%s: loss %.1f%% (bursts %u ms), reorder %.1f%%, dup %.1f%%, %u+/-%u ms, %u kbit/s, queue %u\n",
+         c.name, c.link.loss * 100, c.link.burst_ms, c.link.reorder * 100, c.link.duplicate * 100,
+         c.link.latency_ms, c.link.jitter_ms, c.link.bandwidth_kbps, c.link.queue_packets);
+  printf(" %-9s %-12s %9s %9s %8s %8s %8s %8s\n", "Workload", "Profile", "p50 ms", "p99 ms", "Rexmit", "RTO", "FastRx", "Failed");
+
+  for (size_t w = 0; w < WORKLOADS; w++)
+  {
+   const struct summary *best = NULL;
+   size_t first = results.size();
+
+   if ((workload_filter != NULL) && (strcmp(workload_filter, workloads[w].name) != 0))
+    continue;
+
+   for (const struct tcp_profile &p : profiles)
+   {
+    struct summary s = run_trials(&c, &p, &workloads[w], trials, seed);
+
+    printf(" %-9s %-12s %9.1f %9.1f %8.2f %8.2f %8.2f %5u%s\n", s.workload, s.profile.c_str(), s.p50_ms, s.p99_ms,
+           s.retransmits, s.timeouts, s.fast_retransmits, s.failures, (s.sndbuf_failures > 0) ? " sndbuf" : "");
+    results.push_back(s);
+   }
+
+   for (size_t i = first; i < results.size(); i++)
+   {
+    if ((best == NULL) || (is_better(results[i], *best) == true))
+     best = &results[i];
+   }
+
+   char line[160];
+
+   snprintf(line, sizeof(line), " %-9s %-9s %-12s p99 %.1f ms, p50 %.1f ms\n", c.name, best->workload, best->profile.c_str(), best->p99_ms, best->p50_ms);
+   best_lines += line;
+  }
+ }
+
+ printf("\nLowest p99 per condition and workload:\n%s", best_lines.c_str());
+
+ if (json_path != NULL)
+ {
+  FILE *f = fopen(json_path, "w");
+
+  if (f == NULL)
+  {
+   fprintf(stderr, "Cannot write %s\n", json_path);
+   return 2;
+  }
+
+  fprintf(f, "{\n \"trials\": %d,\n \"seed\": %u,\n \"results\": [\n", trials, seed);
+
+  for (size_t i = 0; i < results.size(); i++)
+  {
+   const struct summary &s = results[i];
+
+   fprintf(f, "  {\"condition\": \"%s\", \"profile\": \"%s\", \"workload\": \"%s\", \"p50_ms\": %.1f, \"p99_ms\": %.1f, "
+              "\"retransmits\": %.3f, \"timeouts\": %.3f, \"fast_retransmits\": %.3f, \"failures\": %u}%s\n",
+           s.condition.c_str(), s.profile.c_str(), s.workload, s.p50_ms, s.p99_ms, s.retransmits, s.timeouts,
+           s.fast_retransmits, s.failures, (i + 1 < results.size()) ? "," : "");
+  }
+
+  fprintf(f, " ]\n}\n");
+  fclose(f);
+ }
+
+ return 0;
+}
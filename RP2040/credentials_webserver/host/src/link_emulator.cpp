@@ -0,0 +1,170 @@
+/*!
+ * @file
+ * Link_Emulator class.
+ */
+
+/*
+ * Copyright (c) 2023, FAV Software Limited. All rights reserved.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * File:   link_emulator.cpp
+ * Author: busdev
+ *
+ * Created on 19 October 2026
+ * Updated on 19 October 2026
+ */
+
+#include <cmath>
+#include <cstring>
+
+#include "link_emulator.h"
+
+Link_Emulator::Link_Emulator(const struct link_config *config, uint32_t seed):
+ config(*config),
+ rng(seed),
+ link_free_us(0),
+ is_bad(false),
+ state_end_us(0)
+{
+ memset(&stats, 0, sizeof(stats));
+
+// Start in the long run state.
+
+ if ((config->burst_ms > 0) && (config->loss > 0.0) && (config->loss < 1.0))
+ {
+  is_bad = (random() < config->loss);
+  state_end_us = period_us(is_bad);
+ }
+}
+
+/*!
+* \brief Returns a random length for a bad or good period.
+*
+* Both are exponential; the good ones are long enough that the link is
+* bad for a fraction loss of the time.
+*/
+
+uint64_t Link_Emulator::period_us(bool bad)
+{
+ double mean_us = config.burst_ms * 1000.0;
+
+ if (bad == false)
+  mean_us = mean_us * (1.0 - config.loss) / config.loss;
+
+ return (uint64_t)(-std::log(1.0 - random()) * mean_us) + 1;
+}
+
+/*!
+* \brief Returns a uniform random number in [0, 1).
+*/
+
+double Link_Emulator::random(void)
+{
+ return std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+}
+
+/*!
+* \brief Moves the loss model on to now_us and returns whether a packet
+* sent then is lost.
+*/
+
+bool Link_Emulator::is_lost(uint64_t now_us)
+{
+ if ((config.burst_ms == 0) || (config.loss <= 0.0) || (config.loss >= 1.0))
+  return random() < config.loss;
+
+ while (state_end_us <= now_us)
+ {
+  is_bad = !is_bad;
+  state_end_us += period_us(is_bad);
+ }
+
+ return is_bad;
+}
+
+/*!
+* \brief Sends a packet.
+*
+* \param now_us Time the packet is handed to the link.
+* \param payload_bytes Payload size, LINK_HEADER_BYTES are added.
+* \param arrival_us Set to the arrival time of each copy.
+* \return int. Number of copies that arrive: 0 (dropped), 1 or 2.
+*/
+
+int Link_Emulator::send(uint64_t now_us, uint32_t payload_bytes, uint64_t arrival_us[LINK_MAX_COPIES])
+{
+ uint64_t departure_us = now_us;
+ int copies = 1;
+
+ stats.sent++;
+
+// Queue: packets still waiting at now_us.
+
+ while ((departures.empty() == false) && (departures.front() <= now_us))
+  departures.pop_front();
+
+ if ((config.queue_packets > 0) && (departures.size() >= config.queue_packets))
+ {
+  stats.queue_drops++;
+  return 0;
+ }
+
+ if (config.bandwidth_kbps > 0)
+ {
+  departure_us = std::max(now_us, link_free_us) + ((uint64_t)(payload_bytes + LINK_HEADER_BYTES) * 8000) / config.bandwidth_kbps;
+  link_free_us = departure_us;
+  departures.push_back(departure_us);
+ }
+
+// The packet uses the link even if it is then lost.
+
+ if (is_lost(departure_us) == true)
+ {
+  stats.lost++;
+  return 0;
+ }
+
+ if (random() < config.duplicate)
+ {
+  stats.duplicated++;
+  copies = 2;
+ }
+
+ for (int i = 0; i < copies; i++)
+ {
+  int64_t jitter_us = (config.jitter_ms > 0) ? (int64_t)((random() * 2.0 - 1.0) * config.jitter_ms * 1000) : 0;
+  uint64_t delay_us = (uint64_t)std::max<int64_t>(0, (int64_t)config.latency_ms * 1000 + jitter_us);
+
+  if (random() < config.reorder)
+  {
+   stats.reordered++;
+   delay_us += (uint64_t)config.reorder_ms * 1000;
+  }
+
+  arrival_us[i] = departure_us + delay_us;
+ }
+
+ return copies;
+}
+
+/*!
+* \brief Returns the link counters.
+*/
+
+const struct link_stats *Link_Emulator::get_stats(void)
+{
+ return &stats;
+}
@@ -0,0 +1,392 @@
+/*!
+ * @file
+ * sim_flash_backend class.
+ */
+
+/*
+ * Copyright (c) 2023, FAV Software Limited. All rights reserved.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+//
+// Simulated Flash Backend.
+//
+// Host Flash_Backend implementation that models the Pico-W's NOR flash:
+//
+// - Erase sets whole 4KB sectors to 0xff.
+// - Program writes whole 256B pages and can only clear bits. Setting a
+//   bit that was not erased is counted as a NOR violation and reported.
+// - Erase and program time is accounted per sector, in system clock
+//   cycles, and optionally slept for in real time.
+// - A power cut can be scheduled after a number of erased/programmed
+//   bytes, leaving the operation in progress partially complete.
+//
+// The flash image is mmap'd from a file so that it survives restarts of
+// the simulator, or from anonymous memory if no file is given.
+//
+
+/*
+ * File:   sim_flash_backend.cpp
+ * Author: busdev
+ *
+ * Created on 19 October 2026
+ * Updated on 19 October 2026
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "sim_flash_backend.h"
+
+Sim_Flash_Backend::Sim_Flash_Backend(const char *image_path, uint32_t size_bytes):
+ image(NULL),
+ size_bytes(size_bytes),
+ image_fd(-1),
+ is_realtime(false),
+ is_powered(true),
+ bytes_until_cut(SIM_FLASH_NO_POWER_CUT),
+ sector_stats(NULL),
+ total_busy_cycles(0)
+ {
+  struct stat image_stat;
+  void *mapping;
+  bool is_new_image = true;
+
+  if (image_path != NULL)
+  {
+   image_fd = open(image_path, O_RDWR | O_CREAT, 0644);
+
+   if ((image_fd >= 0) && (fstat(image_fd, &image_stat) == 0))
+   {
+    is_new_image = (image_stat.st_size != (off_t)size_bytes);
+
+    if (is_new_image)
+     ftruncate(image_fd, size_bytes);
+   }
+  }
+
+  if (image_fd >= 0)
+   mapping = mmap(NULL, size_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, image_fd, 0);
+  else
+   mapping = mmap(NULL, size_bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+  if (mapping != MAP_FAILED)
+  {
+   image = (uint8_t*)mapping;
+
+   if (is_new_image)
+    memset(image, SIM_FLASH_ERASED_BYTE, size_bytes);  // Blank flash reads as erased.
+  }
+
+  sector_stats = new struct sim_flash_sector_stats[get_sector_count()];
+  reset_stats();
+ }
+
+Sim_Flash_Backend::~Sim_Flash_Backend()
+{
+ if (image != NULL)
+  munmap(image, size_bytes);
+
+ if (image_fd >= 0)
+  close(image_fd);
+
+ delete[] sector_stats;
+}
+
+/*!
+* \brief Reads bytes from the flash image.
+*
+* \param offset Offset from the start of flash.
+* \param data Destination buffer.
+* \param count Number of bytes to read.
+* \return int. FLASH_OK, FLASH_RANGE_ERR or FLASH_POWER_CUT_ERR.
+*/
+
+int Sim_Flash_Backend::read(uint32_t offset, uint8_t *data, uint32_t count)
+{
+ if ((image == NULL) || (offset > size_bytes) || (count > size_bytes - offset))
+  return FLASH_RANGE_ERR;
+
+ if (is_powered == false)
+  return FLASH_POWER_CUT_ERR;
+
+ memcpy(data, image + offset, count);
+
+ return FLASH_OK;
+}
+
+/*!
+* \brief Erases whole sectors.
+*
+* If a power cut is due during the erase, only the bytes erased before
+* the cut are set to 0xff.
+*
+* \param offset Offset from the start of flash, sector aligned.
+* \param count Number of bytes to erase, multiple of FLASH_SECTOR_SIZE.
+* \return int. FLASH_OK, FLASH_RANGE_ERR, FLASH_ALIGNMENT_ERR or FLASH_POWER_CUT_ERR.
+*/
+
+int Sim_Flash_Backend::erase(uint32_t offset, uint32_t count)
+{
+ bool is_cut;
+
+ if ((image == NULL) || (offset > size_bytes) || (count > size_bytes - offset))
+  return FLASH_RANGE_ERR;
+
+ if ((offset % FLASH_SECTOR_SIZE) || (count % FLASH_SECTOR_SIZE))
+  return FLASH_ALIGNMENT_ERR;
+
+ if (is_powered == false)
+  return FLASH_POWER_CUT_ERR;
+
+ is_cut = consume_power_budget(&count);
+
+ memset(image + offset, SIM_FLASH_ERASED_BYTE, count);
+
+ for (uint32_t done = 0; done < count; done += FLASH_SECTOR_SIZE)
+ {
+  uint32_t sector = (offset + done) / FLASH_SECTOR_SIZE;
+  uint32_t sector_bytes = ((count - done) < FLASH_SECTOR_SIZE) ? (count - done) : FLASH_SECTOR_SIZE;
+
+  sector_stats[sector].erase_count++;
+  account_busy_time(sector, (uint32_t)(((uint64_t)SIM_FLASH_SECTOR_ERASE_US * sector_bytes) / FLASH_SECTOR_SIZE));
+ }
+
+ return (is_cut == true) ? FLASH_POWER_CUT_ERR : FLASH_OK;
+}
+
+/*!
+* \brief Programs whole pages.
+*
+* Each byte is ANDed into the image, as on real NOR flash. If any
+* bit would have to change from 0 to 1 the sector's nor_violations
+* counter is incremented and FLASH_NOR_ERR is returned.
+* If a power cut is due during the program, only the bytes written
+* before the cut are programmed.
+*
+* \param offset Offset from the start of flash, page aligned.
+* \param data Data to be written.
+* \param count Number of bytes to write, multiple of FLASH_PAGE_SIZE.
+* \return int. FLASH_OK, FLASH_RANGE_ERR, FLASH_ALIGNMENT_ERR, FLASH_NOR_ERR or FLASH_POWER_CUT_ERR.
+*/
+
+int Sim_Flash_Backend::program(uint32_t offset, const uint8_t *data, uint32_t count)
+{
+ bool is_cut;
+ bool is_nor_error = false;
+
+ if ((image == NULL) || (offset > size_bytes) || (count > size_bytes - offset))
+  return FLASH_RANGE_ERR;
+
+ if ((offset % FLASH_PAGE_SIZE) || (count % FLASH_PAGE_SIZE))
+  return FLASH_ALIGNMENT_ERR;
+
+ if (is_powered == false)
+  return FLASH_POWER_CUT_ERR;
+
+ is_cut = consume_power_budget(&count);
+
+ for (uint32_t done = 0; done < count; done += FLASH_PAGE_SIZE)
+ {
+  uint32_t sector = (offset + done) / FLASH_SECTOR_SIZE;
+  uint32_t page_bytes = ((count - done) < FLASH_PAGE_SIZE) ? (count - done) : FLASH_PAGE_SIZE;
+  bool is_page_violation = false;
+
+  for (uint32_t i = 0; i < page_bytes; i++)
+  {
+   uint8_t *cell = image + offset + done + i;
+
+   if ((data[done + i] & ~(*cell)) != 0)  // Bit would go from 0 to 1.
+    is_page_violation = true;
+
+   *cell &= data[done + i];
+  }
+
+  if (is_page_violation == true)
+  {
+   sector_stats[sector].nor_violations++;
+   is_nor_error = true;
+  }
+
+  sector_stats[sector].program_count++;
+  account_busy_time(sector, (uint32_t)(((uint64_t)SIM_FLASH_PAGE_PROGRAM_US * page_bytes) / FLASH_PAGE_SIZE));
+ }
+
+ if (is_cut == true)
+  return FLASH_POWER_CUT_ERR;
+
+ return (is_nor_error == true) ? FLASH_NOR_ERR : FLASH_OK;
+}
+
+/*!
+* \brief Sleeps for the modelled erase and program times when true.
+*
+* \param is_realtime
+*/
+
+void Sim_Flash_Backend::set_realtime(bool is_realtime)
+{
+ this->is_realtime = is_realtime;
+}
+
+/*!
+* \brief Schedules a power cut.
+*
+* The power is cut once bytes_until_cut more bytes have been erased or
+* programmed. The interrupted operation returns FLASH_POWER_CUT_ERR, as
+* do all operations until power_cycle() is called.
+*
+* \param bytes_until_cut Number of bytes, or SIM_FLASH_NO_POWER_CUT.
+*/
+
+void Sim_Flash_Backend::schedule_power_cut(uint32_t bytes_until_cut)
+{
+ this->bytes_until_cut = bytes_until_cut;
+}
+
+/*!
+* \brief Restores power after a power cut.
+*
+* The flash image keeps whatever state the cut left it in.
+*/
+
+void Sim_Flash_Backend::power_cycle(void)
+{
+ is_powered = true;
+ bytes_until_cut = SIM_FLASH_NO_POWER_CUT;
+}
+
+/*!
+* \brief Gets is_powered boolean.
+*
+* \return bool
+*/
+
+bool Sim_Flash_Backend::get_is_powered(void)
+{
+ return is_powered;
+}
+
+/*!
+* \brief Gets number of sectors in the flash image.
+*
+* \return uint32_t
+*/
+
+uint32_t Sim_Flash_Backend::get_sector_count(void)
+{
+ return size_bytes / FLASH_SECTOR_SIZE;
+}
+
+/*!
+* \brief Gets the wear and timing counters of one sector.
+*
+* \param sector Sector number, offset / FLASH_SECTOR_SIZE.
+* \return struct sim_flash_sector_stats. All zero if sector is out of range.
+*/
+
+struct sim_flash_sector_stats Sim_Flash_Backend::get_sector_stats(uint32_t sector)
+{
+ struct sim_flash_sector_stats stats;
+
+ if (sector < get_sector_count())
+  return sector_stats[sector];
+
+ memset(&stats, 0, sizeof(stats));
+ return stats;
+}
+
+/*!
+* \brief Gets total cycles spent erasing and programming, all sectors.
+*
+* \return uint64_t
+*/
+
+uint64_t Sim_Flash_Backend::get_total_busy_cycles(void)
+{
+ return total_busy_cycles;
+}
+
+/*!
+* \brief Clears the wear and timing counters.
+*/
+
+void Sim_Flash_Backend::reset_stats(void)
+{
+ memset(sector_stats, 0, get_sector_count() * sizeof(struct sim_flash_sector_stats));
+ total_busy_cycles = 0;
+}
+
+/*!
+* \brief Takes count bytes from the power cut budget.
+*
+* If the budget runs out, count is reduced to the number of bytes
+* processed before the cut and the power is turned off.
+*
+* \param count Number of bytes in the operation, updated on a cut.
+* \return bool. True if the power was cut.
+*/
+
+bool Sim_Flash_Backend::consume_power_budget(uint32_t *count)
+{
+ if (bytes_until_cut == SIM_FLASH_NO_POWER_CUT)
+  return false;
+
+ if (*count <= bytes_until_cut)
+ {
+  bytes_until_cut -= *count;
+  return false;
+ }
+
+ *count = bytes_until_cut;
+ bytes_until_cut = 0;
+ is_powered = false;
+
+ return true;
+}
+
+/*!
+* \brief Adds busy time to a sector's counters, sleeping if realtime.
+*
+* \param sector Sector number.
+* \param busy_us Modelled operation time in microseconds.
+*/
+
+void Sim_Flash_Backend::account_busy_time(uint32_t sector, uint32_t busy_us)
+{
+ uint64_t cycles = (uint64_t)busy_us * SIM_FLASH_CLK_MHZ;
+
+ sector_stats[sector].busy_cycles += cycles;
+ total_busy_cycles += cycles;
+
+ if (is_realtime == true)
+  sleep_us(busy_us);
+}
+
+/*!
+* \brief Creates the flash backend for the host build.
+*
+* The flash image is kept in the file named by the SIM_FLASH_IMAGE
+* environment variable, or in memory if it is not set.
+*
+* \return Flash_Backend*
+*/
+
+Flash_Backend *create_flash_backend(void)
+{
+ return new Sim_Flash_Backend(getenv("SIM_FLASH_IMAGE"), PICO_FLASH_SIZE_BYTES);
+}
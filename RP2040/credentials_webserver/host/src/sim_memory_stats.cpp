@@ -0,0 +1,107 @@
+/*!
+ * @file
+ * simulator memory statistics.
+ */
+
+/*
+ * Copyright (c) 2023, FAV Software Limited. All rights reserved.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+// Host version of memory_stats.cpp for the simulator (cws_sim).
+//
+// Only the heap line is real: the host has no linker stack symbols to
+// paint and the socket bridge has no lwIP pools. The rest of the report
+// keeps the device's layout so tools that read it work on both.
+
+/*
+ * File:   sim_memory_stats.cpp
+ * Author: busdev
+ *
+ * Created on 19 October 2026
+ * Updated on 19 October 2026
+ */
+
+#include <malloc.h>
+
+#include "memory_stats.h"
+#include "metrics.h"
+#include "tiny_format.h"
+
+#define CURSOR_TITLE 0
+#define CURSOR_HEAP  1
+#define CURSOR_END   2
+
+static int heap_used_metric = METRICS_NONE;
+static int heap_peak_metric = METRICS_NONE;
+
+/*!
+* \brief Registers the memory metrics.
+*/
+
+void memory_stats_init(void)
+{
+ heap_used_metric = metrics_gauge("cws_heap_used_bytes", NULL, "C heap in use.");
+ heap_peak_metric = metrics_gauge("cws_heap_peak_bytes", NULL, "C heap high-water mark.");
+}
+
+/*!
+* \brief Copies the current memory statistics to the metrics.
+*/
+
+void memory_stats_update_metrics(void)
+{
+ struct mallinfo2 info = mallinfo2();
+
+ metrics_set(heap_used_metric, (uint32_t)info.uordblks);
+ metrics_set(heap_peak_metric, (uint32_t)info.arena);
+}
+
+/*!
+* \brief Writes the next lines of the memory report into buf.
+*
+* \param buf Destination buffer.
+* \param size Size of buf.
+* \param cursor Render position, updated.
+* \return int. Bytes written, excluding the terminating NUL.
+*/
+
+int memory_stats_render(char *buf, int size, uint32_t *cursor)
+{
+ int len = 0;
+
+ while (*cursor < CURSOR_END)
+ {
+  struct mallinfo2 info = mallinfo2();
+  int line_len;
+
+  if (*cursor == CURSOR_TITLE)
+   line_len = tiny_format(&buf[len], size - len, "%-16s %8s %8s %8s %8s\n", "", "used", "peak", "size", "failed");
+  else
+   line_len = tiny_format(&buf[len], size - len, "%-16s %8u %8u %8u %8u\n", "heap", (uint32_t)info.uordblks, (uint32_t)info.arena, 0, 0);
+
+  if (len + line_len >= size)
+  {
+   buf[len] = '\0';
+   return len;  // Does not fit, write it next time.
+  }
+
+  len += line_len;
+  (*cursor)++;
+ }
+
+ *cursor = MEMORY_STATS_RENDER_DONE;
+
+ return len;
+}
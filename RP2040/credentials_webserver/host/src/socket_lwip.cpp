@@ -0,0 +1,576 @@
+/*!
+ * @file
+ * socket lwIP functions.
+ */
+
+/*
+ * Copyright (c) 2023, FAV Software Limited. All rights reserved.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+// The lwIP raw API over POSIX sockets, for the simulator (cws_sim).
+//
+// Each lwIP port is bound on the host at port + SIM_PORT_OFFSET (default
+// 8000, so HTTP is 8080, DNS 8053, DHCP 8067) on SIM_BIND_ADDRESS
+// (default 127.0.0.1). cyw43_arch_poll() does the work lwIP's input
+// path would: accepts connections, delivers received data in pbufs of
+// at most TCP_MSS bytes, unless the receive window is shut, passes
+// queued data to the socket and reports it to the sent callback.
+//
+// Data taken by the socket counts as acknowledged. The host's socket
+// buffers are much larger than the device's window, so a slow client
+// shows up later than on the device.
+//
+// UDP replies always go back to the sender of the datagram being
+// handled: broadcast and the simulated AP subnet cannot be reached from
+// the host, and the DHCP and DNS servers only ever answer the client
+// that asked.
+
+/*
+ * File:   socket_lwip.cpp
+ * Author: busdev
+ *
+ * Created on 19 October 2026
+ * Updated on 19 October 2026
+ */
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#undef TCP_MSS                      // The BSD one, lwipopts.h has lwIP's.
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "cyw43_config.h"
+#include "pico/cyw43_arch.h"
+#include "lwip/etharp.h"
+#include "host_pbuf.h"
+
+#define SIM_DEFAULT_PORT_OFFSET 8000
+#define SIM_DEFAULT_ADDRESS     "127.0.0.1"
+#define SIM_LISTEN_BACKLOG      8
+#define SIM_UDP_MAX_DATAGRAM    1472
+#define SIM_UDP_READS_PER_POLL  8
+
+struct udp_pcb
+{
+ int fd;
+ u16_t local_port;
+ udp_recv_fn recv;
+ void *recv_arg;
+ struct sockaddr_in peer;       // Sender of the datagram being handled.
+ bool has_peer;
+};
+
+static std::vector<struct tcp_pcb *> tcp_pcbs;
+static std::vector<struct udp_pcb *> udp_pcbs;
+
+/*!
+* \brief Returns the host port for an lwIP port.
+*/
+
+static u16_t host_port(u16_t port)
+{
+ const char *offset = getenv("SIM_PORT_OFFSET");
+
+ return port + ((offset != NULL) ? atoi(offset) : SIM_DEFAULT_PORT_OFFSET);
+}
+
+/*!
+* \brief Opens a non-blocking socket bound to the host port for port.
+*
+* \return int. File descriptor, or -1.
+*/
+
+static int open_socket(int type, u16_t port)
+{
+ const char *address = getenv("SIM_BIND_ADDRESS");
+ struct sockaddr_in addr;
+ int one = 1;
+ int fd = socket(AF_INET, type, 0);
+
+ if (fd < 0)
+  return -1;
+
+ memset(&addr, 0, sizeof(addr));
+ addr.sin_family = AF_INET;
+ addr.sin_port = htons(host_port(port));
+ inet_pton(AF_INET, (address != NULL) ? address : SIM_DEFAULT_ADDRESS, &addr.sin_addr);
+
+ setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+ fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+
+ if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0)
+ {
+  fprintf(stderr, "Simulator: cannot bind port %u (lwIP port %u): %s\n", host_port(port), port, strerror(errno));
+  close(fd);
+  return -1;
+ }
+
+ return fd;
+}
+
+/*!
+* \brief Closes a connection's socket and frees the pcb.
+*/
+
+static void free_tcp_pcb(struct tcp_pcb *pcb)
+{
+ for (size_t i = 0; i < tcp_pcbs.size(); i++)
+ {
+  if (tcp_pcbs[i] == pcb)
+  {
+   tcp_pcbs.erase(tcp_pcbs.begin() + i);
+   break;
+  }
+ }
+
+ if (pcb->fd >= 0)
+  close(pcb->fd);
+
+ free(pcb);
+}
+
+/*!
+* \brief Frees a connection the client has reset.
+*
+* As lwIP, the pcb is freed before tcp_err() is told, so the application
+* must not use it from its error callback.
+*/
+
+static void reset_tcp_pcb(struct tcp_pcb *pcb)
+{
+ tcp_err_fn errf = pcb->errf;
+ void *arg = pcb->callback_arg;
+
+ free_tcp_pcb(pcb);
+
+ if (errf != NULL)
+  errf(arg, ERR_RST);
+}
+
+// TCP.
+
+struct tcp_pcb *tcp_new(void)
+{
+ struct tcp_pcb *pcb = (struct tcp_pcb *)calloc(1, sizeof(struct tcp_pcb));
+
+ if (pcb == NULL)
+  return NULL;
+
+ pcb->state = CLOSED;
+ pcb->fd = -1;
+ pcb->rcv_wnd = TCP_WND;
+ tcp_pcbs.push_back(pcb);
+
+ return pcb;
+}
+
+err_t tcp_bind(struct tcp_pcb *pcb, const ip_addr_t *ipaddr, u16_t port)
+{
+ (void)ipaddr;
+
+ pcb->fd = open_socket(SOCK_STREAM, port);
+ pcb->local_port = port;
+
+ return (pcb->fd >= 0) ? ERR_OK : ERR_USE;
+}
+
+struct tcp_pcb *tcp_listen(struct tcp_pcb *pcb)
+{
+ if ((pcb->fd < 0) || (listen(pcb->fd, SIM_LISTEN_BACKLOG) != 0))
+  return NULL;
+
+ pcb->state = LISTEN;
+ printf("Simulator: HTTP on port %u\n", host_port(pcb->local_port));
+
+ return pcb;
+}
+
+void tcp_arg(struct tcp_pcb *pcb, void *arg)
+{
+ pcb->callback_arg = arg;
+}
+
+void tcp_accept(struct tcp_pcb *pcb, tcp_accept_fn accept)
+{
+ pcb->accept = accept;
+}
+
+void tcp_recv(struct tcp_pcb *pcb, tcp_recv_fn recv)
+{
+ pcb->recv = recv;
+}
+
+void tcp_sent(struct tcp_pcb *pcb, tcp_sent_fn sent)
+{
+ pcb->sent = sent;
+}
+
+void tcp_err(struct tcp_pcb *pcb, tcp_err_fn err)
+{
+ pcb->errf = err;
+}
+
+void tcp_recved(struct tcp_pcb *pcb, u16_t len)
+{
+ pcb->rcv_wnd = LWIP_MIN(pcb->rcv_wnd + len, (u32_t)TCP_WND);
+}
+
+err_t tcp_write(struct tcp_pcb *pcb, const void *dataptr, u16_t len, u8_t apiflags)
+{
+ (void)apiflags;
+
+ if ((pcb->state != ESTABLISHED) || (pcb->is_closing == true))
+  return ERR_CONN;
+
+ if (len > tcp_sndbuf(pcb))
+  return ERR_MEM;
+
+ memcpy(&pcb->snd_buf[pcb->snd_queued], dataptr, len);
+ pcb->snd_queued += len;
+
+ return ERR_OK;
+}
+
+err_t tcp_output(struct tcp_pcb *pcb)
+{
+ (void)pcb;
+ return ERR_OK;   // Sent on the next poll.
+}
+
+err_t tcp_close(struct tcp_pcb *pcb)
+{
+ if (pcb->state == LISTEN)
+ {
+  free_tcp_pcb(pcb);
+  return ERR_OK;
+ }
+
+// Freed by the poll once the queued data has gone, as lwIP frees it
+// after the FIN is acknowledged; the application must not use it again.
+
+ pcb->state = FIN_WAIT_1;
+ pcb->is_closing = true;
+ pcb->recv = NULL;
+ pcb->sent = NULL;
+
+ return ERR_OK;
+}
+
+/*!
+* \brief Accepts the pending connections of a listening pcb.
+*/
+
+static void poll_listen(struct tcp_pcb *listener)
+{
+ int fd;
+ int one = 1;
+
+ while ((fd = accept(listener->fd, NULL, NULL)) >= 0)
+ {
+  struct tcp_pcb *pcb = tcp_new();
+
+  if (pcb == NULL)
+  {
+   close(fd);
+   continue;
+  }
+
+  fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+  setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+  pcb->fd = fd;
+  pcb->state = ESTABLISHED;
+  pcb->local_port = listener->local_port;
+  pcb->callback_arg = listener->callback_arg;
+
+  if ((listener->accept == NULL) || (listener->accept(listener->callback_arg, pcb, ERR_OK) != ERR_OK))
+   free_tcp_pcb(pcb);
+ }
+}
+
+/*!
+* \brief Sends queued data and delivers received data for a connection.
+*
+* \return bool. false if the pcb has been freed.
+*/
+
+static bool poll_connection(struct tcp_pcb *pcb)
+{
+ if (pcb->snd_queued > 0)
+ {
+  ssize_t n = send(pcb->fd, pcb->snd_buf, pcb->snd_queued, MSG_NOSIGNAL);
+
+  if ((n < 0) && (errno != EAGAIN) && (errno != EWOULDBLOCK))
+  {
+   reset_tcp_pcb(pcb);
+   return false;
+  }
+
+  if (n > 0)
+  {
+   pcb->snd_queued -= n;
+   memmove(pcb->snd_buf, &pcb->snd_buf[n], pcb->snd_queued);
+
+   if (pcb->sent != NULL)
+    pcb->sent(pcb->callback_arg, pcb, (u16_t)n);
+  }
+ }
+
+ if (pcb->is_closing == true)
+ {
+  if (pcb->snd_queued > 0)
+   return true;
+
+  shutdown(pcb->fd, SHUT_RDWR);
+  free_tcp_pcb(pcb);
+  return false;
+ }
+
+ if (pcb->rcv_wnd == 0)
+  return true;
+
+ uint8_t buf[TCP_MSS];
+ ssize_t n = recv(pcb->fd, buf, LWIP_MIN(sizeof(buf), pcb->rcv_wnd), 0);
+
+ if ((n < 0) && ((errno == EAGAIN) || (errno == EWOULDBLOCK)))
+  return true;
+
+ if ((n < 0) && (errno == ECONNRESET))
+ {
+  reset_tcp_pcb(pcb);
+  return false;
+ }
+
+ if (n <= 0)
+ {
+// The client closed the connection: a NULL pbuf, as lwIP.
+
+  pcb->state = CLOSE_WAIT;
+
+  if (pcb->recv != NULL)
+   pcb->recv(pcb->callback_arg, pcb, NULL, ERR_OK);
+  else
+   tcp_close(pcb);
+
+  return true;
+ }
+
+ struct pbuf *p = pbuf_alloc(PBUF_RAW, n, PBUF_POOL);
+
+ memcpy(p->payload, buf, n);
+ pcb->rcv_wnd -= n;
+
+ if (pcb->recv != NULL)
+  pcb->recv(pcb->callback_arg, pcb, p, ERR_OK);
+ else
+ {
+  tcp_recved(pcb, n);
+  pbuf_free(p);
+ }
+
+ return true;
+}
+
+// UDP.
+
+struct udp_pcb *udp_new(void)
+{
+ struct udp_pcb *pcb = new udp_pcb();
+
+ pcb->fd = -1;
+ udp_pcbs.push_back(pcb);
+
+ return pcb;
+}
+
+void udp_remove(struct udp_pcb *pcb)
+{
+ for (size_t i = 0; i < udp_pcbs.size(); i++)
+ {
+  if (udp_pcbs[i] == pcb)
+  {
+   udp_pcbs.erase(udp_pcbs.begin() + i);
+   break;
+  }
+ }
+
+ if (pcb->fd >= 0)
+  close(pcb->fd);
+
+ delete pcb;
+}
+
+void udp_recv(struct udp_pcb *pcb, udp_recv_fn recv, void *recv_arg)
+{
+ pcb->recv = recv;
+ pcb->recv_arg = recv_arg;
+}
+
+err_t udp_bind(struct udp_pcb *pcb, const ip_addr_t *ipaddr, u16_t port)
+{
+ (void)ipaddr;
+
+ pcb->fd = open_socket(SOCK_DGRAM, port);
+ pcb->local_port = port;
+
+ if (pcb->fd < 0)
+  return ERR_USE;
+
+ printf("Simulator: UDP port %u on port %u\n", port, host_port(port));
+
+ return ERR_OK;
+}
+
+err_t udp_sendto(struct udp_pcb *pcb, struct pbuf *p, const ip_addr_t *dst_ip, u16_t dst_port)
+{
+ uint8_t buf[SIM_UDP_MAX_DATAGRAM];
+
+ (void)dst_ip;
+ (void)dst_port;
+ host_pbuf_check_live(p, "udp_sendto");
+
+ if ((pcb->has_peer == false) || (p->tot_len > sizeof(buf)))
+  return ERR_VAL;
+
+ u16_t len = pbuf_copy_partial(p, buf, p->tot_len, 0);
+
+ if (sendto(pcb->fd, buf, len, 0, (struct sockaddr *)&pcb->peer, sizeof(pcb->peer)) < 0)
+  return ERR_BUF;
+
+ return ERR_OK;
+}
+
+/*!
+* \brief Delivers the datagrams waiting on a UDP pcb.
+*/
+
+static void poll_udp(struct udp_pcb *pcb)
+{
+ uint8_t buf[SIM_UDP_MAX_DATAGRAM];
+
+ for (int i = 0; (i < SIM_UDP_READS_PER_POLL) && (pcb->fd >= 0); i++)
+ {
+  socklen_t addr_len = sizeof(pcb->peer);
+  ssize_t n = recvfrom(pcb->fd, buf, sizeof(buf), 0, (struct sockaddr *)&pcb->peer, &addr_len);
+
+  if (n < 0)
+   break;
+
+// Header room in front, as a received pbuf has, for replies built in
+// place.
+
+  struct pbuf *p = pbuf_alloc(PBUF_TRANSPORT, n, PBUF_POOL);
+  ip_addr_t src;
+
+  memcpy(p->payload, buf, n);
+  src.addr = pcb->peer.sin_addr.s_addr;
+  pcb->has_peer = true;
+
+  if (pcb->recv != NULL)
+   pcb->recv(pcb->recv_arg, pcb, p, &src, ntohs(pcb->peer.sin_port));
+  else
+   pbuf_free(p);
+
+  pcb->has_peer = false;
+ }
+}
+
+// ARP: nothing to resolve over a socket.
+
+err_t etharp_add_static_entry(const ip4_addr_t *ipaddr, struct eth_addr *ethaddr)
+{
+ (void)ipaddr;
+ (void)ethaddr;
+ return ERR_OK;
+}
+
+err_t etharp_remove_static_entry(const ip4_addr_t *ipaddr)
+{
+ (void)ipaddr;
+ return ERR_OK;
+}
+
+// CYW43.
+
+uint32_t cyw43_hal_ticks_ms(void)
+{
+ return (uint32_t)(time_us_64() / 1000);
+}
+
+int cyw43_arch_init(void)
+{
+ return 0;
+}
+
+void cyw43_arch_deinit(void)
+{
+}
+
+void cyw43_arch_gpio_put(unsigned wl_gpio, bool value)
+{
+ (void)wl_gpio;
+ (void)value;
+}
+
+void cyw43_arch_enable_ap_mode(const char *ssid, const char *password, uint32_t auth)
+{
+ (void)auth;
+ printf("Simulator: access point \"%s\" (password \"%s\")\n", ssid, password);
+}
+
+int cyw43_wifi_pm(cyw43_t *self, uint32_t pm)
+{
+ (void)self;
+ (void)pm;
+ return 0;
+}
+
+/*!
+* \brief Runs the bridge: the simulator's network input and output.
+*/
+
+void cyw43_arch_poll(void)
+{
+// Callbacks can open and close pcbs, so work on a copy of the lists and
+// skip the pcbs freed meanwhile.
+
+ std::vector<struct tcp_pcb *> pcbs = tcp_pcbs;
+
+ for (struct tcp_pcb *pcb : pcbs)
+ {
+  bool is_live = false;
+
+  for (struct tcp_pcb *live : tcp_pcbs)
+   is_live |= (live == pcb);
+
+  if (is_live == false)
+   continue;
+
+  if (pcb->state == LISTEN)
+   poll_listen(pcb);
+  else if (pcb->fd >= 0)
+   poll_connection(pcb);
+ }
+
+ for (size_t i = 0; i < udp_pcbs.size(); i++)
+  poll_udp(udp_pcbs[i]);
+}
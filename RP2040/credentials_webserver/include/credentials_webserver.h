@@ -24,7 +24,7 @@
  * Author: busdev
  *
  * Created on 30 December 2022
- * Updated on 31 January 2023
+ * Updated on 19 October 2026
  */
 
 #ifndef __CREDENTIALS_WEBSERVER_H__
@@ -33,32 +33,157 @@
 #define APSSID "EPD_Init"
 #define APPSK  "epdsetup"
 
-#define MIN_SSID_LENGTH     1
-#define MAX_SSID_LENGTH     32
-#define MIN_PASSWORD_LENGTH 8
-#define MAX_PASSWORD_LENGTH 63
-#define MAX_URL_LENGTH      150
 #define MAX_CONTENTS_LENGTH 2048
 
 #define HTTP_GET_OFFSET  4    // Used by extract_path.
 #define HTTP_POST_OFFSET 5    // Used by extract_path.
+#define HTTP_PUT_OFFSET  4    // Used by extract_path.
 
 #define HTTP_HEADER_BUFFER_SIZE 250
 
-#define HEADER1 "<div align=\"center\"><div style=\"margin:auto;height:auto;max-width:320px;border:2px solid blue;border-radius:4px;text-align:center;background-color:rgb(100,150,150)\">"
-#define HEADER2 "<div align=\"center\"><div style=\"margin:auto;height:auto;max-width:300px;border:2px solid blue;border-radius:4px;text-align:center;background-color:rgb(100,150,150)\">"
-#define HEADER3 "<div align=\"center\"><div style=\"margin:auto;height:auto;max-width:300px;border:2px solid blue;border-radius:4px;text-align:center;background-color:rgb(100,150,150)\">"
-#define HEADER4 "<div align=\"center\"><div style=\"margin:auto;height:auto;max-width:300px;border:2px solid red;border-radius:4px;text-align:center;background-color:rgb(100,150,150)\">"
-#define HEADER5 "<div align=\"center\"><div style=\"margin:auto;height:auto;max-width:300px;border:2px solid gray;border-radius:4px;text-align:center;background-color:rgb(200,200,200)\">"
-#define HEADER6 "<div align=\"center\"><div style=\"margin:auto;height:auto;max-width:300px;border:2px solid red;border-radius:4px;text-align:center;background-color:rgb(100,150,150)\">"
-#define HEADER7 "<div align=\"center\"><div style=\"margin:auto;height:auto;max-width:300px;border:2px solid blue;border-radius:4px;text-align:center;background-color:rgb(100,150,150)\">"
-#define HEADER8 "<div align=\"center\"><div style=\"margin:auto;height:auto;max-width:300px;border:2px solid blue;border-radius:4px;text-align:center;background-color:rgb(100,150,150)\">"
-#define HEADER9 "<div align=\"center\"><div style=\"margin:auto;height:auto;max-width:300px;border:2px solid red;border-radius:4px;text-align:center;background-color:rgb(100,150,150)\">"
-
-#define FOOTER1 "</div></div>"
+// Fixed string sizes, including the terminator.
+// Arguments arrive percent-encoded, so the SSID and password buffers hold
+// three bytes per character; the URL is bounded by the request size.
+
+#define SSID_BUFFER_SIZE     ((3 * MAX_SSID_LENGTH) + 1)
+#define PASSWORD_BUFFER_SIZE ((3 * MAX_PASSWORD_LENGTH) + 1)
+#define URL_BUFFER_SIZE      (MAX_CONTENTS_LENGTH + 1)
+#define PAGE_BUFFER_SIZE     (MAX_CONTENTS_LENGTH + 1)
+
+// Streamed responses (/metrics, /trace, /memory, /profile), see start_stream().
+
+#define STREAM_CHUNK_SIZE   1024
+#define STREAM_METRICS      0
+#define STREAM_TRACE        1
+#define STREAM_MEMORY       2
+#define STREAM_PROFILE      3
+
+// Cached pages, see Page_Cache. Pages that depend only on the credentials
+// are kept rendered until page_generation changes.
+
+#define PAGE_NOT_CACHED        PAGE_CACHE_NONE
+#define PAGE_HOME              0
+#define PAGE_IMAGE_SERVER      1
+#define PAGE_DEVICE_ID         2
+#define PAGE_MASTER_RESET      3
+#define PAGE_DISPLAY_MODE      4
+#define PAGE_NOT_FOUND_ROUTE   5
+
+// Request routes, the method and route labels of cws_http_requests_total.
+// Each has its counter, registered by the constructor. Unknown paths are
+// counted as ROUTE_..._OTHER, they must not become labels.
+
+#define ROUTE_GET_HOME                    0
+#define ROUTE_GET_STYLESHEET              1
+#define ROUTE_GET_IMAGE_SERVER            2
+#define ROUTE_GET_DEVICE_ID               3
+#define ROUTE_GET_MASTER_RESET            4
+#define ROUTE_GET_DISPLAY                 5
+#define ROUTE_GET_RESET_DONE              6
+#define ROUTE_GET_CONFIG                  7
+#define ROUTE_GET_APP                     8
+#define ROUTE_GET_PROBE                   9
+#define ROUTE_GET_METRICS                 10
+#define ROUTE_GET_TRACE                   11
+#define ROUTE_GET_MEMORY                  12
+#define ROUTE_GET_PROFILE                 13
+#define ROUTE_GET_PROFILE_START           14
+#define ROUTE_GET_OTHER                   15
+#define ROUTE_POST_RESET_CONFIRMED        16
+#define ROUTE_POST_CREDENTIALS            17
+#define ROUTE_POST_RESET_CREDENTIALS      18
+#define ROUTE_POST_CANCEL_CREDENTIALS     19
+#define ROUTE_POST_DISPLAY_MODE           20
+#define ROUTE_POST_CONFIG_MASTER_RESET    21
+#define ROUTE_POST_CONFIG_DISPLAY_MODE    22
+#define ROUTE_POST_OTHER                  23
+#define ROUTE_PUT_CONFIG                  24
+#define ROUTE_PUT_OTHER                   25
+#define ROUTE_COUNT                       26
+
+// Cache-Control. Pages carry an ETag and are revalidated with
+// If-None-Match, answered with 304 when unchanged; pages showing the
+// credentials and one off results are not stored at all.
+
+#define CACHE_CONTROL_REVALIDATE "no-cache"
+#define CACHE_CONTROL_NO_STORE   "no-store"
+#define CACHE_CONTROL_IMMUTABLE  "public, max-age=31536000, immutable"
+
+#define CONTENT_TYPE_HTML "text/html"
+#define CONTENT_TYPE_CSS  "text/css"
+#define CONTENT_TYPE_JSON "application/json"
+
+// Provisioning API, GET and PUT /CONFIG_API_PATH. The settings as one
+// flat JSON object, see handle_config_put(). Never stored by the client,
+// it carries the password.
+
+#define CONFIG_API_PATH     "api/v1/config"     // As extract_path() returns it.
+#define CONFIG_ERROR_JSON    "json"             // Error values of a failed PUT.
+#define CONFIG_ERROR_SSID    "ssid"
+#define CONFIG_ERROR_PASS    "password"
+#define CONFIG_ERROR_URL     "url"
+#define CONFIG_ERROR_STORAGE "storage"
+#define CONFIG_ERROR_RESET   "reset"
+
+#define CONFIG_MASTER_RESET_PATH "api/v1/masterreset"   // POST, answers the settings.
+#define CONFIG_DISPLAY_MODE_PATH "api/v1/displaymode"   // POST, then the server stops.
+#define CONFIG_DISPLAY_MODE_JSON "{\"mode\":\"display\"}"
+
+// Single page UI, GET /UI_APP_PATH. One gzipped bundle (ui/app.html,
+// built into ui_bundle.h by tools/make_ui_bundle.py) sent from flash;
+// after that every action is a call to the provisioning API. Clients
+// that do not take gzip are sent to the HTML pages.
+
+#define UI_APP_PATH "app"                               // As extract_path() returns it.
+
+#define DEVICE_LABEL_ID "Test_Label_ID"                 // *** Test *** Outstanding Work ***
+
+#define METRICS_HTTP_HEADER "HTTP/1.1 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nCache-Control: no-store\r\nConnection: close\r\n\r\n"
+#define TEXT_HTTP_HEADER    "HTTP/1.1 200 OK\r\nContent-Type: text/plain\r\nCache-Control: no-store\r\nConnection: close\r\n\r\n"
+
+// Captive portal. Every name resolves to the access point (dns_server.h),
+// so the OS connectivity probes arrive here and are redirected to the
+// setup page, which the OS then pops up. CAPTIVE_PORTAL_URL must match
+// the access point address set in main.cpp.
+
+#define CAPTIVE_PORTAL_URL      "http://192.168.4.1/setup/home"
+#define CAPTIVE_PORTAL_REDIRECT "HTTP/1.1 302 Found\r\nLocation: " CAPTIVE_PORTAL_URL "\r\nCache-Control: no-store\r\nContent-Length: 0\r\nConnection: close\r\n\r\n"
+
+// Post/Redirect/Get. The pages are GETs; a POST changes the settings
+// and answers 303 with the page to show, so a refresh or Back never
+// posts again.
+
+#define SEE_OTHER(location)    "HTTP/1.1 303 See Other\r\nLocation: " location "\r\nCache-Control: no-store\r\nContent-Length: 0\r\nConnection: close\r\n\r\n"
+#define SEE_OTHER_HOME         SEE_OTHER("/setup/home")
+#define SEE_OTHER_IMAGE_SERVER SEE_OTHER("/setup/imageserver")
+#define SEE_OTHER_RESET_DONE   SEE_OTHER("/setup/resetdone")
+
+// Stylesheet, GET /STYLESHEET_PATH. Sent from flash and kept by the
+// browser for a year without revalidating, so the version in the path
+// must change whenever STYLESHEET does.
+
+#define STYLESHEET_PATH "style.v2.css"    // As extract_path() returns it.
+
+#define STYLESHEET \
+ ".box{margin:auto;max-width:300px;border:2px solid blue;border-radius:4px;text-align:center;background-color:rgb(100,150,150)}" \
+ ".wide{max-width:320px}" \
+ ".alert{border-color:red}" \
+ ".plain{border-color:gray;background-color:rgb(200,200,200)}" \
+ ".btn{display:inline-block;margin:10px;padding:5px 10px;border:1px solid gray;border-radius:4px;background-color:rgb(190,190,190);color:black;font:13px sans-serif;text-decoration:none}" \
+ ".danger{border-color:brown;background-color:rgb(255,0,0)}" \
+ ".mono{font-family:courier}"
+
+#define HEADER_MENU  "<div class=\"box wide\">"
+#define HEADER_PANEL "<div class=\"box\">"
+#define HEADER_ALERT "<div class=\"box alert\">"
+#define HEADER_PLAIN "<div class=\"box plain\">"
+
+#define FOOTER1 "</div>"
 #define FORM1   "<form method=\"POST\">"
-#define BUTTON1 "<input type=\"submit\" style=\"margin:10px;padding:5px 10px;border:1px solid gray;border-radius:4px;background-color:rgb(190,190,190)\" "
-#define BUTTON2 "<input type=\"submit\" style=\"margin:10px;padding:5px 10px;border:1px solid brown;border-radius:4px;background-color:rgb(255,0,0)\" "
+#define BUTTON1 "<input type=\"submit\" class=\"btn\" "
+#define BUTTON2 "<input type=\"submit\" class=\"btn danger\" "
+#define LINK1   "<a class=\"btn\" href="
+#define LINK2   "<a class=\"btn danger\" href="
 
 #define PAGE_TITLE          "<title>EPD Setup</title>"
 #define TITLE1              "<H3>DISPLAY SETUP</H3>"
@@ -70,6 +195,9 @@
 #define RESET_DISPLAY_TITLE "<H3>Reset Display</H3>"
 #define PAGE_NOT_FOUND      "<H1>Page Not Found</H1>"
 
+#define WEB_PAGE_HEADER "<html><head>" PAGE_TITLE "<link rel=\"stylesheet\" href=\"/" STYLESHEET_PATH "\"></head>"
+#define WEB_PAGE_FOOTER FOOTER1 "</body></html>"
+
 // SSID rules:
 //
 // 1. First character must not be in ['!', '#', ';'].
@@ -88,22 +216,26 @@
 #define PASSWORD_ARGUMENT     "password"
 #define SERVER_URL_ARGUMENT   "serverURL"
 
-enum http_req_type { HTTP_GET, HTTP_POST, HTTP_UNKNOWN };
-
 #define HTTP_PORT 80
 
-#include <string>
 #include <cstring>
+#include <cstdlib>
 #include <assert.h>
 
-using std::string;
-
 #include "lwip/tcp.h"
+#include "fixed_string.h"
+#include "http_utils.h"
 #include "log.h"
+#include "metrics.h"
+#include "trace.h"
+#include "memory_stats.h"
+#include "page_cache.h"
+#include "pc_sampler.h"
 #include "storage_handler.h"
 
 extern err_t w_http_recv_callback(void *arg, struct tcp_pcb *pcb, struct pbuf *p, err_t err);
 extern err_t w_http_sent_callback(void *arg, struct tcp_pcb *pcb, u16_t len);
+extern void w_http_err_callback(void *arg, err_t err);
 extern err_t http_accept_callback(void *arg, struct tcp_pcb *pcb, err_t err);
 
 class Credentials_Webserver 
@@ -122,50 +254,80 @@ class Credentials_Webserver
 
   err_t http_recv_callback(void *arg, struct tcp_pcb *pcb, struct pbuf *p, err_t err);
   err_t http_sent_callback(void *arg, struct tcp_pcb *pcb, u16_t len);
+  void http_err_callback(void *arg, err_t err);
 
  private:
-  string replace_special_html_characters(string source_str);
   bool check_wifi_ssid_format(void);
   bool check_wifi_password_format(void);
   bool check_image_server_url_format(void);
   bool check_fields(void);
   
-  err_t send_page(struct tcp_pcb *pcb, const char *data_ptr, int data_len);
-  err_t send_data(struct tcp_pcb *pcb, const char *data_ptr, int data_len);
+  void format_page_header(Fixed_String<HTTP_HEADER_BUFFER_SIZE> &header, int status, const char *content_type, const char *cache_control, uint32_t etag, int data_len);
+  err_t send_page(struct tcp_pcb *pcb, int status, const char *content_type, const char *cache_control, const char *data_ptr, int data_len);
+  err_t send_data(struct tcp_pcb *pcb, const char *data_ptr, int data_len, u8_t apiflags);
+  err_t send_web_page(struct tcp_pcb *pcb, int route);
+  err_t send_redirect(struct tcp_pcb *pcb, const char *response);
+  err_t send_cached_page(struct tcp_pcb *pcb, int route, int slot);
+  err_t send_not_modified(struct tcp_pcb *pcb, const char *cache_control, uint32_t etag);
+  bool is_not_modified(uint32_t etag);
+  void invalidate_pages(void);
+  err_t start_stream(struct tcp_pcb *pcb, int kind, const char *http_header);
+  err_t send_stream_chunk(struct tcp_pcb *pcb);
+  void count_request(int route);
 
   err_t handle_page_not_found(struct tcp_pcb *pcb);
+  err_t handle_stylesheet(struct tcp_pcb *pcb);
+  err_t handle_captive_portal_probe(struct tcp_pcb *pcb);
   err_t handle_home_page(struct tcp_pcb *pcb);
   err_t handle_image_server_page(struct tcp_pcb *pcb);
   err_t handle_device_id_page(struct tcp_pcb *pcb);
   err_t handle_master_reset_page(struct tcp_pcb *pcb);
   err_t handle_reset_confirmed_page(struct tcp_pcb *pcb);
+  err_t handle_reset_done_page(struct tcp_pcb *pcb);
   err_t handle_image_server_credentials_page(struct tcp_pcb *pcb, char *req, int rlen);
   err_t handle_reset_image_server_credentials_page(struct tcp_pcb *pcb);
   err_t handle_cancel_image_server_credentials_page(struct tcp_pcb *pcb);
   err_t handle_change_display_mode_page(struct tcp_pcb *pcb);
   err_t handle_setup_display_mode_page(struct tcp_pcb *pcb);
-  err_t handle_error_message_page(struct tcp_pcb *pcb, string error_message, string web_directory);
+  err_t handle_error_message_page(struct tcp_pcb *pcb, const char *error_message, const char *web_directory);
+  err_t handle_config_get(struct tcp_pcb *pcb);
+  err_t handle_config_put(struct tcp_pcb *pcb, char *req, int rlen);
+  err_t send_config(struct tcp_pcb *pcb, int status, const char *error);
+  err_t handle_config_master_reset(struct tcp_pcb *pcb);
+  err_t handle_config_display_mode(struct tcp_pcb *pcb);
+  err_t handle_app_page(struct tcp_pcb *pcb, const char *req, int rlen);
+  bool reset_to_factory_defaults(void);
+  err_t handle_metrics_page(struct tcp_pcb *pcb);
+  err_t handle_trace_page(struct tcp_pcb *pcb);
+  err_t handle_memory_page(struct tcp_pcb *pcb);
+  err_t handle_profile_page(struct tcp_pcb *pcb);
+  err_t handle_profile_start_page(struct tcp_pcb *pcb, const char *query);
   err_t handle_http_post(struct tcp_pcb *pcb, char *req, int rlen);
+  err_t handle_http_put(struct tcp_pcb *pcb, char *req, int rlen);
   err_t handle_http_get(struct tcp_pcb *pcb, const char *req, int rlen);
 
-  enum http_req_type decode_http_request(const char *req);
-
-  void extract_path(char *path, const char *req, int rlen, int initial_offset);
-  string extract_argument(const char* data, int len, const char* argument_name);
+  bool is_captive_portal_probe(const char *path);
    
   Storage_Handler *sh;
   Log *log;
 
-  string log_text;
-  string new_ssid;
-  string new_pass;
-  string new_server;
-  string ssid;
-  string pass;
-  string server;
+  Fixed_String<SSID_BUFFER_SIZE> new_ssid;
+  Fixed_String<PASSWORD_BUFFER_SIZE> new_pass;
+  Fixed_String<URL_BUFFER_SIZE> new_server;
+  Fixed_String<SSID_BUFFER_SIZE> ssid;
+  Fixed_String<PASSWORD_BUFFER_SIZE> pass;
+  Fixed_String<URL_BUFFER_SIZE> server;
+
+  Fixed_String<PAGE_BUFFER_SIZE> web_page;   // Page being built, see send_web_page().
+
+  Page_Cache page_cache;
+  uint32_t page_generation;                  // Changed with new_ssid, new_pass or new_server.
 
-  string web_page_header;
-  string web_page_footer;
+  uint32_t stylesheet_etag;
+  uint32_t ui_bundle_etag;
+
+  const char *if_none_match;                 // If-None-Match of the GET being answered...
+  int if_none_match_len;                     // ...in the request buffer, 0 if none.
 
   bool is_display_reset;
   bool is_master_reset_error;
@@ -174,6 +336,27 @@ class Credentials_Webserver
   bool is_ssid_present_and_correct;
   bool is_password_present_and_correct;
   bool is_server_url_present_and_correct;
+
+// Metrics.
+
+  int bytes_sent_metric;
+  int tcp_buffer_err_metric;
+  int tcp_write_err_metric;
+  int tcp_sndbuf_metric;
+  int first_write_latency_metric;
+  int not_modified_metric;
+  int request_metrics[ROUTE_COUNT];  // cws_http_requests_total, by ROUTE_...
+
+  uint32_t request_start_us;        // Receive time of the request being answered...
+  bool is_request_timed;            // ...until its first tcp_write.
+
+// Streamed response. Only one at a time; a new one replaces the old.
+
+  struct tcp_pcb *stream_pcb;       // Connection being streamed to, or NULL.
+  void *stream_arg;                 // Its callback argument, for http_err_callback().
+  int stream_kind;                  // STREAM_METRICS or STREAM_TRACE.
+  uint32_t stream_cursor;
+  char stream_chunk[STREAM_CHUNK_SIZE];
  };
 
  extern Credentials_Webserver *cws;
@@ -0,0 +1,125 @@
+/*!
+ * @file
+ * DHCP lease table header.
+ */
+
+/*
+ * Copyright (c) 2023, FAV Software Limited. All rights reserved.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/*
+ * File:   dhcp_lease_table.h
+ * Author: busdev
+ *
+ * Created on 19 October 2026
+ * Updated on 19 October 2026
+ */
+
+#ifndef __DHCP_LEASE_TABLE_H__
+#define __DHCP_LEASE_TABLE_H__
+
+// DHCP lease table.
+//
+// One lease per pool address, index i is address DHCPS_BASE_IP + i. A
+// lease is:
+//
+//   FREE       on the free list, reused oldest first.
+//   OFFERED    reserved for a client's DISCOVER for DHCP_OFFER_HOLD_MS.
+//   BOUND      acknowledged, until the lease time runs out or RELEASE.
+//   DECLINED   a client found the address in use (DECLINE), kept out of
+//              the pool for DHCP_DECLINE_HOLD_MS.
+//
+// Clients are found by MAC through a hash index. Expiry runs on a timer
+// wheel of DHCP_WHEEL_SLOTS slots of DHCP_WHEEL_TICK_MS: each OFFERED,
+// BOUND or DECLINED lease sits in the slot of its expiry time, and
+// dhcp_lease_table_expire() visits only the slots that time has passed
+// through. Longer expiries stay put until their rotation comes round.
+//
+// Times are 32 bit ms ticks compared by signed difference, so they wrap
+// correctly as long as every hold and lease time is under 2^31 ms.
+//
+// The table has no knowledge of packets or time sources; dhcpserver.c
+// drives it and the host harness can drive it with any clock.
+
+#ifndef DHCPS_MAX_IP
+#define DHCPS_MAX_IP 32                     // Pool size, see CWS_DHCP_POOL_SIZE.
+#endif
+
+#define DHCP_LEASE_HASH_SIZE  64            // MAC hash buckets, power of 2.
+#define DHCP_WHEEL_SLOTS      64            // Power of 2.
+#define DHCP_WHEEL_TICK_SHIFT 10            // Slot width 1024 ms, one turn about 65 s.
+#define DHCP_WHEEL_TICK_MS    (1u << DHCP_WHEEL_TICK_SHIFT)
+
+#define DHCP_OFFER_HOLD_MS    (30 * 1000)
+#define DHCP_DECLINE_HOLD_MS  (10 * 60 * 1000)
+
+#define DHCP_LEASE_NONE -1                  // No lease; also ends the lists.
+
+// Lease states.
+
+#define DHCP_LEASE_FREE     0
+#define DHCP_LEASE_OFFERED  1
+#define DHCP_LEASE_BOUND    2
+#define DHCP_LEASE_DECLINED 3
+
+// dhcp_lease_table_request() results.
+
+#define DHCP_LEASE_OK       0
+#define DHCP_LEASE_INVALID  -1              // Not a pool address.
+#define DHCP_LEASE_IN_USE   -2              // Held by another client, or declined.
+
+#define DHCP_MAC_LEN 6
+
+#include <stdint.h>
+
+typedef struct _dhcp_lease_t
+{
+ uint8_t mac[DHCP_MAC_LEN];
+ uint8_t state;
+ uint32_t expiry_ms;
+ int16_t hash_next;                      // MAC hash chain.
+ int16_t next;                           // Free list or wheel slot list.
+ int16_t prev;
+} dhcp_lease_t;
+
+typedef struct _dhcp_lease_table_t
+{
+ dhcp_lease_t lease[DHCPS_MAX_IP];
+ int16_t hash[DHCP_LEASE_HASH_SIZE];
+ int16_t wheel[DHCP_WHEEL_SLOTS];
+ int16_t free_head;
+ int16_t free_tail;
+ uint32_t wheel_time_ms;                 // Start of the next slot to visit.
+ int bound_count;
+} dhcp_lease_table_t;
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+void dhcp_lease_table_init(dhcp_lease_table_t *t, uint32_t now_ms);
+int dhcp_lease_table_find(dhcp_lease_table_t *t, const uint8_t *mac);
+int dhcp_lease_table_offer(dhcp_lease_table_t *t, const uint8_t *mac, int preferred, uint32_t now_ms);
+int dhcp_lease_table_request(dhcp_lease_table_t *t, const uint8_t *mac, int index, uint32_t now_ms, uint32_t lease_ms);
+void dhcp_lease_table_release(dhcp_lease_table_t *t, const uint8_t *mac, int index);
+void dhcp_lease_table_decline(dhcp_lease_table_t *t, const uint8_t *mac, int index, uint32_t now_ms);
+void dhcp_lease_table_expire(dhcp_lease_table_t *t, uint32_t now_ms);
+
+#ifdef __cplusplus
+ }
+#endif
+
+#endif
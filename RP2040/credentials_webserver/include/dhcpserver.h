@@ -27,19 +27,14 @@
 #define MICROPY_INCLUDED_LIB_NETUTILS_DHCPSERVER_H
 
 #include "lwip/ip_addr.h"
+#include "dhcp_lease_table.h"
 
 #define DHCPS_BASE_IP (16)
-#define DHCPS_MAX_IP (8)
-
-typedef struct _dhcp_server_lease_t {
-    uint8_t mac[6];
-    uint16_t expiry;
-} dhcp_server_lease_t;
 
 typedef struct _dhcp_server_t {
     ip_addr_t ip;
     ip_addr_t nm;
-    dhcp_server_lease_t lease[DHCPS_MAX_IP];
+    dhcp_lease_table_t leases;
     struct udp_pcb *udp;
 } dhcp_server_t;
 
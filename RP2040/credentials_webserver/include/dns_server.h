@@ -0,0 +1,71 @@
+/*!
+ * @file
+ * Captive portal DNS responder header.
+ */
+
+/*
+ * Copyright (c) 2023, FAV Software Limited. All rights reserved.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/*
+ * File:   dns_server.h
+ * Author: busdev
+ *
+ * Created on 19 October 2026
+ * Updated on 19 October 2026
+ */
+
+#ifndef __DNS_SERVER_H__
+#define __DNS_SERVER_H__
+
+// Captive portal DNS responder.
+//
+// The access point has no uplink, so any name a client looks up can only
+// be served by us. Every A query is answered with the gateway address and
+// a short TTL; other query types get an empty answer (NODATA), so clients
+// fall back to A at once rather than waiting for a timeout. The DHCP
+// server advertises the gateway as the DNS server.
+//
+// With the names resolving to us, the OS connectivity probes (e.g.
+// connectivitycheck.gstatic.com/generate_204) arrive at the web server,
+// which redirects them to the setup page, see CAPTIVE_PORTAL_URL.
+//
+//   cws_dns_queries_total{result="answered|nodata|ignored"}
+
+#define DNS_PORT          53
+#define DNS_TTL_S         10        // Short, the answers are only good on the AP.
+#define DNS_MAX_NAME_LEN  255
+
+#include "lwip/ip_addr.h"
+
+typedef struct _dns_server_t
+{
+ ip_addr_t ip;
+ struct udp_pcb *udp;
+} dns_server_t;
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+void dns_server_init(dns_server_t *d, ip_addr_t *ip);
+void dns_server_deinit(dns_server_t *d);
+
+#ifdef __cplusplus
+ }
+#endif
+
+#endif
@@ -0,0 +1,191 @@
+/*!
+ * @file
+ * fixed_string class template.
+ */
+
+/*
+ * Copyright (c) 2023, FAV Software Limited. All rights reserved.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * File:   fixed_string.h
+ * Author: busdev
+ *
+ * Created on 19 October 2026
+ * Updated on 19 October 2026
+ */
+
+#ifndef __FIXED_STRING_H__
+#define __FIXED_STRING_H__
+
+#include <stdarg.h>
+#include <string.h>
+
+#include "tiny_format.h"
+
+/*!
+* \brief Null terminated string held in a fixed size array.
+*
+* Replaces std::string: no heap, no exceptions, no hidden copies.
+* SIZE includes the terminator, so at most SIZE - 1 characters are held.
+* Text that does not fit is cut off and is_truncated() is set until the
+* next assign() or clear(), so callers can reject over long input instead
+* of silently using part of it.
+*/
+
+template <int SIZE>
+class Fixed_String
+{
+ public:
+  Fixed_String():
+   len(0),
+   is_overflow(false)
+   {
+    buf[0] = 0;
+   }
+
+  Fixed_String(const char *str):
+   Fixed_String()
+   {
+    append(str);
+   }
+
+  void clear(void)
+  {
+   len = 0;
+   is_overflow = false;
+   buf[0] = 0;
+  }
+
+  Fixed_String &assign(const char *str, int count)
+  {
+   clear();
+   return append(str, count);
+  }
+
+  Fixed_String &assign(const char *str)
+  {
+   clear();
+   return append(str);
+  }
+
+  Fixed_String &append(const char *str, int count)
+  {
+   if (count > SIZE - 1 - len)
+   {
+    count = SIZE - 1 - len;
+    is_overflow = true;
+   }
+
+   memcpy(&buf[len], str, count);
+   len += count;
+   buf[len] = 0;
+
+   return *this;
+  }
+
+  Fixed_String &append(const char *str)
+  {
+   return append(str, strlen(str));
+  }
+
+  Fixed_String &append(char c)
+  {
+   return append(&c, 1);
+  }
+
+  // Appends printf style formatted text, see tiny_format.h.
+
+  Fixed_String &append_format(const char *fmt, ...)
+  {
+   va_list args;
+   int count;
+
+   va_start(args, fmt);
+   count = tiny_vformat(&buf[len], SIZE - len, fmt, args);
+   va_end(args);
+
+   if (count > SIZE - 1 - len)
+   {
+    count = SIZE - 1 - len;
+    is_overflow = true;
+   }
+
+   len += count;
+
+   return *this;
+  }
+
+  Fixed_String &operator=(const char *str) { return assign(str); }
+  Fixed_String &operator+=(const char *str) { return append(str); }
+  Fixed_String &operator+=(char c) { return append(c); }
+
+  template <int OTHER_SIZE>
+  Fixed_String &operator=(const Fixed_String<OTHER_SIZE> &str)
+  {
+   clear();
+   append(str.c_str(), str.length());
+   is_overflow = is_overflow || str.is_truncated();
+   return *this;
+  }
+
+  Fixed_String &operator=(const Fixed_String &str)
+  {
+   return operator=<SIZE>(str);
+  }
+
+  bool operator==(const char *str) const { return strcmp(buf, str) == 0; }
+  bool operator!=(const char *str) const { return strcmp(buf, str) != 0; }
+
+  template <int OTHER_SIZE>
+  bool operator==(const Fixed_String<OTHER_SIZE> &str) const
+  {
+   return (len == str.length()) && (memcmp(buf, str.c_str(), len) == 0);
+  }
+
+  template <int OTHER_SIZE>
+  bool operator!=(const Fixed_String<OTHER_SIZE> &str) const
+  {
+   return !(*this == str);
+  }
+
+  char operator[](int index) const { return buf[index]; }
+
+  // Sets the length after editing or writing data() in place, up to
+  // capacity(); data() must hold that many characters.
+
+  void set_length(int new_len)
+  {
+   if ((new_len >= 0) && (new_len <= SIZE - 1))
+   {
+    len = new_len;
+    buf[len] = 0;
+   }
+  }
+
+  const char *c_str(void) const { return buf; }
+  char *data(void) { return buf; }
+  int length(void) const { return len; }
+  bool empty(void) const { return len == 0; }
+  bool is_truncated(void) const { return is_overflow; }
+  static int capacity(void) { return SIZE - 1; }
+
+ private:
+  char buf[SIZE];
+  int len;
+  bool is_overflow;
+};
+
+#endif
@@ -0,0 +1,71 @@
+/*!
+ * @file
+ * flash_backend interface and associated constants.
+ */
+
+/*
+ * Copyright (c) 2023, FAV Software Limited. All rights reserved.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * File:   flash_backend.h
+ * Author: busdev
+ *
+ * Created on 19 October 2026
+ * Updated on 19 October 2026
+ */
+
+#ifndef __FLASH_BACKEND_H__
+#define __FLASH_BACKEND_H__
+
+// Error codes.
+
+#define FLASH_OK             0
+#define FLASH_RANGE_ERR     -1    // Offset or length outside the flash device.
+#define FLASH_ALIGNMENT_ERR -2    // Erase not sector aligned, or program not page aligned.
+#define FLASH_NOR_ERR       -3    // Program tried to set a bit that was not erased.
+#define FLASH_POWER_CUT_ERR -4    // Operation interrupted by a (simulated) power cut.
+
+// PICO_FLASH_SIZE_BYTES # 2MB.  The total size of the RP2040 flash, in bytes
+// FLASH_SECTOR_SIZE     # 4096. The size of one sector, in bytes (the minimum amount you can erase)
+// FLASH_PAGE_SIZE       # 256.  The size of one page, in bytes (the mimimum amount you can write)
+
+#include "pico/stdlib.h"
+#include "hardware/flash.h"
+
+/*!
+* \brief Access to the NOR flash device holding the persistent storage.
+*
+* Offsets are relative to the start of the flash device, not XIP_BASE.
+* Erase operates on whole sectors and program on whole pages, as
+* required by the RP2040 boot ROM flash routines.
+*/
+
+class Flash_Backend
+{
+ public:
+  virtual ~Flash_Backend() { }
+
+  virtual int read(uint32_t offset, uint8_t *data, uint32_t count) = 0;
+  virtual int erase(uint32_t offset, uint32_t count) = 0;
+  virtual int program(uint32_t offset, const uint8_t *data, uint32_t count) = 0;
+};
+
+// Implemented by whichever backend is linked into the build:
+// Pico_Flash_Backend on the device, Sim_Flash_Backend on the host.
+
+extern Flash_Backend *create_flash_backend(void);
+
+#endif
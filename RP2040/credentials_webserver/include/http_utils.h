@@ -0,0 +1,77 @@
+/*!
+ * @file
+ * HTTP request parsing and form value validation.
+ */
+
+/*
+ * Copyright (c) 2023, FAV Software Limited. All rights reserved.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * File:   http_utils.h
+ * Author: busdev
+ *
+ * Created on 19 October 2026
+ * Updated on 19 October 2026
+ */
+
+#ifndef __HTTP_UTILS_H__
+#define __HTTP_UTILS_H__
+
+// HTTP request parsing and form value validation.
+//
+// The pure-logic helpers of Credentials_Webserver: no lwIP, flash or
+// webserver state, so the host microbenchmark (host/src/http_utils_bench.cpp)
+// runs the same code as the device.
+//
+// Entity tags are 32 bit hashes of the page contents, sent as eight hex
+// digits in quotes, so the same page always gets the same tag, whichever
+// device or boot sent it.
+
+#include <stdint.h>
+
+#define MIN_SSID_LENGTH     1
+#define MAX_SSID_LENGTH     32
+#define MIN_PASSWORD_LENGTH 8
+#define MAX_PASSWORD_LENGTH 63
+#define MAX_URL_LENGTH      150
+
+#define HTTP_ETAG_SIZE 11          // Quoted entity tag, eight hex digits, and the terminator.
+
+#define HTTP_STATUS_OK           200
+#define HTTP_STATUS_NOT_MODIFIED 304
+#define HTTP_STATUS_BAD_REQUEST  400
+#define HTTP_STATUS_NOT_FOUND    404
+#define HTTP_STATUS_SERVER_ERROR 500
+
+enum http_req_type { HTTP_GET, HTTP_POST, HTTP_PUT, HTTP_UNKNOWN };
+
+enum http_req_type decode_http_request(const char *req);
+void extract_path(char *path, const char *req, int rlen, int initial_offset);
+int extract_argument(const char *data, int len, const char *argument_name, const char **value);
+int replace_special_html_characters(char *str, int len);
+bool is_valid_wifi_ssid(const char *ssid, int len);
+bool is_valid_wifi_password(const char *password, int len);
+bool is_valid_image_server_url(const char *url, int len);
+
+const char *http_status_text(int status);
+int find_http_header(const char *req, int rlen, const char *name, const char **value);
+int find_http_body(const char *req, int rlen);
+bool is_http_token_listed(const char *list, int len, const char *token);
+uint32_t http_etag(const char *data, int len);
+void format_etag(char *buf, uint32_t etag);
+bool is_etag_listed(const char *list, int len, uint32_t etag);
+
+#endif
@@ -0,0 +1,80 @@
+/*!
+ * @file
+ * Compact JSON reader and writer header.
+ */
+
+/*
+ * Copyright (c) 2023, FAV Software Limited. All rights reserved.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * File:   json.h
+ * Author: busdev
+ *
+ * Created on 19 October 2026
+ * Updated on 19 October 2026
+ */
+
+#ifndef __JSON_H__
+#define __JSON_H__
+
+// Compact JSON for the provisioning API (/api/v1/config).
+//
+// Flat objects only: members whose values are strings, numbers, true,
+// false or null. Nothing is allocated. The reader walks the members of
+// an object in place, one call per member, leaving the string values
+// escaped until json_unescape() copies them out; the writer appends
+// members to a caller's buffer and reports whether they all fitted.
+//
+// Like http_utils, no lwIP or webserver state, so the host benchmark
+// runs the same code as the device.
+
+#define JSON_MEMBER  1     // json_next_member() results.
+#define JSON_END     0
+#define JSON_ERROR  -1
+
+#define JSON_STRING  0     // json_member types.
+#define JSON_NUMBER  1
+#define JSON_TRUE    2
+#define JSON_FALSE   3
+#define JSON_NULL    4
+
+struct json_member
+{
+ const char *name;         // Escaped, without the quotes.
+ int name_len;
+ const char *value;        // Escaped strings without the quotes, other values as written.
+ int value_len;
+ int type;                 // JSON_STRING ...
+};
+
+struct json_writer
+{
+ char *buf;
+ int size;
+ int len;
+ bool is_overflow;
+};
+
+int json_next_member(const char *json, int len, int *cursor, struct json_member *member);
+bool json_name_is(const struct json_member *member, const char *name);
+int json_unescape(char *out, int size, const char *value, int len);
+
+void json_begin_object(struct json_writer *writer, char *buf, int size);
+void json_add_string(struct json_writer *writer, const char *name, const char *value, int len);
+void json_add_int(struct json_writer *writer, const char *name, int value);
+int json_end_object(struct json_writer *writer);
+
+#endif
@@ -24,7 +24,7 @@
  * Author: busdev
  *
  * Created on 14 February 2023
- * Updated on 14 February 2023
+ * Updated on 19 October 2026
  */
 
 #ifndef LOG_H
@@ -39,6 +39,8 @@
 #define TCP_BUFFER_ERR       4
 #define TCP_WRITE_ERR        5
 #define WIFI_INIT_ERR        6
+#define FLASH_WRITE_ERR      7
+#define PAGE_BUFFER_ERR      8
 
 // Error Messages.
 
@@ -49,6 +51,8 @@
 #define TCP_BUFFER_ERR_MSG       "Cannot send data, TCP send buffer too small."
 #define TCP_WRITE_ERR_MSG        "Cannot send data, TCP write."
 #define WIFI_INIT_ERR_MSG        "Failed to initialise WiFi module."
+#define FLASH_WRITE_ERR_MSG      "Unable to write data store to flash."
+#define PAGE_BUFFER_ERR_MSG      "Web page does not fit the %u byte page buffer."
 
 // Log Codes.
 
@@ -56,18 +60,84 @@
 #define FLASH_STORAGE_AREA_INITIALISED 2
 #define WIFI_CREDENTIALS_SET           3
 #define WIFI_CREDENTIALS_UPDATED       4
+#define WIFI_CREDENTIALS_RECEIVED      5
+#define MAIN_SINCE_TIMER_START         6
+#define PROVISIONING_SESSION_ENDED     7
 
 #define UNDEFINED_LOG_MSG                  "Undefined message code."
 #define CONFIG_JUMPER_DETECTED_MSG         "Configuration jumper detected."
 #define FLASH_STORAGE_AREA_INITIALISED_MSG "Flash storage area initialised."
 #define WIFI_CREDENTIALS_SET_MSG           "WiFi credentials set."
 #define WIFI_CREDENTIALS_UPDATED_MSG       "WiFi credentials updated."
+#define WIFI_CREDENTIALS_RECEIVED_MSG      "WiFi credentials received. SSID length %u, URL length %u."
+#define MAIN_SINCE_TIMER_START_MSG         "Reached main %u us since timer start."
+#define PROVISIONING_SESSION_ENDED_MSG     "Provisioning session ended. %u requests, %u frames dropped."
 
-#include <iostream> 
-#include <fstream>
-#include <string>
+// Messages may contain up to LOG_RECORD_ARGS "%u" conversions, filled in
+// from the record's arguments when the record is formatted.
+// tools/log_decode.py reads the message texts above from this file.
 
-using std::string;
+// Log levels.
+// Records above LOG_LEVEL are removed at compile time.
+
+#define LOG_LEVEL_NONE  0
+#define LOG_LEVEL_ERROR 1
+#define LOG_LEVEL_WARN  2
+#define LOG_LEVEL_INFO  3
+#define LOG_LEVEL_DEBUG 4
+
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_INFO
+#endif
+
+// Record types.
+
+#define LOG_TYPE_ERROR 0   // code is an error code.
+#define LOG_TYPE_LOG   1   // code is a log code.
+
+// Ring buffer.
+
+#define LOG_RING_SIZE       64   // Records, must be a power of 2.
+#define LOG_RECORD_ARGS     2
+#define LOG_PROCESS_BUDGET  8    // Records formatted per call to process().
+#define LOG_LINE_SIZE       128  // Longest formatted text record.
+
+// Binary output framing, see tools/log_decode.py.
+
+#define LOG_SYNC_BYTE_1 0xa5
+#define LOG_SYNC_BYTE_2 0x5a
+
+#include <atomic>
+
+#include "pico/stdlib.h"
+#include "log_sink.h"
+
+// Log macros.
+// Push a binary record for deferred formatting. The level comparison is
+// a constant expression, so filtered out records generate no code.
+
+#define LOG_ERROR(log, code, arg0, arg1) \
+ do { if (LOG_LEVEL >= LOG_LEVEL_ERROR) (log)->push(LOG_TYPE_ERROR, LOG_LEVEL_ERROR, (code), (arg0), (arg1)); } while (0)
+
+#define LOG_WARN(log, code, arg0, arg1) \
+ do { if (LOG_LEVEL >= LOG_LEVEL_WARN) (log)->push(LOG_TYPE_LOG, LOG_LEVEL_WARN, (code), (arg0), (arg1)); } while (0)
+
+#define LOG_INFO(log, code, arg0, arg1) \
+ do { if (LOG_LEVEL >= LOG_LEVEL_INFO) (log)->push(LOG_TYPE_LOG, LOG_LEVEL_INFO, (code), (arg0), (arg1)); } while (0)
+
+#define LOG_DEBUG(log, code, arg0, arg1) \
+ do { if (LOG_LEVEL >= LOG_LEVEL_DEBUG) (log)->push(LOG_TYPE_LOG, LOG_LEVEL_DEBUG, (code), (arg0), (arg1)); } while (0)
+
+// Fixed size binary log record, 16 bytes.
+
+struct log_record
+{
+ uint32_t timestamp_us;
+ uint8_t type;
+ uint8_t level;
+ uint16_t code;
+ uint32_t args[LOG_RECORD_ARGS];
+};
 
 class Log 
 {
@@ -75,15 +145,35 @@ class Log
   Log(bool is_verbose);
   ~Log();
 
-  string get_error_text(int error_number);
-  string get_log_text(int log_number);
+  const char *get_error_text(int error_number);
+  const char *get_log_text(int log_number);
    
   void print_error(int error_number);
   void print_log(int log_number);
-  void print_message(string msg);
+  void print_message(const char *msg);
+
+  void push(uint8_t type, uint8_t level, uint16_t code, uint32_t arg0, uint32_t arg1);
+  int process(void);
+  void flush(void);
+  uint32_t get_dropped_count(void);
+
+  void set_sink(Log_Sink *sink);
+  Log_Sink *get_sink(void);
  
  private:
+  void output_record(const struct log_record *record);
+
   bool is_verbose;
+  Log_Sink *sink;
+
+// Single producer, single consumer ring. Records are pushed from the
+// lwIP poll context and popped by process() in idle time, so only the
+// producer writes head and only the consumer writes tail.
+
+  struct log_record ring[LOG_RING_SIZE];
+  std::atomic<uint32_t> head;
+  std::atomic<uint32_t> tail;
+  uint32_t dropped_count;
 };
 
 #endif /* LOG_H */
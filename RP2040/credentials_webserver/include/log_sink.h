@@ -0,0 +1,89 @@
+/*!
+ * @file
+ * log_sink class header and associated constants.
+ */
+
+/*
+ * Copyright (c) 2023, FAV Software Limited. All rights reserved.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * File:   log_sink.h
+ * Author: busdev
+ *
+ * Created on 19 October 2026
+ * Updated on 19 October 2026
+ */
+
+#ifndef __LOG_SINK_H__
+#define __LOG_SINK_H__
+
+#define LOG_SINK_BUFFER_SIZE 2048   // Bytes, must be a power of 2.
+
+#include "pico/stdlib.h"
+
+// Sink counters.
+
+struct log_sink_stats
+{
+ uint32_t bytes_queued;
+ uint32_t bytes_sent;
+ uint32_t bytes_dropped;
+ uint32_t drop_events;       // Writes that did not fit, wholly or partly.
+ uint32_t last_latency_us;   // Time from write() to the data leaving the sink.
+ uint32_t max_latency_us;
+};
+
+/*!
+* \brief Non-blocking byte sink for log output.
+*
+* write() copies into a ring buffer and returns immediately. Bytes that
+* do not fit are dropped and counted, the caller never waits for the
+* output device. The derived class drains the ring in poll().
+*
+* Latency is sampled: one write at a time is tagged and its latency is
+* measured when its last byte has been consumed.
+*/
+
+class Log_Sink
+{
+ public:
+  Log_Sink();
+  virtual ~Log_Sink();
+
+  int write(const char *data, int len);
+  virtual void poll(void) = 0;
+  void flush(void);
+
+  bool is_empty(void);
+  struct log_sink_stats get_stats(void);
+
+ protected:
+  int get_pending(const uint8_t **data);
+  void consume(int count);
+
+ private:
+  uint8_t buffer[LOG_SINK_BUFFER_SIZE];
+  volatile uint32_t head;
+  volatile uint32_t tail;
+
+  bool is_probe_pending;
+  uint32_t probe_end;
+  uint32_t probe_start_us;
+
+  struct log_sink_stats stats;
+};
+
+#endif
@@ -0,0 +1,84 @@
+/*!
+ * @file
+ * main loop profiler header.
+ */
+
+/*
+ * Copyright (c) 2023, FAV Software Limited. All rights reserved.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/*
+ * File:   loop_profiler.h
+ * Author: busdev
+ *
+ * Created on 19 October 2026
+ * Updated on 19 October 2026
+ */
+
+#ifndef __LOOP_PROFILER_H__
+#define __LOOP_PROFILER_H__
+
+// Main loop profiler.
+//
+// The loop marks where it services the network and where it waits:
+//
+//   for (;;)
+//   {
+//    loop_profiler_poll_begin();
+//    cyw43_arch_poll();
+//    loop_profiler_poll_end();
+//    ...
+//    loop_profiler_idle_begin();
+//    sleep_ms(1);               // Or wait for an event.
+//    loop_profiler_idle_end();
+//   }
+//
+// which works the same for a polling loop and an event driven one, so the
+// two can be compared. From these the profiler keeps:
+//
+//   cws_loop_iteration_us           Histogram, time between polls.
+//   cws_loop_poll_us                Histogram, time in cyw43_arch_poll().
+//   cws_loop_busy_permille          Gauge, time not idle over the last
+//                                   LOOP_PROFILER_WINDOW_US.
+//   cws_loop_service_gap_max_us     Gauge, worst time from the CYW43
+//                                   raising its host wake interrupt (data
+//                                   waiting) to the start of the poll
+//                                   that services it.
+//
+// They are exported by /metrics; loop_profiler_render() writes a summary
+// for the UART.
+
+#define LOOP_PROFILER_WINDOW_US   1000000   // Busy ratio averaging window.
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+void loop_profiler_init(void);
+void loop_profiler_watch_wake_gpio(uint32_t gpio);
+void loop_profiler_poll_begin(void);
+void loop_profiler_poll_end(void);
+void loop_profiler_idle_begin(void);
+void loop_profiler_idle_end(void);
+int loop_profiler_render(char *buf, int size);
+
+#ifdef __cplusplus
+ }
+#endif
+
+#endif
@@ -30,9 +30,14 @@
 #define LWIP_NETIF_LINK_CALLBACK    1
 #define LWIP_NETIF_HOSTNAME         1
 #define LWIP_NETCONN                0
-#define MEM_STATS                   0
+// Heap and pool statistics for the memory report (memory_stats.h), see
+// CWS_LWIP_STATS in CMakeLists.txt.
+#ifndef LWIP_STATS_ENABLED
+#define LWIP_STATS_ENABLED          0
+#endif
+#define MEM_STATS                   LWIP_STATS_ENABLED
 #define SYS_STATS                   0
-#define MEMP_STATS                  0
+#define MEMP_STATS                  LWIP_STATS_ENABLED
 #define LINK_STATS                  0
 // #define ETH_PAD_SIZE                2
 #define LWIP_CHKSUM_ALGORITHM       3
@@ -44,12 +49,17 @@
 #define LWIP_TCP_KEEPALIVE          1
 #define LWIP_NETIF_TX_SINGLE_PBUF   1
 #define DHCP_DOES_ARP_CHECK         0
+// The DHCP server unicasts replies to clients without an address yet
+// through a temporary static ARP entry.
+#define ETHARP_SUPPORT_STATIC_ENTRIES 1
 #define LWIP_DHCP_DOES_ACD_CHECK    0
 
 #ifndef NDEBUG
 #define LWIP_DEBUG                  1
 #define LWIP_STATS                  1
 #define LWIP_STATS_DISPLAY          1
+#elif LWIP_STATS_ENABLED
+#define LWIP_STATS                  1
 #endif
 
 #define LWIP_HTTPD 0           // 1
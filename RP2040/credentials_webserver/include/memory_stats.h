@@ -0,0 +1,68 @@
+/*!
+ * @file
+ * memory statistics header and associated constants.
+ */
+
+/*
+ * Copyright (c) 2023, FAV Software Limited. All rights reserved.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/*
+ * File:   memory_stats.h
+ * Author: busdev
+ *
+ * Created on 19 October 2026
+ * Updated on 19 October 2026
+ */
+
+#ifndef __MEMORY_STATS_H__
+#define __MEMORY_STATS_H__
+
+// Memory statistics.
+//
+// Reports how close the firmware runs to its memory limits:
+//
+//   heap     C heap in use and its high-water mark (the heap top), from
+//            mallinfo(). lwIP allocates from it (MEM_LIBC_MALLOC).
+//   lwip     lwIP's share of the heap and every memp pool (PBUF_POOL,
+//            TCP_SEG, ...): in use, high-water mark, size and failed
+//            allocations. Needs the firmware built with CWS_LWIP_STATS.
+//   stack    Per core stack high-water mark, found by painting the unused
+//            stack at boot and looking for the deepest overwritten word.
+//
+// memory_stats_render() writes a text table a line at a time (GET /memory,
+// or 'M' on the UART); memory_stats_update_metrics() copies the headline
+// numbers to the cws_heap_* and cws_stack_* metrics.
+
+#define MEMORY_STATS_PAINT        0xa5a5a5a5  // Unused stack fill pattern.
+#define MEMORY_STATS_PAINT_MARGIN 64          // Bytes left unpainted below the caller's frame.
+#define MEMORY_STATS_RENDER_DONE  0xffffffff  // memory_stats_render() cursor once everything is rendered.
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+void memory_stats_init(void);
+void memory_stats_update_metrics(void);
+int memory_stats_render(char *buf, int size, uint32_t *cursor);
+
+#ifdef __cplusplus
+ }
+#endif
+
+#endif
@@ -0,0 +1,84 @@
+/*!
+ * @file
+ * metrics functions header and associated constants.
+ */
+
+/*
+ * Copyright (c) 2023, FAV Software Limited. All rights reserved.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * File:   metrics.h
+ * Author: busdev
+ *
+ * Created on 19 October 2026
+ * Updated on 19 October 2026
+ */
+
+#ifndef __METRICS_H__
+#define __METRICS_H__
+
+// Metrics registry.
+//
+// Counters, gauges and fixed bucket histograms, held in static tables.
+// A metric is registered once, at initialisation, and updated through the
+// id returned. Registering the same name and labels again returns the
+// same id. Labelled families (e.g. requests per route) register every
+// label set at initialisation, and the tables are sized for all of them;
+// a registration that does not fit is counted in
+// cws_metrics_dropped_registrations_total, the first counter.
+//
+// Updates are lock-free: every metric has a single writer (the main loop,
+// which runs the lwIP callbacks) and its values are atomics, so the export
+// can read them at any time without stopping the writer.
+//
+// metrics_render() writes the Prometheus text exposition format, a few
+// lines at a time, so /metrics can be streamed from a small buffer
+// however many series a family has.
+
+#define METRICS_OTHER_COUNTERS    15    // Counters other than the HTTP routes (ROUTE_COUNT), with the dropped registrations.
+#define METRICS_MAX_COUNTERS      48
+#define METRICS_MAX_GAUGES        12
+#define METRICS_MAX_HISTOGRAMS    6
+#define METRICS_MAX_BUCKETS       8     // Bucket bounds per histogram, +Inf is implied.
+#define METRICS_LABELS_SIZE       80    // Label text, e.g. method="POST",route="setup/home".
+
+#define METRICS_NONE -1                 // Id returned when a table is full. Updates to it are ignored.
+#define METRICS_RENDER_DONE 0xffffffff  // metrics_render() cursor once everything is rendered.
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+int metrics_counter(const char *name, const char *labels, const char *help);
+int metrics_gauge(const char *name, const char *labels, const char *help);
+int metrics_histogram(const char *name, const char *help, const uint32_t *bounds, int bound_count);
+
+void metrics_add(int counter, uint32_t count);
+void metrics_inc(int counter);
+void metrics_set(int gauge, int32_t value);
+void metrics_observe(int histogram, uint32_t value);
+
+uint32_t metrics_get(int counter);
+
+int metrics_render(char *buf, int size, uint32_t *cursor);
+
+#ifdef __cplusplus
+ }
+#endif
+
+#endif
@@ -0,0 +1,123 @@
+/*!
+ * @file
+ * Rendered page cache header.
+ */
+
+/*
+ * Copyright (c) 2023, FAV Software Limited. All rights reserved.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * File:   page_cache.h
+ * Author: busdev
+ *
+ * Created on 19 October 2026
+ * Updated on 19 October 2026
+ */
+
+#ifndef __PAGE_CACHE_H__
+#define __PAGE_CACHE_H__
+
+// Rendered page cache.
+//
+// Holds complete responses, HTTP header and page, in PAGE_CACHE_SLOTS
+// fixed slots. A slot is keyed by route and generation: the web server
+// bumps its generation whenever the credentials it shows change, so a
+// page rendered from old values is never found again and its slot is
+// reused, least recently used first.
+//
+// Hits are written to the connection without TCP_WRITE_FLAG_COPY, so
+// lwIP sends from the slot itself. A slot must then not change until
+// the connection's data has been acknowledged: pin() records the
+// connection, unpin() releases it, and a pinned slot is never reused.
+// Pins left behind by connections that went away without a callback
+// expire after PAGE_CACHE_PIN_TIMEOUT_US, longer than lwIP takes to give
+// up retransmitting. A connection that lwIP frees on an error (reset,
+// timeout) is released by unpin_freed(), from its tcp_err() callback,
+// by the callback argument: the pcb is gone by then.
+//
+// The lookups and pins are on the request path and are RAM_FUNC();
+// store() follows a page render, which runs from flash anyway, and is not.
+
+#define PAGE_CACHE_SLOTS          4
+#define PAGE_CACHE_SLOT_SIZE      1536          // Header and page, bytes.
+#define PAGE_CACHE_PINS           8             // Connections sending from slots.
+#define PAGE_CACHE_PIN_TIMEOUT_US (300 * 1000 * 1000)
+
+#define PAGE_CACHE_NONE -1                      // No slot.
+
+#include <stdint.h>
+
+#include "lwip/tcp.h"
+
+/*!
+* \brief Fixed budget cache of rendered responses.
+*
+* Counts cws_page_cache_hits_total, cws_page_cache_misses_total and
+* cws_page_cache_bytes_saved_total (response bytes not rendered again),
+* and keeps cws_page_cache_hit_ratio_percent.
+*/
+
+class Page_Cache
+{
+ public:
+  Page_Cache();
+  ~Page_Cache();
+
+  int find(int route, uint32_t generation);
+  int store(int route, uint32_t generation, uint32_t etag, const char *header, int header_len, const char *page, int page_len, uint32_t now_us);
+
+  const char *get_data(int slot);
+  int get_length(int slot);
+  uint32_t get_etag(int slot);
+
+  bool pin(int slot, const struct tcp_pcb *pcb, uint32_t now_us);
+  void unpin(const struct tcp_pcb *pcb);
+  void unpin_freed(const void *arg);
+
+ private:
+  void expire_pins(uint32_t now_us);
+  void update_hit_ratio(void);
+
+  struct page_cache_slot
+  {
+   int route;                 // PAGE_CACHE_NONE if empty.
+   uint32_t generation;
+   uint32_t etag;             // Of the page, see http_etag().
+   uint32_t last_use;         // use_count at the last find() or store().
+   int pins;
+   int length;
+   char data[PAGE_CACHE_SLOT_SIZE];
+  };
+
+  struct page_cache_pin
+  {
+   const struct tcp_pcb *pcb; // NULL if unused.
+   const void *arg;           // The pcb's callback argument, its connection id.
+   int slot;
+   uint32_t start_us;
+  };
+
+  struct page_cache_slot slots[PAGE_CACHE_SLOTS];
+  struct page_cache_pin pins[PAGE_CACHE_PINS];
+  uint32_t use_count;
+
+  int hits_metric;
+  int misses_metric;
+  int bytes_saved_metric;
+  int hit_ratio_metric;
+};
+
+#endif
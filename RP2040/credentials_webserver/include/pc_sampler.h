@@ -0,0 +1,86 @@
+/*!
+ * @file
+ * PC sampling profiler header.
+ */
+
+/*
+ * Copyright (c) 2023, FAV Software Limited. All rights reserved.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/*
+ * File:   pc_sampler.h
+ * Author: busdev
+ *
+ * Created on 19 October 2026
+ * Updated on 19 October 2026
+ */
+
+#ifndef __PC_SAMPLER_H__
+#define __PC_SAMPLER_H__
+
+// PC sampling profiler.
+//
+// A hardware timer alarm interrupts the CPU at a fixed rate for a set
+// window and records the interrupted PC, and with PC_SAMPLER_RECORD_LR
+// the interrupted LR (usually the caller), into a fixed hash table of
+// (pc, lr, count). Samples that find the table full are counted as
+// dropped. With PC_SAMPLER_ENABLED 0 (the default, see CWS_PC_SAMPLER in
+// CMakeLists.txt) nothing is compiled.
+//
+// GET /profile/start?ms=5000&hz=997 starts a window, GET /profile returns
+// the table as text:
+//
+//   # pc_sampler state running|done rate_hz N window_ms N samples N dropped N
+//   <pc hex> <lr hex> <count>
+//   ...
+//
+// tools/pc_profile.py symbolizes it against credentials_webserver.elf.
+// Pick a rate that is not a multiple of the main loop's 1 kHz, or the
+// samples alias with it.
+
+#ifndef PC_SAMPLER_ENABLED
+#define PC_SAMPLER_ENABLED 0
+#endif
+
+#ifndef PC_SAMPLER_SLOTS
+#define PC_SAMPLER_SLOTS 512           // Distinct (pc, lr) pairs, must be a power of 2.
+#endif
+
+#ifndef PC_SAMPLER_RECORD_LR
+#define PC_SAMPLER_RECORD_LR 1         // 0 keys the table on pc alone, more samples per slot.
+#endif
+
+#define PC_SAMPLER_DEFAULT_HZ         997
+#define PC_SAMPLER_MAX_HZ             10000
+#define PC_SAMPLER_DEFAULT_WINDOW_MS  5000
+#define PC_SAMPLER_MAX_WINDOW_MS      600000
+#define PC_SAMPLER_RENDER_DONE        0xffffffff  // pc_sampler_render() cursor once everything is rendered.
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+int pc_sampler_start(uint32_t window_ms, uint32_t rate_hz);
+void pc_sampler_stop(void);
+int pc_sampler_render(char *buf, int size, uint32_t *cursor);
+
+#ifdef __cplusplus
+ }
+#endif
+
+#endif
@@ -0,0 +1,104 @@
+/*!
+ * @file
+ * provisioning class header and associated constants.
+ */
+
+/*
+ * Copyright (c) 2023, FAV Software Limited. All rights reserved.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * File:   provisioning.h
+ * Author: busdev
+ *
+ * Created on 19 October 2026
+ * Updated on 19 October 2026
+ */
+
+#ifndef __PROVISIONING_H__
+#define __PROVISIONING_H__
+
+// Factory provisioning session, see provisioning_frame.h for the frames.
+//
+// main() opens a window of PROVISIONING_WINDOW_MS after boot, before the
+// WiFi is brought up, and feeds the bytes from stdio to receive(). Each
+// request is a batch of commands, run in order. The whole batch is
+// checked first, lengths and settings, and nothing is run if any of it
+// is wrong, so a batch is applied completely or not at all. The settings
+// are staged here, not in the Storage_Handler, and only a commit applies
+// them and writes them in one flash erase and program, then reads the
+// sector back. If that fails the Storage_Handler is put back as it was,
+// so main() and the web server never see settings that are not in flash.
+//
+// A repeated request (same sequence number and CRC, its reply was lost)
+// is answered from the last reply, without running it again.
+
+#define PROVISIONING_WINDOW_MS 300    // Time after boot for a host to open a session.
+#define PROVISIONING_IDLE_MS   5000   // A session ends after this long without a request.
+#define PROVISIONING_POLL_US   1000   // Longest wait for a byte.
+
+#include <cstdint>
+
+#include "provisioning_frame.h"
+#include "storage_handler.h"
+
+class Provisioning
+{
+ public:
+  Provisioning(Storage_Handler *sh);
+
+  bool receive(uint8_t c);
+  const uint8_t *get_reply(void);
+  int get_reply_length(void);
+
+  bool get_is_session_open(void);
+  bool get_is_done(void);
+  uint32_t get_frame_count(void);
+  uint32_t get_error_count(void);
+
+ private:
+  uint8_t check_command(const struct prov_record *command);
+  uint8_t run_command(const struct prov_record *command, int *len);
+  uint8_t commit(void);
+  int add_setting(int len, uint8_t op, const char *value);
+  void process_request(void);
+
+  struct settings
+  {
+   char ssid[WIFI_SSID_LENGTH];
+   char password[WIFI_PASSWORD_LENGTH];
+   char url[IMAGE_SERVER_URL_LENGTH];
+  };
+
+  void stage(char *field, int field_size, const uint8_t *value, int len);
+  void read_settings(struct settings *settings);
+  void apply_settings(const struct settings *settings);
+
+  Storage_Handler *sh;
+
+  struct settings staged;           // Settings as the session has set them.
+  struct settings previous;         // Settings before a commit, to put back if it fails.
+
+  struct prov_decoder decoder;
+  uint8_t reply[PROV_MAX_FRAME];
+  int reply_len;
+
+  uint8_t last_sequence;
+  uint16_t last_crc;
+  bool is_session_open;
+  bool is_done;
+};
+
+#endif
@@ -0,0 +1,128 @@
+/*!
+ * @file
+ * Factory provisioning protocol frames header.
+ */
+
+/*
+ * Copyright (c) 2023, FAV Software Limited. All rights reserved.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * File:   provisioning_frame.h
+ * Author: busdev
+ *
+ * Created on 19 October 2026
+ * Updated on 19 October 2026
+ */
+
+#ifndef __PROVISIONING_FRAME_H__
+#define __PROVISIONING_FRAME_H__
+
+// Binary factory provisioning over the stdio UART or USB CDC.
+//
+// Frame, both directions:
+//
+//   sync 0xc5 0x3a | length (2, LE) | payload (length) | CRC (2, LE)
+//
+// The CRC is CRC-16/CCITT-FALSE over the length and the payload. Bytes
+// outside a frame (log text, line noise) are skipped while looking for
+// the sync bytes, and a frame with a bad CRC is dropped; the host then
+// sends it again. The sync bytes differ from the binary log records'
+// (LOG_SYNC_BYTE_1/2), which may share the line.
+//
+// Payload: sequence number (1), then records, one per command in a
+// request and one per result in the reply:
+//
+//   op (1) | status (1) | length (2, LE) | value (length)
+//
+// status is 0 in a request. The reply echoes the sequence number.
+//
+// Like json.h, no device state, so the host tool builds its frames with
+// the same code.
+
+#define PROV_SYNC_BYTE_1    0xc5
+#define PROV_SYNC_BYTE_2    0x3a
+#define PROV_MAX_PAYLOAD    2560     // A full batch: every setting, a commit and the read back.
+#define PROV_FRAME_OVERHEAD 6        // Sync 2, length 2, CRC 2.
+#define PROV_MAX_FRAME      (PROV_MAX_PAYLOAD + PROV_FRAME_OVERHEAD)
+#define PROV_RECORD_HEADER  4
+#define PROV_VERSION        1
+
+// Operations.
+
+#define PROV_OP_INFO         0x01    // Value: version (1), EPD_STORE_... status (1), PROV_MAX_PAYLOAD (2).
+#define PROV_OP_SET_SSID     0x10    // Value: the setting, not terminated. Staged until a commit.
+#define PROV_OP_SET_PASSWORD 0x11
+#define PROV_OP_SET_URL      0x12
+#define PROV_OP_GET_SSID     0x20    // Reply value: the setting, as staged.
+#define PROV_OP_GET_PASSWORD 0x21
+#define PROV_OP_GET_URL      0x22
+#define PROV_OP_COMMIT       0x30    // One flash write of the staged settings, verified by reading back.
+#define PROV_OP_EXIT         0x3f    // Ends the session, the device carries on booting.
+
+// Result status.
+
+#define PROV_OK              0
+#define PROV_ERROR_FORMAT    1       // Malformed payload, or a value of the wrong length.
+#define PROV_ERROR_OP        2       // Unknown operation.
+#define PROV_ERROR_VALUE     3       // Setting not valid, as for the web forms.
+#define PROV_ERROR_STORAGE   4       // Flash erase or program failed.
+#define PROV_ERROR_VERIFY    5       // Flash did not read back as written.
+#define PROV_ERROR_SIZE      6       // Reply full.
+#define PROV_SKIPPED         7       // Not run, an earlier command of the batch failed.
+
+// prov_decode() results.
+
+#define PROV_DECODE_MORE     0
+#define PROV_DECODE_FRAME    1
+#define PROV_DECODE_ERROR   -1       // CRC or length error, the frame was dropped.
+
+// prov_next_record() results.
+
+#define PROV_RECORD          1
+#define PROV_END             0
+#define PROV_ERROR          -1
+
+#include <cstdint>
+
+struct prov_decoder
+{
+ uint8_t state;
+ uint16_t length;
+ uint16_t count;
+ uint16_t crc;
+ uint32_t frames;
+ uint32_t errors;
+ uint8_t payload[PROV_MAX_PAYLOAD];
+};
+
+struct prov_record
+{
+ uint8_t op;
+ uint8_t status;
+ const uint8_t *value;
+ int value_len;
+};
+
+uint16_t prov_crc16(uint16_t crc, const uint8_t *data, int len);
+
+void prov_decoder_init(struct prov_decoder *decoder);
+int prov_decode(struct prov_decoder *decoder, uint8_t c);
+int prov_encode(uint8_t *frame, int size, const uint8_t *payload, int len);
+
+int prov_next_record(const uint8_t *payload, int len, int *cursor, struct prov_record *record);
+int prov_add_record(uint8_t *payload, int size, int len, uint8_t op, uint8_t status, const void *value, int value_len);
+
+#endif
@@ -0,0 +1,61 @@
+/*!
+ * @file
+ * SRAM code placement macros.
+ */
+
+/*
+ * Copyright (c) 2023, FAV Software Limited. All rights reserved.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/*
+ * File:   ram_code.h
+ * Author: busdev
+ *
+ * Created on 19 October 2026
+ * Updated on 19 October 2026
+ */
+
+#ifndef __RAM_CODE_H__
+#define __RAM_CODE_H__
+
+// Code placement.
+//
+// Code runs from flash through the 16 KB XIP cache and stalls on every
+// miss. RAM_FUNC() marks the hot paths, the request receive, parse and
+// dispatch path, the DHCP handler and the flash commit, to be copied to
+// SRAM at boot (the SDK's __not_in_flash_func() section), e.g.
+//
+//   err_t RAM_FUNC(Credentials_Webserver::send_data)(struct tcp_pcb *pcb, ...)
+//
+// With RAM_CODE_ENABLED 0 (CWS_RAM_CODE=OFF in CMakeLists.txt, and the
+// host build) everything stays in flash, for comparison. The XIP cache
+// counters (xip_stats.h) show the difference.
+//
+// Functions called from a RAM_FUNC() still run from wherever they are,
+// e.g. the C library and lwIP run from flash.
+
+#ifndef RAM_CODE_ENABLED
+#define RAM_CODE_ENABLED 0
+#endif
+
+#if RAM_CODE_ENABLED
+#include "pico.h"
+#define RAM_FUNC(name) __not_in_flash_func(name)
+#else
+#define RAM_FUNC(name) name
+#endif
+
+#endif
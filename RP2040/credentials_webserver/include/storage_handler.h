@@ -24,7 +24,7 @@
  * Author: busdev
  *
  * Created on 28 January 2023
- * Updated on 14 February 2023
+ * Updated on 19 October 2026
  */
 
 #ifndef __STORAGE_HANDLER_H__
@@ -45,12 +45,7 @@
 
 // Flash memory.
 
-// PICO_FLASH_SIZE_BYTES # 2MB.  The total size of the RP2040 flash, in bytes
-// FLASH_SECTOR_SIZE     # 4096. The size of one sector, in bytes (the minimum amount you can erase)
-// FLASH_PAGE_SIZE       # 256.  The size of one page, in bytes (the mimimum amount you can write)
-
-#define STORAGE_OFFSET PICO_FLASH_SIZE_BYTES - (1 * FLASH_SECTOR_SIZE)
-#define STORAGE_ADDR_START (XIP_BASE + STORAGE_OFFSET)
+#define STORAGE_OFFSET (PICO_FLASH_SIZE_BYTES - (1 * FLASH_SECTOR_SIZE))
 
 #define WIFI_SSID_LENGTH     33
 #define WIFI_PASSWORD_LENGTH 64
@@ -61,15 +56,11 @@
 #define STORAGE_SIZE 2304            // Divisible by page size (256).
 
 
-#include "pico/stdlib.h"
-#include "hardware/flash.h"
-#include "hardware/sync.h"
+#include "flash_backend.h"
+#include "metrics.h"
 
-#include <string>
 #include <cstring>
 
-using std::string;
-
 // Storage variables.
 
 struct store 
@@ -89,30 +80,35 @@ struct store
 class Storage_Handler 
 {
  public:
-  Storage_Handler();
+  Storage_Handler(Flash_Backend *flash);
   ~Storage_Handler();
 
   void initialise_storage(void);
 
-  void set_wifi_ssid(string wifi_ssid);
-  void set_wifi_password(string wifi_pswd);
-  void set_image_server_url(string server_url);
+  void set_wifi_ssid(const char *wifi_ssid);
+  void set_wifi_password(const char *wifi_pswd);
+  void set_image_server_url(const char *server_url);
+  void set_wifi_ssid(const char *wifi_ssid, int len);
+  void set_wifi_password(const char *wifi_pswd, int len);
+  void set_image_server_url(const char *server_url, int len);
   void set_epd_status(uint8_t status);
 
-  string get_wifi_ssid(void);
-  string get_wifi_password(void);
-  string get_image_server_url(void);
+  const char *get_wifi_ssid(void);
+  const char *get_wifi_password(void);
+  const char *get_image_server_url(void);
   uint8_t get_epd_status(void);
 
-  void write_data_to_store(void);
+  int write_data_to_store(void);
+  int verify_data_in_store(void);
 
  private:
-  string ssid;
-  string pass;
-  string server;
+  void set_store_string(uint8_t *field, int field_size, const char *value, int len);
+
+  Flash_Backend *flash;
+  int commit_metric;
+
   uint8_t epd_status;
 
-  struct store* store;
   struct store new_store;
 
 };
@@ -0,0 +1,57 @@
+/*!
+ * @file
+ * tiny_format functions header.
+ */
+
+/*
+ * Copyright (c) 2023, FAV Software Limited. All rights reserved.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * File:   tiny_format.h
+ * Author: busdev
+ *
+ * Created on 19 October 2026
+ * Updated on 19 October 2026
+ */
+
+#ifndef __TINY_FORMAT_H__
+#define __TINY_FORMAT_H__
+
+// Minimal snprintf replacement.
+//
+// Conversions: %s %c %d %i %u %x %X %p %%, with an optional '-' or '0'
+// flag, a field width and the 'l' length modifier (ignored, long and
+// int are the same size on the RP2040).
+// No floating point, no precision, no positional arguments.
+//
+// Like snprintf, the output is always terminated (if size > 0) and the
+// return value is the length the output would have had without
+// truncation.
+
+#include <stdarg.h>
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+int tiny_format(char *buf, int size, const char *fmt, ...);
+int tiny_vformat(char *buf, int size, const char *fmt, va_list args);
+
+#ifdef __cplusplus
+ }
+#endif
+
+#endif
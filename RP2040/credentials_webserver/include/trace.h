@@ -0,0 +1,115 @@
+/*!
+ * @file
+ * trace functions header and associated constants.
+ */
+
+/*
+ * Copyright (c) 2023, FAV Software Limited. All rights reserved.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * File:   trace.h
+ * Author: busdev
+ *
+ * Created on 19 October 2026
+ * Updated on 19 October 2026
+ */
+
+#ifndef __TRACE_H__
+#define __TRACE_H__
+
+// Request tracing.
+//
+// TRACE() records (event, connection id, time since the previous record)
+// into a RAM ring, overwriting the oldest records when full. With
+// TRACE_ENABLED 0 (the default, see CWS_TRACE in CMakeLists.txt) the
+// macros generate no code and the ring is not linked in.
+//
+// Events come in _BEGIN/_END pairs around a stage, or are single points.
+// tools/trace_to_chrome.py reads the event names from this file, keep
+// the "// B|E|I stage" comments.
+
+#ifndef TRACE_ENABLED
+#define TRACE_ENABLED 0
+#endif
+
+// Events.
+
+#define TRACE_RECV_BEGIN      1   // B http_recv_callback
+#define TRACE_RECV_END        2   // E http_recv_callback
+#define TRACE_RESPONSE_BEGIN  3   // B generate_response
+#define TRACE_RESPONSE_END    4   // E generate_response
+#define TRACE_PATH_BEGIN      5   // B extract_path
+#define TRACE_PATH_END        6   // E extract_path
+#define TRACE_SEND_PAGE_BEGIN 7   // B send_page
+#define TRACE_SEND_PAGE_END   8   // E send_page
+#define TRACE_WRITE_BEGIN     9   // B tcp_write
+#define TRACE_WRITE_END       10  // E tcp_write
+#define TRACE_SENT            11  // I http_sent_callback
+#define TRACE_ACCEPT          12  // I http_accept_callback
+#define TRACE_ERR             13  // I http_err_callback
+
+#define TRACE_RING_SIZE 512       // Records, must be a power of 2.
+
+// Dump format, little endian: a trace_header, then header.record_count
+// records, oldest first.
+
+#define TRACE_MAGIC       "CWTR"
+#define TRACE_DUMP_DONE   0xffffffff  // trace_dump() cursor once the dump is complete.
+#define TRACE_HTTP_HEADER "HTTP/1.1 200 OK\r\nContent-Type: application/octet-stream\r\nCache-Control: no-store\r\nConnection: close\r\n\r\n"
+
+#include <stdint.h>
+
+struct trace_header
+{
+ char magic[4];
+ uint16_t record_size;
+ uint16_t record_count;
+ uint64_t last_time_us;   // time_us_64() of the newest record.
+};
+
+struct trace_record
+{
+ uint32_t delta_us;       // Time since the previous record, saturated.
+ uint16_t event;
+ uint16_t conn;
+};
+
+// The connection id is the accept sequence number, kept as the pcb's
+// callback argument (see http_accept_callback()). Reading it after
+// stop_webserver() is safe: lwIP does not free a pcb closed from within
+// one of its callbacks until the callback has returned.
+
+#define TRACE_CONN(pcb) ((pcb) ? (uint16_t)(uintptr_t)(pcb)->callback_arg : 0)
+
+#if TRACE_ENABLED
+#define TRACE(event, pcb) trace_add((event), TRACE_CONN(pcb))
+#else
+#define TRACE(event, pcb) do { } while (0)
+#endif
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+void trace_add(uint16_t event, uint16_t conn);
+int trace_dump(char *buf, int size, uint32_t *cursor);
+void trace_dump_abort(void);
+
+#ifdef __cplusplus
+ }
+#endif
+
+#endif
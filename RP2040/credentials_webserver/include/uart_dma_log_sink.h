@@ -0,0 +1,56 @@
+/*!
+ * @file
+ * uart_dma_log_sink class header and associated constants.
+ */
+
+/*
+ * Copyright (c) 2023, FAV Software Limited. All rights reserved.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * File:   uart_dma_log_sink.h
+ * Author: busdev
+ *
+ * Created on 19 October 2026
+ * Updated on 19 October 2026
+ */
+
+#ifndef __UART_DMA_LOG_SINK_H__
+#define __UART_DMA_LOG_SINK_H__
+
+#define LOG_SINK_BAUD_RATE 115200
+
+#include "hardware/uart.h"
+#include "hardware/dma.h"
+#include "log_sink.h"
+
+class Uart_Dma_Log_Sink : public Log_Sink
+{
+ public:
+  Uart_Dma_Log_Sink(uart_inst_t *uart, uint tx_pin, uint rx_pin, uint baud_rate);
+  ~Uart_Dma_Log_Sink();
+
+  void poll(void);
+  int read(char *data, int len);
+
+  void install_stdio_driver(void);
+
+ private:
+  uart_inst_t *uart;
+  int dma_channel;
+  int transfer_count;   // Bytes in the DMA transfer in progress.
+};
+
+#endif
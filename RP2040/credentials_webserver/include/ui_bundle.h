@@ -0,0 +1,118 @@
+/*
+ * File:   ui_bundle.h
+ * Author: busdev
+ *
+ * Generated by tools/make_ui_bundle.py from ui/app.html, do not edit.
+ */
+
+#ifndef __UI_BUNDLE_H__
+#define __UI_BUNDLE_H__
+
+#include <stdint.h>
+
+#define UI_BUNDLE_SOURCE_LENGTH 3814    // Bytes before compressing.
+
+static const uint8_t ui_bundle[1574] =
+{
+ 0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0xb5, 0x57, 0xdd, 0x73, 0xda, 0x38,
+ 0x10, 0x7f, 0xe7, 0xaf, 0xd8, 0xfa, 0x3a, 0xb5, 0x99, 0x3a, 0x10, 0x42, 0xd2, 0xe9, 0x61, 0xe0,
+ 0xa6, 0x97, 0x64, 0x6e, 0xb8, 0x36, 0x1f, 0x53, 0x9a, 0x87, 0x4e, 0xa7, 0x0f, 0xc2, 0x96, 0x8d,
+ 0xae, 0x46, 0xf2, 0xc9, 0x32, 0x09, 0x43, 0xf3, 0xbf, 0xdf, 0xae, 0x84, 0x89, 0xc9, 0xd7, 0xa4,
+ 0x0f, 0xf7, 0x00, 0x46, 0xd2, 0x7e, 0xfd, 0xf6, 0xb7, 0xbb, 0x32, 0xc3, 0x57, 0x27, 0x17, 0xc7,
+ 0x5f, 0xbe, 0x5e, 0x9e, 0xc2, 0xdc, 0x2c, 0xf2, 0x71, 0x6b, 0x68, 0x1f, 0xc3, 0x39, 0x67, 0xc9,
+ 0x78, 0xb8, 0xe0, 0x86, 0x81, 0x64, 0x0b, 0x3e, 0xf2, 0x96, 0x82, 0x5f, 0x17, 0x4a, 0x1b, 0x0f,
+ 0x62, 0x25, 0x0d, 0x97, 0x66, 0xe4, 0x5d, 0x8b, 0xc4, 0xcc, 0x47, 0x09, 0x5f, 0x8a, 0x98, 0xef,
+ 0xd9, 0x85, 0x37, 0x1e, 0x1a, 0x61, 0x72, 0x3e, 0x3e, 0xbd, 0x3c, 0x81, 0x29, 0x37, 0x55, 0x31,
+ 0xec, 0xba, 0x8d, 0x61, 0x69, 0x56, 0xf8, 0x68, 0x75, 0x66, 0xea, 0x66, 0xbd, 0x60, 0x3a, 0x13,
+ 0x72, 0xc0, 0x2a, 0xa3, 0xa2, 0x05, 0xbb, 0x71, 0xba, 0x83, 0xfe, 0xc1, 0x7e, 0x71, 0x13, 0xcd,
+ 0x94, 0x4e, 0xb8, 0x1e, 0x1c, 0x14, 0x37, 0x50, 0xaa, 0x5c, 0x24, 0x30, 0xcb, 0x2b, 0xbe, 0xd9,
+ 0xdd, 0xd3, 0x2c, 0x11, 0x55, 0x39, 0x38, 0x44, 0x39, 0xc3, 0x6f, 0xcc, 0x1e, 0xcb, 0x45, 0x26,
+ 0x07, 0x31, 0x46, 0xc3, 0x75, 0x34, 0x63, 0xf1, 0x8f, 0x4c, 0xab, 0x4a, 0x26, 0x7b, 0xb1, 0xca,
+ 0x95, 0x1e, 0xe8, 0x6c, 0x16, 0xf4, 0xf6, 0xf7, 0xc3, 0xde, 0x91, 0xfd, 0xb4, 0x6f, 0xd1, 0xbb,
+ 0x91, 0xb5, 0xf7, 0x1e, 0x79, 0x2b, 0x58, 0x92, 0x08, 0x99, 0x0d, 0x8e, 0xd0, 0x5d, 0xaf, 0xe1,
+ 0xbe, 0xb7, 0x75, 0x9f, 0x69, 0xb6, 0x7a, 0xc4, 0xfd, 0xe3, 0xce, 0x7e, 0x47, 0x47, 0xee, 0xd3,
+ 0x8e, 0x52, 0x4c, 0xd3, 0xa0, 0xd7, 0x27, 0x43, 0x4c, 0x96, 0x7b, 0x25, 0xd7, 0x22, 0xc5, 0x08,
+ 0x12, 0x26, 0x33, 0xae, 0xd7, 0x1b, 0x8b, 0x4e, 0x77, 0xa6, 0xd5, 0xb5, 0x7c, 0xdc, 0xe4, 0xc1,
+ 0xd1, 0x51, 0xb8, 0x1f, 0xda, 0xd8, 0x17, 0x4a, 0xaa, 0x35, 0x59, 0xdd, 0x4b, 0xd9, 0x42, 0xe4,
+ 0xab, 0x41, 0xac, 0x2a, 0x2d, 0xb8, 0xbe, 0x6d, 0x0d, 0xbb, 0x2e, 0xbb, 0xc3, 0xae, 0xa3, 0x6d,
+ 0xa6, 0x92, 0xd5, 0x78, 0x98, 0x88, 0x25, 0xc4, 0x39, 0x2b, 0xcb, 0x91, 0x87, 0x49, 0x47, 0x6a,
+ 0xe6, 0xfd, 0xf1, 0xc9, 0x64, 0x7a, 0xf9, 0xe9, 0xc3, 0x57, 0x98, 0x9e, 0x7e, 0xb9, 0xba, 0x44,
+ 0xf1, 0x3e, 0x12, 0x4e, 0x72, 0x22, 0x19, 0x79, 0x0b, 0x2e, 0x2b, 0x92, 0x3a, 0x1c, 0x9f, 0x31,
+ 0x21, 0xe1, 0x0c, 0x97, 0x28, 0x71, 0x88, 0x12, 0xb3, 0xca, 0x18, 0x25, 0xb7, 0xc6, 0x8c, 0xf4,
+ 0x40, 0xc9, 0x38, 0x17, 0xf1, 0x8f, 0x91, 0x57, 0xce, 0xd5, 0x75, 0xe0, 0x5f, 0x8b, 0x54, 0xf8,
+ 0x6d, 0x6f, 0x3c, 0x59, 0xb0, 0x8c, 0x23, 0xf3, 0x7a, 0xc9, 0xf5, 0xb0, 0xeb, 0xf4, 0x5e, 0x64,
+ 0x40, 0x24, 0xa4, 0x7e, 0x62, 0x6b, 0x09, 0x26, 0x27, 0xcf, 0xeb, 0x52, 0xb4, 0x99, 0x7a, 0x60,
+ 0x23, 0x11, 0x65, 0x61, 0xad, 0xe0, 0x33, 0x67, 0xab, 0xad, 0x8d, 0xe1, 0x4c, 0x3f, 0x66, 0x07,
+ 0x1c, 0x15, 0x0f, 0xcc, 0x68, 0x5e, 0x72, 0x43, 0x76, 0xce, 0x58, 0x89, 0x75, 0x05, 0x9f, 0x69,
+ 0x7d, 0x67, 0xac, 0x8b, 0xf9, 0x42, 0x73, 0xa9, 0xd2, 0x0b, 0x1b, 0x08, 0x41, 0x77, 0x69, 0x6b,
+ 0x82, 0x87, 0x63, 0xcd, 0x13, 0xac, 0x4b, 0xc1, 0xf2, 0x72, 0x93, 0x45, 0x21, 0x8b, 0xca, 0x6c,
+ 0xba, 0xa9, 0x2c, 0x45, 0xe2, 0x01, 0x46, 0x19, 0xf3, 0xb9, 0xca, 0xb1, 0x12, 0x46, 0xde, 0x39,
+ 0x37, 0xd7, 0x4a, 0xff, 0x80, 0x73, 0x14, 0xf0, 0x00, 0xdb, 0x22, 0xe7, 0x32, 0xc3, 0xfe, 0xf2,
+ 0xfa, 0x07, 0x9e, 0x85, 0xe0, 0x60, 0x34, 0xad, 0x14, 0x08, 0x05, 0x75, 0xd0, 0x92, 0x59, 0x15,
+ 0x3b, 0xeb, 0x1d, 0xcb, 0x97, 0xdb, 0xed, 0x86, 0xd5, 0x77, 0xfd, 0xa7, 0xac, 0x56, 0x3a, 0xbf,
+ 0x67, 0x60, 0x07, 0xd8, 0xd5, 0xe7, 0x4f, 0x3b, 0x86, 0x0e, 0xf6, 0x0f, 0xdf, 0x7b, 0x4f, 0xe5,
+ 0xd8, 0x1b, 0x4f, 0xd9, 0x92, 0x3f, 0xcf, 0xa6, 0x8b, 0xdd, 0x1d, 0x34, 0xc8, 0x48, 0x45, 0x9e,
+ 0x07, 0xeb, 0x5b, 0xe4, 0x61, 0x97, 0x80, 0x5f, 0xb6, 0x11, 0xa7, 0x59, 0x3b, 0x72, 0xd4, 0x52,
+ 0x89, 0x13, 0xb3, 0xc7, 0x4c, 0xc6, 0x3c, 0x6f, 0x70, 0x4a, 0x6c, 0x36, 0x5a, 0x01, 0xc9, 0xb1,
+ 0x8c, 0x6e, 0x2a, 0xc9, 0x16, 0x24, 0x2e, 0x87, 0xc5, 0xf8, 0xaa, 0xe4, 0x60, 0xe6, 0x1c, 0x92,
+ 0xed, 0x09, 0x18, 0x85, 0x3a, 0x44, 0x75, 0xba, 0xc2, 0x23, 0x51, 0x52, 0x2a, 0xea, 0x63, 0xec,
+ 0x23, 0x92, 0x16, 0x36, 0x81, 0xa5, 0x4b, 0x20, 0xce, 0xcf, 0x54, 0x64, 0x95, 0x66, 0x46, 0xe9,
+ 0xce, 0xb0, 0x5b, 0xa0, 0xdf, 0x02, 0xf3, 0x57, 0xe3, 0xa1, 0x36, 0x77, 0x25, 0x9e, 0xb3, 0x19,
+ 0xcf, 0x31, 0x90, 0xee, 0x6c, 0x4c, 0x62, 0x2f, 0xe8, 0xa2, 0x1a, 0xdf, 0xc5, 0xc7, 0x07, 0xf5,
+ 0x5a, 0x43, 0xa3, 0xc8, 0x1c, 0xb8, 0x53, 0x9a, 0x9a, 0x50, 0x43, 0x3c, 0x53, 0x09, 0xaf, 0x41,
+ 0x5e, 0x62, 0x0b, 0x94, 0x70, 0xf1, 0x91, 0xa0, 0xd9, 0xd9, 0xba, 0x85, 0xbb, 0x40, 0xa9, 0x4d,
+ 0xcc, 0xcf, 0x45, 0xc3, 0x62, 0xe3, 0xda, 0x11, 0x75, 0x48, 0xc5, 0x0f, 0xfd, 0xd3, 0x1b, 0x61,
+ 0x70, 0xd2, 0x36, 0xd0, 0x0b, 0x25, 0x3b, 0x9d, 0xce, 0xbd, 0x70, 0x5b, 0xbf, 0x80, 0xf2, 0x01,
+ 0x8b, 0xbb, 0x48, 0x6d, 0x1f, 0x3b, 0xa8, 0xb6, 0x82, 0x60, 0x3b, 0x17, 0x9a, 0x28, 0x8f, 0x29,
+ 0x1e, 0x6c, 0x65, 0x84, 0x6a, 0x15, 0x9a, 0xec, 0x12, 0x93, 0xb8, 0x9f, 0x22, 0x1c, 0xa5, 0x57,
+ 0x90, 0xf0, 0x94, 0x55, 0xb9, 0x29, 0x5f, 0x9a, 0x80, 0x85, 0x9d, 0x1f, 0x6e, 0x9c, 0x84, 0x7e,
+ 0x9d, 0xe8, 0x8d, 0x97, 0x87, 0x66, 0x2d, 0x24, 0x17, 0xcd, 0xff, 0x91, 0x8e, 0x45, 0x99, 0x61,
+ 0x32, 0x0a, 0xfb, 0x9b, 0x2e, 0x4f, 0xef, 0x85, 0x45, 0x85, 0xed, 0xd3, 0xa1, 0x71, 0x35, 0x1a,
+ 0xc9, 0x2a, 0xcf, 0xff, 0xf0, 0xd1, 0x8e, 0x3f, 0x78, 0xae, 0xd2, 0xec, 0x63, 0x58, 0xc6, 0x5a,
+ 0x14, 0x66, 0xdc, 0x5a, 0x32, 0xac, 0xf8, 0x34, 0x83, 0x11, 0xac, 0x6f, 0x43, 0xb0, 0x53, 0x73,
+ 0x04, 0x89, 0x8a, 0x2b, 0xb4, 0x60, 0x3a, 0x19, 0x37, 0xa7, 0x39, 0xa7, 0x9f, 0x7f, 0xae, 0x26,
+ 0x49, 0x7d, 0x8f, 0x44, 0x56, 0x0b, 0x53, 0xa7, 0x74, 0x49, 0x8a, 0xad, 0x7f, 0x4a, 0x25, 0x07,
+ 0xe0, 0x4f, 0xe4, 0x92, 0xd1, 0x9d, 0xac, 0xf9, 0xbf, 0x15, 0x2f, 0x4d, 0xc7, 0x0f, 0x5b, 0x14,
+ 0x59, 0xe3, 0x44, 0x6e, 0x86, 0x28, 0x4d, 0x32, 0x08, 0xa6, 0xd3, 0xc9, 0x49, 0x7b, 0x00, 0x3d,
+ 0xca, 0x76, 0xff, 0x00, 0xe2, 0x39, 0xd3, 0x98, 0x73, 0xae, 0xcb, 0x10, 0xa4, 0x32, 0x50, 0x1a,
+ 0xa6, 0x6d, 0x4d, 0x5e, 0x0b, 0x33, 0x87, 0x57, 0x21, 0xfc, 0x06, 0x4a, 0x43, 0x14, 0xda, 0xb5,
+ 0xc2, 0x79, 0xf8, 0x36, 0x84, 0xef, 0x21, 0x74, 0x69, 0xd7, 0x03, 0x26, 0xd1, 0xbc, 0x02, 0xa3,
+ 0x99, 0xc8, 0x49, 0xa9, 0x2c, 0x70, 0x42, 0x96, 0x14, 0x43, 0x3d, 0x76, 0x1b, 0x71, 0xdc, 0x6d,
+ 0xbd, 0x27, 0xe7, 0xef, 0xfa, 0x50, 0x68, 0x21, 0x0d, 0x9b, 0xe5, 0x1c, 0x3e, 0x4c, 0x8f, 0x27,
+ 0x93, 0x46, 0x30, 0x64, 0x02, 0x67, 0x6e, 0x43, 0x1b, 0x47, 0xec, 0x80, 0x7c, 0x39, 0x17, 0xa1,
+ 0x75, 0x1d, 0x2b, 0xac, 0xa4, 0xd8, 0xe4, 0x2b, 0x9b, 0x43, 0x9e, 0x58, 0xf0, 0x58, 0x3f, 0x38,
+ 0x58, 0x50, 0xf3, 0x4a, 0x5a, 0xd3, 0xe8, 0x8a, 0xf6, 0xdc, 0x88, 0xc2, 0x32, 0x23, 0x74, 0xd6,
+ 0xbe, 0x2d, 0xba, 0x1d, 0xb9, 0x07, 0xc5, 0xfe, 0x58, 0x49, 0x76, 0xfc, 0xd6, 0x6d, 0xd4, 0x4a,
+ 0x2b, 0x19, 0x53, 0xb7, 0xc2, 0xeb, 0x40, 0x24, 0x6d, 0x58, 0xa3, 0xae, 0xa9, 0xb4, 0x7c, 0x92,
+ 0x45, 0x14, 0x8a, 0xe0, 0xf6, 0x4e, 0xcd, 0x96, 0x11, 0xbd, 0x3f, 0xa2, 0x6e, 0x0b, 0xa3, 0x87,
+ 0x80, 0xe8, 0x5d, 0x82, 0x4a, 0xe1, 0x9b, 0x2b, 0xa4, 0x10, 0x1c, 0xf3, 0xf8, 0xc4, 0x17, 0x01,
+ 0xfc, 0xb6, 0x57, 0x39, 0x3e, 0x37, 0xcd, 0x03, 0xb6, 0xea, 0xbe, 0xb7, 0x31, 0x82, 0x65, 0xbb,
+ 0x33, 0x17, 0x09, 0xce, 0x5b, 0x2c, 0x8c, 0x60, 0x09, 0xaf, 0x46, 0x60, 0x2d, 0x47, 0xad, 0xd7,
+ 0x81, 0x9f, 0x29, 0xbf, 0x79, 0x6a, 0x2b, 0xd7, 0x30, 0x53, 0x95, 0x24, 0xe6, 0xdb, 0x5b, 0x3d,
+ 0x6a, 0x35, 0x03, 0x63, 0xab, 0x80, 0x5a, 0x81, 0x30, 0xa1, 0x3a, 0xfd, 0x44, 0x03, 0xf4, 0x38,
+ 0x76, 0xef, 0xb8, 0x68, 0x85, 0x56, 0x11, 0x6c, 0x3a, 0x0d, 0x83, 0xd8, 0x85, 0xe6, 0x2e, 0x18,
+ 0xd2, 0x27, 0x56, 0x6c, 0x9f, 0x74, 0x90, 0xc3, 0x8a, 0xa3, 0x66, 0x6c, 0x97, 0xf0, 0xf3, 0x27,
+ 0xf8, 0x7e, 0xe4, 0xce, 0xeb, 0xb2, 0x68, 0xc8, 0xd4, 0x5b, 0x3b, 0x72, 0x58, 0x0e, 0x0d, 0x11,
+ 0x5c, 0xd5, 0xa7, 0x0d, 0xd7, 0xb9, 0x62, 0x89, 0x73, 0xed, 0xda, 0x2b, 0x8e, 0xea, 0x68, 0x22,
+ 0x02, 0x63, 0x2f, 0x8f, 0x07, 0x68, 0xe2, 0x8e, 0x48, 0x76, 0xac, 0xb0, 0x42, 0x04, 0xf8, 0x96,
+ 0x3f, 0x57, 0x49, 0x88, 0x45, 0x6b, 0xe6, 0x21, 0xd0, 0xcb, 0x23, 0x11, 0xb5, 0x21, 0x39, 0xe5,
+ 0x26, 0x9e, 0x07, 0x7e, 0x17, 0x05, 0xbb, 0xcb, 0x5e, 0xd7, 0x87, 0xb7, 0x1b, 0xb9, 0x35, 0x38,
+ 0xbd, 0x01, 0xd4, 0xfa, 0xa4, 0x39, 0xb0, 0xdf, 0xf0, 0xe6, 0x0d, 0xfc, 0x3d, 0xbd, 0x38, 0xc7,
+ 0xf4, 0x63, 0xd9, 0x67, 0x78, 0x33, 0x06, 0xce, 0xec, 0x2d, 0x06, 0x34, 0xe7, 0x32, 0xd8, 0xfa,
+ 0x0f, 0x74, 0xa3, 0xa0, 0x74, 0x87, 0x1a, 0x3d, 0xa0, 0x14, 0xef, 0x12, 0x95, 0x62, 0xcf, 0xf1,
+ 0x24, 0x20, 0x51, 0xe2, 0xcc, 0x3f, 0xa7, 0xfa, 0x2d, 0xa8, 0x17, 0xb4, 0x5a, 0x34, 0x8b, 0xb8,
+ 0xb3, 0xe1, 0x87, 0x92, 0xa8, 0x64, 0x59, 0xcd, 0x16, 0x82, 0x60, 0xdf, 0xb9, 0xe3, 0x04, 0x8d,
+ 0x77, 0x0a, 0xcd, 0x97, 0x98, 0x91, 0x13, 0x57, 0xe7, 0xe8, 0xb1, 0x45, 0x89, 0xf0, 0x2f, 0xaf,
+ 0xbe, 0x50, 0xb1, 0xb9, 0x3b, 0xca, 0x27, 0x8c, 0x6e, 0xbe, 0xdc, 0x23, 0x37, 0x6c, 0xf4, 0xf7,
+ 0x23, 0xbc, 0x86, 0x60, 0xdb, 0xf9, 0x1e, 0x93, 0x0f, 0xa1, 0x13, 0x79, 0x2d, 0x91, 0xe2, 0x8f,
+ 0x8e, 0x9d, 0x75, 0x6d, 0x0b, 0xce, 0x8d, 0xbd, 0x6f, 0x9b, 0xbd, 0xef, 0x88, 0x87, 0xe7, 0xf8,
+ 0xd2, 0xb1, 0xae, 0x09, 0xdf, 0x16, 0xa3, 0x9d, 0xc0, 0x84, 0x96, 0xe6, 0xaa, 0x4d, 0x10, 0x25,
+ 0xad, 0xd1, 0xae, 0x74, 0x09, 0x39, 0xae, 0x12, 0x25, 0x2d, 0x70, 0x07, 0xf2, 0x62, 0x4a, 0x28,
+ 0xe9, 0xe4, 0x05, 0x21, 0xad, 0x9f, 0x08, 0xca, 0x51, 0x46, 0xee, 0x9d, 0xb8, 0xad, 0x75, 0x6c,
+ 0x33, 0xba, 0x24, 0xda, 0xdb, 0x58, 0x5b, 0xa4, 0x6c, 0xbd, 0x47, 0xbb, 0x61, 0xb6, 0x1c, 0x08,
+ 0xbf, 0xce, 0xfc, 0x5f, 0xa7, 0xcd, 0xcc, 0x3f, 0x1a, 0xd7, 0x93, 0x09, 0x68, 0xd8, 0xc5, 0x7f,
+ 0x42, 0xee, 0xde, 0xc1, 0x5b, 0xc9, 0xfe, 0x09, 0xea, 0xba, 0x7f, 0xb5, 0xff, 0x01, 0x74, 0xbf,
+ 0x70, 0x3c, 0xe6, 0x0e, 0x00, 0x00
+};
+
+#endif
@@ -0,0 +1,60 @@
+/*!
+ * @file
+ * XIP cache statistics header.
+ */
+
+/*
+ * Copyright (c) 2023, FAV Software Limited. All rights reserved.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/*
+ * File:   xip_stats.h
+ * Author: busdev
+ *
+ * Created on 19 October 2026
+ * Updated on 19 October 2026
+ */
+
+#ifndef __XIP_STATS_H__
+#define __XIP_STATS_H__
+
+// XIP cache statistics.
+//
+// The XIP block counts cache accesses and hits in two 32 bit registers,
+// which wrap in well under a minute at full speed. xip_stats_poll(),
+// called from the main loop, reads and clears them once every
+// XIP_STATS_WINDOW_US and publishes the last window:
+//
+//   cws_xip_cache_hit_permille      Gauge, hits per thousand accesses.
+//   cws_xip_cache_misses            Gauge, misses in the last window.
+
+#define XIP_STATS_WINDOW_US 1000000
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+void xip_stats_init(void);
+void xip_stats_poll(void);
+int xip_stats_render(char *buf, int size);
+
+#ifdef __cplusplus
+ }
+#endif
+
+#endif
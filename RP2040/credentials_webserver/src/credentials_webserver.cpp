@@ -23,17 +23,33 @@
 //
 // Directories
 // -----------
-// /                                   Home page.
-// /setup/home                         Home page.
-// /setup/imageserver                  WiFi credentials amd image server URL entry.
-// /setup/imageservercredentials       Store wifi credentials and image server URL.
-// /setup/resetimageservercredentials  Clears WiFi and image server URL input fields.
-// /setup/cancelimageservercredentials Restores "new" ssid, pass and server to original values.
-// /setup/deviceid                     Displays device ID.
-// /setup/display                      Allows switch to display mode.
-// /setup/displaymode                  Switches to display mode.
-// /setup/masterreset                  Displays confirm reset page.
-// /setup/resetconfirmed               Restores display to factory defaults.
+// The pages are GETs. The POSTs change the settings and, but for
+// displaymode and input errors, answer 303 See Other with the page to show.
+//
+// /                                   Home page (GET).
+// /setup/home                         Home page (GET).
+// /setup/imageserver                  WiFi credentials amd image server URL entry (GET).
+// /setup/imageservercredentials       Store wifi credentials and image server URL (POST).
+// /setup/resetimageservercredentials  Clears WiFi and image server URL input fields (POST).
+// /setup/cancelimageservercredentials Restores "new" ssid, pass and server to original values (POST).
+// /setup/deviceid                     Displays device ID (GET).
+// /setup/display                      Allows switch to display mode (GET).
+// /setup/displaymode                  Switches to display mode (POST).
+// /setup/masterreset                  Displays confirm reset page (GET).
+// /setup/resetconfirmed               Restores display to factory defaults (POST).
+// /setup/resetdone                    Result of the master reset (GET).
+// /style.v2.css                       Stylesheet shared by the pages (GET).
+// /api/v1/config                      Settings as JSON (GET and PUT).
+// /api/v1/masterreset                 Restores display to factory defaults (POST, JSON).
+// /api/v1/displaymode                 Switches to display mode (POST, JSON).
+// /app                                Single page UI, gzipped (GET).
+// /metrics                            Prometheus text format metrics (GET).
+// /trace                              Binary request trace dump (GET, CWS_TRACE builds).
+// /memory                             Heap, lwIP pool and stack usage (GET).
+// /profile                            PC sampling profile (GET, CWS_PC_SAMPLER builds).
+// /profile/start?ms=N&hz=N            Starts a PC sampling window (GET, CWS_PC_SAMPLER builds).
+// /generate_204, /hotspot-detect.html, OS connectivity probes, redirected to
+// /connecttest.txt, ...               /setup/home (GET, see captive_portal_probes).
 
 //
 // The display has two operating modes: DISPLAY and CONFIGURATION.
@@ -45,34 +61,138 @@
  * Author: busdev
  *
  * Created on 30 December 2022
- * Updated on 14 February 2023
+ * Updated on 19 October 2026
  */
 
 #include "credentials_webserver.h"
+#include "json.h"
+#include "tiny_format.h"
+#include "ui_bundle.h"
+#include "ram_code.h"
 
 Credentials_Webserver *cws;
 
+// Status and Cache-Control of the cached pages, by route (PAGE_HOME ...).
+// The image server page shows the password, so the browser must not
+// store it.
+
+static const struct
+{
+ int status;
+ const char *cache_control;
+} page_headers[] =
+{
+ { HTTP_STATUS_OK, CACHE_CONTROL_REVALIDATE },         // PAGE_HOME
+ { HTTP_STATUS_OK, CACHE_CONTROL_NO_STORE },           // PAGE_IMAGE_SERVER
+ { HTTP_STATUS_OK, CACHE_CONTROL_REVALIDATE },         // PAGE_DEVICE_ID
+ { HTTP_STATUS_OK, CACHE_CONTROL_REVALIDATE },         // PAGE_MASTER_RESET
+ { HTTP_STATUS_OK, CACHE_CONTROL_REVALIDATE },         // PAGE_DISPLAY_MODE
+ { HTTP_STATUS_NOT_FOUND, CACHE_CONTROL_REVALIDATE }   // PAGE_NOT_FOUND_ROUTE
+};
+
+// Labels of cws_http_requests_total, by route (ROUTE_GET_HOME ...).
+
+#define GET_ROUTE(route)  "method=\"GET\",route=\"" route "\""
+#define POST_ROUTE(route) "method=\"POST\",route=\"" route "\""
+#define PUT_ROUTE(route)  "method=\"PUT\",route=\"" route "\""
+
+static const char *const route_labels[] =
+{
+ GET_ROUTE("setup/home"),                          // ROUTE_GET_HOME
+ GET_ROUTE(STYLESHEET_PATH),                       // ROUTE_GET_STYLESHEET
+ GET_ROUTE("setup/imageserver"),                   // ROUTE_GET_IMAGE_SERVER
+ GET_ROUTE("setup/deviceid"),                      // ROUTE_GET_DEVICE_ID
+ GET_ROUTE("setup/masterreset"),                   // ROUTE_GET_MASTER_RESET
+ GET_ROUTE("setup/display"),                       // ROUTE_GET_DISPLAY
+ GET_ROUTE("setup/resetdone"),                     // ROUTE_GET_RESET_DONE
+ GET_ROUTE(CONFIG_API_PATH),                       // ROUTE_GET_CONFIG
+ GET_ROUTE(UI_APP_PATH),                           // ROUTE_GET_APP
+ GET_ROUTE("probe"),                               // ROUTE_GET_PROBE, all the probes.
+ GET_ROUTE("metrics"),                             // ROUTE_GET_METRICS
+ GET_ROUTE("trace"),                               // ROUTE_GET_TRACE
+ GET_ROUTE("memory"),                              // ROUTE_GET_MEMORY
+ GET_ROUTE("profile"),                             // ROUTE_GET_PROFILE
+ GET_ROUTE("profile/start"),                       // ROUTE_GET_PROFILE_START, without the query.
+ GET_ROUTE("other"),                               // ROUTE_GET_OTHER
+ POST_ROUTE("setup/resetconfirmed"),               // ROUTE_POST_RESET_CONFIRMED
+ POST_ROUTE("setup/imageservercredentials"),       // ROUTE_POST_CREDENTIALS
+ POST_ROUTE("setup/resetimageservercredentials"),  // ROUTE_POST_RESET_CREDENTIALS
+ POST_ROUTE("setup/cancelimageservercredentials"), // ROUTE_POST_CANCEL_CREDENTIALS
+ POST_ROUTE("setup/displaymode"),                  // ROUTE_POST_DISPLAY_MODE
+ POST_ROUTE(CONFIG_MASTER_RESET_PATH),             // ROUTE_POST_CONFIG_MASTER_RESET
+ POST_ROUTE(CONFIG_DISPLAY_MODE_PATH),             // ROUTE_POST_CONFIG_DISPLAY_MODE
+ POST_ROUTE("other"),                              // ROUTE_POST_OTHER
+ PUT_ROUTE(CONFIG_API_PATH),                       // ROUTE_PUT_CONFIG
+ PUT_ROUTE("other")                                // ROUTE_PUT_OTHER
+};
+
+static_assert(sizeof(route_labels) / sizeof(route_labels[0]) == ROUTE_COUNT, "route_labels must have a label per ROUTE_...");
+static_assert(ROUTE_COUNT + METRICS_OTHER_COUNTERS <= METRICS_MAX_COUNTERS, "METRICS_MAX_COUNTERS too small for a counter per route");
+
+// Shared by all the pages, sent from flash.
+
+static const char stylesheet[] = STYLESHEET;
+
+// Names of the storage states in the provisioning API, by EPD_STORE_...
+
+static const char *const epd_status_names[] =
+{
+ "uninitialised",
+ "formatted",
+ "default",
+ "setting",
+ "set"
+};
+
+// Connectivity probe paths, as extract_path() returns them.
+
+static const char *const captive_portal_probes[] =
+{
+ "generate_204",                // Android, Chrome OS.
+ "gen_204",
+ "hotspot-detect.html",         // Apple.
+ "library/test/success.html",
+ "connecttest.txt",             // Windows.
+ "ncsi.txt",
+ "redirect",
+ "success.txt",                 // Firefox.
+ "canonical.html",
+ "kindle-wifi/wifistub.html"    // Kindle.
+};
+
 Credentials_Webserver::Credentials_Webserver(Storage_Handler *sh, Log *log):
  sh(sh),
  log(log),
- log_text(""),
- new_ssid(""),
- new_pass(""),
- new_server(""),
- ssid(""),
- pass(""),
- server(""),
+ page_generation(0),
+ stylesheet_etag(http_etag(stylesheet, sizeof(stylesheet) - 1)),
+ ui_bundle_etag(http_etag((const char *)ui_bundle, sizeof(ui_bundle))),
+ if_none_match(NULL),
+ if_none_match_len(0),
  is_display_reset(false),
  is_master_reset_error(false),
  is_configuring(false),
  is_ssid_present_and_correct(false),
  is_password_present_and_correct(false),
- is_server_url_present_and_correct(false)
+ is_server_url_present_and_correct(false),
+ request_start_us(0),
+ is_request_timed(false),
+ stream_pcb(NULL),
+ stream_arg(NULL),
+ stream_kind(STREAM_METRICS),
+ stream_cursor(0)
  {
-  web_page_header = "<html><head>";
-  web_page_header = web_page_header + PAGE_TITLE + "<style type=\"text/css\"></style></head>";
-  web_page_footer = FOOTER1;
-  web_page_footer = web_page_footer + "</body></html>";
+  static const uint32_t latency_bounds_us[] = { 100, 250, 500, 1000, 2500, 5000, 10000, 25000 };
+
+  bytes_sent_metric = metrics_counter("cws_http_bytes_sent_total", NULL, "Bytes passed to tcp_write.");
+  tcp_buffer_err_metric = metrics_counter("cws_tcp_errors_total", "error=\"buffer\"", "TCP send errors.");
+  tcp_write_err_metric = metrics_counter("cws_tcp_errors_total", "error=\"write\"", "TCP send errors.");
+  tcp_sndbuf_metric = metrics_gauge("cws_tcp_sndbuf_bytes", NULL, "TCP send buffer space before the last write.");
+  first_write_latency_metric = metrics_histogram("cws_http_first_write_latency_us", "Time from receiving a request to its first tcp_write.",
+                                                 latency_bounds_us, sizeof(latency_bounds_us) / sizeof(latency_bounds_us[0]));
+  not_modified_metric = metrics_counter("cws_http_not_modified_total", NULL, "Conditional requests answered with 304 Not Modified.");
+
+  for (int i = 0; i < ROUTE_COUNT; i++)
+   request_metrics[i] = metrics_counter("cws_http_requests_total", route_labels[i], "HTTP requests by method and route.");
 
 // Retrieve existing credentials.
 
@@ -119,198 +239,42 @@ bool Credentials_Webserver::get_is_configuring(void)
 }
 
 /*!
-* \brief Replaces special characters in HTML string.
-*
-* Replaces '+' with ' ' and %nn with the ASCII character.
-* Note: the 'special' characters are introduced by the client
-* when the browser encounters user input characters that have
-* a special meaning e.g. ' ' and '/'.
-*
-* \param source_str Input string from web client.
-* \return string.
-*/
-
-string Credentials_Webserver::replace_special_html_characters(string source_str)
-{
- string output_str = "";
- int source_len = source_str.length();
- uint8_t high_nibble;
- uint8_t low_nibble;
- uint8_t ascii_value;
- char current_char;
-
- for (int i = 0; i < source_len; i++)
- {
-  if (source_str[i] == '+')
-  {
-   output_str += " ";  // Replace '+' with ' '.
-  }
-  else if (source_str[i] == '%') // Next two characters are the hex value for an ascii character.
-  {
-   current_char = source_str[++i];
-
-   if ((current_char >= '0') && (current_char <= '9'))
-   {
-    high_nibble = (uint8_t)(current_char - '0');
-   }
-   else  // Character between 'A' and 'F'.
-   {
-    high_nibble = (uint8_t)((current_char - 'A') + 10);
-   }
-
-   current_char = source_str[++i];
-
-   if ((current_char >= '0') && (current_char <= '9'))
-   {
-    low_nibble = (uint8_t)(current_char - '0');
-   }
-   else  // Character between 'A' and 'F'.
-   {
-    low_nibble = (uint8_t)((current_char - 'A') + 10);
-   }
-
-   ascii_value = (high_nibble * 16) + low_nibble;
-   output_str += (char)ascii_value;
-  }
-  else
-  {
-   output_str += source_str[i];
-  }
- }
-
- return output_str;
-}
-
-/*!
-* \brief Checks the WiFi SSID.
-*
-* The WiFi SSID's length must be between 1 and 32 characters (bytes).
-*
-* Rules
-* -----
-* 1. First character must not be in ['!', '#', ';'].
-* 2. Following characters NOT allowed ['+', ']', '/', '"', TAB].
-* 3. Trailing spaces NOT allowed.
-* 4. Each character must be 'ASCII printable' i.e. in the decimal range 32..126.
+* \brief Decodes and checks the new WiFi SSID, see is_valid_wifi_ssid().
 *
 * \return Boolean.
 */
 
 bool Credentials_Webserver::check_wifi_ssid_format(void)
 {
- int ssid_len;
- uint8_t ssid_char;
- bool is_valid_characters = false;
+ new_ssid.set_length(replace_special_html_characters(new_ssid.data(), new_ssid.length()));
 
- new_ssid = replace_special_html_characters(new_ssid);
- ssid_len = new_ssid.length();
-
- if ((ssid_len >= MIN_SSID_LENGTH) && 
-     (ssid_len <= MAX_SSID_LENGTH))
- {
-  if ((new_ssid[0] != '!') && (new_ssid[0] != '#') && (new_ssid[0] != ';'))  // Illegal start character.
-  {
-   if (new_ssid[ssid_len - 1] != ' ')  // Trailing space NOT allowed
-   {
-    if ((new_ssid.find("+") == std::string::npos)  &&
-        (new_ssid.find("]") == std::string::npos)  &&
-        (new_ssid.find("/") == std::string::npos)  &&
-        (new_ssid.find("\"") == std::string::npos) &&
-        (new_ssid.find("\t") == std::string::npos))
-    {
-     is_valid_characters = true;
-
-     for (int i = 0; i < ssid_len; i++)
-     {
-      ssid_char = (uint8_t)new_ssid[i];
-
-      if ((ssid_char < 32) || (ssid_char > 126))
-      {
-       is_valid_characters = false;
-       break;
-      }
-     }
-    }
-   }
-  }
- }
-
- return is_valid_characters;
+ return (new_ssid.is_truncated() == false) && (is_valid_wifi_ssid(new_ssid.c_str(), new_ssid.length()) == true);
 }
 
 /*!
-* \brief Checks the WiFi password (passphrase).
-*
-* The WiFi password's length must be between 8 and 63 characters (bytes).
-* Each character must be 'ASCII printable' i.e. in the decimal range 32..126.
+* \brief Decodes and checks the new WiFi password, see is_valid_wifi_password().
 *
 * \return Boolean.
 */
 
 bool Credentials_Webserver::check_wifi_password_format(void)
 {
- int password_len;
- uint8_t password_char;
- bool is_valid_characters = false;
-
- new_pass = replace_special_html_characters(new_pass);
- password_len = new_pass.length();
-
- if ((password_len >= MIN_PASSWORD_LENGTH) && 
-     (password_len <= MAX_PASSWORD_LENGTH))
- {
-  is_valid_characters = true;
-
-  for (int i = 0; i < password_len; i++)
-  {
-   password_char = (uint8_t)new_pass[i];
-
-   if ((password_char < 32) || (password_char > 126))
-   {
-    is_valid_characters = false;
-    break;
-   }
-  }
- }
+ new_pass.set_length(replace_special_html_characters(new_pass.data(), new_pass.length()));
 
- return is_valid_characters;
+ return (new_pass.is_truncated() == false) && (is_valid_wifi_password(new_pass.c_str(), new_pass.length()) == true);
 }
 
 /*!
-* \brief Checks the image server's URL format.
-*
-* The image server's URL must not contain any spaces.
-* Each character must be 'ASCII printable' i.e. in the decimal range 32..126.
+* \brief Decodes and checks the new image server URL, see is_valid_image_server_url().
 *
 * \return Boolean.
 */
 
 bool Credentials_Webserver::check_image_server_url_format(void)
 {
- int server_url_len;
- uint8_t server_url_char;
- bool is_valid_characters = false;
-
- new_server = replace_special_html_characters(new_server);
- server_url_len = new_server.length();
-
- if (new_server.find(" ") == std::string::npos)
- {
-  is_valid_characters = true;
+ new_server.set_length(replace_special_html_characters(new_server.data(), new_server.length()));
 
-  for (int i = 0; i < server_url_len; i++)
-  {
-   server_url_char = (uint8_t)new_server[i];
-
-   if ((server_url_char < 32) || (server_url_char > 126))
-   {
-    is_valid_characters = false;
-    break;
-   }
-  }
- }
-
- return is_valid_characters;
+ return (new_server.is_truncated() == false) && (is_valid_image_server_url(new_server.c_str(), new_server.length()) == true);
 }
 
 /*!
@@ -337,43 +301,89 @@ bool Credentials_Webserver::check_fields(void)
 }
 
 /*!
-* \brief Sends an HTML page to the client.
+* \brief Formats the HTTP header of a page.
+*
+* A 304 header has no Content-Type or Content-length, there is no body.
+* It is appended piece by piece: tiny_format() would take longer than
+* the rest of the 304.
+*
+* \param header Set to the header.
+* \param status HTTP_STATUS_OK ...
+* \param content_type CONTENT_TYPE_HTML or CONTENT_TYPE_CSS.
+* \param cache_control Cache-Control value.
+* \param etag Entity tag of the page, see http_etag().
+* \param data_len Number of bytes in the page contents.
+*/
+
+void RAM_FUNC(Credentials_Webserver::format_page_header)(Fixed_String<HTTP_HEADER_BUFFER_SIZE> &header, int status, const char *content_type, const char *cache_control, uint32_t etag, int data_len)
+{
+ char tag[HTTP_ETAG_SIZE];
+
+ format_etag(tag, etag);
+
+ if (status == HTTP_STATUS_NOT_MODIFIED)
+ {
+  header = "HTTP/1.1 304 Not Modified\r\nCache-Control: ";
+  header += cache_control;
+  header += "\r\nETag: ";
+  header += tag;
+  header += "\r\nConnection: close\r\n\r\n";
+  return;
+ }
+
+ header.clear();
+ header.append_format("HTTP/1.1 %d %s\r\nContent-Type: %s\r\nCache-Control: %s\r\nETag: %s\r\nContent-length: %d\r\nConnection: close\r\n\r\n",
+                      status, http_status_text(status), content_type, cache_control, tag, data_len);
+}
+
+/*!
+* \brief Sends an HTML page, or other contents, to the client.
 *
-* The page consists of a header and contents.
+* The page consists of a header and contents. If the request's
+* If-None-Match names the page's entity tag, only a 304 header is sent.
 *
 * \param pcb Pointer to the TCP protocol control block of the socket.
+* \param status HTTP_STATUS_OK ...
+* \param content_type CONTENT_TYPE_HTML ...
+* \param cache_control Cache-Control value.
 * \param data_ptr Pointer to the page contents.
 * \param data_len Number of bytes in contents.
 * \return err_t. If < 0, an error occurred.
 */
 
-err_t Credentials_Webserver::send_page(struct tcp_pcb *pcb, const char *data_ptr, int data_len)
+err_t RAM_FUNC(Credentials_Webserver::send_page)(struct tcp_pcb *pcb, int status, const char *content_type, const char *cache_control, const char *data_ptr, int data_len)
 {
  err_t err = ERR_OK;
- int hlen;
- char http_header_buf[HTTP_HEADER_BUFFER_SIZE];
- char lbuf[40];
+ uint32_t etag;
+ Fixed_String<HTTP_HEADER_BUFFER_SIZE> http_header;
+
+ TRACE(TRACE_SEND_PAGE_BEGIN, pcb);
 
 // Check the parameters.
 
- if ((!pcb) || (!data_ptr) || (data_len > MAX_CONTENTS_LENGTH))
+ if ((!pcb) || (!content_type) || (!cache_control) || (!data_ptr) || (data_len > MAX_CONTENTS_LENGTH))
   err = ERR_ARG;
 
 // Create header, setting content length.
 
  if (err == ERR_OK)
  {
-  strcpy(http_header_buf, "HTTP/1.1 200 OK\r\nContent-Type: text/html\r\n");
-  sprintf(lbuf, "Content-length: %d\r\n", data_len);
-  strcat(http_header_buf, lbuf);
-  strcat(http_header_buf, "Connection: close\r\n\r\n");
-  hlen = strlen(http_header_buf);
- 
-  err = send_data(pcb, http_header_buf, hlen);  // Send data (header) to client.
+  etag = http_etag(data_ptr, data_len);
 
-  if (err == ERR_OK)
+  if (is_not_modified(etag) == true)
+  {
+   err = send_not_modified(pcb, cache_control, etag);
+  }
+  else
   {
-   err = send_data(pcb, data_ptr, data_len);    // Send data (contents) to client.
+   format_page_header(http_header, status, content_type, cache_control, etag, data_len);
+
+   err = send_data(pcb, http_header.c_str(), http_header.length(), TCP_WRITE_FLAG_COPY);  // Send data (header) to client.
+
+   if (err == ERR_OK)
+   {
+    err = send_data(pcb, data_ptr, data_len, TCP_WRITE_FLAG_COPY);    // Send data (contents) to client.
+   }
   }
  }
 
@@ -382,6 +392,8 @@ err_t Credentials_Webserver::send_page(struct tcp_pcb *pcb, const char *data_ptr
   stop_webserver(pcb);
  }
 
+ TRACE(TRACE_SEND_PAGE_END, pcb);
+
  return err;
 }
 
@@ -393,10 +405,12 @@ err_t Credentials_Webserver::send_page(struct tcp_pcb *pcb, const char *data_ptr
 * \param pcb Pointer to the TCP protocol control block of the socket.
 * \param data_ptr Pointer to the data to be sent.
 * \param data_len Number of bytes in data.
+* \param apiflags tcp_write() flags. Without TCP_WRITE_FLAG_COPY the data
+*                 must stay unchanged until it has been acknowledged.
 * \return err_t. If < 0, an error occurred.
 */
 
-err_t Credentials_Webserver::send_data(struct tcp_pcb *pcb, const char *data_ptr, int data_len)
+err_t RAM_FUNC(Credentials_Webserver::send_data)(struct tcp_pcb *pcb, const char *data_ptr, int data_len, u8_t apiflags)
 {
  err_t err = ERR_OK;
 
@@ -407,25 +421,212 @@ err_t Credentials_Webserver::send_data(struct tcp_pcb *pcb, const char *data_ptr
 
 // Check the tcp buffer size.
 
+ metrics_set(tcp_sndbuf_metric, tcp_sndbuf(pcb));
+
  if (tcp_sndbuf(pcb) < data_len) 
  {
-  log->print_error(TCP_BUFFER_ERR);
+  LOG_ERROR(log, TCP_BUFFER_ERR, tcp_sndbuf(pcb), data_len);
+  metrics_inc(tcp_buffer_err_metric);
   err = ERR_MEM;
  }
 
  if (err == ERR_OK)
  {
-  err = tcp_write(pcb, data_ptr, data_len, TCP_WRITE_FLAG_COPY);
+  if (is_request_timed == true)
+  {
+   metrics_observe(first_write_latency_metric, time_us_32() - request_start_us);
+   is_request_timed = false;
+  }
+
+  TRACE(TRACE_WRITE_BEGIN, pcb);
+  err = tcp_write(pcb, data_ptr, data_len, apiflags);
+  TRACE(TRACE_WRITE_END, pcb);
 
   if (err != ERR_OK) 
   {
-   log->print_error(TCP_WRITE_ERR);
+   LOG_ERROR(log, TCP_WRITE_ERR, (uint32_t)err, data_len);
+   metrics_inc(tcp_write_err_metric);
+  }
+  else
+  {
+   metrics_add(bytes_sent_metric, data_len);
   }
  }
 
  return err;
 }
 
+/*!
+* \brief Sends the page built in web_page to the client.
+*
+* A page that did not fit the page buffer is not sent part way; the
+* error is logged and the connection closed, as send_page() does for
+* any other page it cannot send.
+*
+* A cacheable page is stored, with its header, in the page cache and
+* sent from there; it is sent as is if the cache cannot take it. Pages
+* that are not cached are one off results, never stored by the browser.
+*
+* \param pcb Pointer to the TCP protocol control block of the socket.
+* \param route PAGE_HOME ... or PAGE_NOT_CACHED.
+* \return err_t. If < 0, an error occurred.
+*/
+
+err_t Credentials_Webserver::send_web_page(struct tcp_pcb *pcb, int route)
+{
+ if (web_page.is_truncated() == true)
+ {
+  LOG_ERROR(log, PAGE_BUFFER_ERR, web_page.capacity(), 0);
+  stop_webserver(pcb);
+  return ERR_MEM;
+ }
+
+ if (route == PAGE_NOT_CACHED)
+  return send_page(pcb, HTTP_STATUS_OK, CONTENT_TYPE_HTML, CACHE_CONTROL_NO_STORE, web_page.c_str(), web_page.length());
+
+ Fixed_String<HTTP_HEADER_BUFFER_SIZE> http_header;
+ uint32_t etag = http_etag(web_page.c_str(), web_page.length());
+
+ format_page_header(http_header, page_headers[route].status, CONTENT_TYPE_HTML, page_headers[route].cache_control, etag, web_page.length());
+
+ int slot = page_cache.store(route, page_generation, etag, http_header.c_str(), http_header.length(),
+                             web_page.c_str(), web_page.length(), time_us_32());
+
+ if (slot != PAGE_CACHE_NONE)
+  return send_cached_page(pcb, route, slot);
+
+ return send_page(pcb, page_headers[route].status, CONTENT_TYPE_HTML, page_headers[route].cache_control, web_page.c_str(), web_page.length());
+}
+
+/*!
+* \brief Sends a response held in the page cache to the client.
+*
+* One write, header and page, sent from the cache slot without a copy
+* while the slot can be pinned. If the request's If-None-Match names the
+* page's entity tag, only a 304 header is sent.
+*
+* \param pcb Pointer to the TCP protocol control block of the socket.
+* \param route Route the slot holds, PAGE_HOME ...
+* \param slot Slot from Page_Cache::find() or Page_Cache::store().
+* \return err_t. If < 0, an error occurred.
+*/
+
+err_t RAM_FUNC(Credentials_Webserver::send_cached_page)(struct tcp_pcb *pcb, int route, int slot)
+{
+ err_t err;
+ u8_t apiflags = TCP_WRITE_FLAG_COPY;
+ uint32_t etag = page_cache.get_etag(slot);
+
+ TRACE(TRACE_SEND_PAGE_BEGIN, pcb);
+
+ if (is_not_modified(etag) == true)
+ {
+  err = send_not_modified(pcb, page_headers[route].cache_control, etag);
+ }
+ else
+ {
+  if (page_cache.pin(slot, pcb, time_us_32()) == true)
+   apiflags = 0;
+
+  err = send_data(pcb, page_cache.get_data(slot), page_cache.get_length(slot), apiflags);
+
+  if (err != ERR_OK)
+   page_cache.unpin(pcb);  // Nothing was queued.
+ }
+
+ if (err != ERR_OK)
+  stop_webserver(pcb);
+
+ TRACE(TRACE_SEND_PAGE_END, pcb);
+
+ return err;
+}
+
+/*!
+* \brief Sends 304 Not Modified, a header without a body.
+*
+* \param pcb Pointer to the TCP protocol control block of the socket.
+* \param cache_control Cache-Control value.
+* \param etag Entity tag the client named in If-None-Match.
+* \return err_t. If < 0, an error occurred.
+*/
+
+err_t RAM_FUNC(Credentials_Webserver::send_not_modified)(struct tcp_pcb *pcb, const char *cache_control, uint32_t etag)
+{
+ Fixed_String<HTTP_HEADER_BUFFER_SIZE> http_header;
+
+ format_page_header(http_header, HTTP_STATUS_NOT_MODIFIED, NULL, cache_control, etag, 0);
+ metrics_inc(not_modified_metric);
+
+ return send_data(pcb, http_header.c_str(), http_header.length(), TCP_WRITE_FLAG_COPY);
+}
+
+/*!
+* \brief Checks the request's If-None-Match for an entity tag.
+*
+* \param etag Entity tag of the page about to be sent.
+* \return bool. true if the client's copy is current.
+*/
+
+bool RAM_FUNC(Credentials_Webserver::is_not_modified)(uint32_t etag)
+{
+ return (if_none_match_len > 0) && (is_etag_listed(if_none_match, if_none_match_len, etag) == true);
+}
+
+/*!
+* \brief Invalidates the cached pages.
+*
+* Call whenever new_ssid, new_pass, new_server or their checks change.
+*/
+
+void Credentials_Webserver::invalidate_pages(void)
+{
+ page_generation++;
+}
+
+/*!
+* \brief Sends the stylesheet to the client.
+*
+* The contents go from flash without a copy. The browser keeps the
+* stylesheet for a year without asking again; a 304 is only sent to a
+* client that revalidates anyway, e.g. on a forced reload.
+*
+* \param pcb Pointer to the TCP protocol control block of the socket.
+* \return err_t. If < 0, an error occurred.
+*/
+
+err_t RAM_FUNC(Credentials_Webserver::handle_stylesheet)(struct tcp_pcb *pcb)
+{
+ err_t err;
+ Fixed_String<HTTP_HEADER_BUFFER_SIZE> http_header;
+
+ if (!pcb)
+  return ERR_ARG;
+
+ TRACE(TRACE_SEND_PAGE_BEGIN, pcb);
+
+ if (is_not_modified(stylesheet_etag) == true)
+ {
+  err = send_not_modified(pcb, CACHE_CONTROL_IMMUTABLE, stylesheet_etag);
+ }
+ else
+ {
+  format_page_header(http_header, HTTP_STATUS_OK, CONTENT_TYPE_CSS, CACHE_CONTROL_IMMUTABLE, stylesheet_etag, sizeof(stylesheet) - 1);
+
+  err = send_data(pcb, http_header.c_str(), http_header.length(), TCP_WRITE_FLAG_COPY);
+
+  if (err == ERR_OK)
+   err = send_data(pcb, stylesheet, sizeof(stylesheet) - 1, 0);  // Flash, never changes.
+ }
+
+ if (err != ERR_OK)
+  stop_webserver(pcb);
+
+ TRACE(TRACE_SEND_PAGE_END, pcb);
+
+ return err;
+}
+
 /*!
 * \brief Sends page not found to the client.
 *
@@ -435,15 +636,53 @@ err_t Credentials_Webserver::send_data(struct tcp_pcb *pcb, const char *data_ptr
 
 err_t Credentials_Webserver::handle_page_not_found(struct tcp_pcb *pcb)
 {
- string web_page_str;
-
  if (!pcb)
   return ERR_ARG;
 
- web_page_str = web_page_header;
- web_page_str = web_page_str + "<body> " + HEADER5 + PAGE_NOT_FOUND + " </body> </html>";
+ int slot = page_cache.find(PAGE_NOT_FOUND_ROUTE, page_generation);
+
+ if (slot != PAGE_CACHE_NONE)
+  return send_cached_page(pcb, PAGE_NOT_FOUND_ROUTE, slot);
+
+ web_page = WEB_PAGE_HEADER;
+ web_page += "<body> " HEADER_PLAIN PAGE_NOT_FOUND " </body> </html>";
+
+ return send_web_page(pcb, PAGE_NOT_FOUND_ROUTE);
+}
+
+/*!
+* \brief Redirects an OS connectivity probe to the setup page.
+*
+* \param pcb Pointer to the TCP protocol control block of the socket.
+* \return err_t. If < 0, an error occurred.
+*/
+
+err_t Credentials_Webserver::handle_captive_portal_probe(struct tcp_pcb *pcb)
+{
+ return send_redirect(pcb, CAPTIVE_PORTAL_REDIRECT);
+}
+
+/*!
+* \brief Sends a redirect, a header without a body, to the client.
+*
+* \param pcb Pointer to the TCP protocol control block of the socket.
+* \param response Constant response, e.g. SEE_OTHER_HOME. Not copied.
+* \return err_t. If < 0, an error occurred.
+*/
+
+err_t Credentials_Webserver::send_redirect(struct tcp_pcb *pcb, const char *response)
+{
+ err_t err;
+
+ if ((!pcb) || (!response))
+  return ERR_ARG;
+
+ err = send_data(pcb, response, strlen(response), 0);  // Constant, no copy needed.
+
+ if (err != ERR_OK)
+  stop_webserver(pcb);
 
- return send_page(pcb, (char*)web_page_str.c_str(), web_page_str.length());
+ return err;
 }
 
 /*!
@@ -455,27 +694,30 @@ err_t Credentials_Webserver::handle_page_not_found(struct tcp_pcb *pcb)
 
 err_t Credentials_Webserver::handle_home_page(struct tcp_pcb *pcb)
 {
- string web_page_str;
-
  if (!pcb)
   return ERR_ARG;
 
- web_page_str = web_page_header;
- web_page_str = web_page_str + "<body>" + HEADER1 + TITLE1 + MAIN_MENU + FORM1;
- web_page_str = web_page_str + BUTTON1 + "formaction=\"/setup/imageserver\" value=\"Image Server\">&nbsp;&nbsp;";
- web_page_str = web_page_str + BUTTON1 + "formaction=\"/setup/deviceid\" value=\"Device ID\">";
+ int slot = page_cache.find(PAGE_HOME, page_generation);
+
+ if (slot != PAGE_CACHE_NONE)
+  return send_cached_page(pcb, PAGE_HOME, slot);
+
+ web_page = WEB_PAGE_HEADER;
+ web_page += "<body>" HEADER_MENU TITLE1 MAIN_MENU;
+ web_page += LINK1 "\"/setup/imageserver\">Image Server</a>&nbsp;&nbsp;";
+ web_page += LINK1 "\"/setup/deviceid\">Device ID</a>";
 
 // Test wifi credentials. If O.K, show display button.
 
  if (check_fields() == true)
  {
-  web_page_str = web_page_str  + "&nbsp;&nbsp;" + BUTTON1 + "formaction=\"/setup/display\" value=\"Display\">";
+  web_page += "&nbsp;&nbsp;" LINK1 "\"/setup/display\">Display</a>";
  }
  
- web_page_str = web_page_str + "<br><br>" + BUTTON2 + "formaction=\"/setup/masterreset\" value=\"Master Reset\"></form><br>";
- web_page_str = web_page_str + web_page_footer;
+ web_page += "<br><br>" LINK2 "\"/setup/masterreset\">Master Reset</a><br><br>";
+ web_page += WEB_PAGE_FOOTER;
 
- return send_page(pcb, (char*)web_page_str.c_str(), web_page_str.length());
+ return send_web_page(pcb, PAGE_HOME);
 }
 
 /*!
@@ -496,25 +738,31 @@ err_t Credentials_Webserver::handle_home_page(struct tcp_pcb *pcb)
 
 err_t Credentials_Webserver::handle_image_server_page(struct tcp_pcb *pcb)
 {
- string web_page_str;
-
  if (!pcb)
   return ERR_ARG;
 
- web_page_str = web_page_header;
- web_page_str = web_page_str + "<body> " + HEADER3 + TITLE1 + WIFI_TITLE + FORM1;
- web_page_str = web_page_str + "<input type=\"text\" name=\"networkname\" placeholder=\"Network Name\" maxlength=\"32\" autofocus";
- web_page_str = web_page_str + " value=\"" + new_ssid + "\"><br><br>";
- web_page_str = web_page_str + "<input type=\"password\" name=\"password\" placeholder=\"Password\" maxlength=\"63\"";
- web_page_str = web_page_str + " value=\"" + new_pass + "\"><br><br>";
- web_page_str = web_page_str + "<input type=\"text/plain\" name=\"serverURL\" placeholder=\"Image Server URL\" maxlength=\"2048\"";
- web_page_str = web_page_str + " value=\"" + new_server + "\"><br><br>";
- web_page_str = web_page_str + BUTTON1 + "formaction=\"/setup/imageservercredentials\" value=\"Save\">&nbsp;&nbsp;";
- web_page_str = web_page_str + BUTTON1 + "formaction=\"/setup/resetimageservercredentials\" value=\"Reset\">&nbsp;&nbsp";
- web_page_str = web_page_str + BUTTON1 + "formaction=\"/setup/cancelimageservercredentials\" value=\"Cancel\"></form>";
- web_page_str = web_page_str + web_page_footer;
-
- return send_page(pcb, (char*)web_page_str.c_str(), web_page_str.length());
+ int slot = page_cache.find(PAGE_IMAGE_SERVER, page_generation);
+
+ if (slot != PAGE_CACHE_NONE)
+  return send_cached_page(pcb, PAGE_IMAGE_SERVER, slot);
+
+ web_page = WEB_PAGE_HEADER;
+ web_page += "<body> " HEADER_PANEL TITLE1 WIFI_TITLE FORM1;
+ web_page += "<input type=\"text\" name=\"networkname\" placeholder=\"Network Name\" maxlength=\"32\" autofocus value=\"";
+ web_page += new_ssid.c_str();
+ web_page += "\"><br><br>";
+ web_page += "<input type=\"password\" name=\"password\" placeholder=\"Password\" maxlength=\"63\" value=\"";
+ web_page += new_pass.c_str();
+ web_page += "\"><br><br>";
+ web_page += "<input type=\"text/plain\" name=\"serverURL\" placeholder=\"Image Server URL\" maxlength=\"2048\" value=\"";
+ web_page += new_server.c_str();
+ web_page += "\"><br><br>";
+ web_page += BUTTON1 "formaction=\"/setup/imageservercredentials\" value=\"Save\">&nbsp;&nbsp;";
+ web_page += BUTTON1 "formaction=\"/setup/resetimageservercredentials\" value=\"Reset\">&nbsp;&nbsp";
+ web_page += BUTTON1 "formaction=\"/setup/cancelimageservercredentials\" value=\"Cancel\"></form>";
+ web_page += WEB_PAGE_FOOTER;
+
+ return send_web_page(pcb, PAGE_IMAGE_SERVER);
 }
 
 /*!
@@ -529,20 +777,24 @@ err_t Credentials_Webserver::handle_image_server_page(struct tcp_pcb *pcb)
 
 err_t Credentials_Webserver::handle_device_id_page(struct tcp_pcb *pcb)
 {
- string web_page_str;
- string label_id = "Test_Label_ID";   // *** Test *** Outstanding Work ***
-
  if (!pcb)
   return ERR_ARG;
 
- web_page_str = web_page_header;
- web_page_str = web_page_str + "<body> " + HEADER2 + TITLE1 + DEVICE_ID_TITLE;
- web_page_str = web_page_str + "<p>Use the display ID to identify this<br>display in the image server configurator.<br> ";
- web_page_str = web_page_str + "<br><b><span style=\"font-family:courier\">" + label_id + "</span></b></p>";
- web_page_str = web_page_str + FORM1 + BUTTON1 + "formaction=\"/setup/home\" value=\"OK\">";
- web_page_str = web_page_str + web_page_footer;
+ int slot = page_cache.find(PAGE_DEVICE_ID, page_generation);
+
+ if (slot != PAGE_CACHE_NONE)
+  return send_cached_page(pcb, PAGE_DEVICE_ID, slot);
 
- return send_page(pcb, (char*)web_page_str.c_str(), web_page_str.length());
+ web_page = WEB_PAGE_HEADER;
+ web_page += "<body> " HEADER_PANEL TITLE1 DEVICE_ID_TITLE;
+ web_page += "<p>Use the display ID to identify this<br>display in the image server configurator.<br> ";
+ web_page += "<br><b><span class=\"mono\">";
+ web_page += DEVICE_LABEL_ID;
+ web_page += "</span></b></p>";
+ web_page += LINK1 "\"/setup/home\">OK</a>";
+ web_page += WEB_PAGE_FOOTER;
+
+ return send_web_page(pcb, PAGE_DEVICE_ID);
 }
 
 /*!
@@ -558,27 +810,29 @@ err_t Credentials_Webserver::handle_device_id_page(struct tcp_pcb *pcb)
 
 err_t Credentials_Webserver::handle_master_reset_page(struct tcp_pcb *pcb)
 {
- string web_page_str;
-
  if (!pcb)
   return ERR_ARG;
 
- web_page_str = web_page_header;
- web_page_str = web_page_str + "<body> " + HEADER6 + TITLE1 + RESET_DISPLAY_TITLE;
- web_page_str = web_page_str + "<p>Press Confirm to reset the display<br>to factory defaults.</p>";
- web_page_str = web_page_str + FORM1 + BUTTON1 + "formaction=\"/setup/resetconfirmed\" value=\"Confirm\">&nbsp;&nbsp";
- web_page_str = web_page_str + BUTTON1 + "formaction=\"/setup/home\" value=\"Cancel\"></form>";
- web_page_str = web_page_str + web_page_footer;
+ int slot = page_cache.find(PAGE_MASTER_RESET, page_generation);
+
+ if (slot != PAGE_CACHE_NONE)
+  return send_cached_page(pcb, PAGE_MASTER_RESET, slot);
+
+ web_page = WEB_PAGE_HEADER;
+ web_page += "<body> " HEADER_ALERT TITLE1 RESET_DISPLAY_TITLE;
+ web_page += "<p>Press Confirm to reset the display<br>to factory defaults.</p>";
+ web_page += FORM1 BUTTON1 "formaction=\"/setup/resetconfirmed\" value=\"Confirm\">&nbsp;&nbsp";
+ web_page += LINK1 "\"/setup/home\">Cancel</a></form>";
+ web_page += WEB_PAGE_FOOTER;
 
- return send_page(pcb, (char*)web_page_str.c_str(), web_page_str.length());
+ return send_web_page(pcb, PAGE_MASTER_RESET);
 }
 
 /*!
 * \brief Processes user master reset confirmation.
 *
-* Attempts to reset the display to it's default configuration.
-* If successful, displays page indicating display was indeed reset,
-* otherwise display page informing user the display was NOT reset.
+* Attempts to reset the display to it's default configuration,
+* then redirects to the page showing the result.
 *
 * \param pcb Pointer to the TCP protocol control block of the socket.
 * \return err_t. If < 0, an error occurred.
@@ -586,52 +840,94 @@ err_t Credentials_Webserver::handle_master_reset_page(struct tcp_pcb *pcb)
 
 err_t Credentials_Webserver::handle_reset_confirmed_page(struct tcp_pcb *pcb)
 {
- err_t err = ERR_OK;
- string web_page_str;
-
- bool result = false;
-
  if (!pcb)
   return ERR_ARG;
 
-// *** Outstanding Work ***
-// result = master_reset(); // Main display reset function.
- result = true;  // *** Test ***
+ reset_to_factory_defaults();
 
- if (result == true)
+ return send_redirect(pcb, SEE_OTHER_RESET_DONE);
+}
+
+/*!
+* \brief Resets the display to it's default configuration.
+*
+* Sets is_display_reset, or is_master_reset_error if the reset failed,
+* clearing the result of any earlier reset.
+*
+* \return bool. true if the display was reset.
+*/
+
+bool Credentials_Webserver::reset_to_factory_defaults(void)
+{
+ bool result = false;
+
+ is_display_reset = false;
+ is_master_reset_error = false;
+
+// *** Outstanding Work ***
+// result = master_reset(); // Main display reset function.
+ result = true;  // *** Test ***
+
+ if (result == true)
  {
   is_display_reset = true;
 
   new_ssid   = ssid;
   new_pass   = pass;
   new_server = server;
+  invalidate_pages();
  }
  else
  {
   is_master_reset_error = true;
  }
- 
+
+ return result;
+}
+
+/*!
+* \brief Sends the master reset result page to the client.
+*
+* Displays page indicating display was indeed reset, otherwise page
+* informing user the display was NOT reset. The result is shown once;
+* without a reset since, a refresh or a later visit is sent to the home
+* page.
+*
+* \param pcb Pointer to the TCP protocol control block of the socket.
+* \return err_t. If < 0, an error occurred.
+*/
+
+err_t Credentials_Webserver::handle_reset_done_page(struct tcp_pcb *pcb)
+{
+ if (!pcb)
+  return ERR_ARG;
+
  if (is_master_reset_error == true) // Show display failed to reset page.
  {
-  web_page_str = web_page_header;
-  web_page_str = web_page_str + "<body>" + HEADER4 + TITLE1;
-  web_page_str = web_page_str + "<p>Unable to reset the display to<br>factory defaults</p>";
-  web_page_str = web_page_str + FORM1 + BUTTON1 + "formaction=\"/setup/home\" value=\"OK\"></form>";
-  web_page_str = web_page_str + web_page_footer;
-
-  err = send_page(pcb, (char*)web_page_str.c_str(), web_page_str.length());
+  web_page = WEB_PAGE_HEADER;
+  web_page += "<body>" HEADER_ALERT TITLE1;
+  web_page += "<p>Unable to reset the display to<br>factory defaults</p>";
+  web_page += LINK1 "\"/setup/home\">OK</a>";
+  web_page += WEB_PAGE_FOOTER;
  }
  else if (is_display_reset == true) // Show Display reset page.
  {
-  web_page_str = web_page_header;
-  web_page_str = web_page_str + "<body> " + HEADER4 + TITLE1;
-  web_page_str = web_page_str + "<p>Display reset to factory defaults</p>";
-  web_page_str = web_page_str + FORM1 + BUTTON1 + "formaction=\"/setup/home\" value=\"OK\"></form>";
-  web_page_str = web_page_str + web_page_footer;
-
-  err = send_page(pcb, (char*)web_page_str.c_str(), web_page_str.length());
+  web_page = WEB_PAGE_HEADER;
+  web_page += "<body> " HEADER_ALERT TITLE1;
+  web_page += "<p>Display reset to factory defaults</p>";
+  web_page += LINK1 "\"/setup/home\">OK</a>";
+  web_page += WEB_PAGE_FOOTER;
  }
- 
+ else
+ {
+  return send_redirect(pcb, SEE_OTHER_HOME);
+ }
+
+ err_t err = send_web_page(pcb, PAGE_NOT_CACHED);
+
+ is_display_reset = false;
+ is_master_reset_error = false;
+
  return err;
 }
 
@@ -644,7 +940,7 @@ err_t Credentials_Webserver::handle_reset_confirmed_page(struct tcp_pcb *pcb)
 * Set the globals ssid, pass and server, writing them to the file system.
 *
 * If any argument is absent, or incorrect, display warning page with 
-* relevant message.
+* relevant message, otherwise redirect to the home page.
 *
 * \param pcb Pointer to the TCP protocol control block of the socket.
 * \param req HTTP request from client.
@@ -655,6 +951,8 @@ err_t Credentials_Webserver::handle_reset_confirmed_page(struct tcp_pcb *pcb)
 err_t Credentials_Webserver::handle_image_server_credentials_page(struct tcp_pcb *pcb, char *req, int rlen)
 {
  char *data;
+ const char *value;
+ int value_len;
  int len;
 
  bool is_data_changed = false;
@@ -680,14 +978,17 @@ err_t Credentials_Webserver::handle_image_server_credentials_page(struct tcp_pcb
 
 // Allow for zero length ssid and password. They may have been reset.
 
- new_ssid   = extract_argument(data, len, NETWORK_NAME_ARGUMENT);
- new_pass   = extract_argument(data, len, PASSWORD_ARGUMENT);
- new_server = extract_argument(data, len, SERVER_URL_ARGUMENT);
+ value_len = extract_argument(data, len, NETWORK_NAME_ARGUMENT, &value);
+ new_ssid.assign(value, value_len);
+ value_len = extract_argument(data, len, PASSWORD_ARGUMENT, &value);
+ new_pass.assign(value, value_len);
+ value_len = extract_argument(data, len, SERVER_URL_ARGUMENT, &value);
+ new_server.assign(value, value_len);
 
  memset(req, 0, rlen);  // Clear request buffer.
+ invalidate_pages();
 
- log_text = "\n SSID:       " + new_ssid + "\n Password:   " + new_pass + "s\n Server URL: " + new_server + "\n";
- log->print_message(log_text);
+ LOG_DEBUG(log, WIFI_CREDENTIALS_RECEIVED, new_ssid.length(), new_server.length());
 
  is_ssid_present_and_correct = check_wifi_ssid_format();
 
@@ -695,7 +996,7 @@ err_t Credentials_Webserver::handle_image_server_credentials_page(struct tcp_pcb
  {
   if (new_ssid != ssid)
   {
-   sh->set_wifi_ssid(new_ssid);
+   sh->set_wifi_ssid(new_ssid.c_str());
    ssid = new_ssid;
    is_data_changed = true;
   }
@@ -711,7 +1012,7 @@ err_t Credentials_Webserver::handle_image_server_credentials_page(struct tcp_pcb
  {
   if (pass != new_pass)
   {
-   sh->set_wifi_password(new_pass);
+   sh->set_wifi_password(new_pass.c_str());
    pass = new_pass;
    is_data_changed = true;
   }
@@ -727,7 +1028,7 @@ err_t Credentials_Webserver::handle_image_server_credentials_page(struct tcp_pcb
  {
   if (server != new_server)
   {
-   sh->set_image_server_url(new_server);
+   sh->set_image_server_url(new_server.c_str());
    server = new_server;
    is_data_changed = true;
   }
@@ -737,186 +1038,734 @@ err_t Credentials_Webserver::handle_image_server_credentials_page(struct tcp_pcb
   is_server_error = true;
  }
 
- // Set EPD Status.
+ // Set EPD Status.
+
+ if (check_fields() == true)
+ {
+  if (sh->get_epd_status() != EPD_STORE_CREDENTIALS_SET)
+  {
+   sh->set_epd_status(EPD_STORE_CREDENTIALS_SET);
+   is_data_changed = true;
+  }
+ }
+ else
+ {
+  if (sh->get_epd_status() != EPD_STORE_SETTING_CREDENTIALS)
+  {
+   sh->set_epd_status(EPD_STORE_SETTING_CREDENTIALS);
+   is_data_changed = true;
+  }
+ }
+
+ // User entered data has changed - write it to flash.
+
+ if ((is_data_changed == true) && 
+     (is_ssid_error == false) && 
+     (is_password_error == false) && 
+     (is_server_error == false))
+ {
+  if (sh->write_data_to_store() == SH_OK)
+  {
+   LOG_INFO(log, WIFI_CREDENTIALS_UPDATED, 0, 0);
+  }
+  else
+  {
+   LOG_ERROR(log, FLASH_WRITE_ERR, 0, 0);
+   return handle_error_message_page(pcb, STORAGE_ERROR, "/setup/imageserver");
+  }
+ }
+ else if (is_ssid_error == true)
+ {
+  return handle_error_message_page(pcb, SSID_ERROR, "/setup/imageserver");
+ }
+ else if (is_password_error == true)
+ {
+  return handle_error_message_page(pcb, PASS_ERROR, "/setup/imageserver");
+ }
+ else if (is_server_error == true)
+ {
+  return handle_error_message_page(pcb, URL_ERROR, "/setup/imageserver");
+ }
+
+ return send_redirect(pcb, SEE_OTHER_HOME);
+}
+
+/*!
+* \brief Processes user request to reset (clear) credentials.
+*
+* Sets credentials to empty strings.
+* Redirects to the image server credentials page.
+*
+* \param pcb Pointer to the TCP protocol control block of the socket.
+* \return err_t. If < 0, an error occurred.
+*/
+
+err_t Credentials_Webserver::handle_reset_image_server_credentials_page(struct tcp_pcb *pcb)
+{
+ if (!pcb)
+  return ERR_ARG;
+
+ new_ssid   = "";
+ new_pass   = "";
+ new_server = "";
+ invalidate_pages();
+
+ return send_redirect(pcb, SEE_OTHER_IMAGE_SERVER);
+}
+
+/*!
+* \brief Processes user request to cancel credentials.
+*
+* Returns credentials to previous (saved) values.
+* Redirects to the home page.
+*
+* \param pcb Pointer to the TCP protocol control block of the socket.
+* \return err_t. If < 0, an error occurred.
+*/
+
+err_t Credentials_Webserver::handle_cancel_image_server_credentials_page(struct tcp_pcb *pcb)
+{
+ if (!pcb)
+  return ERR_ARG;
+
+ new_ssid   = ssid;
+ new_pass   = pass;
+ new_server = server;
+ invalidate_pages();
+
+ return send_redirect(pcb, SEE_OTHER_HOME);
+}
+
+/*!
+* \brief Sends enter display mode page to client.
+*
+* Displays button allowing user to exit display configuration mode.
+*
+* \param pcb Pointer to the TCP protocol control block of the socket.
+* \return err_t. If < 0, an error occurred.
+*/
+
+err_t Credentials_Webserver::handle_change_display_mode_page(struct tcp_pcb *pcb) 
+{
+ if (!pcb)
+  return ERR_ARG;
+
+ int slot = page_cache.find(PAGE_DISPLAY_MODE, page_generation);
+
+ if (slot != PAGE_CACHE_NONE)
+  return send_cached_page(pcb, PAGE_DISPLAY_MODE, slot);
+
+ web_page = WEB_PAGE_HEADER;
+ web_page += "<body> " HEADER_PANEL TITLE1 DISPLAY_MODE_TITLE;
+ web_page += "<p>Press OK to enter display mode.</p>";
+ web_page += FORM1 BUTTON1 "formaction=\"/setup/displaymode\" value=\"OK\">&nbsp;&nbsp";
+ web_page += LINK1 "\"/setup/home\">Cancel</a></form>";
+ web_page += WEB_PAGE_FOOTER;
+
+ return send_web_page(pcb, PAGE_DISPLAY_MODE);
+}
+
+/*!
+* \brief Exits display configuration mode.
+*
+* Sends exiting configuration message to the client.
+* Stops the web server (closes the TCP socket connection).
+* Changes system state from configuring display to display.
+*
+* Not redirected: the server is gone before the client could GET
+* another page.
+*
+* \param pcb Pointer to the TCP protocol control block of the socket.
+* \return err_t. If < 0, an error occurred.
+*/
+
+err_t Credentials_Webserver::handle_setup_display_mode_page(struct tcp_pcb *pcb) 
+{
+ err_t err;
+ if (!pcb)
+  return ERR_ARG;
+
+ web_page = WEB_PAGE_HEADER;
+ web_page += "<body> " HEADER_PANEL TITLE1;
+ web_page += "<p>Exiting configuration...</p>";
+ web_page += WEB_PAGE_FOOTER;
+
+ err = send_web_page(pcb, PAGE_NOT_CACHED);
+
+ stop_webserver(pcb);
+ is_configuring = false;
+
+ return err;
+}
+
+/*!
+* \brief Sends error page to client.
+*
+* Displays the error page and a button that navigates to the web directory (page).
+*
+* \param pcb Pointer to the TCP protocol control block of the socket.
+* \param error_message Message to be displayed on the client.
+* \param web_directory Web page to navigate to.
+* \return err_t. If < 0, an error occurred.
+*/
+
+err_t Credentials_Webserver::handle_error_message_page(struct tcp_pcb *pcb, const char *error_message, const char *web_directory)
+{
+ if ((!pcb) || (!error_message) || (!web_directory) || (error_message[0] == 0) || (web_directory[0] == 0))
+  return ERR_ARG;
+
+ web_page = WEB_PAGE_HEADER;
+ web_page += "<body> " HEADER_ALERT TITLE1 ERROR_TITLE;
+ web_page += "<p>";
+ web_page += error_message;
+ web_page += "</p>";
+ web_page += LINK1 "\"";
+ web_page += web_directory;
+ web_page += "\">OK</a>";
+ web_page += WEB_PAGE_FOOTER;
+
+ return send_web_page(pcb, PAGE_NOT_CACHED);
+}
+
+/*!
+* \brief Sends the settings as JSON to the client.
+*
+* \param pcb Pointer to the TCP protocol control block of the socket.
+* \return err_t. If < 0, an error occurred.
+*/
+
+err_t Credentials_Webserver::handle_config_get(struct tcp_pcb *pcb)
+{
+ if (!pcb)
+  return ERR_ARG;
+
+ return send_config(pcb, HTTP_STATUS_OK, NULL);
+}
+
+/*!
+* \brief Replaces the settings with those in a JSON object.
+*
+* {"ssid":"...","password":"...","url":"..."}, all three required. Each
+* must be valid, or empty to clear it, as for the form. "status" and
+* "id", as GET returns them, may be included but are ignored: they are
+* not settings. Other members are an error.
+*
+* Every value is checked before anything is changed, and the store is
+* written once. If the write fails the previous settings are put back,
+* in flash too, so the device is left as it was. Nothing is written if
+* the settings are unchanged.
+*
+* The request must arrive in one segment, as for the forms. The URL is
+* decoded into web_page, which is free until the response is built.
+*
+* \param pcb Pointer to the TCP protocol control block of the socket.
+* \param req HTTP request from client.
+* \param rlen Length of HTTP request.
+* \return err_t. If < 0, an error occurred.
+*/
+
+err_t Credentials_Webserver::handle_config_put(struct tcp_pcb *pcb, char *req, int rlen)
+{
+ char put_ssid[MAX_SSID_LENGTH + 1];
+ char put_pass[MAX_PASSWORD_LENGTH + 1];
+ char *put_server = web_page.data();
+ int ssid_len = -1;
+ int pass_len = -1;
+ int server_len = -1;
+ const char *error = NULL;
+ struct json_member member;
+ int cursor = 0;
+ int result = JSON_ERROR;
+ int body;
+
+ if ((!pcb) || (!req) || (rlen > MAX_CONTENTS_LENGTH))
+  return ERR_ARG;
+
+ body = find_http_body(req, rlen);
+
+ if (body < 0)
+  return send_config(pcb, HTTP_STATUS_BAD_REQUEST, CONFIG_ERROR_JSON);
+
+// Parse, decoding each value into its own buffer. A value that does not
+// fit is too long, and invalid.
+
+ while ((error == NULL) && ((result = json_next_member(&req[body], rlen - body, &cursor, &member)) == JSON_MEMBER))
+ {
+  if ((json_name_is(&member, "ssid") == true) && (member.type == JSON_STRING))
+  {
+   ssid_len = json_unescape(put_ssid, sizeof(put_ssid), member.value, member.value_len);
+   if (ssid_len < 0) error = CONFIG_ERROR_SSID;
+  }
+  else if ((json_name_is(&member, "password") == true) && (member.type == JSON_STRING))
+  {
+   pass_len = json_unescape(put_pass, sizeof(put_pass), member.value, member.value_len);
+   if (pass_len < 0) error = CONFIG_ERROR_PASS;
+  }
+  else if ((json_name_is(&member, "url") == true) && (member.type == JSON_STRING))
+  {
+   server_len = json_unescape(put_server, PAGE_BUFFER_SIZE, member.value, member.value_len);
+   if (server_len < 0) error = CONFIG_ERROR_URL;
+  }
+  else if ((json_name_is(&member, "status") == false) && (json_name_is(&member, "id") == false))
+  {
+   error = CONFIG_ERROR_JSON;
+  }
+ }
+
+ memset(req, 0, rlen);  // Clear request buffer.
+
+ if ((error == NULL) && (result == JSON_ERROR))
+  error = CONFIG_ERROR_JSON;
+
+// Validate all of them before changing anything.
+
+ bool is_ssid_valid = (error == NULL) && (ssid_len > 0) && (is_valid_wifi_ssid(put_ssid, ssid_len) == true);
+ bool is_pass_valid = (error == NULL) && (pass_len > 0) && (is_valid_wifi_password(put_pass, pass_len) == true);
+ bool is_server_valid = (error == NULL) && (server_len > 0) && (is_valid_image_server_url(put_server, server_len) == true);
+
+ if (error == NULL)
+ {
+  if ((is_ssid_valid == false) && (ssid_len != 0))  // Invalid, or missing (-1).
+   error = CONFIG_ERROR_SSID;
+  else if ((is_pass_valid == false) && (pass_len != 0))
+   error = CONFIG_ERROR_PASS;
+  else if ((is_server_valid == false) && (server_len != 0))
+   error = CONFIG_ERROR_URL;
+ }
+
+ if (error != NULL)
+ {
+  memset(put_pass, 0, sizeof(put_pass));
+  return send_config(pcb, HTTP_STATUS_BAD_REQUEST, error);
+ }
+
+// Commit.
+
+ uint8_t old_status = sh->get_epd_status();
+ uint8_t new_status = ((is_ssid_valid == true) && (is_pass_valid == true) && (is_server_valid == true)) ?
+                      EPD_STORE_CREDENTIALS_SET : EPD_STORE_SETTING_CREDENTIALS;
+
+ if ((strcmp(put_ssid, ssid.c_str()) != 0) || (strcmp(put_pass, pass.c_str()) != 0) ||
+     (strcmp(put_server, server.c_str()) != 0) || (new_status != old_status))
+ {
+  sh->set_wifi_ssid(put_ssid);
+  sh->set_wifi_password(put_pass);
+  sh->set_image_server_url(put_server);
+  sh->set_epd_status(new_status);
+
+  if (sh->write_data_to_store() != SH_OK)
+  {
+   LOG_ERROR(log, FLASH_WRITE_ERR, 0, 0);
+
+   sh->set_wifi_ssid(ssid.c_str());
+   sh->set_wifi_password(pass.c_str());
+   sh->set_image_server_url(server.c_str());
+   sh->set_epd_status(old_status);
+   sh->write_data_to_store();  // The sector may have been erased.
+
+   memset(put_pass, 0, sizeof(put_pass));
+   return send_config(pcb, HTTP_STATUS_SERVER_ERROR, CONFIG_ERROR_STORAGE);
+  }
+
+  LOG_INFO(log, WIFI_CREDENTIALS_UPDATED, 0, 0);
+ }
+
+ ssid = put_ssid;
+ pass = put_pass;
+ server = put_server;
+ new_ssid = ssid;
+ new_pass = pass;
+ new_server = server;
+ memset(put_pass, 0, sizeof(put_pass));
+
+ is_ssid_present_and_correct = is_ssid_valid;
+ is_password_present_and_correct = is_pass_valid;
+ is_server_url_present_and_correct = is_server_valid;
+ invalidate_pages();
+
+ return send_config(pcb, HTTP_STATUS_OK, NULL);
+}
+
+/*!
+* \brief Sends the settings, or an error, as JSON to the client.
+*
+* {"ssid":"...","password":"...","url":"...","status":"set","id":"..."},
+* the saved settings, the storage state and the display ID, or
+* {"error":"ssid"} naming what was wrong with a request.
+*
+* \param pcb Pointer to the TCP protocol control block of the socket.
+* \param status HTTP_STATUS_OK ...
+* \param error CONFIG_ERROR_..., or NULL for the settings.
+* \return err_t. If < 0, an error occurred.
+*/
+
+err_t Credentials_Webserver::send_config(struct tcp_pcb *pcb, int status, const char *error)
+{
+ struct json_writer writer;
+ uint8_t epd_status = sh->get_epd_status();
+ const char *status_name = (epd_status <= EPD_STORE_CREDENTIALS_SET) ? epd_status_names[epd_status] : "unknown";
+ int len;
+
+ json_begin_object(&writer, web_page.data(), PAGE_BUFFER_SIZE);
+
+ if (error != NULL)
+ {
+  json_add_string(&writer, "error", error, strlen(error));
+ }
+ else
+ {
+  json_add_string(&writer, "ssid", ssid.c_str(), ssid.length());
+  json_add_string(&writer, "password", pass.c_str(), pass.length());
+  json_add_string(&writer, "url", server.c_str(), server.length());
+  json_add_string(&writer, "status", status_name, strlen(status_name));
+  json_add_string(&writer, "id", DEVICE_LABEL_ID, strlen(DEVICE_LABEL_ID));
+ }
+
+ len = json_end_object(&writer);
+
+ if (len < 0)
+ {
+  LOG_ERROR(log, PAGE_BUFFER_ERR, PAGE_BUFFER_SIZE, 0);
+  stop_webserver(pcb);
+  return ERR_MEM;
+ }
+
+ web_page.set_length(len);
+
+ return send_page(pcb, status, CONTENT_TYPE_JSON, CACHE_CONTROL_NO_STORE, web_page.c_str(), web_page.length());
+}
+
+/*!
+* \brief Resets the display to factory defaults, for the API.
+*
+* \param pcb Pointer to the TCP protocol control block of the socket.
+* \return err_t. If < 0, an error occurred.
+*/
+
+err_t Credentials_Webserver::handle_config_master_reset(struct tcp_pcb *pcb)
+{
+ if (!pcb)
+  return ERR_ARG;
+
+ bool is_reset = reset_to_factory_defaults();
+
+ is_display_reset = false;       // The result is in this reply, not for /setup/resetdone.
+ is_master_reset_error = false;
+
+ if (is_reset == false)
+  return send_config(pcb, HTTP_STATUS_SERVER_ERROR, CONFIG_ERROR_RESET);
+
+ return send_config(pcb, HTTP_STATUS_OK, NULL);
+}
+
+/*!
+* \brief Exits display configuration mode, for the API.
+*
+* As handle_setup_display_mode_page(), with a JSON answer.
+*
+* \param pcb Pointer to the TCP protocol control block of the socket.
+* \return err_t. If < 0, an error occurred.
+*/
+
+err_t Credentials_Webserver::handle_config_display_mode(struct tcp_pcb *pcb)
+{
+ err_t err;
+
+ if (!pcb)
+  return ERR_ARG;
+
+ err = send_page(pcb, HTTP_STATUS_OK, CONTENT_TYPE_JSON, CACHE_CONTROL_NO_STORE,
+                 CONFIG_DISPLAY_MODE_JSON, strlen(CONFIG_DISPLAY_MODE_JSON));
+
+ if (err == ERR_OK)
+  stop_webserver(pcb);  // send_page() closed it otherwise.
+
+ is_configuring = false;
+
+ return err;
+}
+
+/*!
+* \brief Sends the single page UI to the client.
+*
+* The bundle is gzipped at build time and goes from flash without a
+* copy. It is revalidated, like the pages, so a new firmware's UI is
+* picked up. A client that does not accept gzip gets the HTML pages.
+*
+* \param pcb Pointer to the TCP protocol control block of the socket.
+* \param req HTTP request from client.
+* \param rlen Length of HTTP request.
+* \return err_t. If < 0, an error occurred.
+*/
+
+err_t Credentials_Webserver::handle_app_page(struct tcp_pcb *pcb, const char *req, int rlen)
+{
+ err_t err;
+ const char *encodings;
+ int encodings_len;
+ char tag[HTTP_ETAG_SIZE];
+ Fixed_String<HTTP_HEADER_BUFFER_SIZE> http_header;
+
+ if ((!pcb) || (!req))
+  return ERR_ARG;
+
+ encodings_len = find_http_header(req, rlen, "Accept-Encoding", &encodings);
+
+ if (is_http_token_listed(encodings, encodings_len, "gzip") == false)
+  return send_redirect(pcb, SEE_OTHER_HOME);
+
+ if (is_not_modified(ui_bundle_etag) == true)
+ {
+  err = send_not_modified(pcb, CACHE_CONTROL_REVALIDATE, ui_bundle_etag);
+ }
+ else
+ {
+  format_etag(tag, ui_bundle_etag);
+  http_header.append_format("HTTP/1.1 200 OK\r\nContent-Type: " CONTENT_TYPE_HTML "\r\nContent-Encoding: gzip\r\nVary: Accept-Encoding\r\n"
+                            "Cache-Control: " CACHE_CONTROL_REVALIDATE "\r\nETag: %s\r\nContent-length: %d\r\nConnection: close\r\n\r\n",
+                            tag, (int)sizeof(ui_bundle));
+
+  err = send_data(pcb, http_header.c_str(), http_header.length(), TCP_WRITE_FLAG_COPY);
+
+  if (err == ERR_OK)
+   err = send_data(pcb, (const char *)ui_bundle, sizeof(ui_bundle), 0);  // Flash, never changes.
+ }
+
+ if (err != ERR_OK)
+  stop_webserver(pcb);
+
+ return err;
+}
+
+/*!
+* \brief Starts a streamed response.
+*
+* The body is produced a part at a time into stream_chunk and sent as
+* the send buffer allows, continuing from http_sent_callback().
+* There is no Content-length, the connection is closed at the end.
+*
+* \param pcb Pointer to the TCP protocol control block of the socket.
+* \param kind STREAM_METRICS, STREAM_TRACE, STREAM_MEMORY or STREAM_PROFILE.
+* \param http_header Status line and headers.
+* \return err_t. If < 0, an error occurred.
+*/
+
+err_t Credentials_Webserver::start_stream(struct tcp_pcb *pcb, int kind, const char *http_header)
+{
+ err_t err;
+
+ if ((stream_pcb != NULL) && (stream_pcb != pcb))
+  stop_webserver(stream_pcb);  // Abandon the previous stream.
+
+ stream_pcb = pcb;
+ stream_arg = pcb->callback_arg;
+ stream_kind = kind;
+ stream_cursor = 0;
+
+ err = send_data(pcb, http_header, strlen(http_header), TCP_WRITE_FLAG_COPY);
+
+ if (err != ERR_OK)
+ {
+  stop_webserver(pcb);
+  return err;
+ }
+
+ return send_stream_chunk(pcb);
+}
+
+/*!
+* \brief Sends the next part of the streamed response.
+*
+* Closes the connection once everything has been sent, or if the next
+* part can never fit STREAM_CHUNK_SIZE.
+*
+* \param pcb Pointer to the TCP protocol control block of the socket.
+* \return err_t. If < 0, an error occurred.
+*/
+
+err_t Credentials_Webserver::send_stream_chunk(struct tcp_pcb *pcb)
+{
+ err_t err = ERR_OK;
+ int size = tcp_sndbuf(pcb);
+ int len = 0;
+ bool is_done = true;
+
+ if (size > STREAM_CHUNK_SIZE)
+  size = STREAM_CHUNK_SIZE;
 
- if (check_fields() == true)
+ if (stream_kind == STREAM_METRICS)
  {
-  if (sh->get_epd_status() != EPD_STORE_CREDENTIALS_SET)
-  {
-   sh->set_epd_status(EPD_STORE_CREDENTIALS_SET);
-   is_data_changed = true;
-  }
+  len = metrics_render(stream_chunk, size, &stream_cursor);
+  is_done = (stream_cursor == METRICS_RENDER_DONE);
  }
- else
+ else if (stream_kind == STREAM_MEMORY)
  {
-  if (sh->get_epd_status() != EPD_STORE_SETTING_CREDENTIALS)
-  {
-   sh->set_epd_status(EPD_STORE_SETTING_CREDENTIALS);
-   is_data_changed = true;
-  }
+  len = memory_stats_render(stream_chunk, size, &stream_cursor);
+  is_done = (stream_cursor == MEMORY_STATS_RENDER_DONE);
  }
-
- // User entered data has changed - write it to flash.
-
- if ((is_data_changed == true) && 
-     (is_ssid_error == false) && 
-     (is_password_error == false) && 
-     (is_server_error == false))
+#if TRACE_ENABLED
+ else if (stream_kind == STREAM_TRACE)
  {
-  log->print_message("Writing credentials to data store.\n");  // *** Debug ***
-
-  sh->write_data_to_store();
+  len = trace_dump(stream_chunk, size, &stream_cursor);
+  is_done = (stream_cursor == TRACE_DUMP_DONE);
  }
- else if (is_ssid_error == true)
+#endif
+#if PC_SAMPLER_ENABLED
+ else if (stream_kind == STREAM_PROFILE)
  {
-  return handle_error_message_page(pcb, SSID_ERROR, "/setup/imageserver");
+  len = pc_sampler_render(stream_chunk, size, &stream_cursor);
+  is_done = (stream_cursor == PC_SAMPLER_RENDER_DONE);
  }
- else if (is_password_error == true)
+#endif
+
+ if (len > 0)
  {
-  return handle_error_message_page(pcb, PASS_ERROR, "/setup/imageserver");
+  err = send_data(pcb, stream_chunk, len, TCP_WRITE_FLAG_COPY);
  }
- else if (is_server_error == true)
+ else if ((is_done == false) && (size == STREAM_CHUNK_SIZE))
  {
-  return handle_error_message_page(pcb, URL_ERROR, "/setup/imageserver");
+  err = ERR_MEM;  // A single line longer than a chunk, it will never fit.
+ }
+
+ if ((err != ERR_OK) || (is_done == true))
+ {
+  stop_webserver(pcb);
  }
 
- return handle_home_page(pcb);
+ return err;
 }
 
 /*!
-* \brief Processes user request to reset (clear) credentials.
+* \brief Streams the metrics to the client.
 *
-* Sets credentials to empty strings.
-* Re-displays image server credentials page.
+* Prometheus text format, see metrics.h.
 *
 * \param pcb Pointer to the TCP protocol control block of the socket.
 * \return err_t. If < 0, an error occurred.
 */
 
-err_t Credentials_Webserver::handle_reset_image_server_credentials_page(struct tcp_pcb *pcb)
+err_t Credentials_Webserver::handle_metrics_page(struct tcp_pcb *pcb)
 {
  if (!pcb)
   return ERR_ARG;
 
- new_ssid   = "";
- new_pass   = "";
- new_server = "";
+ memory_stats_update_metrics();
 
- return handle_image_server_page(pcb);
+ return start_stream(pcb, STREAM_METRICS, METRICS_HTTP_HEADER);
 }
 
 /*!
-* \brief Processes user request to cancel credentials.
+* \brief Streams the memory report to the client.
 *
-* Returns credentials to previous (saved) values.
-* Returns to home page.
+* Text table, see memory_stats.h.
 *
 * \param pcb Pointer to the TCP protocol control block of the socket.
 * \return err_t. If < 0, an error occurred.
 */
 
-err_t Credentials_Webserver::handle_cancel_image_server_credentials_page(struct tcp_pcb *pcb)
+err_t Credentials_Webserver::handle_memory_page(struct tcp_pcb *pcb)
 {
  if (!pcb)
   return ERR_ARG;
 
- new_ssid   = ssid;
- new_pass   = pass;
- new_server = server;
-
- return handle_home_page(pcb);
+ return start_stream(pcb, STREAM_MEMORY, TEXT_HTTP_HEADER);
 }
 
 /*!
-* \brief Sends enter display mode page to client.
+* \brief Streams the trace ring to the client.
 *
-* Displays button allowing user to exit display configuration mode.
+* Binary dump, see trace.h; convert it with tools/trace_to_chrome.py.
+* Not found unless the firmware is built with CWS_TRACE.
 *
 * \param pcb Pointer to the TCP protocol control block of the socket.
 * \return err_t. If < 0, an error occurred.
 */
 
-err_t Credentials_Webserver::handle_change_display_mode_page(struct tcp_pcb *pcb) 
+err_t Credentials_Webserver::handle_trace_page(struct tcp_pcb *pcb)
 {
- string web_page_str;
-
  if (!pcb)
   return ERR_ARG;
 
- web_page_str = web_page_header;
- web_page_str = web_page_str + "<body> " + HEADER8 + TITLE1 + DISPLAY_MODE_TITLE;
- web_page_str = web_page_str + "<p>Press OK to enter display mode.</p>";
- web_page_str = web_page_str + FORM1 + BUTTON1 + "formaction=\"/setup/displaymode\" value=\"OK\">&nbsp;&nbsp";
- web_page_str = web_page_str + BUTTON1 + "formaction=\"/setup/home\" value=\"Cancel\"></form>";
- web_page_str = web_page_str + web_page_footer;
-
- return send_page(pcb, (char*)web_page_str.c_str(), web_page_str.length());
+#if TRACE_ENABLED
+ return start_stream(pcb, STREAM_TRACE, TRACE_HTTP_HEADER);
+#else
+ return handle_page_not_found(pcb);
+#endif
 }
 
 /*!
-* \brief Exits display configuration mode.
+* \brief Streams the PC sampling profile to the client.
 *
-* Sends exiting configuration message to the client.
-* Stops the web server (closes the TCP socket connection).
-* Changes system state from configuring display to display.
+* Text table, see pc_sampler.h; symbolize it with tools/pc_profile.py.
+* Not found unless the firmware is built with CWS_PC_SAMPLER.
 *
 * \param pcb Pointer to the TCP protocol control block of the socket.
 * \return err_t. If < 0, an error occurred.
 */
 
-err_t Credentials_Webserver::handle_setup_display_mode_page(struct tcp_pcb *pcb) 
+err_t Credentials_Webserver::handle_profile_page(struct tcp_pcb *pcb)
 {
- err_t err;
- string web_page_str;
-
  if (!pcb)
   return ERR_ARG;
 
- web_page_str = web_page_header;
- web_page_str = web_page_str + "<body> " + HEADER7 + TITLE1;
- web_page_str = web_page_str + "<p>Exiting configuration...</p>";
- web_page_str = web_page_str + web_page_footer;
-
- err = send_page(pcb, (char*)web_page_str.c_str(), web_page_str.length());
-
- stop_webserver(pcb);
- is_configuring = false;
-
- return err;
+#if PC_SAMPLER_ENABLED
+ return start_stream(pcb, STREAM_PROFILE, TEXT_HTTP_HEADER);
+#else
+ return handle_page_not_found(pcb);
+#endif
 }
 
 /*!
-* \brief Sends error page to client.
-*
-* Displays the error page and a button that navigates to the web directory (page).
+* \brief Starts a PC sampling window and returns the (empty) profile.
 *
 * \param pcb Pointer to the TCP protocol control block of the socket.
-* \param error_message Message to be displayed on the client.
-* \param web_directory Web page to navigate to.
+* \param query Request query, "ms=N&hz=N", either optional, or "".
 * \return err_t. If < 0, an error occurred.
 */
 
-err_t Credentials_Webserver::handle_error_message_page(struct tcp_pcb *pcb, string error_message, string web_directory)
+err_t Credentials_Webserver::handle_profile_start_page(struct tcp_pcb *pcb, const char *query)
 {
- string web_page_str;
-
- if ((!pcb) || (error_message.empty()) || (web_directory.empty()))
+ if ((!pcb) || (!query))
   return ERR_ARG;
 
- web_page_str = web_page_header;
- web_page_str = web_page_str + "<body> " + HEADER6 + TITLE1 + ERROR_TITLE;
- web_page_str = web_page_str + "<p>" + error_message + "</p>";
- web_page_str = web_page_str + FORM1 + BUTTON1 + "formaction=\"" + web_directory + "\" value=\"OK\">";
- web_page_str = web_page_str + web_page_footer;
+#if PC_SAMPLER_ENABLED
+ const char *value;
+ uint32_t window_ms = 0;
+ uint32_t rate_hz = 0;
+ int len = strlen(query);
+
+ if (extract_argument(query, len, "ms", &value) > 0)
+  window_ms = strtoul(value, NULL, 10);
+
+ if (extract_argument(query, len, "hz", &value) > 0)
+  rate_hz = strtoul(value, NULL, 10);
 
- return send_page(pcb, (char*)web_page_str.c_str(), web_page_str.length());
+ if (pc_sampler_start(window_ms, rate_hz) != 0)
+  return handle_error_message_page(pcb, "No free hardware alarm for the sampler.", "/setup/home");
+
+ return handle_profile_page(pcb);
+#else
+ return handle_page_not_found(pcb);
+#endif
+}
+
+/*!
+* \brief Counts a request in cws_http_requests_total.
+*
+* \param route ROUTE_GET_HOME ...
+*/
+
+void RAM_FUNC(Credentials_Webserver::count_request)(int route)
+{
+ metrics_inc(request_metrics[route]);
 }
 
 /*!
 * \brief Handles client POST request.
 *
 * Extracts the path from the request and uses it to call the relevant
-* page handler.
+* page handler. Only the requests that change the settings are POSTs,
+* a POST to a page is not found.
 *
 * \param pcb Pointer to the TCP protocol control block of the socket.
 * \param req HTTP request from client.
@@ -924,61 +1773,101 @@ err_t Credentials_Webserver::handle_error_message_page(struct tcp_pcb *pcb, stri
 * \return err_t. If < 0, an error occurred.
 */
 
-err_t Credentials_Webserver::handle_http_post(struct tcp_pcb *pcb, char *req, int rlen)
+err_t RAM_FUNC(Credentials_Webserver::handle_http_post)(struct tcp_pcb *pcb, char *req, int rlen)
 {
  err_t err = ERR_OK;
+ int route;
  char path[MAX_URL_LENGTH];
 
  if ((!pcb) || (!req) || (rlen > MAX_CONTENTS_LENGTH))
   return ERR_ARG;
 
+ TRACE(TRACE_PATH_BEGIN, pcb);
  extract_path(path, req, rlen, HTTP_POST_OFFSET);
+ TRACE(TRACE_PATH_END, pcb);
 
- if (strcmp(path, "setup/imageserver") == 0)
- {
-  err = handle_image_server_page(pcb);
- }
- else if (strcmp(path, "setup/deviceid") == 0)
- {
-  err = handle_device_id_page(pcb);
- }
- else if (strcmp(path, "setup/masterreset") == 0)
- {
-  err = handle_master_reset_page(pcb);
- }
- else if (strcmp(path, "setup/resetconfirmed") == 0)
+ if (strcmp(path, "setup/resetconfirmed") == 0)
  {
+  route = ROUTE_POST_RESET_CONFIRMED;
   err = handle_reset_confirmed_page(pcb);
  }
  else if (strcmp(path, "setup/imageservercredentials") == 0)
  {
+  route = ROUTE_POST_CREDENTIALS;
   err = handle_image_server_credentials_page(pcb, req, rlen);
  }
  else if (strcmp(path, "setup/resetimageservercredentials") == 0)
  {
+  route = ROUTE_POST_RESET_CREDENTIALS;
   err = handle_reset_image_server_credentials_page(pcb);
  }
  else if (strcmp(path, "setup/cancelimageservercredentials") == 0)
  {
+  route = ROUTE_POST_CANCEL_CREDENTIALS;
   err = handle_cancel_image_server_credentials_page(pcb);
  }
- else if (strcmp(path, "setup/display") == 0)
- {
-  err = handle_change_display_mode_page(pcb);
- }
  else if (strcmp(path, "setup/displaymode") == 0)
  {
+  route = ROUTE_POST_DISPLAY_MODE;
   err = handle_setup_display_mode_page(pcb);
  }
- else if (strcmp(path, "setup/home") == 0)
+ else if (strcmp(path, CONFIG_MASTER_RESET_PATH) == 0)
  {
-  err = handle_home_page(pcb);
+  route = ROUTE_POST_CONFIG_MASTER_RESET;
+  err = handle_config_master_reset(pcb);
+ }
+ else if (strcmp(path, CONFIG_DISPLAY_MODE_PATH) == 0)
+ {
+  route = ROUTE_POST_CONFIG_DISPLAY_MODE;
+  err = handle_config_display_mode(pcb);
+ }
+ else
+ {
+  route = ROUTE_POST_OTHER;
+  err = handle_page_not_found(pcb);
+ }
+
+ count_request(route);
+
+ return err;
+}
+
+/*!
+* \brief Handles client PUT request.
+*
+* Extracts the path from the request and uses it to call the relevant
+* handler. Only the provisioning API is a PUT.
+*
+* \param pcb Pointer to the TCP protocol control block of the socket.
+* \param req HTTP request from client.
+* \param rlen Length of HTTP request.
+* \return err_t. If < 0, an error occurred.
+*/
+
+err_t Credentials_Webserver::handle_http_put(struct tcp_pcb *pcb, char *req, int rlen)
+{
+ err_t err;
+ int route;
+ char path[MAX_URL_LENGTH];
+
+ if ((!pcb) || (!req) || (rlen > MAX_CONTENTS_LENGTH))
+  return ERR_ARG;
+
+ extract_path(path, req, rlen, HTTP_PUT_OFFSET);
+
+ if (strcmp(path, CONFIG_API_PATH) == 0)
+ {
+  route = ROUTE_PUT_CONFIG;
+  err = handle_config_put(pcb, req, rlen);
  }
  else
  {
+  route = ROUTE_PUT_OTHER;
   err = handle_page_not_found(pcb);
  }
 
+ count_request(route);
+
  return err;
 }
 
@@ -986,7 +1875,8 @@ err_t Credentials_Webserver::handle_http_post(struct tcp_pcb *pcb, char *req, in
 * \brief Handles client GET request.
 *
 * Extracts the path from the request and uses it to call the relevant
-* page handler.
+* page handler. The If-None-Match header is kept for the page senders,
+* which answer 304 if it names the page's entity tag.
 *
 * \param pcb Pointer to the TCP protocol control block of the socket.
 * \param req HTTP request from client.
@@ -994,52 +1884,126 @@ err_t Credentials_Webserver::handle_http_post(struct tcp_pcb *pcb, char *req, in
 * \return err_t. If < 0, an error occurred.
 */
 
-err_t Credentials_Webserver::handle_http_get(struct tcp_pcb *pcb, const char *req, int rlen)
+err_t RAM_FUNC(Credentials_Webserver::handle_http_get)(struct tcp_pcb *pcb, const char *req, int rlen)
 {
  err_t err = 0;
+ int route;
  char path[MAX_URL_LENGTH];
 
  if ((!pcb) || (!req) || (rlen > MAX_CONTENTS_LENGTH))
   return ERR_ARG;
 
+ TRACE(TRACE_PATH_BEGIN, pcb);
  extract_path(path, req, rlen, HTTP_GET_OFFSET);
+ if_none_match_len = find_http_header(req, rlen, "If-None-Match", &if_none_match);
+ TRACE(TRACE_PATH_END, pcb);
 
 // Use path to determine next step(s).
 
  if (strcmp(path, "setup/home") == 0)
  {
+  route = ROUTE_GET_HOME;
   err = handle_home_page(pcb);
  }
+ else if (strcmp(path, STYLESHEET_PATH) == 0)
+ {
+  route = ROUTE_GET_STYLESHEET;
+  err = handle_stylesheet(pcb);
+ }
+ else if (strcmp(path, "setup/imageserver") == 0)
+ {
+  route = ROUTE_GET_IMAGE_SERVER;
+  err = handle_image_server_page(pcb);
+ }
+ else if (strcmp(path, "setup/deviceid") == 0)
+ {
+  route = ROUTE_GET_DEVICE_ID;
+  err = handle_device_id_page(pcb);
+ }
+ else if (strcmp(path, "setup/masterreset") == 0)
+ {
+  route = ROUTE_GET_MASTER_RESET;
+  err = handle_master_reset_page(pcb);
+ }
+ else if (strcmp(path, "setup/display") == 0)
+ {
+  route = ROUTE_GET_DISPLAY;
+  err = handle_change_display_mode_page(pcb);
+ }
+ else if (strcmp(path, "setup/resetdone") == 0)
+ {
+  route = ROUTE_GET_RESET_DONE;
+  err = handle_reset_done_page(pcb);
+ }
+ else if (strcmp(path, CONFIG_API_PATH) == 0)
+ {
+  route = ROUTE_GET_CONFIG;
+  err = handle_config_get(pcb);
+ }
+ else if (strcmp(path, UI_APP_PATH) == 0)
+ {
+  route = ROUTE_GET_APP;
+  err = handle_app_page(pcb, req, rlen);
+ }
+ else if (is_captive_portal_probe(path) == true)
+ {
+  route = ROUTE_GET_PROBE;
+  err = handle_captive_portal_probe(pcb);
+ }
+ else if (strcmp(path, "metrics") == 0)
+ {
+  route = ROUTE_GET_METRICS;
+  err = handle_metrics_page(pcb);
+ }
+ else if (strcmp(path, "trace") == 0)
+ {
+  route = ROUTE_GET_TRACE;
+  err = handle_trace_page(pcb);
+ }
+ else if (strcmp(path, "memory") == 0)
+ {
+  route = ROUTE_GET_MEMORY;
+  err = handle_memory_page(pcb);
+ }
+ else if (strcmp(path, "profile") == 0)
+ {
+  route = ROUTE_GET_PROFILE;
+  err = handle_profile_page(pcb);
+ }
+ else if ((strncmp(path, "profile/start", 13) == 0) && ((path[13] == '\0') || (path[13] == '?')))
+ {
+  route = ROUTE_GET_PROFILE_START;
+  err = handle_profile_start_page(pcb, (path[13] == '?') ? &path[14] : "");
+ }
  else
  {
+  route = ROUTE_GET_OTHER;
   err = handle_page_not_found(pcb);
  }
 
+ if_none_match_len = 0;  // Points into the request, gone after this.
+
+ count_request(route);
+
  return err;
 }
 
 /*!
-* \brief Decodes HTTP request.
-*
-* Searches for "GET" or "POST" in the request string and returns
-* the request type.
+* \brief Checks for the path of an OS connectivity probe.
 *
-* \param req HTTP request from client.
-* \return http_req_type. [HTTP_GET | HTTP_POST | HTTP_UNKNOWN].
+* \param path Path, as set by extract_path().
+* \return bool. true if path is a probe.
 */
 
-enum http_req_type Credentials_Webserver::decode_http_request(const char *req)
+bool RAM_FUNC(Credentials_Webserver::is_captive_portal_probe)(const char *path)
 {
- char const *get_str  = "GET";
- char const *post_str = "POST";
-
- if (!strncmp(req, get_str, strlen(get_str)))
-  return HTTP_GET;
-
- if (!strncmp(req, post_str, strlen(post_str)))
-  return HTTP_POST;
+ for (const char *probe : captive_portal_probes)
+ {
+  if (strcmp(path, probe) == 0)
+   return true;
+ }
 
- return HTTP_UNKNOWN;
+ return false;
 }
 
 /*!
@@ -1051,23 +2015,36 @@ enum http_req_type Credentials_Webserver::decode_http_request(const char *req)
 * \return err_t. If < 0, an error occurred.
 */
 
-err_t Credentials_Webserver::generate_response(struct tcp_pcb *pcb, char *http_req, int http_req_len)
+err_t RAM_FUNC(Credentials_Webserver::generate_response)(struct tcp_pcb *pcb, char *http_req, int http_req_len)
 {
  if ((!pcb) || (!http_req) || (http_req_len > MAX_CONTENTS_LENGTH))
   return ERR_ARG;
 
+ err_t err;
+
+ TRACE(TRACE_RESPONSE_BEGIN, pcb);
+
  enum http_req_type request_type = decode_http_request(http_req);
 
  switch (request_type) 
  {
   case HTTP_GET:
-       return handle_http_get(pcb, http_req, http_req_len);
+       err = handle_http_get(pcb, http_req, http_req_len);
+       break;
   case HTTP_POST:
-       return handle_http_post(pcb, http_req, http_req_len);
+       err = handle_http_post(pcb, http_req, http_req_len);
+       break;
+  case HTTP_PUT:
+       err = handle_http_put(pcb, http_req, http_req_len);
+       break;
   default:
-       printf("request_type != GET|POST\r\n");
-       return -1;
+       log->print_message("request_type != GET|POST|PUT");
+       err = -1;
  }
+
+ TRACE(TRACE_RESPONSE_END, pcb);
+
+ return err;
 }
 
 /*!
@@ -1081,14 +2058,33 @@ err_t Credentials_Webserver::generate_response(struct tcp_pcb *pcb, char *http_r
 
 void Credentials_Webserver::stop_webserver(struct tcp_pcb *pcb) 
 {
+ if (pcb == stream_pcb)
+ {
+#if TRACE_ENABLED
+  if (stream_kind == STREAM_TRACE)
+   trace_dump_abort();  // No-op if the dump completed.
+#endif
+  stream_pcb = NULL;
+  stream_arg = NULL;
+ }
+
+// Otherwise held until the pin times out, or the tcp_err() callback,
+// which stays set, reports the closing connection reset.
+
+ if ((pcb) && (tcp_sndbuf(pcb) == TCP_SND_BUF))
+  page_cache.unpin(pcb);
+
  tcp_recv(pcb, NULL);
  tcp_sent(pcb, NULL);
  tcp_close(pcb); 
 }
 
 /*!
-* \brief Sent callback - does nothing.
+* \brief Sent callback.
 *
+* Releases the cached page the connection was sending from once it has
+* all been acknowledged, and continues the metrics export, if one is
+* being streamed on this connection.
 * Called from C wrapper function w_http_sent_callback().
 *
 * \param arg Not used.
@@ -1097,11 +2093,52 @@ void Credentials_Webserver::stop_webserver(struct tcp_pcb *pcb)
 * \return err_t. If < 0, an error occurred.
 */
 
-err_t Credentials_Webserver::http_sent_callback(void *arg, struct tcp_pcb *pcb, u16_t len)
+err_t RAM_FUNC(Credentials_Webserver::http_sent_callback)(void *arg, struct tcp_pcb *pcb, u16_t len)
 {
+ TRACE(TRACE_SENT, pcb);
+
+ if (tcp_sndbuf(pcb) == TCP_SND_BUF)
+  page_cache.unpin(pcb);
+
+ if ((stream_pcb != NULL) && (pcb == stream_pcb) && (arg == stream_arg))
+  return send_stream_chunk(pcb);
+
  return ERR_OK;
 }
 
+/*!
+* \brief Error callback.
+*
+* lwIP has freed the connection (reset by the client, retransmission
+* timeout or out of memory) and will not call it again. Drops the
+* stream and the cached page pins it had, without touching the pcb,
+* which may already belong to a new connection.
+* Called from C wrapper function w_http_err_callback().
+*
+* \param arg The connection's callback argument.
+* \param err Error code.
+*/
+
+void Credentials_Webserver::http_err_callback(void *arg, err_t err)
+{
+#if TRACE_ENABLED
+ trace_add(TRACE_ERR, (uint16_t)(uintptr_t)arg);
+#endif
+
+ if ((stream_pcb != NULL) && (arg == stream_arg))
+ {
+#if TRACE_ENABLED
+  if (stream_kind == STREAM_TRACE)
+   trace_dump_abort();
+#endif
+  stream_pcb = NULL;
+  stream_arg = NULL;
+  stream_cursor = 0;
+ }
+
+ page_cache.unpin_freed(arg);
+}
+
 /*!
 * \brief Receive callback.
 *
@@ -1116,7 +2153,7 @@ err_t Credentials_Webserver::http_sent_callback(void *arg, struct tcp_pcb *pcb,
 * \return err_t. If < 0, an error occurred.
 */
 
-err_t Credentials_Webserver::http_recv_callback(void *arg, struct tcp_pcb *pcb, struct pbuf *p, err_t err)
+err_t RAM_FUNC(Credentials_Webserver::http_recv_callback)(void *arg, struct tcp_pcb *pcb, struct pbuf *p, err_t err)
 {
  err_t l_err = ERR_OK;
 
@@ -1136,6 +2173,7 @@ err_t Credentials_Webserver::http_recv_callback(void *arg, struct tcp_pcb *pcb,
 
 // Acknowledge that we've read the payload.
 
+ TRACE(TRACE_RECV_BEGIN, pcb);
  tcp_recved(pcb, p->len);
 
 // Read and decipher the request.
@@ -1145,9 +2183,15 @@ err_t Credentials_Webserver::http_recv_callback(void *arg, struct tcp_pcb *pcb,
 // not, then it sets up the appropriate arguments to the sent
 // callback handler.
  
+ request_start_us = time_us_32();
+ is_request_timed = true;
+
  l_err = generate_response(pcb, (char*)p->payload, p->len);
+ is_request_timed = false;
  pbuf_free(p);  // Free received packet.
 
+ TRACE(TRACE_RECV_END, pcb);
+
  return l_err;
 }
 
@@ -1197,97 +2241,6 @@ void Credentials_Webserver::start_webserver()
  tcp_accept(pcb, http_accept_callback);  // Specify callback to use for incoming connections.
 }
 
-/*!
-* \brief Extract URL's path from HTTP GET or POST request.
-*
-* \param path Pointer to path.
-* \param req  HTTP request.
-* \param rlen Length of HTTP request.
-* \param initial_offset  Length of "GET" or "POST".
-*/
-
-void Credentials_Webserver::extract_path(char *path, const char *req, int rlen, int initial_offset)
-{
- char *fstart, *fend;
- int offset = initial_offset;
-
-// Locate the start of the path in the request.
-// Requests are of the form GET /path/to/filename HTTP...
-
- if (req[offset] == '/')
-  offset++;
-
- fstart = (char*)(req + offset);   // Start marker.
-
-// Path finally ends in a space.
-
- while (req[offset] != ' ')
-  offset++;
-
- fend = (char*)(req + offset - 1); // End marker.
-
- if (fend < fstart) // No path found, default to home page.
- {
-  strcpy(path, "setup/home");
-  return;
- }
-
-// Malformed URL, or URL too long: set path to "NOT_FOUND".
-// This causes the "Page not found" page to be displayed.
-
- if (offset > rlen || fend - fstart > MAX_URL_LENGTH) 
- {
-  *fend = 0;
-  strcpy(path, "NOT_FOUND");
-  return;
- }
-
- strncpy(path, fstart, (fend - fstart + 1));  // Copy over the path...
- path[fend - fstart + 1] = 0;                 // ...and terminate it.
-}
-
-/*!
-* \brief Extract argument value from data string.
-*
-* \param data  String containing arguments and their values.
-* \param len   Length of data string.
-* \param argument_name Argument's name whose value is to be extracted.
-* \return string containing argument's value.
-*/
-
-string Credentials_Webserver::extract_argument(const char* data, int len, const char* argument_name)
-{
- string argument_value = "";
- char* start_ptr;  // Points to start of argument's value.
- char* end_ptr;    // Points to end of argument's value.
- 
- // Set start pointer.
- // Look for argument's name, then add length of argument's name
- // plus 1 for the '='.
-
- start_ptr = strstr(data, argument_name);
-
- if (start_ptr != NULL)
- {
-  start_ptr += (strlen(argument_name) + 1);  // Take account of the '=' character.
- }
-
- // Set end pointer.
- // Look for the argument separator "&".
- // If not found, set it to the end of the data.
-
- end_ptr = strstr(start_ptr, "&");
-
- if (end_ptr == NULL)
-  end_ptr = (char*)data + len - 1;
- else
-  end_ptr -= 1;
-
- argument_value.assign(start_ptr, (end_ptr - start_ptr + 1));
-
- return argument_value;
-}
-
 // *** End of class definition ***
 
 // *** Start of C functions ***
@@ -1303,7 +2256,7 @@ string Credentials_Webserver::extract_argument(const char* data, int len, const
 * \param err Error code.
 */
 
-err_t w_http_recv_callback(void *arg, struct tcp_pcb *pcb, struct pbuf *p, err_t err)
+err_t RAM_FUNC(w_http_recv_callback)(void *arg, struct tcp_pcb *pcb, struct pbuf *p, err_t err)
 {
  return cws->http_recv_callback(arg, pcb, p, err);
 }
@@ -1318,16 +2271,32 @@ err_t w_http_recv_callback(void *arg, struct tcp_pcb *pcb, struct pbuf *p, err_t
 * \param len Length of HTTP request.
 */
 
-err_t w_http_sent_callback(void *arg, struct tcp_pcb *pcb, u16_t len)
+err_t RAM_FUNC(w_http_sent_callback)(void *arg, struct tcp_pcb *pcb, u16_t len)
 {
  return cws->http_sent_callback(arg, pcb, len);
 }
 
+/*!
+* \brief Wrapper function for tcp_err().
+*
+* Allows C function to call C++ method http_err_callback().
+*
+* \param arg The connection's callback argument.
+* \param err Error code.
+*/
+
+void w_http_err_callback(void *arg, err_t err)
+{
+ cws->http_err_callback(arg, err);
+}
+
 /*!
 * \brief Callback function used by tcp_accept().
 *
 * C function that assigns wrapper callback
-* functions to tcp_rev() and tcp_sent().
+* functions to tcp_rev(), tcp_sent() and tcp_err().
+* The connection's callback argument is set to its accept sequence
+* number, used as the connection id in traces.
 *
 * \param arg Not used.
 * \param pcb Pointer to the TCP protocol control block of the socket.
@@ -1336,10 +2305,17 @@ err_t w_http_sent_callback(void *arg, struct tcp_pcb *pcb, u16_t len)
 
 err_t http_accept_callback(void *arg, struct tcp_pcb *pcb, err_t err)
 {
- tcp_arg(pcb, NULL);
+ static uint16_t accept_count = 0;
+
+ if (++accept_count == 0)
+  accept_count = 1;  // 0 would be a NULL arg, no trace id.
+
+ tcp_arg(pcb, (void*)(uintptr_t)accept_count);
+ TRACE(TRACE_ACCEPT, pcb);
 
  tcp_recv(pcb, w_http_recv_callback);
  tcp_sent(pcb, w_http_sent_callback);
+ tcp_err(pcb, w_http_err_callback);
 
  return ERR_OK;
 }
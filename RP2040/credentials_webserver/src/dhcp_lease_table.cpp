@@ -0,0 +1,445 @@
+/*!
+ * @file
+ * DHCP lease table.
+ */
+
+/*
+ * Copyright (c) 2023, FAV Software Limited. All rights reserved.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+// Every lease is on exactly one list, chosen by its state: the free list
+// (FREE) or the wheel slot of its expiry time (any other state). Both are
+// doubly linked through next/prev, so a lease moves between them in
+// constant time. Leases with a MAC are also on their hash chain.
+//
+// Called from dhcp_server_process(), so all but the initialisation is
+// RAM_FUNC().
+
+/*
+ * File:   dhcp_lease_table.cpp
+ * Author: busdev
+ *
+ * Created on 19 October 2026
+ * Updated on 19 October 2026
+ */
+
+#include <cstring>
+
+#include "dhcp_lease_table.h"
+#include "ram_code.h"
+
+static_assert((DHCP_LEASE_HASH_SIZE & (DHCP_LEASE_HASH_SIZE - 1)) == 0, "DHCP_LEASE_HASH_SIZE must be a power of 2");
+static_assert((DHCP_WHEEL_SLOTS & (DHCP_WHEEL_SLOTS - 1)) == 0, "DHCP_WHEEL_SLOTS must be a power of 2");
+static_assert((DHCPS_MAX_IP > 0) && (DHCPS_MAX_IP <= 32767), "DHCPS_MAX_IP out of range");
+
+/*!
+* \brief Returns the MAC hash bucket.
+*/
+
+static int RAM_FUNC(mac_hash)(const uint8_t *mac)
+{
+ uint32_t h = 2166136261u;   // FNV-1a.
+
+ for (int i = 0; i < DHCP_MAC_LEN; i++)
+  h = (h ^ mac[i]) * 16777619u;
+
+ return h & (DHCP_LEASE_HASH_SIZE - 1);
+}
+
+/*!
+* \brief Returns true once now_ms has reached time_ms, across the tick wrap.
+*/
+
+static bool RAM_FUNC(is_due)(uint32_t time_ms, uint32_t now_ms)
+{
+ return (int32_t)(now_ms - time_ms) >= 0;
+}
+
+/*!
+* \brief Returns the head of the list a lease belongs on.
+*/
+
+static int16_t *RAM_FUNC(list_head)(dhcp_lease_table_t *t, int index)
+{
+ if (t->lease[index].state == DHCP_LEASE_FREE)
+  return &t->free_head;
+
+ return &t->wheel[(t->lease[index].expiry_ms >> DHCP_WHEEL_TICK_SHIFT) & (DHCP_WHEEL_SLOTS - 1)];
+}
+
+/*!
+* \brief Removes a lease from its free list or wheel slot.
+*/
+
+static void RAM_FUNC(list_unlink)(dhcp_lease_t *lease, dhcp_lease_table_t *t, int index)
+{
+ if (lease->prev != DHCP_LEASE_NONE)
+  t->lease[lease->prev].next = lease->next;
+ else
+  *list_head(t, index) = lease->next;
+
+ if (lease->next != DHCP_LEASE_NONE)
+  t->lease[lease->next].prev = lease->prev;
+ else if (lease->state == DHCP_LEASE_FREE)
+  t->free_tail = lease->prev;
+
+ lease->next = lease->prev = DHCP_LEASE_NONE;
+}
+
+/*!
+* \brief Adds a lease to the wheel slot of its expiry.
+*/
+
+static void RAM_FUNC(wheel_insert)(dhcp_lease_table_t *t, int index)
+{
+ int16_t *head = list_head(t, index);
+
+ t->lease[index].prev = DHCP_LEASE_NONE;
+ t->lease[index].next = *head;
+
+ if (*head != DHCP_LEASE_NONE)
+  t->lease[*head].prev = index;
+
+ *head = index;
+}
+
+/*!
+* \brief Adds a lease to the tail of the free list.
+*/
+
+static void RAM_FUNC(free_append)(dhcp_lease_table_t *t, int index)
+{
+ t->lease[index].next = DHCP_LEASE_NONE;
+ t->lease[index].prev = t->free_tail;
+
+ if (t->free_tail != DHCP_LEASE_NONE)
+  t->lease[t->free_tail].next = index;
+ else
+  t->free_head = index;
+
+ t->free_tail = index;
+}
+
+/*!
+* \brief Adds a lease to its MAC's hash chain.
+*/
+
+static void RAM_FUNC(hash_insert)(dhcp_lease_table_t *t, int index)
+{
+ int bucket = mac_hash(t->lease[index].mac);
+
+ t->lease[index].hash_next = t->hash[bucket];
+ t->hash[bucket] = index;
+}
+
+/*!
+* \brief Removes a lease from its MAC's hash chain.
+*/
+
+static void RAM_FUNC(hash_remove)(dhcp_lease_table_t *t, int index)
+{
+ int16_t *link = &t->hash[mac_hash(t->lease[index].mac)];
+
+ while (*link != DHCP_LEASE_NONE)
+ {
+  if (*link == index)
+  {
+   *link = t->lease[index].hash_next;
+   break;
+  }
+
+  link = &t->lease[*link].hash_next;
+ }
+
+ t->lease[index].hash_next = DHCP_LEASE_NONE;
+}
+
+/*!
+* \brief Moves a lease to a new state and expiry, and its wheel slot.
+*/
+
+static void RAM_FUNC(reschedule)(dhcp_lease_table_t *t, int index, int state, uint32_t expiry_ms)
+{
+ dhcp_lease_t *lease = &t->lease[index];
+
+ list_unlink(lease, t, index);
+
+ if (lease->state == DHCP_LEASE_BOUND)
+  t->bound_count--;
+
+ if (state == DHCP_LEASE_BOUND)
+  t->bound_count++;
+
+ lease->state = state;
+ lease->expiry_ms = expiry_ms;
+ wheel_insert(t, index);
+}
+
+/*!
+* \brief Returns a lease to the free list.
+*/
+
+static void RAM_FUNC(free_lease)(dhcp_lease_table_t *t, int index)
+{
+ dhcp_lease_t *lease = &t->lease[index];
+
+ if (lease->state == DHCP_LEASE_FREE)
+  return;
+
+ list_unlink(lease, t, index);
+
+ if (lease->state == DHCP_LEASE_BOUND)
+  t->bound_count--;
+
+ if (lease->state != DHCP_LEASE_DECLINED)
+  hash_remove(t, index);
+
+ memset(lease->mac, 0, DHCP_MAC_LEN);
+ lease->state = DHCP_LEASE_FREE;
+ free_append(t, index);
+}
+
+/*!
+* \brief Takes a FREE lease for a client.
+*/
+
+static void RAM_FUNC(claim_lease)(dhcp_lease_table_t *t, int index, const uint8_t *mac)
+{
+ list_unlink(&t->lease[index], t, index);
+ memcpy(t->lease[index].mac, mac, DHCP_MAC_LEN);
+ hash_insert(t, index);
+}
+
+/*!
+* \brief Empties the table, all addresses free.
+*
+* \param t Lease table.
+* \param now_ms Current tick.
+*/
+
+void dhcp_lease_table_init(dhcp_lease_table_t *t, uint32_t now_ms)
+{
+ memset(t, 0, sizeof(*t));
+
+ for (int i = 0; i < DHCP_LEASE_HASH_SIZE; i++)
+  t->hash[i] = DHCP_LEASE_NONE;
+
+ for (int i = 0; i < DHCP_WHEEL_SLOTS; i++)
+  t->wheel[i] = DHCP_LEASE_NONE;
+
+ t->free_head = t->free_tail = DHCP_LEASE_NONE;
+
+ for (int i = 0; i < DHCPS_MAX_IP; i++)
+ {
+  t->lease[i].state = DHCP_LEASE_FREE;
+  t->lease[i].hash_next = DHCP_LEASE_NONE;
+  free_append(t, i);
+ }
+
+ t->wheel_time_ms = now_ms & ~(DHCP_WHEEL_TICK_MS - 1);
+}
+
+/*!
+* \brief Finds the lease (offered or bound) held by a client.
+*
+* \param t Lease table.
+* \param mac Client hardware address.
+* \return int. Lease index, or DHCP_LEASE_NONE.
+*/
+
+int RAM_FUNC(dhcp_lease_table_find)(dhcp_lease_table_t *t, const uint8_t *mac)
+{
+ for (int i = t->hash[mac_hash(mac)]; i != DHCP_LEASE_NONE; i = t->lease[i].hash_next)
+ {
+  if (memcmp(t->lease[i].mac, mac, DHCP_MAC_LEN) == 0)
+   return i;
+ }
+
+ return DHCP_LEASE_NONE;
+}
+
+/*!
+* \brief Chooses an address to offer a client (DISCOVER).
+*
+* The client's existing lease if it has one, else the address it asked
+* for if free, else the free address released longest ago. A new offer
+* is held for DHCP_OFFER_HOLD_MS.
+*
+* \param t Lease table.
+* \param mac Client hardware address.
+* \param preferred Lease index asked for, or DHCP_LEASE_NONE.
+* \param now_ms Current tick.
+* \return int. Lease index, or DHCP_LEASE_NONE if the pool is exhausted.
+*/
+
+int RAM_FUNC(dhcp_lease_table_offer)(dhcp_lease_table_t *t, const uint8_t *mac, int preferred, uint32_t now_ms)
+{
+ int index = dhcp_lease_table_find(t, mac);
+
+ if (index != DHCP_LEASE_NONE)
+ {
+  if (t->lease[index].state == DHCP_LEASE_OFFERED)
+   reschedule(t, index, DHCP_LEASE_OFFERED, now_ms + DHCP_OFFER_HOLD_MS);
+
+  return index;
+ }
+
+ if ((preferred >= 0) && (preferred < DHCPS_MAX_IP) && (t->lease[preferred].state == DHCP_LEASE_FREE))
+  index = preferred;
+ else
+  index = t->free_head;
+
+ if (index == DHCP_LEASE_NONE)
+  return DHCP_LEASE_NONE;
+
+ claim_lease(t, index, mac);
+ t->lease[index].state = DHCP_LEASE_OFFERED;
+ t->lease[index].expiry_ms = now_ms + DHCP_OFFER_HOLD_MS;
+ wheel_insert(t, index);
+
+ return index;
+}
+
+/*!
+* \brief Binds an address to a client (REQUEST).
+*
+* Succeeds if the address is the client's offer or lease, or is free. A
+* client taking a free address gives up any other lease it held.
+*
+* \param t Lease table.
+* \param mac Client hardware address.
+* \param index Lease index requested.
+* \param now_ms Current tick.
+* \param lease_ms Lease time, under 2^31.
+* \return int. DHCP_LEASE_OK, DHCP_LEASE_INVALID or DHCP_LEASE_IN_USE.
+*/
+
+int RAM_FUNC(dhcp_lease_table_request)(dhcp_lease_table_t *t, const uint8_t *mac, int index, uint32_t now_ms, uint32_t lease_ms)
+{
+ if ((index < 0) || (index >= DHCPS_MAX_IP))
+  return DHCP_LEASE_INVALID;
+
+ dhcp_lease_t *lease = &t->lease[index];
+
+ if (lease->state == DHCP_LEASE_FREE)
+ {
+  int held = dhcp_lease_table_find(t, mac);
+
+  if (held != DHCP_LEASE_NONE)
+   free_lease(t, held);
+
+  claim_lease(t, index, mac);
+  lease->state = DHCP_LEASE_OFFERED;   // Until rescheduled below.
+  lease->expiry_ms = now_ms;
+  wheel_insert(t, index);
+ }
+ else if ((lease->state == DHCP_LEASE_DECLINED) || (memcmp(lease->mac, mac, DHCP_MAC_LEN) != 0))
+ {
+  return DHCP_LEASE_IN_USE;
+ }
+
+ reschedule(t, index, DHCP_LEASE_BOUND, now_ms + lease_ms);
+
+ return DHCP_LEASE_OK;
+}
+
+/*!
+* \brief Frees a client's lease (RELEASE, or it chose another server).
+*
+* Ignored unless the lease is held by mac.
+*
+* \param t Lease table.
+* \param mac Client hardware address.
+* \param index Lease index.
+*/
+
+void RAM_FUNC(dhcp_lease_table_release)(dhcp_lease_table_t *t, const uint8_t *mac, int index)
+{
+ if ((index < 0) || (index >= DHCPS_MAX_IP))
+  return;
+
+ dhcp_lease_t *lease = &t->lease[index];
+
+ if (((lease->state == DHCP_LEASE_OFFERED) || (lease->state == DHCP_LEASE_BOUND)) &&
+     (memcmp(lease->mac, mac, DHCP_MAC_LEN) == 0))
+ {
+  free_lease(t, index);
+ }
+}
+
+/*!
+* \brief Takes an address out of the pool for DHCP_DECLINE_HOLD_MS (DECLINE).
+*
+* Ignored unless the lease is held by mac.
+*
+* \param t Lease table.
+* \param mac Client hardware address.
+* \param index Lease index.
+* \param now_ms Current tick.
+*/
+
+void RAM_FUNC(dhcp_lease_table_decline)(dhcp_lease_table_t *t, const uint8_t *mac, int index, uint32_t now_ms)
+{
+ if ((index < 0) || (index >= DHCPS_MAX_IP))
+  return;
+
+ dhcp_lease_t *lease = &t->lease[index];
+
+ if (((lease->state == DHCP_LEASE_OFFERED) || (lease->state == DHCP_LEASE_BOUND)) &&
+     (memcmp(lease->mac, mac, DHCP_MAC_LEN) == 0))
+ {
+  hash_remove(t, index);
+  memset(lease->mac, 0, DHCP_MAC_LEN);
+  reschedule(t, index, DHCP_LEASE_DECLINED, now_ms + DHCP_DECLINE_HOLD_MS);
+ }
+}
+
+/*!
+* \brief Frees the leases whose time has run out.
+*
+* Visits the wheel slots from the last call up to and including the
+* current one (at most one full turn).
+*
+* \param t Lease table.
+* \param now_ms Current tick.
+*/
+
+void RAM_FUNC(dhcp_lease_table_expire)(dhcp_lease_table_t *t, uint32_t now_ms)
+{
+ uint32_t current_ms = now_ms & ~(DHCP_WHEEL_TICK_MS - 1);
+
+ for (int step = 0; step < DHCP_WHEEL_SLOTS; step++)
+ {
+  int index = t->wheel[(t->wheel_time_ms >> DHCP_WHEEL_TICK_SHIFT) & (DHCP_WHEEL_SLOTS - 1)];
+
+  while (index != DHCP_LEASE_NONE)
+  {
+   int next = t->lease[index].next;
+
+   if (is_due(t->lease[index].expiry_ms, now_ms) == true)
+    free_lease(t, index);
+
+   index = next;
+  }
+
+  if (t->wheel_time_ms == current_ms)
+   return;   // The current slot is visited again next time.
+
+  t->wheel_time_ms += DHCP_WHEEL_TICK_MS;
+ }
+
+ t->wheel_time_ms = current_ms;   // A full turn covered every slot.
+}
@@ -29,12 +29,16 @@
 //  https://tools.ietf.org/html/rfc2132 -- DHCP Options and BOOTP Vendor Extensions
 
 #include <stdio.h>
+#include <stdbool.h>
 #include <string.h>
 #include <errno.h>
 
 #include "cyw43_config.h"
 #include "dhcpserver.h"
+#include "metrics.h"
+#include "ram_code.h"
 #include "lwip/udp.h"
+#include "lwip/etharp.h"
 
 #define DHCPDISCOVER    (1)
 #define DHCPOFFER       (2)
@@ -63,13 +67,35 @@
 #define PORT_DHCP_SERVER (67)
 #define PORT_DHCP_CLIENT (68)
 
-#define DEFAULT_DNS MAKE_IP4(8, 8, 8, 8)
-#define DEFAULT_LEASE_TIME_S (24 * 60 * 60) // in seconds
+#ifndef DHCPS_LEASE_TIME_S
+#define DHCPS_LEASE_TIME_S (60 * 60) // in seconds, see CWS_DHCP_LEASE_TIME_S
+#endif
+
+#ifndef DHCPS_LOG_LEASES
+#define DHCPS_LOG_LEASES (1) // print each ACK, the host harness turns it off
+#endif
 
 #define MAC_LEN (6)
+
+#define BOOTREPLY (2)
+#define BOOTP_FLAG_BROADCAST (0x80) // first byte of flags
+
+// Fixed fields and magic cookie, and the space the reply's options need.
+#define DHCP_HEADER_SIZE (240)
+#define DHCP_REPLY_OPT_SPACE (48)
+#define DHCP_REPLY_SIZE (DHCP_HEADER_SIZE + DHCP_REPLY_OPT_SPACE)
+
+_Static_assert(DHCPS_BASE_IP + DHCPS_MAX_IP <= 255, "DHCP pool does not fit the /24 subnet");
+_Static_assert(DHCPS_LEASE_TIME_S < 0x7fffffff / 1000, "DHCP lease time must be under 2^31 ms");
+
+static int dhcp_leases_metric = METRICS_NONE;
+static int dhcp_naks_metric = METRICS_NONE;
+static int dhcp_exhausted_metric = METRICS_NONE;
+static int dhcp_bound_metric = METRICS_NONE;
 #define MAKE_IP4(a, b, c, d) ((a) << 24 | (b) << 16 | (c) << 8 | (d))
 
-typedef struct {
+// Overlaid on the received packet, which is not word aligned, hence packed.
+typedef struct __attribute__((packed)) {
     uint8_t op; // message opcode
     uint8_t htype; // hardware address type
     uint8_t hlen; // hardware address length
@@ -116,42 +142,39 @@ static int dhcp_socket_bind(struct udp_pcb **udp, uint32_t ip, uint16_t port) {
     return udp_bind(*udp, &addr, port);
 }
 
-static int dhcp_socket_sendto(struct udp_pcb **udp, const void *buf, size_t len, uint32_t ip, uint16_t port) {
-    if (len > 0xffff) {
-        len = 0xffff;
-    }
-
-    struct pbuf *p = pbuf_alloc(PBUF_TRANSPORT, len, PBUF_RAM);
-    if (p == NULL) {
-        return -ENOMEM;
-    }
-
-    memcpy(p->payload, buf, len);
-
+// Sends p as it is; lwIP adds the headers, in the space in front of the
+// payload when there is room. The caller still owns p.
+static int RAM_FUNC(dhcp_socket_sendto)(struct udp_pcb **udp, struct pbuf *p, uint32_t ip, uint16_t port) {
     ip_addr_t dest;
     IP4_ADDR(&dest, ip >> 24 & 0xff, ip >> 16 & 0xff, ip >> 8 & 0xff, ip & 0xff);
     err_t err = udp_sendto(*udp, p, &dest, port);
 
-    pbuf_free(p);
-
     if (err != ERR_OK) {
         return err;
     }
 
-    return len;
+    return p->tot_len;
 }
 
-static uint8_t *opt_find(uint8_t *opt, uint8_t cmd) {
-    for (int i = 0; i < 308 && opt[i] != DHCP_OPT_END;) {
-        if (opt[i] == cmd) {
-            return &opt[i];
+// Returns the option cmd in [opt, end), or NULL.
+static uint8_t *RAM_FUNC(opt_find)(uint8_t *opt, uint8_t *end, uint8_t cmd) {
+    while (opt + 1 < end && opt[0] != DHCP_OPT_END) {
+        if (opt[0] == DHCP_OPT_PAD) {
+            opt++;
+            continue;
+        }
+        if (opt + 2 + opt[1] > end) {
+            break; // truncated option
         }
-        i += 2 + opt[i + 1];
+        if (opt[0] == cmd) {
+            return opt;
+        }
+        opt += 2 + opt[1];
     }
     return NULL;
 }
 
-static void opt_write_n(uint8_t **opt, uint8_t cmd, size_t n, void *data) {
+static void RAM_FUNC(opt_write_n)(uint8_t **opt, uint8_t cmd, size_t n, void *data) {
     uint8_t *o = *opt;
     *o++ = cmd;
     *o++ = n;
@@ -159,7 +182,7 @@ static void opt_write_n(uint8_t **opt, uint8_t cmd, size_t n, void *data) {
     *opt = o + n;
 }
 
-static void opt_write_u8(uint8_t **opt, uint8_t cmd, uint8_t val) {
+static void RAM_FUNC(opt_write_u8)(uint8_t **opt, uint8_t cmd, uint8_t val) {
     uint8_t *o = *opt;
     *o++ = cmd;
     *o++ = 1;
@@ -167,7 +190,7 @@ static void opt_write_u8(uint8_t **opt, uint8_t cmd, uint8_t val) {
     *opt = o;
 }
 
-static void opt_write_u32(uint8_t **opt, uint8_t cmd, uint32_t val) {
+static void RAM_FUNC(opt_write_u32)(uint8_t **opt, uint8_t cmd, uint32_t val) {
     uint8_t *o = *opt;
     *o++ = cmd;
     *o++ = 4;
@@ -178,117 +201,203 @@ static void opt_write_u32(uint8_t **opt, uint8_t cmd, uint32_t val) {
     *opt = o;
 }
 
-static void dhcp_server_process(void *arg, struct udp_pcb *upcb, struct pbuf *p, const ip_addr_t *src_addr, u16_t src_port) {
+// Returns the lease index of a pool address, or DHCP_LEASE_NONE.
+static int RAM_FUNC(dhcp_lease_index)(dhcp_server_t *d, const uint8_t *ip) {
+    if (memcmp(ip, &d->ip.addr, 3) != 0) {
+        return DHCP_LEASE_NONE;
+    }
+    if (ip[3] < DHCPS_BASE_IP || ip[3] >= DHCPS_BASE_IP + DHCPS_MAX_IP) {
+        return DHCP_LEASE_NONE;
+    }
+    return ip[3] - DHCPS_BASE_IP;
+}
+
+// Sends a reply to yiaddr at the client's MAC address: the client cannot
+// answer ARP yet, so a static ARP entry is added for the send.
+static void RAM_FUNC(dhcp_send_unicast_to_chaddr)(dhcp_server_t *d, struct pbuf *p, dhcp_msg_t *dhcp_msg) {
+    #if ETHARP_SUPPORT_STATIC_ENTRIES
+    ip4_addr_t yiaddr;
+    struct eth_addr mac;
+    IP4_ADDR(&yiaddr, dhcp_msg->yiaddr[0], dhcp_msg->yiaddr[1], dhcp_msg->yiaddr[2], dhcp_msg->yiaddr[3]);
+    memcpy(mac.addr, dhcp_msg->chaddr, MAC_LEN);
+    if (etharp_add_static_entry(&yiaddr, &mac) == ERR_OK) {
+        dhcp_socket_sendto(&d->udp, p, lwip_ntohl(ip4_addr_get_u32(&yiaddr)), PORT_DHCP_CLIENT);
+        etharp_remove_static_entry(&yiaddr);
+        return;
+    }
+    #endif
+    dhcp_socket_sendto(&d->udp, p, 0xffffffff, PORT_DHCP_CLIENT);
+}
+
+// The reply is built in place in the request's pbuf and sent back in it:
+// no copy to the stack and no allocation. Only a request in a chained
+// pbuf, or too short to hold the reply, is first copied into a new one.
+static void RAM_FUNC(dhcp_server_process)(void *arg, struct udp_pcb *upcb, struct pbuf *p, const ip_addr_t *src_addr, u16_t src_port) {
     dhcp_server_t *d = arg;
     (void)upcb;
     (void)src_addr;
     (void)src_port;
 
-    // This is around 548 bytes
-    dhcp_msg_t dhcp_msg;
+    struct pbuf *msg_p = p;
+    uint16_t msg_len = p->tot_len;
 
     #define DHCP_MIN_SIZE (240 + 3)
     if (p->tot_len < DHCP_MIN_SIZE) {
         goto ignore_request;
     }
 
-    size_t len = pbuf_copy_partial(p, &dhcp_msg, sizeof(dhcp_msg), 0);
-    if (len < DHCP_MIN_SIZE) {
+    if (p->len != p->tot_len || p->len < DHCP_REPLY_SIZE) {
+        msg_len = LWIP_MIN(p->tot_len, sizeof(dhcp_msg_t));
+        msg_p = pbuf_alloc(PBUF_TRANSPORT, LWIP_MAX(msg_len, DHCP_REPLY_SIZE), PBUF_RAM);
+        if (msg_p == NULL) {
+            msg_p = p;
+            goto ignore_request;
+        }
+        pbuf_copy_partial(p, msg_p->payload, msg_len, 0);
+    }
+
+    dhcp_msg_t *dhcp_msg = msg_p->payload;
+    uint8_t *opt = (uint8_t *)&dhcp_msg->options;
+    uint8_t *opt_end = (uint8_t *)dhcp_msg + msg_len;
+    opt += 4; // assume magic cookie: 99, 130, 83, 99
+
+    // Read the request's options before the reply overwrites them.
+    uint8_t *o = opt_find(opt, opt_end, DHCP_OPT_MSG_TYPE);
+    if (o == NULL) {
         goto ignore_request;
     }
+    uint8_t msg_type = o[2];
+    o = opt_find(opt, opt_end, DHCP_OPT_REQUESTED_IP);
+    int requested = dhcp_lease_index(d, (o != NULL) ? o + 2 : dhcp_msg->ciaddr); // RENEWING/REBINDING use ciaddr
+    o = opt_find(opt, opt_end, DHCP_OPT_SERVER_ID);
+    bool other_server = (o != NULL) && (memcmp(o + 2, &d->ip.addr, 4) != 0);
 
-    dhcp_msg.op = DHCPOFFER;
-    memcpy(&dhcp_msg.yiaddr, &d->ip.addr, 4);
+    uint32_t now_ms = cyw43_hal_ticks_ms();
+    dhcp_lease_table_expire(&d->leases, now_ms);
 
-    uint8_t *opt = (uint8_t *)&dhcp_msg.options;
-    opt += 4; // assume magic cookie: 99, 130, 83, 99
+    uint8_t reply_type;
+    int yi = DHCP_LEASE_NONE;
 
-    switch (opt[2]) {
+    switch (msg_type) {
         case DHCPDISCOVER: {
-            int yi = DHCPS_MAX_IP;
-            for (int i = 0; i < DHCPS_MAX_IP; ++i) {
-                if (memcmp(d->lease[i].mac, dhcp_msg.chaddr, MAC_LEN) == 0) {
-                    // MAC match, use this IP address
-                    yi = i;
-                    break;
-                }
-                if (yi == DHCPS_MAX_IP) {
-                    // Look for a free IP address
-                    if (memcmp(d->lease[i].mac, "\x00\x00\x00\x00\x00\x00", MAC_LEN) == 0) {
-                        // IP available
-                        yi = i;
-                    }
-                    uint32_t expiry = d->lease[i].expiry << 16 | 0xffff;
-                    if ((int32_t)(expiry - cyw43_hal_ticks_ms()) < 0) {
-                        // IP expired, reuse it
-                        memset(d->lease[i].mac, 0, MAC_LEN);
-                        yi = i;
-                    }
-                }
-            }
-            if (yi == DHCPS_MAX_IP) {
+            yi = dhcp_lease_table_offer(&d->leases, dhcp_msg->chaddr, requested, now_ms);
+            if (yi == DHCP_LEASE_NONE) {
                 // No more IP addresses left
+                metrics_inc(dhcp_exhausted_metric);
                 goto ignore_request;
             }
-            dhcp_msg.yiaddr[3] = DHCPS_BASE_IP + yi;
-            opt_write_u8(&opt, DHCP_OPT_MSG_TYPE, DHCPOFFER);
+            reply_type = DHCPOFFER;
             break;
         }
 
         case DHCPREQUEST: {
-            uint8_t *o = opt_find(opt, DHCP_OPT_REQUESTED_IP);
-            if (o == NULL) {
-                // Should be NACK
+            if (other_server) {
+                // The client chose another server's offer
+                dhcp_lease_table_release(&d->leases, dhcp_msg->chaddr, dhcp_lease_table_find(&d->leases, dhcp_msg->chaddr));
                 goto ignore_request;
             }
-            if (memcmp(o + 2, &d->ip.addr, 3) != 0) {
-                // Should be NACK
-                goto ignore_request;
+            if (dhcp_lease_table_request(&d->leases, dhcp_msg->chaddr, requested, now_ms, DHCPS_LEASE_TIME_S * 1000) != DHCP_LEASE_OK) {
+                // Wrong subnet, not a pool address, or in use by another client
+                metrics_inc(dhcp_naks_metric);
+                reply_type = DHCPNACK;
+                break;
             }
-            uint8_t yi = o[5] - DHCPS_BASE_IP;
-            if (yi >= DHCPS_MAX_IP) {
-                // Should be NACK
-                goto ignore_request;
+            yi = requested;
+            reply_type = DHCPACK;
+            metrics_inc(dhcp_leases_metric);
+            break;
+        }
+
+        case DHCPDECLINE:
+            // The client found the address in use
+            if (!other_server) {
+                dhcp_lease_table_decline(&d->leases, dhcp_msg->chaddr, requested, now_ms);
             }
-            if (memcmp(d->lease[yi].mac, dhcp_msg.chaddr, MAC_LEN) == 0) {
-                // MAC match, ok to use this IP address
-            } else if (memcmp(d->lease[yi].mac, "\x00\x00\x00\x00\x00\x00", MAC_LEN) == 0) {
-                // IP unused, ok to use this IP address
-                memcpy(d->lease[yi].mac, dhcp_msg.chaddr, MAC_LEN);
-            } else {
-                // IP already in use
-                // Should be NACK
+            goto ignore_request;
+
+        case DHCPRELEASE:
+            dhcp_lease_table_release(&d->leases, dhcp_msg->chaddr, dhcp_lease_index(d, dhcp_msg->ciaddr));
+            goto ignore_request;
+
+        case DHCPINFORM:
+            // Configured elsewhere, wants the other parameters: ACK with no
+            // address or lease time
+            if (memcmp(dhcp_msg->ciaddr, "\x00\x00\x00\x00", 4) == 0) {
                 goto ignore_request;
             }
-            d->lease[yi].expiry = (cyw43_hal_ticks_ms() + DEFAULT_LEASE_TIME_S * 1000) >> 16;
-            dhcp_msg.yiaddr[3] = DHCPS_BASE_IP + yi;
-            opt_write_u8(&opt, DHCP_OPT_MSG_TYPE, DHCPACK);
-            printf("DHCPS: client connected: MAC=%02x:%02x:%02x:%02x:%02x:%02x IP=%u.%u.%u.%u\n",
-                dhcp_msg.chaddr[0], dhcp_msg.chaddr[1], dhcp_msg.chaddr[2], dhcp_msg.chaddr[3], dhcp_msg.chaddr[4], dhcp_msg.chaddr[5],
-                dhcp_msg.yiaddr[0], dhcp_msg.yiaddr[1], dhcp_msg.yiaddr[2], dhcp_msg.yiaddr[3]);
+            reply_type = DHCPACK;
             break;
-        }
 
         default:
             goto ignore_request;
     }
 
+    dhcp_msg->op = BOOTREPLY;
+    memset(&dhcp_msg->yiaddr, 0, 4);
+    if (yi != DHCP_LEASE_NONE) {
+        memcpy(&dhcp_msg->yiaddr, &d->ip.addr, 4);
+        dhcp_msg->yiaddr[3] = DHCPS_BASE_IP + yi;
+    }
+
+    // Choose the destination (RFC 2131 4.1) before clearing ciaddr: NAK
+    // broadcast, a client with an address (renewing, INFORM) at that
+    // address, otherwise broadcast if the client asked, else its MAC.
+    uint32_t dest = 0xffffffff;
+    bool to_chaddr = false;
+    if (reply_type == DHCPNACK) {
+        memset(&dhcp_msg->ciaddr, 0, 4);
+    } else if (memcmp(dhcp_msg->ciaddr, "\x00\x00\x00\x00", 4) != 0) {
+        dest = MAKE_IP4(dhcp_msg->ciaddr[0], dhcp_msg->ciaddr[1], dhcp_msg->ciaddr[2], dhcp_msg->ciaddr[3]);
+    } else if (!(((uint8_t *)&dhcp_msg->flags)[0] & BOOTP_FLAG_BROADCAST)) {
+        to_chaddr = true;
+    }
+    if (msg_type == DHCPINFORM) {
+        memset(&dhcp_msg->ciaddr, 0, 4);
+    }
+
+    opt_write_u8(&opt, DHCP_OPT_MSG_TYPE, reply_type);
     opt_write_n(&opt, DHCP_OPT_SERVER_ID, 4, &d->ip.addr);
-    opt_write_n(&opt, DHCP_OPT_SUBNET_MASK, 4, &d->nm.addr);
-    opt_write_n(&opt, DHCP_OPT_ROUTER, 4, &d->ip.addr); // aka gateway; can have mulitple addresses
-    opt_write_u32(&opt, DHCP_OPT_DNS, DEFAULT_DNS); // can have mulitple addresses
-    opt_write_u32(&opt, DHCP_OPT_IP_LEASE_TIME, DEFAULT_LEASE_TIME_S);
+    if (reply_type != DHCPNACK) {
+        opt_write_n(&opt, DHCP_OPT_SUBNET_MASK, 4, &d->nm.addr);
+        opt_write_n(&opt, DHCP_OPT_ROUTER, 4, &d->ip.addr); // aka gateway; can have mulitple addresses
+        opt_write_n(&opt, DHCP_OPT_DNS, 4, &d->ip.addr); // our captive portal responder, see dns_server.h
+        if (msg_type != DHCPINFORM) {
+            opt_write_u32(&opt, DHCP_OPT_IP_LEASE_TIME, DHCPS_LEASE_TIME_S);
+        }
+    }
     *opt++ = DHCP_OPT_END;
-    dhcp_socket_sendto(&d->udp, &dhcp_msg, opt - (uint8_t *)&dhcp_msg, 0xffffffff, PORT_DHCP_CLIENT);
+
+    LWIP_ASSERT("DHCP reply options overflow", opt - (uint8_t *)dhcp_msg <= DHCP_REPLY_SIZE);
+    pbuf_realloc(msg_p, opt - (uint8_t *)dhcp_msg);
+
+    if (to_chaddr) {
+        dhcp_send_unicast_to_chaddr(d, msg_p, dhcp_msg);
+    } else {
+        dhcp_socket_sendto(&d->udp, msg_p, dest, PORT_DHCP_CLIENT);
+    }
+
+    if (DHCPS_LOG_LEASES && reply_type == DHCPACK && yi != DHCP_LEASE_NONE) {
+        printf("DHCPS: client connected: MAC=%02x:%02x:%02x:%02x:%02x:%02x IP=%u.%u.%u.%u\n",
+            dhcp_msg->chaddr[0], dhcp_msg->chaddr[1], dhcp_msg->chaddr[2], dhcp_msg->chaddr[3], dhcp_msg->chaddr[4], dhcp_msg->chaddr[5],
+            dhcp_msg->yiaddr[0], dhcp_msg->yiaddr[1], dhcp_msg->yiaddr[2], dhcp_msg->yiaddr[3]);
+    }
 
 ignore_request:
+    metrics_set(dhcp_bound_metric, d->leases.bound_count);
+    if (msg_p != p) {
+        pbuf_free(msg_p);
+    }
     pbuf_free(p);
 }
 
 void dhcp_server_init(dhcp_server_t *d, ip_addr_t *ip, ip_addr_t *nm) {
     ip_addr_copy(d->ip, *ip);
     ip_addr_copy(d->nm, *nm);
-    memset(d->lease, 0, sizeof(d->lease));
+    dhcp_lease_table_init(&d->leases, cyw43_hal_ticks_ms());
+    dhcp_leases_metric = metrics_counter("cws_dhcp_leases_issued_total", NULL, "DHCP leases acknowledged.");
+    dhcp_naks_metric = metrics_counter("cws_dhcp_naks_total", NULL, "DHCP requests refused with a NAK.");
+    dhcp_exhausted_metric = metrics_counter("cws_dhcp_pool_exhausted_total", NULL, "DHCP discovers ignored, no free address.");
+    dhcp_bound_metric = metrics_gauge("cws_dhcp_leases_bound", NULL, "DHCP leases currently bound.");
     if (dhcp_socket_new_dgram(&d->udp, d, dhcp_server_process) != 0) {
         return;
     }
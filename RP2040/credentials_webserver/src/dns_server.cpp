@@ -0,0 +1,196 @@
+/*!
+ * @file
+ * Captive portal DNS responder.
+ */
+
+/*
+ * Copyright (c) 2023, FAV Software Limited. All rights reserved.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/*
+ * File:   dns_server.cpp
+ * Author: busdev
+ *
+ * Created on 19 October 2026
+ * Updated on 19 October 2026
+ */
+
+#include <cstring>
+
+#include "lwip/udp.h"
+#include "dns_server.h"
+#include "metrics.h"
+#include "ram_code.h"
+
+#define DNS_HEADER_SIZE   12
+#define DNS_ANSWER_SIZE   16        // Name pointer, type, class, TTL, length, address.
+#define DNS_FLAG_QR       0x80      // First flags byte.
+#define DNS_FLAG_AA       0x04
+#define DNS_FLAG_RD       0x01
+#define DNS_OPCODE_MASK   0x78
+#define DNS_TYPE_A        1
+#define DNS_TYPE_ANY      255
+#define DNS_CLASS_IN      1
+#define DNS_CLASS_ANY     255
+#define DNS_NAME_POINTER  0xc00c    // To the name in the question.
+
+static int answered_metric = METRICS_NONE;
+static int nodata_metric = METRICS_NONE;
+static int ignored_metric = METRICS_NONE;
+
+/*!
+* \brief Finds the end of the question of a query.
+*
+* \param query Query, from the header.
+* \param len Length of query.
+* \return int. Offset just past the question, or -1 if it is malformed.
+*/
+
+static int RAM_FUNC(dns_question_end)(const uint8_t *query, int len)
+{
+ int offset = DNS_HEADER_SIZE;
+
+// The name is a list of labels ending in a zero length one. A query has
+// nothing to point back to, so compression pointers are not allowed.
+
+ while ((offset < len) && (query[offset] != 0))
+ {
+  if ((query[offset] & 0xc0) != 0)
+   return -1;
+
+  offset += 1 + query[offset];
+
+  if (offset - DNS_HEADER_SIZE > DNS_MAX_NAME_LEN)
+   return -1;
+ }
+
+ offset += 1 + 4;   // Terminator, type and class.
+
+ return (offset <= len) ? offset : -1;
+}
+
+/*!
+* \brief Answers a query: A (or ANY) with the gateway address, anything
+* else with no records.
+*
+* Responses, queries with more than one question and opcodes other than
+* QUERY are dropped.
+*/
+
+static void RAM_FUNC(dns_server_process)(void *arg, struct udp_pcb *upcb, struct pbuf *p, const ip_addr_t *src_addr, u16_t src_port)
+{
+ dns_server_t *d = (dns_server_t *)arg;
+ uint8_t query[DNS_HEADER_SIZE + DNS_MAX_NAME_LEN + 1 + 4];
+ int len = pbuf_copy_partial(p, query, sizeof(query), 0);
+ int question_end;
+
+ (void)upcb;
+ pbuf_free(p);
+
+ if ((len < DNS_HEADER_SIZE) ||
+     ((query[2] & (DNS_FLAG_QR | DNS_OPCODE_MASK)) != 0) ||
+     (query[4] != 0) || (query[5] != 1) ||
+     ((question_end = dns_question_end(query, len)) < 0))
+ {
+  metrics_inc(ignored_metric);
+  return;
+ }
+
+ uint16_t qtype = (query[question_end - 4] << 8) | query[question_end - 3];
+ uint16_t qclass = (query[question_end - 2] << 8) | query[question_end - 1];
+ bool is_answered = ((qtype == DNS_TYPE_A) || (qtype == DNS_TYPE_ANY)) && ((qclass == DNS_CLASS_IN) || (qclass == DNS_CLASS_ANY));
+ struct pbuf *reply = pbuf_alloc(PBUF_TRANSPORT, question_end + (is_answered ? DNS_ANSWER_SIZE : 0), PBUF_RAM);
+
+ if (reply == NULL)
+ {
+  metrics_inc(ignored_metric);
+  return;
+ }
+
+// Header and question, as received; any additional records (EDNS) are
+// left out.
+
+ uint8_t *r = (uint8_t *)reply->payload;
+
+ memcpy(r, query, question_end);
+ r[2] = DNS_FLAG_QR | DNS_FLAG_AA | (query[2] & DNS_FLAG_RD);
+ r[3] = 0;                              // No recursion available, no error.
+ memset(&r[6], 0, 6);
+ r[7] = is_answered ? 1 : 0;            // Answer count.
+
+ if (is_answered == true)
+ {
+  uint8_t *answer = &r[question_end];
+
+  answer[0] = DNS_NAME_POINTER >> 8;
+  answer[1] = DNS_NAME_POINTER & 0xff;
+  answer[2] = 0;
+  answer[3] = DNS_TYPE_A;
+  answer[4] = 0;
+  answer[5] = DNS_CLASS_IN;
+  answer[6] = 0;
+  answer[7] = 0;
+  answer[8] = DNS_TTL_S >> 8;
+  answer[9] = DNS_TTL_S & 0xff;
+  answer[10] = 0;
+  answer[11] = 4;
+  memcpy(&answer[12], &d->ip.addr, 4);  // Already in network order.
+ }
+
+ udp_sendto(d->udp, reply, src_addr, src_port);
+ pbuf_free(reply);
+
+ metrics_inc(is_answered ? answered_metric : nodata_metric);
+}
+
+/*!
+* \brief Starts answering queries on port 53.
+*
+* \param d Server state, must stay allocated until dns_server_deinit().
+* \param ip Gateway address, the answer to every A query.
+*/
+
+void dns_server_init(dns_server_t *d, ip_addr_t *ip)
+{
+ ip_addr_copy(d->ip, *ip);
+
+ answered_metric = metrics_counter("cws_dns_queries_total", "result=\"answered\"", "DNS queries by result.");
+ nodata_metric = metrics_counter("cws_dns_queries_total", "result=\"nodata\"", "DNS queries by result.");
+ ignored_metric = metrics_counter("cws_dns_queries_total", "result=\"ignored\"", "DNS queries by result.");
+
+ d->udp = udp_new();
+
+ if (d->udp == NULL)
+  return;
+
+ udp_recv(d->udp, dns_server_process, d);
+
+ if (udp_bind(d->udp, IP_ADDR_ANY, DNS_PORT) != ERR_OK)
+  dns_server_deinit(d);
+}
+
+/*!
+* \brief Stops the responder.
+*/
+
+void dns_server_deinit(dns_server_t *d)
+{
+ if (d->udp != NULL)
+ {
+  udp_remove(d->udp);
+  d->udp = NULL;
+ }
+}
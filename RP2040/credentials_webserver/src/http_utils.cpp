@@ -0,0 +1,575 @@
+/*!
+ * @file
+ * HTTP request parsing and form value validation.
+ */
+
+/*
+ * Copyright (c) 2023, FAV Software Limited. All rights reserved.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * File:   http_utils.cpp
+ * Author: busdev
+ *
+ * Created on 19 October 2026
+ * Updated on 19 October 2026
+ */
+
+#include <cstdint>
+#include <cstring>
+#include <strings.h>
+
+#include "http_utils.h"
+#include "ram_code.h"
+
+/*!
+* \brief Returns true if every character is 'ASCII printable' (32..126).
+*/
+
+static bool is_printable(const char *str, int len)
+{
+ for (int i = 0; i < len; i++)
+ {
+  if (((uint8_t)str[i] < 32) || ((uint8_t)str[i] > 126))
+   return false;
+ }
+
+ return true;
+}
+
+/*!
+* \brief Decodes HTTP request type.
+*
+* \param req HTTP request from client.
+* \return http_req_type. [HTTP_GET | HTTP_POST | HTTP_PUT | HTTP_UNKNOWN].
+*/
+
+enum http_req_type RAM_FUNC(decode_http_request)(const char *req)
+{
+ char const *get_str  = "GET";
+ char const *post_str = "POST";
+ char const *put_str  = "PUT";
+
+ if (!strncmp(req, get_str, strlen(get_str)))
+  return HTTP_GET;
+
+ if (!strncmp(req, post_str, strlen(post_str)))
+  return HTTP_POST;
+
+ if (!strncmp(req, put_str, strlen(put_str)))
+  return HTTP_PUT;
+
+ return HTTP_UNKNOWN;
+}
+
+/*!
+* \brief Extract URL's path from HTTP GET or POST request.
+*
+* path must hold MAX_URL_LENGTH bytes. A path that does not fit, or a
+* request with no space after the path, gives "NOT_FOUND".
+*
+* \param path Pointer to path.
+* \param req  HTTP request.
+* \param rlen Length of HTTP request.
+* \param initial_offset  Length of "GET" or "POST".
+*/
+
+void RAM_FUNC(extract_path)(char *path, const char *req, int rlen, int initial_offset)
+{
+ const char *fstart, *fend;
+ int offset = initial_offset;
+
+// Locate the start of the path in the request.
+// Requests are of the form GET /path/to/filename HTTP...
+
+ if ((offset < rlen) && (req[offset] == '/'))
+  offset++;
+
+ fstart = req + offset;   // Start marker.
+
+// Path finally ends in a space.
+
+ while ((offset < rlen) && (req[offset] != ' '))
+  offset++;
+
+ fend = req + offset - 1; // End marker.
+
+// Malformed URL, or URL too long: set path to "NOT_FOUND".
+// This causes the "Page not found" page to be displayed.
+
+ if ((offset >= rlen) || (fend - fstart + 1 >= MAX_URL_LENGTH))
+ {
+  strcpy(path, "NOT_FOUND");
+  return;
+ }
+
+ if (fend < fstart) // No path found, default to home page.
+ {
+  strcpy(path, "setup/home");
+  return;
+ }
+
+ memcpy(path, fstart, (fend - fstart + 1));  // Copy over the path...
+ path[fend - fstart + 1] = 0;                // ...and terminate it.
+}
+
+/*!
+* \brief Extract argument value from data string.
+*
+* The value is not copied: value is set to point at it in data.
+*
+* \param data  String containing arguments and their values.
+* \param len   Length of data string.
+* \param argument_name Argument's name whose value is to be extracted.
+* \param value Set to the start of the argument's value.
+* \return int. Length of the argument's value, 0 if the argument is absent.
+*/
+
+int RAM_FUNC(extract_argument)(const char *data, int len, const char *argument_name, const char **value)
+{
+ const char *start_ptr;  // Points to start of argument's value.
+ const char *end_ptr;    // Points to end of argument's value.
+
+ *value = data;
+
+ // Set start pointer.
+ // Look for argument's name, then add length of argument's name
+ // plus 1 for the '='.
+
+ start_ptr = strstr(data, argument_name);
+
+ if (start_ptr == NULL)
+  return 0;
+
+ start_ptr += (strlen(argument_name) + 1);  // Take account of the '=' character.
+
+ // Set end pointer.
+ // Look for the argument separator "&".
+ // If not found, set it to the end of the data.
+
+ end_ptr = strchr(start_ptr, '&');
+
+ if (end_ptr == NULL)
+  end_ptr = data + len - 1;
+ else
+  end_ptr -= 1;
+
+ if (end_ptr < start_ptr)
+  return 0;
+
+ *value = start_ptr;
+
+ return (int)(end_ptr - start_ptr + 1);
+}
+
+/*!
+* \brief Replaces 'special' characters in a form value.
+*
+* Replaces '+' with ' ' and %nn with the ASCII character.
+* Note: the 'special' characters are introduced by the client
+* when the browser encounters user input characters that have
+* a special meaning e.g. ' ' and '/'.
+*
+* The string is decoded in place; decoding never makes it longer.
+* The hex digits may be upper or lower case. A '%' not followed by two
+* hex digits, including one at the end of the string, is kept as is.
+*
+* \param str Input string from web client.
+* \param len Length of str.
+* \return int. Length of the decoded string.
+*/
+
+int replace_special_html_characters(char *str, int len)
+{
+ int out_len = 0;
+ int nibble[2];
+
+ for (int i = 0; i < len; i++)
+ {
+  if (str[i] == '+')
+  {
+   str[out_len++] = ' ';  // Replace '+' with ' '.
+  }
+  else if ((str[i] == '%') && (i + 2 < len)) // Next two characters are the hex value for an ascii character.
+  {
+   for (int n = 0; n < 2; n++)
+   {
+    char current_char = str[i + 1 + n];
+
+    if ((current_char >= '0') && (current_char <= '9'))
+     nibble[n] = current_char - '0';
+    else if ((current_char >= 'A') && (current_char <= 'F'))
+     nibble[n] = (current_char - 'A') + 10;
+    else if ((current_char >= 'a') && (current_char <= 'f'))
+     nibble[n] = (current_char - 'a') + 10;
+    else
+     nibble[n] = -1;
+   }
+
+   if ((nibble[0] < 0) || (nibble[1] < 0))
+   {
+    str[out_len++] = str[i];
+   }
+   else
+   {
+    str[out_len++] = (char)((nibble[0] * 16) + nibble[1]);
+    i += 2;
+   }
+  }
+  else
+  {
+   str[out_len++] = str[i];
+  }
+ }
+
+ if (out_len < len)
+  str[out_len] = 0;
+
+ return out_len;
+}
+
+/*!
+* \brief Checks a decoded WiFi SSID.
+*
+* The WiFi SSID's length must be between 1 and 32 characters (bytes).
+*
+* Rules
+* -----
+* 1. First character must not be in ['!', '#', ';'].
+* 2. Following characters NOT allowed ['+', ']', '/', '"', TAB].
+* 3. Trailing spaces NOT allowed.
+* 4. Each character must be 'ASCII printable' i.e. in the decimal range 32..126.
+*
+* \param ssid SSID.
+* \param len Length of ssid.
+* \return Boolean.
+*/
+
+bool is_valid_wifi_ssid(const char *ssid, int len)
+{
+ if ((len < MIN_SSID_LENGTH) || (len > MAX_SSID_LENGTH))
+  return false;
+
+ if ((ssid[0] == '!') || (ssid[0] == '#') || (ssid[0] == ';'))  // Illegal start character.
+  return false;
+
+ if (ssid[len - 1] == ' ')  // Trailing space NOT allowed
+  return false;
+
+ for (int i = 0; i < len; i++)
+ {
+  if (strchr("+]/\"\t", ssid[i]) != NULL)
+   return false;
+ }
+
+ return is_printable(ssid, len);
+}
+
+/*!
+* \brief Checks a decoded WiFi password (passphrase).
+*
+* The WiFi password's length must be between 8 and 63 characters (bytes).
+* Each character must be 'ASCII printable' i.e. in the decimal range 32..126.
+*
+* \param password Password.
+* \param len Length of password.
+* \return Boolean.
+*/
+
+bool is_valid_wifi_password(const char *password, int len)
+{
+ if ((len < MIN_PASSWORD_LENGTH) || (len > MAX_PASSWORD_LENGTH))
+  return false;
+
+ return is_printable(password, len);
+}
+
+/*!
+* \brief Checks a decoded image server URL.
+*
+* The image server's URL must not contain any spaces.
+* Each character must be 'ASCII printable' i.e. in the decimal range 32..126.
+*
+* \param url URL.
+* \param len Length of url.
+* \return Boolean.
+*/
+
+bool is_valid_image_server_url(const char *url, int len)
+{
+ if (memchr(url, ' ', len) != NULL)
+  return false;
+
+ return is_printable(url, len);
+}
+
+/*!
+* \brief Returns the reason phrase of an HTTP status code.
+*
+* \param status HTTP_STATUS_OK ...
+* \return const char *. Reason phrase, "Unknown" for codes not used here.
+*/
+
+const char *RAM_FUNC(http_status_text)(int status)
+{
+ switch (status)
+ {
+  case HTTP_STATUS_OK:
+       return "OK";
+  case HTTP_STATUS_NOT_MODIFIED:
+       return "Not Modified";
+  case HTTP_STATUS_BAD_REQUEST:
+       return "Bad Request";
+  case HTTP_STATUS_NOT_FOUND:
+       return "Not Found";
+  case HTTP_STATUS_SERVER_ERROR:
+       return "Internal Server Error";
+  default:
+       return "Unknown";
+ }
+}
+
+/*!
+* \brief Finds a request header.
+*
+* Looks at the start of each header line, from the second line up to the
+* blank line, for the name followed by ':'; names are compared without
+* regard to case. The value is not copied, and leading and trailing
+* spaces and tabs are left out.
+*
+* \param req HTTP request.
+* \param rlen Length of HTTP request.
+* \param name Header name, without the ':'.
+* \param value Set to the start of the header's value.
+* \return int. Length of the value, 0 if the header is absent or empty.
+*/
+
+int RAM_FUNC(find_http_header)(const char *req, int rlen, const char *name, const char **value)
+{
+ int name_len = strlen(name);
+ const char *end = req + rlen;
+ const char *line = (const char *)memchr(req, '\n', rlen);
+
+ *value = req;
+
+ while (line != NULL)
+ {
+  line++;
+
+  if ((line >= end) || (*line == '\r') || (*line == '\n'))
+   return 0;  // End of the headers.
+
+  const char *line_end = (const char *)memchr(line, '\n', end - line);
+
+  if (line_end == NULL)
+   line_end = end;
+
+  if ((line_end - line > name_len) && (line[name_len] == ':') && (strncasecmp(line, name, name_len) == 0))
+  {
+   const char *start = line + name_len + 1;
+   const char *stop = line_end;
+
+   while ((start < stop) && ((*start == ' ') || (*start == '\t')))
+    start++;
+
+   while ((stop > start) && ((stop[-1] == '\r') || (stop[-1] == ' ') || (stop[-1] == '\t')))
+    stop--;
+
+   *value = start;
+   return (int)(stop - start);
+  }
+
+  line = (line_end < end) ? line_end : NULL;
+ }
+
+ return 0;
+}
+
+/*!
+* \brief Finds the body of a request, after the blank line.
+*
+* \param req HTTP request.
+* \param rlen Length of HTTP request.
+* \return int. Offset of the body in req, or -1 if the headers do not end.
+*/
+
+int find_http_body(const char *req, int rlen)
+{
+ for (int i = 0; i + 3 < rlen; i++)
+ {
+  if ((req[i] == '\r') && (req[i + 1] == '\n') && (req[i + 2] == '\r') && (req[i + 3] == '\n'))
+   return i + 4;
+ }
+
+ return -1;
+}
+
+/*!
+* \brief Returns the entity tag of a page.
+*
+* A multiply and rotate hash, a word at a time: one multiply per four
+* bytes rather than one per byte, it runs on every page sent.
+*
+* \param data Page contents.
+* \param len Length of data.
+* \return uint32_t. Hash of data.
+*/
+
+uint32_t RAM_FUNC(http_etag)(const char *data, int len)
+{
+ uint32_t h = 2166136261u ^ (uint32_t)len;
+ uint32_t word;
+ int i = 0;
+
+ for (; i + 4 <= len; i += 4)
+ {
+  memcpy(&word, &data[i], sizeof(word));
+  h = (h ^ word) * 0x9e3779b1u;
+  h = (h << 15) | (h >> 17);
+ }
+
+ for (; i < len; i++)
+  h = (h ^ (uint8_t)data[i]) * 0x9e3779b1u;
+
+ return h ^ (h >> 16);
+}
+
+/*!
+* \brief Formats an entity tag as sent in ETag.
+*
+* \param buf Buffer of HTTP_ETAG_SIZE bytes, set to the quoted tag.
+* \param etag Entity tag, see http_etag().
+*/
+
+void RAM_FUNC(format_etag)(char *buf, uint32_t etag)
+{
+ static const char hex_digits[] = "0123456789abcdef";
+
+ buf[0] = '"';
+
+ for (int n = 0; n < 8; n++)
+  buf[1 + n] = hex_digits[(etag >> (28 - (4 * n))) & 0xf];
+
+ buf[9] = '"';
+ buf[10] = 0;
+}
+
+/*!
+* \brief Checks an If-None-Match value for an entity tag.
+*
+* The value is "*" or a comma separated list of quoted tags, each
+* optionally weak ("W/"); If-None-Match compares them weakly, so the
+* prefix is ignored.
+*
+* \param list If-None-Match value.
+* \param len Length of list.
+* \param etag Tag of the current page, see http_etag().
+* \return bool. true if the client's copy is current.
+*/
+
+bool RAM_FUNC(is_etag_listed)(const char *list, int len, uint32_t etag)
+{
+ char tag[HTTP_ETAG_SIZE];
+ int i = 0;
+
+ format_etag(tag, etag);
+
+ while (i < len)
+ {
+  while ((i < len) && ((list[i] == ' ') || (list[i] == '\t') || (list[i] == ',')))
+   i++;
+
+  if ((i < len) && (list[i] == '*'))
+   return true;
+
+  if ((i + 1 < len) && (list[i] == 'W') && (list[i + 1] == '/'))
+   i += 2;
+
+  if ((i + HTTP_ETAG_SIZE - 1 <= len) && (memcmp(&list[i], tag, HTTP_ETAG_SIZE - 1) == 0))
+   return true;
+
+// Skip to the next tag. Tags are quoted and may contain commas.
+
+  if ((i < len) && (list[i] == '"'))
+  {
+   const char *close = (const char *)memchr(&list[i + 1], '"', len - i - 1);
+
+   i = (close == NULL) ? len : (int)(close - list) + 1;
+  }
+
+  while ((i < len) && (list[i] != ','))
+   i++;
+ }
+
+ return false;
+}
+
+/*!
+* \brief Checks a header's comma separated list for a token.
+*
+* As in Accept-Encoding: "gzip, deflate;q=0.5". Tokens are compared
+* without regard to case; one with q=0 is refused, not listed.
+*
+* \param list Header value, e.g. from find_http_header().
+* \param len Length of list.
+* \param token Token to look for, e.g. "gzip".
+* \return bool. true if the token is listed and not refused.
+*/
+
+bool is_http_token_listed(const char *list, int len, const char *token)
+{
+ int token_len = strlen(token);
+ int i = 0;
+
+ while (i < len)
+ {
+  while ((i < len) && ((list[i] == ' ') || (list[i] == '\t') || (list[i] == ',')))
+   i++;
+
+  int start = i;
+
+  while ((i < len) && (list[i] != ',') && (list[i] != ';') && (list[i] != ' ') && (list[i] != '\t'))
+   i++;
+
+  bool is_match = (i - start == token_len) && (strncasecmp(&list[start], token, token_len) == 0);
+
+// Parameters, up to the next element.
+
+  start = i;
+
+  while ((i < len) && (list[i] != ','))
+   i++;
+
+  if (is_match == true)
+  {
+   for (int q = start; q + 2 < i; q++)
+   {
+    if (((list[q] == 'q') || (list[q] == 'Q')) && (list[q + 1] == '='))
+    {
+     q += 2;
+
+     while ((q < i) && ((list[q] == '0') || (list[q] == '.')))
+      q++;
+
+     return (q < i) && (list[q] >= '1') && (list[q] <= '9');
+    }
+   }
+
+   return true;
+  }
+ }
+
+ return false;
+}
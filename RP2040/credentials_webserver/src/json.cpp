@@ -0,0 +1,611 @@
+/*!
+ * @file
+ * Compact JSON reader and writer.
+ */
+
+/*
+ * Copyright (c) 2023, FAV Software Limited. All rights reserved.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * File:   json.cpp
+ * Author: busdev
+ *
+ * Created on 19 October 2026
+ * Updated on 19 October 2026
+ */
+
+#include <cstdint>
+#include <cstring>
+
+#include "json.h"
+
+/*!
+* \brief Skips white space.
+*
+* \return int. Offset of the first other character, or len.
+*/
+
+static int skip_space(const char *json, int len, int offset)
+{
+ while ((offset < len) && ((json[offset] == ' ') || (json[offset] == '\t') || (json[offset] == '\r') || (json[offset] == '\n')))
+  offset++;
+
+ return offset;
+}
+
+/*!
+* \brief Returns the value of a hex digit, or -1.
+*/
+
+static int hex_value(char c)
+{
+ if ((c >= '0') && (c <= '9'))
+  return c - '0';
+
+ if ((c >= 'a') && (c <= 'f'))
+  return c - 'a' + 10;
+
+ if ((c >= 'A') && (c <= 'F'))
+  return c - 'A' + 10;
+
+ return -1;
+}
+
+/*!
+* \brief Reads the four hex digits of a \u escape.
+*
+* \return long. The code unit, or -1.
+*/
+
+static long read_code_unit(const char *hex, int len)
+{
+ long unit = 0;
+
+ if (len < 4)
+  return -1;
+
+ for (int i = 0; i < 4; i++)
+ {
+  int digit = hex_value(hex[i]);
+
+  if (digit < 0)
+   return -1;
+
+  unit = (unit << 4) | digit;
+ }
+
+ return unit;
+}
+
+/*!
+* \brief Scans a string, from the opening quote.
+*
+* Control characters must be escaped and escapes must be valid; the
+* \u escapes are checked by json_unescape().
+*
+* \return int. Offset after the closing quote, or JSON_ERROR.
+*/
+
+static int scan_string(const char *json, int len, int offset)
+{
+ offset++;  // Opening quote.
+
+ while (offset < len)
+ {
+  uint8_t c = json[offset];
+
+  if (c == '"')
+   return offset + 1;
+
+  if (c < 0x20)
+   return JSON_ERROR;
+
+  if (c == '\\')
+  {
+   if (offset + 1 >= len)
+    return JSON_ERROR;
+
+   if (strchr("\"\\/bfnrtu", json[offset + 1]) == NULL)
+    return JSON_ERROR;
+
+   offset++;
+  }
+
+  offset++;
+ }
+
+ return JSON_ERROR;  // Not terminated.
+}
+
+/*!
+* \brief Scans a number: -?int(.digits)?([eE][+-]?digits)?
+*
+* \return int. Offset after the number, or JSON_ERROR.
+*/
+
+static int scan_number(const char *json, int len, int offset)
+{
+ int start;
+
+ if ((offset < len) && (json[offset] == '-'))
+  offset++;
+
+ if ((offset < len) && (json[offset] == '0'))
+ {
+  offset++;
+ }
+ else
+ {
+  start = offset;
+
+  while ((offset < len) && (json[offset] >= '0') && (json[offset] <= '9'))
+   offset++;
+
+  if (offset == start)
+   return JSON_ERROR;
+ }
+
+ if ((offset < len) && (json[offset] == '.'))
+ {
+  start = ++offset;
+
+  while ((offset < len) && (json[offset] >= '0') && (json[offset] <= '9'))
+   offset++;
+
+  if (offset == start)
+   return JSON_ERROR;
+ }
+
+ if ((offset < len) && ((json[offset] == 'e') || (json[offset] == 'E')))
+ {
+  offset++;
+
+  if ((offset < len) && ((json[offset] == '+') || (json[offset] == '-')))
+   offset++;
+
+  start = offset;
+
+  while ((offset < len) && (json[offset] >= '0') && (json[offset] <= '9'))
+   offset++;
+
+  if (offset == start)
+   return JSON_ERROR;
+ }
+
+ return offset;
+}
+
+/*!
+* \brief Reads the next member of a flat object.
+*
+* Start with *cursor set to 0; each call reads one member and moves the
+* cursor past it. Values that are objects or arrays are not supported.
+* Nothing but white space may follow the object.
+*
+* \param json Object text, need not be terminated.
+* \param len Length of json.
+* \param cursor Position in json, kept between calls.
+* \param member Set to the member read.
+* \return int. JSON_MEMBER, JSON_END after the last member, or JSON_ERROR.
+*/
+
+int json_next_member(const char *json, int len, int *cursor, struct json_member *member)
+{
+ int offset = *cursor;
+ int end;
+
+ if (offset > len)
+  return JSON_END;
+
+ if (offset == 0)
+ {
+  offset = skip_space(json, len, 0);
+
+  if ((offset >= len) || (json[offset] != '{'))
+   return JSON_ERROR;
+
+  offset++;
+ }
+
+ offset = skip_space(json, len, offset);
+
+ if (offset >= len)
+  return JSON_ERROR;
+
+// End of the object, unless it follows a comma.
+
+ if (json[offset] == '}')
+ {
+  int previous = offset - 1;
+
+  while ((previous > 0) && (skip_space(json, len, previous) != previous))
+   previous--;
+
+  if (json[previous] == ',')
+   return JSON_ERROR;
+
+  if (skip_space(json, len, offset + 1) != len)
+   return JSON_ERROR;  // Trailing text.
+
+  *cursor = len + 1;
+  return JSON_END;
+ }
+
+// Name.
+
+ if (json[offset] != '"')
+  return JSON_ERROR;
+
+ end = scan_string(json, len, offset);
+
+ if (end == JSON_ERROR)
+  return JSON_ERROR;
+
+ member->name = &json[offset + 1];
+ member->name_len = end - offset - 2;
+
+ offset = skip_space(json, len, end);
+
+ if ((offset >= len) || (json[offset] != ':'))
+  return JSON_ERROR;
+
+ offset = skip_space(json, len, offset + 1);
+
+ if (offset >= len)
+  return JSON_ERROR;
+
+// Value.
+
+ if (json[offset] == '"')
+ {
+  end = scan_string(json, len, offset);
+
+  if (end == JSON_ERROR)
+   return JSON_ERROR;
+
+  member->value = &json[offset + 1];
+  member->value_len = end - offset - 2;
+  member->type = JSON_STRING;
+ }
+ else
+ {
+  if ((json[offset] == '-') || ((json[offset] >= '0') && (json[offset] <= '9')))
+  {
+   end = scan_number(json, len, offset);
+   member->type = JSON_NUMBER;
+  }
+  else if ((len - offset >= 4) && (strncmp(&json[offset], "true", 4) == 0))
+  {
+   end = offset + 4;
+   member->type = JSON_TRUE;
+  }
+  else if ((len - offset >= 5) && (strncmp(&json[offset], "false", 5) == 0))
+  {
+   end = offset + 5;
+   member->type = JSON_FALSE;
+  }
+  else if ((len - offset >= 4) && (strncmp(&json[offset], "null", 4) == 0))
+  {
+   end = offset + 4;
+   member->type = JSON_NULL;
+  }
+  else
+  {
+   end = JSON_ERROR;  // Object, array or not JSON.
+  }
+
+  if (end == JSON_ERROR)
+   return JSON_ERROR;
+
+  member->value = &json[offset];
+  member->value_len = end - offset;
+ }
+
+// A comma, or the end of the object for the next call.
+
+ offset = skip_space(json, len, end);
+
+ if ((offset < len) && (json[offset] == ','))
+  offset++;
+ else if ((offset >= len) || (json[offset] != '}'))
+  return JSON_ERROR;
+
+ *cursor = offset;
+
+ return JSON_MEMBER;
+}
+
+/*!
+* \brief Checks a member's name.
+*
+* \param member Member from json_next_member().
+* \param name Name, without escapes.
+* \return bool. true if the member has that name.
+*/
+
+bool json_name_is(const struct json_member *member, const char *name)
+{
+ int len = strlen(name);
+
+ return (member->name_len == len) && (memcmp(member->name, name, len) == 0);
+}
+
+/*!
+* \brief Copies a string value out, resolving its escapes.
+*
+* \u escapes are written as UTF-8; surrogate pairs are joined. An escaped
+* NUL, a lone surrogate or an invalid escape is an error, as is a value
+* that does not fit out with its terminator.
+*
+* \param out Set to the terminated value.
+* \param size Size of out.
+* \param value String value from json_next_member().
+* \param len Length of value.
+* \return int. Length of the value written to out, or JSON_ERROR.
+*/
+
+int json_unescape(char *out, int size, const char *value, int len)
+{
+ int n = 0;
+
+ for (int i = 0; i < len; i++)
+ {
+  long code = (uint8_t)value[i];
+  int bytes = 1;
+
+  if (code == '\\')
+  {
+   if (++i >= len)
+    return JSON_ERROR;
+
+   switch (value[i])
+   {
+    case '"':  code = '"';  break;
+    case '\\': code = '\\'; break;
+    case '/':  code = '/';  break;
+    case 'b':  code = '\b'; break;
+    case 'f':  code = '\f'; break;
+    case 'n':  code = '\n'; break;
+    case 'r':  code = '\r'; break;
+    case 't':  code = '\t'; break;
+    case 'u':
+         code = read_code_unit(&value[i + 1], len - i - 1);
+         i += 4;
+
+         if ((code >= 0xD800) && (code <= 0xDBFF))  // High surrogate, the low one must follow.
+         {
+          long low = -1;
+
+          if ((i + 2 < len) && (value[i + 1] == '\\') && (value[i + 2] == 'u'))
+           low = read_code_unit(&value[i + 3], len - i - 3);
+
+          if ((low < 0xDC00) || (low > 0xDFFF))
+           return JSON_ERROR;
+
+          code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+          i += 6;
+         }
+         else if ((code >= 0xDC00) && (code <= 0xDFFF))
+         {
+          return JSON_ERROR;
+         }
+
+         if (code <= 0)
+          return JSON_ERROR;  // Invalid, or NUL.
+
+         bytes = (code < 0x80) ? 1 : (code < 0x800) ? 2 : (code < 0x10000) ? 3 : 4;
+         break;
+    default:
+         return JSON_ERROR;
+   }
+  }
+  else if (code < 0x20)
+  {
+   return JSON_ERROR;
+  }
+
+  if (n + bytes >= size)
+   return JSON_ERROR;
+
+// Raw bytes, including UTF-8 sequences, are copied as they are.
+
+  if (bytes == 1)
+  {
+   out[n++] = (char)code;
+  }
+  else
+  {
+   int shift = 6 * (bytes - 1);
+
+   out[n++] = (char)(((0xF00 >> bytes) & 0xFF) | (code >> shift));
+
+   while (shift > 0)
+   {
+    shift -= 6;
+    out[n++] = (char)(0x80 | ((code >> shift) & 0x3F));
+   }
+  }
+ }
+
+ out[n] = 0;
+
+ return n;
+}
+
+/*!
+* \brief Appends text to the writer's buffer.
+*
+* Keeps one byte for the terminator. Once something does not fit,
+* nothing more is written.
+*/
+
+static void put(struct json_writer *writer, const char *text, int len)
+{
+ if ((writer->is_overflow == true) || (writer->len + len >= writer->size))
+ {
+  writer->is_overflow = true;
+  return;
+ }
+
+ memcpy(&writer->buf[writer->len], text, len);
+ writer->len += len;
+}
+
+/*!
+* \brief Appends a quoted, escaped string.
+*
+* Quotes, backslashes and control characters are escaped; all other
+* bytes, UTF-8 included, are written as they are.
+*/
+
+static void put_string(struct json_writer *writer, const char *value, int len)
+{
+ static const char hex[] = "0123456789abcdef";
+ int start = 0;
+
+ put(writer, "\"", 1);
+
+ for (int i = 0; i < len; i++)
+ {
+  uint8_t c = value[i];
+  char escape[6] = { '\\', 0, '0', '0', 0, 0 };
+  int escape_len = 2;
+
+  if (c == '"')
+   escape[1] = '"';
+  else if (c == '\\')
+   escape[1] = '\\';
+  else if (c == '\n')
+   escape[1] = 'n';
+  else if (c == '\r')
+   escape[1] = 'r';
+  else if (c == '\t')
+   escape[1] = 't';
+  else if (c < 0x20)
+  {
+   escape[1] = 'u';
+   escape[4] = hex[c >> 4];
+   escape[5] = hex[c & 0x0F];
+   escape_len = 6;
+  }
+  else
+   continue;
+
+  put(writer, &value[start], i - start);  // The run before the escape.
+  put(writer, escape, escape_len);
+  start = i + 1;
+ }
+
+ put(writer, &value[start], len - start);
+ put(writer, "\"", 1);
+}
+
+/*!
+* \brief Appends a member's name, after a comma if it is not the first.
+*/
+
+static void put_name(struct json_writer *writer, const char *name)
+{
+ if (writer->len > 1)
+  put(writer, ",", 1);
+
+ put_string(writer, name, strlen(name));
+ put(writer, ":", 1);
+}
+
+/*!
+* \brief Starts an object.
+*
+* \param writer Writer to start.
+* \param buf Buffer to write the object to.
+* \param size Size of buf.
+*/
+
+void json_begin_object(struct json_writer *writer, char *buf, int size)
+{
+ writer->buf = buf;
+ writer->size = size;
+ writer->len = 0;
+ writer->is_overflow = false;
+
+ put(writer, "{", 1);
+}
+
+/*!
+* \brief Adds a string member.
+*
+* \param writer Writer from json_begin_object().
+* \param name Member name.
+* \param value String, need not be terminated.
+* \param len Length of value.
+*/
+
+void json_add_string(struct json_writer *writer, const char *name, const char *value, int len)
+{
+ put_name(writer, name);
+ put_string(writer, value, len);
+}
+
+/*!
+* \brief Adds a number member.
+*
+* \param writer Writer from json_begin_object().
+* \param name Member name.
+* \param value Number.
+*/
+
+void json_add_int(struct json_writer *writer, const char *name, int value)
+{
+ char digits[12];
+ int n = sizeof(digits);
+ uint32_t magnitude = (value < 0) ? (0u - (uint32_t)value) : (uint32_t)value;
+
+ do
+ {
+  digits[--n] = '0' + (magnitude % 10);
+  magnitude /= 10;
+ } while (magnitude > 0);
+
+ if (value < 0)
+  digits[--n] = '-';
+
+ put_name(writer, name);
+ put(writer, &digits[n], sizeof(digits) - n);
+}
+
+/*!
+* \brief Ends the object and terminates it.
+*
+* \param writer Writer from json_begin_object().
+* \return int. Length of the object, or JSON_ERROR if it did not fit.
+*/
+
+int json_end_object(struct json_writer *writer)
+{
+ put(writer, "}", 1);
+
+ if (writer->is_overflow == true)
+ {
+  if (writer->size > 0)
+   writer->buf[0] = 0;
+
+  return JSON_ERROR;
+ }
+
+ writer->buf[writer->len] = 0;
+
+ return writer->len;
+}
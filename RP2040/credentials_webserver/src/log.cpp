@@ -21,6 +21,12 @@
 
 //
 // Log.
+//
+// Errors and log events are pushed as fixed size binary records into a
+// ring buffer, so that the caller does not format text, allocate or wait
+// for the UART. The records are formatted later, in idle time, by
+// process(). With LOG_BINARY_OUTPUT set, process() writes the raw records
+// instead and formatting is left to tools/log_decode.py on the host.
 // 
 
 /* 
@@ -28,13 +34,24 @@
  * Author: busdev
  *
  * Created on 14 February 2023
- * Updated on 14 February 2023
+ * Updated on 19 October 2026
  */
 
+#include <cstdio>
+
 #include "log.h"
+#include "tiny_format.h"
+
+#ifndef LOG_BINARY_OUTPUT
+#define LOG_BINARY_OUTPUT 0
+#endif
 
 Log::Log(bool is_verbose):
- is_verbose(is_verbose) { }
+ is_verbose(is_verbose),
+ sink(NULL),
+ head(0),
+ tail(0),
+ dropped_count(0) { }
 
 Log::~Log()
 { }
@@ -43,12 +60,12 @@ Log::~Log()
 * \brief Gets error text using error number.
 *
 * \param error_number
-* \return string
+* \return const char*
 */
 
-string Log::get_error_text(int error_number)
+const char *Log::get_error_text(int error_number)
 {
- string error_text = "";
+ const char *error_text = "";
 
  switch (error_number)
  {
@@ -59,6 +76,8 @@ string Log::get_error_text(int error_number)
   case TCP_BUFFER_ERR: error_text = TCP_BUFFER_ERR_MSG; break;
   case TCP_WRITE_ERR: error_text = TCP_WRITE_ERR_MSG; break;
   case WIFI_INIT_ERR: error_text = WIFI_INIT_ERR_MSG; break;
+  case FLASH_WRITE_ERR: error_text = FLASH_WRITE_ERR_MSG; break;
+  case PAGE_BUFFER_ERR: error_text = PAGE_BUFFER_ERR_MSG; break;
   
   default: error_text = UNDEFINED_ERROR_MSG;
  }
@@ -70,12 +89,12 @@ string Log::get_error_text(int error_number)
 * \brief Gets log text using log number.
 *
 * \param log_number
-* \return string
+* \return const char*
 */
 
-string Log::get_log_text(int log_number)
+const char *Log::get_log_text(int log_number)
 {
- string log_text = "";
+ const char *log_text = "";
 
  switch (log_number)
  {
@@ -83,6 +102,9 @@ string Log::get_log_text(int log_number)
   case FLASH_STORAGE_AREA_INITIALISED: log_text = FLASH_STORAGE_AREA_INITIALISED_MSG; break;
   case WIFI_CREDENTIALS_SET: log_text = WIFI_CREDENTIALS_SET_MSG; break;
   case WIFI_CREDENTIALS_UPDATED: log_text = WIFI_CREDENTIALS_UPDATED_MSG; break;
+  case WIFI_CREDENTIALS_RECEIVED: log_text = WIFI_CREDENTIALS_RECEIVED_MSG; break;
+  case MAIN_SINCE_TIMER_START: log_text = MAIN_SINCE_TIMER_START_MSG; break;
+  case PROVISIONING_SESSION_ENDED: log_text = PROVISIONING_SESSION_ENDED_MSG; break;
 
   default: log_text = UNDEFINED_LOG_MSG;
  }
@@ -91,72 +113,206 @@ string Log::get_log_text(int log_number)
 }
 
 /*!
-* \brief Prints error message.
+* \brief Logs error.
 *
-* Looks up text of error message using the error_number.
+* Pushes an error record, the text is looked up when it is processed.
 *
 * \param error_number
 */
 
 void Log::print_error(int error_number)
 {
- if (is_verbose == true)
- {
-  print_message("");  
-  
-  switch (error_number)
-  {
-   case NO_ERROR: break;
-   case TCP_PCB_MEMORY_ERR: print_message(TCP_PCB_MEMORY_ERR_MSG); break;
-   case TCP_BIND_ERR: print_message(TCP_BIND_ERR_MSG); break;
-   case TCP_START_LISTEN_ERR: print_message(TCP_START_LISTEN_ERR_MSG); break;
-   case TCP_BUFFER_ERR: print_message(TCP_BUFFER_ERR_MSG); break;
-   case TCP_WRITE_ERR: print_message(TCP_WRITE_ERR_MSG); break;
-   case WIFI_INIT_ERR: print_message(WIFI_INIT_ERR_MSG); break;
-  
-   default: print_message(UNDEFINED_ERROR_MSG);
-  }
- }
+ LOG_ERROR(this, error_number, 0, 0);
 }
 
 /*!
-* \brief Prints log message.
+* \brief Logs log message.
 *
-* Looks up text of log message using the log_number.
+* Pushes a log record, the text is looked up when it is processed.
 *
 * \param log_number
 */
 
 void Log::print_log(int log_number)
+{
+ LOG_INFO(this, log_number, 0, 0);
+}
+
+/*!
+* \brief Prints message.
+*
+* Checks the is_verbose boolean and if true, prints msg to stdout
+* immediately. Intended for rare, free text messages only; use the
+* log macros on the request paths.
+*
+* \param msg
+*/
+
+void Log::print_message(const char *msg)
 {
  if (is_verbose == true)
  {
-  print_message("");   
-  
-  switch (log_number)
-  {
-   case CONFIG_JUMPER_DETECTED: print_message(CONFIG_JUMPER_DETECTED_MSG); break;
-   case FLASH_STORAGE_AREA_INITIALISED: print_message(FLASH_STORAGE_AREA_INITIALISED_MSG); break;
-   case WIFI_CREDENTIALS_SET: print_message(WIFI_CREDENTIALS_SET_MSG); break;
-   case WIFI_CREDENTIALS_UPDATED: print_message(WIFI_CREDENTIALS_UPDATED_MSG); break;
+  fputs(msg, stdout);
+  fputc('\n', stdout);
+ }
+}
+
+/*!
+* \brief Pushes a binary record into the ring.
+*
+* Does not block or allocate. If the ring is full the record is dropped
+* and counted.
+*
+* \param type LOG_TYPE_ERROR or LOG_TYPE_LOG.
+* \param level LOG_LEVEL_ERROR..LOG_LEVEL_DEBUG.
+* \param code Error or log code.
+* \param arg0 First argument of the message.
+* \param arg1 Second argument of the message.
+*/
+
+void Log::push(uint8_t type, uint8_t level, uint16_t code, uint32_t arg0, uint32_t arg1)
+{
+ uint32_t h = head.load(std::memory_order_relaxed);
+
+ if ((h - tail.load(std::memory_order_acquire)) >= LOG_RING_SIZE)
+ {
+  dropped_count++;
+  return;
+ }
+
+ struct log_record *record = &ring[h & (LOG_RING_SIZE - 1)];
+
+ record->timestamp_us = time_us_32();
+ record->type = type;
+ record->level = level;
+ record->code = code;
+ record->args[0] = arg0;
+ record->args[1] = arg1;
+
+ head.store(h + 1, std::memory_order_release);
+}
+
+/*!
+* \brief Formats and outputs pending records.
+*
+* Called in idle time. At most LOG_PROCESS_BUDGET records are output
+* per call, to bound the time spent away from the network.
+* Also keeps the output sink, if any, draining.
+*
+* \return int. Number of records processed.
+*/
+
+int Log::process(void)
+{
+ int processed = 0;
+ uint32_t t = tail.load(std::memory_order_relaxed);
+
+ if (sink != NULL)
+ {
+  sink->poll();
+ }
 
-   default: print_message(UNDEFINED_LOG_MSG);
+ while ((processed < LOG_PROCESS_BUDGET) && (t != head.load(std::memory_order_acquire)))
+ {
+  if (is_verbose == true)
+  {
+   output_record(&ring[t & (LOG_RING_SIZE - 1)]);
   }
+
+  t++;
+  tail.store(t, std::memory_order_release);
+  processed++;
  }
+
+ return processed;
 }
 
 /*!
-* \brief Prints message.
+* \brief Processes all pending records.
 *
-* Checks the is_verbose boolean and if true, prints msg to stdout.
+* Used before leaving the application, when idle time is not a concern.
+*/
+
+void Log::flush(void)
+{
+ while (process() > 0);
+
+ if (sink != NULL)
+ {
+  sink->flush();
+ }
+}
+
+/*!
+* \brief Gets number of records dropped because the ring was full.
 *
-* \param msg
+* \return uint32_t
 */
 
-void Log::print_message(string msg)
+uint32_t Log::get_dropped_count(void)
 {
- if (is_verbose == true)
+ return dropped_count;
+}
+
+/*!
+* \brief Sets the sink that stdout is routed through.
+*
+* The Log does not write to the sink directly, stdout does; the Log
+* keeps it draining from process() and flush().
+*
+* \param sink
+*/
+
+void Log::set_sink(Log_Sink *sink)
+{
+ this->sink = sink;
+}
+
+/*!
+* \brief Gets the output sink.
+*
+* \return Log_Sink*. NULL if stdout is not routed through a sink.
+*/
+
+Log_Sink *Log::get_sink(void)
+{
+ return sink;
+}
+
+/*!
+* \brief Outputs one record.
+*
+* Text output: "[timestamp] E|W|I|D code message", formatted with
+* tiny_format() into a stack buffer and written with a single fputs().
+* Binary output: the two sync bytes followed by the record.
+*
+* \param record
+*/
+
+void Log::output_record(const struct log_record *record)
+{
+ static const char level_chars[] = "-EWID";
+ char line[LOG_LINE_SIZE];
+ int len;
+
+ if (LOG_BINARY_OUTPUT)
  {
-  std::cout << msg << std::endl;
+  fputc(LOG_SYNC_BYTE_1, stdout);
+  fputc(LOG_SYNC_BYTE_2, stdout);
+  fwrite(record, sizeof(struct log_record), 1, stdout);
+  return;
  }
-}
\ No newline at end of file
+
+ const char *text = (record->type == LOG_TYPE_ERROR) ? get_error_text(record->code) : get_log_text(record->code);
+
+ len = tiny_format(line, sizeof(line) - 1, "[%10u] %c%02u ", record->timestamp_us, (record->level <= LOG_LEVEL_DEBUG) ? level_chars[record->level] : '?', (uint32_t)record->code);
+ len += tiny_format(&line[len], sizeof(line) - 1 - len, text, record->args[0], record->args[1]);
+
+ if (len > (int)sizeof(line) - 2)
+  len = sizeof(line) - 2;
+
+ line[len++] = '\n';
+ line[len] = 0;
+
+ fputs(line, stdout);
+}
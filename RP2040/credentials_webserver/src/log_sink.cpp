@@ -0,0 +1,187 @@
+/*!
+ * @file
+ * log_sink class.
+ */
+
+/*
+ * Copyright (c) 2023, FAV Software Limited. All rights reserved.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+//
+// Log Sink.
+//
+// Ring buffer, overflow and latency accounting shared by the log sinks.
+// head is only written by write(), tail only by consume(), so a single
+// writer and a single drainer need no locking.
+//
+
+/*
+ * File:   log_sink.cpp
+ * Author: busdev
+ *
+ * Created on 19 October 2026
+ * Updated on 19 October 2026
+ */
+
+#include <cstring>
+
+#include "log_sink.h"
+
+Log_Sink::Log_Sink():
+ head(0),
+ tail(0),
+ is_probe_pending(false),
+ probe_end(0),
+ probe_start_us(0)
+ {
+  memset(&stats, 0, sizeof(stats));
+ }
+
+Log_Sink::~Log_Sink()
+{ }
+
+/*!
+* \brief Queues bytes for output.
+*
+* Copies as many bytes as fit into the ring, drops the rest.
+* Never blocks.
+*
+* \param data Bytes to be output.
+* \param len Number of bytes.
+* \return int. Number of bytes queued.
+*/
+
+int Log_Sink::write(const char *data, int len)
+{
+ uint32_t h = head;
+ uint32_t space = LOG_SINK_BUFFER_SIZE - (h - tail);
+ uint32_t index = h & (LOG_SINK_BUFFER_SIZE - 1);
+ uint32_t first = LOG_SINK_BUFFER_SIZE - index;
+ uint32_t count;
+
+ if (len <= 0)
+  return 0;
+
+ count = ((uint32_t)len < space) ? (uint32_t)len : space;
+
+ if (first > count)
+  first = count;
+
+ memcpy(&buffer[index], data, first);
+ memcpy(&buffer[0], data + first, count - first);
+
+ head = h + count;
+
+ stats.bytes_queued += count;
+
+ if (count < (uint32_t)len)
+ {
+  stats.bytes_dropped += len - count;
+  stats.drop_events++;
+ }
+
+ if ((is_probe_pending == false) && (count > 0))  // Tag this write for latency measurement.
+ {
+  is_probe_pending = true;
+  probe_end = head;
+  probe_start_us = time_us_32();
+ }
+
+ poll();  // Start draining now if the output is idle.
+
+ return count;
+}
+
+/*!
+* \brief Waits until all queued bytes have been output.
+*
+* Blocking, intended for use before leaving the application only.
+*/
+
+void Log_Sink::flush(void)
+{
+ while (is_empty() == false)
+ {
+  poll();
+ }
+}
+
+/*!
+* \brief Checks if all queued bytes have been output.
+*
+* \return bool
+*/
+
+bool Log_Sink::is_empty(void)
+{
+ return head == tail;
+}
+
+/*!
+* \brief Gets the sink counters.
+*
+* \return struct log_sink_stats
+*/
+
+struct log_sink_stats Log_Sink::get_stats(void)
+{
+ return stats;
+}
+
+/*!
+* \brief Gets the contiguous block of bytes at the tail of the ring.
+*
+* \param data Set to the start of the block.
+* \return int. Number of bytes in the block, 0 if the ring is empty.
+*/
+
+int Log_Sink::get_pending(const uint8_t **data)
+{
+ uint32_t t = tail;
+ uint32_t count = head - t;
+ uint32_t index = t & (LOG_SINK_BUFFER_SIZE - 1);
+
+ if (count > LOG_SINK_BUFFER_SIZE - index)
+  count = LOG_SINK_BUFFER_SIZE - index;
+
+ *data = &buffer[index];
+
+ return count;
+}
+
+/*!
+* \brief Releases bytes that have been output.
+*
+* \param count Number of bytes output, from the tail of the ring.
+*/
+
+void Log_Sink::consume(int count)
+{
+ uint32_t latency_us;
+
+ tail += count;
+ stats.bytes_sent += count;
+
+ if ((is_probe_pending == true) && ((int32_t)(tail - probe_end) >= 0))
+ {
+  latency_us = time_us_32() - probe_start_us;
+  stats.last_latency_us = latency_us;
+
+  if (latency_us > stats.max_latency_us)
+   stats.max_latency_us = latency_us;
+
+  is_probe_pending = false;
+ }
+}
@@ -0,0 +1,218 @@
+/*!
+ * @file
+ * main loop profiler.
+ */
+
+/*
+ * Copyright (c) 2023, FAV Software Limited. All rights reserved.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+// All functions except the wake interrupt handler are called from the main
+// loop. The handler only stores the arrival time of the first wake not yet
+// serviced; the next loop_profiler_poll_begin() takes it.
+//
+// The CYW43 driver keeps the (level) host wake interrupt disabled from the
+// first wake until the poll that services it, so the handler runs once
+// per wake. It is added ahead of the driver's own handler and leaves the
+// interrupt for it to handle.
+//
+// Times are time_us_32() differences, correct across its wrap.
+
+/*
+ * File:   loop_profiler.cpp
+ * Author: busdev
+ *
+ * Created on 19 October 2026
+ * Updated on 19 October 2026
+ */
+
+#include <atomic>
+
+#include "pico/stdlib.h"
+#include "hardware/gpio.h"
+#include "loop_profiler.h"
+#include "metrics.h"
+#include "tiny_format.h"
+
+static const uint32_t iteration_bounds[] = {500, 1000, 1500, 2000, 5000, 10000, 50000, 250000};
+static const uint32_t poll_bounds[] = {10, 25, 50, 100, 250, 1000, 5000, 25000};
+
+static int iteration_metric = METRICS_NONE;
+static int poll_metric = METRICS_NONE;
+static int busy_metric = METRICS_NONE;
+static int service_gap_metric = METRICS_NONE;
+
+static uint32_t wake_gpio;
+static std::atomic<uint32_t> wake_time_us;   // Set by the interrupt handler.
+static std::atomic<bool> is_wake_pending;
+
+static bool is_started;
+static uint32_t poll_start_us;
+static uint32_t idle_start_us;
+static uint32_t window_start_us;
+static uint32_t window_idle_us;
+
+// Summary for loop_profiler_render().
+
+static uint32_t iterations;
+static uint32_t iteration_max_us;
+static uint32_t poll_max_us;
+static uint32_t busy_permille;
+static uint32_t service_gap_max_us;
+
+/*!
+* \brief Records the arrival time of a CYW43 host wake.
+*/
+
+static void wake_irq_handler(void)
+{
+ if (gpio_get_irq_event_mask(wake_gpio) & GPIO_IRQ_LEVEL_HIGH)
+ {
+  if (is_wake_pending.load(std::memory_order_relaxed) == false)
+  {
+   wake_time_us.store(time_us_32(), std::memory_order_relaxed);
+   is_wake_pending.store(true, std::memory_order_release);
+  }
+ }
+}
+
+/*!
+* \brief Registers the profiler metrics.
+*/
+
+void loop_profiler_init(void)
+{
+ iteration_metric = metrics_histogram("cws_loop_iteration_us", "Time between main loop polls.",
+                                      iteration_bounds, sizeof(iteration_bounds) / sizeof(iteration_bounds[0]));
+ poll_metric = metrics_histogram("cws_loop_poll_us", "Time in cyw43_arch_poll().",
+                                 poll_bounds, sizeof(poll_bounds) / sizeof(poll_bounds[0]));
+ busy_metric = metrics_gauge("cws_loop_busy_permille", NULL, "Main loop time not idle, per mille.");
+ service_gap_metric = metrics_gauge("cws_loop_service_gap_max_us", NULL, "Worst time from a CYW43 host wake to its poll.");
+}
+
+/*!
+* \brief Times the service gap from the CYW43 host wake interrupt.
+*
+* Call after cyw43_arch_init(), which sets the interrupt up. Without it
+* the service gap is not measured.
+*
+* \param gpio Host wake pin, CYW43_PIN_WL_HOST_WAKE.
+*/
+
+void loop_profiler_watch_wake_gpio(uint32_t gpio)
+{
+ wake_gpio = gpio;
+ gpio_add_raw_irq_handler_with_order_priority(gpio, wake_irq_handler, PICO_SHARED_IRQ_HANDLER_HIGHEST_ORDER_PRIORITY);
+}
+
+/*!
+* \brief Marks the start of a poll, and of a loop iteration.
+*/
+
+void loop_profiler_poll_begin(void)
+{
+ uint32_t now_us = time_us_32();
+
+ if (is_started == true)
+ {
+  uint32_t iteration_us = now_us - poll_start_us;
+
+  metrics_observe(iteration_metric, iteration_us);
+  iterations++;
+
+  if (iteration_us > iteration_max_us)
+   iteration_max_us = iteration_us;
+ }
+ else
+ {
+  window_start_us = now_us;
+  is_started = true;
+ }
+
+ if (is_wake_pending.load(std::memory_order_acquire) == true)
+ {
+  uint32_t gap_us = now_us - wake_time_us.load(std::memory_order_relaxed);
+
+  is_wake_pending.store(false, std::memory_order_relaxed);
+
+  if (gap_us > service_gap_max_us)
+  {
+   service_gap_max_us = gap_us;
+   metrics_set(service_gap_metric, gap_us);
+  }
+ }
+
+// Close the busy ratio window.
+
+ if ((now_us - window_start_us) >= LOOP_PROFILER_WINDOW_US)
+ {
+  uint32_t window_us = now_us - window_start_us;
+
+  busy_permille = (uint32_t)(((uint64_t)(window_us - window_idle_us) * 1000) / window_us);
+  metrics_set(busy_metric, busy_permille);
+
+  window_start_us = now_us;
+  window_idle_us = 0;
+ }
+
+ poll_start_us = now_us;
+}
+
+/*!
+* \brief Marks the end of a poll.
+*/
+
+void loop_profiler_poll_end(void)
+{
+ uint32_t poll_us = time_us_32() - poll_start_us;
+
+ metrics_observe(poll_metric, poll_us);
+
+ if (poll_us > poll_max_us)
+  poll_max_us = poll_us;
+}
+
+/*!
+* \brief Marks the start of a wait, sleep or wait for event.
+*/
+
+void loop_profiler_idle_begin(void)
+{
+ idle_start_us = time_us_32();
+}
+
+/*!
+* \brief Marks the end of a wait.
+*/
+
+void loop_profiler_idle_end(void)
+{
+ window_idle_us += time_us_32() - idle_start_us;
+}
+
+/*!
+* \brief Writes a summary of the profile into buf.
+*
+* \param buf Destination buffer.
+* \param size Size of buf.
+* \return int. Length of the summary, truncated if >= size.
+*/
+
+int loop_profiler_render(char *buf, int size)
+{
+ return tiny_format(buf, size, "iterations %u, iteration max %u us, poll max %u us, busy %u.%u%%, service gap max %u us",
+                    iterations, iteration_max_us, poll_max_us, busy_permille / 10, busy_permille % 10, service_gap_max_us);
+}
@@ -19,7 +19,7 @@
  * Author: Z Taylor
  *
  * Created on 30 December 2022
- * Updated on 14 February 2023
+ * Updated on 19 October 2026
  * 
  * Description
  * -----------
@@ -60,6 +60,13 @@
 
 #define GPIO15 15
 
+// Optional boot marker: the GPIO, if any, driven high on entry to main(),
+// so a scope or logic analyser can time reset (RUN released) to main().
+
+#ifndef BOOT_MARKER_GPIO
+#define BOOT_MARKER_GPIO -1
+#endif
+
 #include <string.h>
 #include <stdlib.h>
 
@@ -67,12 +74,159 @@
 #include "pico/stdlib.h"
 #include "pico/cyw43_arch.h"
 #include "dhcpserver.h"
+#include "dns_server.h"
 #include "storage_handler.h"
 #include "log.h"
 #include "credentials_webserver.h"
+#include "fixed_string.h"
+#include "trace.h"
+#include "memory_stats.h"
+#include "loop_profiler.h"
+#include "xip_stats.h"
+#include "provisioning.h"
+
+#if LOG_SINK_DMA
+#include "uart_dma_log_sink.h"
+#endif
 
 cyw43_t cyw43_state;
 
+#define MEMORY_REPORT_KEY  'M'  // Sent to the UART to request a memory report.
+#define PROFILE_REPORT_KEY 'P'  // Sent to the UART to request the main loop profile.
+#define SEND_RAW_CHUNK     256  // Bytes per write to the log sink, well within its ring.
+
+/*!
+* \brief Sends binary data to the UART, or USB, as it is.
+*
+* The bytes go straight to the log sink, a chunk at a time so none are
+* dropped, or out with putchar_raw(), so stdio's CR/LF translation does
+* not alter them. Blocks until they have been sent.
+*
+* \param log
+* \param buf
+* \param len
+*/
+
+void send_raw(Log *log, const char *buf, int len)
+{
+ if (log->get_sink() != NULL)
+ {
+  for (int sent = 0; sent < len; sent += SEND_RAW_CHUNK)
+  {
+   log->get_sink()->write(buf + sent, (len - sent < SEND_RAW_CHUNK) ? len - sent : SEND_RAW_CHUNK);
+   log->get_sink()->flush();
+  }
+ }
+ else
+ {
+  for (int i = 0; i < len; i++)
+   putchar_raw(buf[i]);
+
+  stdio_flush();
+ }
+}
+
+/*!
+* \brief Prints the memory report, see memory_stats.h.
+*
+* \param log
+*/
+
+void print_memory_report(Log *log)
+{
+ static char buf[256];
+ uint32_t cursor = 0;
+ int len;
+
+ log->flush();
+
+ while (cursor != MEMORY_STATS_RENDER_DONE)
+ {
+  len = memory_stats_render(buf, sizeof(buf), &cursor);
+
+  if (len > 0)
+  {
+   buf[len - 1] = '\0';  // print_message() adds the last newline.
+   log->print_message(buf);
+  }
+ }
+}
+
+#if TRACE_ENABLED
+
+#define TRACE_DUMP_KEY 'T'   // Sent to the UART to request a trace dump.
+
+/*!
+* \brief Dumps the trace ring to the UART.
+*
+* Same binary format as GET /trace, sent with send_raw(). Blocks until
+* the dump has been sent.
+*
+* \param log
+*/
+
+void dump_trace(Log *log)
+{
+ static char buf[256];
+ uint32_t cursor = 0;
+ int len;
+
+ log->flush();
+
+ while (cursor != TRACE_DUMP_DONE)
+ {
+  len = trace_dump(buf, sizeof(buf), &cursor);
+  send_raw(log, buf, len);
+ }
+}
+
+#endif
+
+/*!
+* \brief Runs a factory provisioning session over stdio, see provisioning.h.
+*
+* Waits PROVISIONING_WINDOW_MS for a request. Once a host has sent one,
+* the session lasts until it sends PROV_OP_EXIT or is silent for
+* PROVISIONING_IDLE_MS. Nothing else uses the UART meanwhile.
+*
+* \param sh
+* \param log
+* \return bool. true if a host opened a session.
+*/
+
+bool run_provisioning(Storage_Handler *sh, Log *log)
+{
+ Provisioning *prov = new Provisioning(sh);
+ uint64_t end_us = time_us_64() + (PROVISIONING_WINDOW_MS * 1000);
+ bool is_session_open;
+ int c;
+
+ log->flush();
+
+ while ((prov->get_is_done() == false) && (time_us_64() < end_us))
+ {
+  c = getchar_timeout_us(PROVISIONING_POLL_US);
+
+  if (c == PICO_ERROR_TIMEOUT)
+   continue;
+
+  if (prov->receive((uint8_t)c) == true)
+  {
+   send_raw(log, (const char *)prov->get_reply(), prov->get_reply_length());
+   end_us = time_us_64() + (PROVISIONING_IDLE_MS * 1000);
+  }
+ }
+
+ is_session_open = prov->get_is_session_open();
+
+ if (is_session_open == true)
+  LOG_INFO(log, PROVISIONING_SESSION_ENDED, prov->get_frame_count(), prov->get_error_count());
+
+ delete prov;
+
+ return is_session_open;
+}
+
 /*!
 * \brief Starts local webserver and polls for WiFi activity.
 *
@@ -86,14 +240,41 @@ cyw43_t cyw43_state;
 
 void run_server(Storage_Handler *sh, Log *log) 
 {
+ char profile[LOG_LINE_SIZE];
+
  cws = new Credentials_Webserver(sh, log);
  cws->set_is_configuring(true);
  cws->start_webserver();
 
  for (;;) // Poll for WiFi activity.
  {
+  loop_profiler_poll_begin();
   cyw43_arch_poll();
+  loop_profiler_poll_end();
+
+  log->process();  // Format pending log records in idle time.
+  xip_stats_poll();
+
+  int key = getchar_timeout_us(0);
+
+  if (key == MEMORY_REPORT_KEY)
+   print_memory_report(log);
+
+  if (key == PROFILE_REPORT_KEY)
+  {
+   loop_profiler_render(profile, sizeof(profile));
+   log->print_message(profile);
+   xip_stats_render(profile, sizeof(profile));
+   log->print_message(profile);
+  }
+
+#if TRACE_ENABLED
+  if (key == TRACE_DUMP_KEY)
+   dump_trace(log);
+#endif
+  loop_profiler_idle_begin();
   sleep_ms(1);  // 1
+  loop_profiler_idle_end();
 
 // Check display mode and stop web server when mode changes from
 // configuration to display.
@@ -122,18 +303,44 @@ void run_server(Storage_Handler *sh, Log *log)
 *
 * Starts local webserver.
 *
+* Before any of that, a host on the UART or USB may provision the display
+* (run_provisioning()); the WiFi is then not started if the credentials
+* are set.
+*
 */
 
 int main() 
 {
- string log_text;
+ uint32_t main_since_timer_us = time_us_32();  // Static constructors and the runtime init after clocks_init().
+
+#if BOOT_MARKER_GPIO >= 0
+ gpio_init(BOOT_MARKER_GPIO);
+ gpio_set_dir(BOOT_MARKER_GPIO, GPIO_OUT);
+ gpio_put(BOOT_MARKER_GPIO, 1);
+#endif
+
+ memory_stats_init();  // Paint the stacks before they are used.
  ip4_addr_t gw, mask;
- dhcp_server_t dhcp_server;
+ static dhcp_server_t dhcp_server;  // Lease table, too big for the stack.
+ static dns_server_t dns_server;
  Storage_Handler *sh;
  Log *log;
 
  stdio_init_all();
 
+ log = new Log(true); // Verbose output.
+
+// Route stdout through the non-blocking DMA UART sink, printf then never
+// waits for the UART.
+
+#if LOG_SINK_DMA
+ Uart_Dma_Log_Sink *log_sink = new Uart_Dma_Log_Sink(uart0, PICO_DEFAULT_UART_TX_PIN, PICO_DEFAULT_UART_RX_PIN, LOG_SINK_BAUD_RATE);
+ log_sink->install_stdio_driver();
+ log->set_sink(log_sink);
+#endif
+
+ LOG_INFO(log, MAIN_SINCE_TIMER_START, main_since_timer_us, 0);
+
 // GPIO15 is set as an input pin that is pulled up.
 // On the hardware side, it can be jumpered to ground, causing the Pico-W to
 // act as a wireless access point.
@@ -141,19 +348,30 @@ int main()
  gpio_init(GPIO15);
  gpio_pull_up(GPIO15);
 
- log = new Log(true); // Verbose output.
- sh = new Storage_Handler();
+ sh = new Storage_Handler(create_flash_backend());
 
 // Check the EPD status byte and the level of GPIO15 (false = LOW).
 
- if ((sh->get_epd_status() != EPD_STORE_CREDENTIALS_SET) || (gpio_get(GPIO15) == false))
+ bool is_setup = (sh->get_epd_status() != EPD_STORE_CREDENTIALS_SET) || (gpio_get(GPIO15) == false);
+
+// Factory provisioning, over stdio before the WiFi is brought up.
+
+ if ((is_setup == true) && (run_provisioning(sh, log) == true))
+  is_setup = (sh->get_epd_status() != EPD_STORE_CREDENTIALS_SET);
+
+ if (is_setup == true)
  {
   if (cyw43_arch_init()) 
   {
    log->print_error(WIFI_INIT_ERR);
+   log->flush();
    return 1;
   }
 
+  loop_profiler_init();
+  xip_stats_init();
+  loop_profiler_watch_wake_gpio(CYW43_PIN_WL_HOST_WAKE);
+
   cyw43_arch_gpio_put(CYW43_WL_GPIO_LED_PIN, 1);  // Turn on LED.
   cyw43_arch_enable_ap_mode(APSSID, APPSK, CYW43_AUTH_WPA2_AES_PSK);
   cyw43_wifi_pm(&cyw43_state, cyw43_pm_value(CYW43_NO_POWERSAVE_MODE, 20, 1, 1, 1));
@@ -163,9 +381,11 @@ int main()
   IP4_ADDR(&gw, 192, 168, 4, 1);
   IP4_ADDR(&mask, 255, 255, 255, 0);
   dhcp_server_init(&dhcp_server, &gw, &mask);  // Start the DHCP server.
+  dns_server_init(&dns_server, &gw);           // Every name resolves to us.
 
   run_server(sh, log);
 
+  log->flush();
   log->print_message("\nEntering Display Mode.\n");  // *** Debug ***
  }
  else
@@ -173,14 +393,12 @@ int main()
 
 // *** Start of Test Section ***
 
-  string log_text;
-
-  string store_ssid       = sh->get_wifi_ssid();
-  string store_password   = sh->get_wifi_password();
-  string store_server_url = sh->get_image_server_url();
+  static Fixed_String<WIFI_SSID_LENGTH + WIFI_PASSWORD_LENGTH + IMAGE_SERVER_URL_LENGTH + 64> log_text;
 
-  log_text = "\n SSID:       " + store_ssid + "\n Password:   " + store_password + "s\n Server URL: " + store_server_url + "\n";
-  log->print_message(log_text);
+  log_text.append_format("\n SSID:       %s\n Password:   %ss\n Server URL: %s\n",
+                         sh->get_wifi_ssid(), sh->get_wifi_password(), sh->get_image_server_url());
+  log->flush();
+  log->print_message(log_text.c_str());
   log->print_message("\nWiFi credentials already set, leaving...\n");
 
 // *** End of Test Section ***
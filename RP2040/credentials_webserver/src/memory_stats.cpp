@@ -0,0 +1,264 @@
+/*!
+ * @file
+ * memory statistics.
+ */
+
+/*
+ * Copyright (c) 2023, FAV Software Limited. All rights reserved.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+// Stack painting: memory_stats_init() fills each core's stack, from its
+// bottom up to just below the caller's frame, with MEMORY_STATS_PAINT.
+// Core 0 runs on the stack it paints, so it must be called from main()
+// before anything deep has run; core 1's stack is painted whole, so it
+// must be called before core 1 is launched. The high-water mark is the
+// distance from the top of the stack to the lowest overwritten word.
+//
+// The heap and stack bounds come from the Pico SDK linker script.
+
+/*
+ * File:   memory_stats.cpp
+ * Author: busdev
+ *
+ * Created on 19 October 2026
+ * Updated on 19 October 2026
+ */
+
+#include <malloc.h>
+
+#include "pico/stdlib.h"
+#include "lwip/stats.h"
+#include "lwip/memp.h"
+#include "memory_stats.h"
+#include "metrics.h"
+#include "tiny_format.h"
+
+extern "C" uint32_t __end__[];           // Heap start.
+extern "C" uint32_t __StackLimit[];      // Heap limit, see _sbrk().
+extern "C" uint32_t __StackBottom[];     // Core 0 stack.
+extern "C" uint32_t __StackTop[];
+extern "C" uint32_t __StackOneBottom[];  // Core 1 stack.
+extern "C" uint32_t __StackOneTop[];
+
+// Render cursor: the heap and stack lines, then one line per memp pool.
+
+#define CURSOR_TITLE  0
+#define CURSOR_HEAP   1
+#define CURSOR_LWIP   2
+#define CURSOR_STACK0 3
+#define CURSOR_STACK1 4
+#define CURSOR_POOLS  5
+
+#if MEMP_STATS
+static const char *const pool_names[] =
+{
+#define LWIP_MEMPOOL(name, num, size, desc) #name,
+#include "lwip/priv/memp_std.h"
+};
+#endif
+
+static int heap_used_metric = METRICS_NONE;
+static int heap_peak_metric = METRICS_NONE;
+static int stack0_peak_metric = METRICS_NONE;
+static int stack1_peak_metric = METRICS_NONE;
+static int lwip_failures_metric = METRICS_NONE;
+
+/*!
+* \brief Fills [bottom, top) with MEMORY_STATS_PAINT.
+*/
+
+static void paint_stack(uint32_t *bottom, uint32_t *top)
+{
+ for (volatile uint32_t *p = bottom; p < top; p++)
+  *p = MEMORY_STATS_PAINT;
+}
+
+/*!
+* \brief Returns the stack high-water mark.
+*
+* \param bottom Lowest address of the stack.
+* \param top Highest address of the stack (initial stack pointer).
+* \return uint32_t. Bytes used at the deepest point.
+*/
+
+static uint32_t stack_peak(uint32_t *bottom, uint32_t *top)
+{
+ volatile uint32_t *p = bottom;
+
+ while ((p < top) && (*p == MEMORY_STATS_PAINT))
+  p++;
+
+ return (uint32_t)((top - (uint32_t*)p) * sizeof(uint32_t));
+}
+
+/*!
+* \brief Returns the failed lwIP allocations, heap and pools.
+*/
+
+static uint32_t lwip_failures(void)
+{
+ uint32_t failures = 0;
+
+#if MEM_STATS
+ failures += lwip_stats.mem.err;
+#endif
+#if MEMP_STATS
+ for (int i = 0; i < MEMP_MAX; i++)
+  failures += lwip_stats.memp[i]->err;
+#endif
+
+ return failures;
+}
+
+/*!
+* \brief Paints the stacks and registers the memory metrics.
+*
+* Call first thing in main(), see the note on stack painting above.
+*/
+
+void memory_stats_init(void)
+{
+ uint32_t *frame = (uint32_t*)__builtin_frame_address(0);
+
+ paint_stack(__StackBottom, frame - (MEMORY_STATS_PAINT_MARGIN / sizeof(uint32_t)));
+ paint_stack(__StackOneBottom, __StackOneTop);
+
+ heap_used_metric = metrics_gauge("cws_heap_used_bytes", NULL, "C heap in use.");
+ heap_peak_metric = metrics_gauge("cws_heap_peak_bytes", NULL, "C heap high-water mark.");
+ stack0_peak_metric = metrics_gauge("cws_stack_peak_bytes", "core=\"0\"", "Stack high-water mark.");
+ stack1_peak_metric = metrics_gauge("cws_stack_peak_bytes", "core=\"1\"", "Stack high-water mark.");
+ lwip_failures_metric = metrics_counter("cws_lwip_alloc_failures_total", NULL, "Failed lwIP heap and pool allocations.");
+}
+
+/*!
+* \brief Copies the current memory statistics to the metrics.
+*
+* Call before rendering the metrics.
+*/
+
+void memory_stats_update_metrics(void)
+{
+ struct mallinfo info = mallinfo();
+
+ metrics_set(heap_used_metric, info.uordblks);
+ metrics_set(heap_peak_metric, info.arena);
+ metrics_set(stack0_peak_metric, stack_peak(__StackBottom, __StackTop));
+ metrics_set(stack1_peak_metric, stack_peak(__StackOneBottom, __StackOneTop));
+ metrics_add(lwip_failures_metric, lwip_failures() - metrics_get(lwip_failures_metric));
+}
+
+/*!
+* \brief Writes the next lines of the memory report into buf.
+*
+* Start with *cursor = 0 and call again until *cursor is
+* MEMORY_STATS_RENDER_DONE. Only whole lines are written.
+*
+* \param buf Destination buffer.
+* \param size Size of buf.
+* \param cursor Render position, updated.
+* \return int. Bytes written, excluding the terminating NUL.
+*/
+
+int memory_stats_render(char *buf, int size, uint32_t *cursor)
+{
+ int len = 0;
+
+ while (*cursor != MEMORY_STATS_RENDER_DONE)
+ {
+  const char *name = NULL;
+  uint32_t used = 0;
+  uint32_t peak = 0;
+  uint32_t total = 0;
+  uint32_t failed = 0;
+
+  if (*cursor == CURSOR_TITLE)
+  {
+   name = "";
+  }
+  else if (*cursor == CURSOR_HEAP)
+  {
+   struct mallinfo info = mallinfo();
+
+   name = "heap";
+   used = info.uordblks;
+   peak = info.arena;
+   total = (uint32_t)((char*)__StackLimit - (char*)__end__);
+  }
+#if MEM_STATS
+  else if (*cursor == CURSOR_LWIP)
+  {
+   name = "lwip_heap";
+   used = lwip_stats.mem.used;
+   peak = lwip_stats.mem.max;
+   total = lwip_stats.mem.avail;
+   failed = lwip_stats.mem.err;
+  }
+#endif
+  else if (*cursor == CURSOR_STACK0)
+  {
+   name = "stack_core0";
+   used = peak = stack_peak(__StackBottom, __StackTop);
+   total = (uint32_t)((char*)__StackTop - (char*)__StackBottom);
+  }
+  else if (*cursor == CURSOR_STACK1)
+  {
+   name = "stack_core1";
+   used = peak = stack_peak(__StackOneBottom, __StackOneTop);
+   total = (uint32_t)((char*)__StackOneTop - (char*)__StackOneBottom);
+  }
+#if MEMP_STATS
+  else if (*cursor < (uint32_t)(CURSOR_POOLS + MEMP_MAX))
+  {
+   const struct stats_mem *pool = lwip_stats.memp[*cursor - CURSOR_POOLS];
+
+   name = pool_names[*cursor - CURSOR_POOLS];
+   used = pool->used;
+   peak = pool->max;
+   total = pool->avail;
+   failed = pool->err;
+  }
+#endif
+  else if (*cursor >= CURSOR_POOLS)
+  {
+   *cursor = MEMORY_STATS_RENDER_DONE;
+   break;
+  }
+
+// Sections compiled out leave their cursor with no line.
+
+  if (name != NULL)
+  {
+   int line_len;
+
+   if (*cursor == CURSOR_TITLE)
+    line_len = tiny_format(&buf[len], size - len, "%-16s %8s %8s %8s %8s\n", "", "used", "peak", "size", "failed");
+   else
+    line_len = tiny_format(&buf[len], size - len, "%-16s %8u %8u %8u %8u\n", name, used, peak, total, failed);
+
+   if (len + line_len >= size)
+   {
+    buf[len] = '\0';
+    break;  // Does not fit, write it next time.
+   }
+
+   len += line_len;
+  }
+
+  (*cursor)++;
+ }
+
+ return len;
+}
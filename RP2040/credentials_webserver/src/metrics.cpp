@@ -0,0 +1,465 @@
+/*!
+ * @file
+ * metrics functions.
+ */
+
+/*
+ * Copyright (c) 2023, FAV Software Limited. All rights reserved.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+// The registry is three static tables. Each entry keeps pointers to its
+// (static) name and help text and a copy of its labels.
+//
+// The Cortex-M0+ has no atomic read-modify-write instructions, so values
+// are updated with a relaxed load and store. This is safe because each
+// metric has one writer; readers see either the old or the new value.
+// The updates are made from the RAM_FUNC() request and DHCP paths, so
+// they are RAM_FUNC() too.
+//
+// Export order: counters, gauges, histograms. Entries with the same name
+// form a family, exported together under one HELP/TYPE header whatever
+// order they were registered in. A family may be split across buffers,
+// between lines.
+
+/*
+ * File:   metrics.cpp
+ * Author: busdev
+ *
+ * Created on 19 October 2026
+ * Updated on 19 October 2026
+ */
+
+#include <atomic>
+#include <cstring>
+
+#include "metrics.h"
+#include "tiny_format.h"
+#include "ram_code.h"
+
+#define CURSOR_GAUGES     METRICS_MAX_COUNTERS
+#define CURSOR_HISTOGRAMS (METRICS_MAX_COUNTERS + METRICS_MAX_GAUGES)
+#define CURSOR_END        (METRICS_MAX_COUNTERS + METRICS_MAX_GAUGES + METRICS_MAX_HISTOGRAMS)
+
+// The render cursor is the table position in the low 16 bits and the
+// step within that family or histogram in the high 16 bits.
+
+#define CURSOR_INDEX(c)          ((c) & 0xffff)
+#define CURSOR_STEP(c)           ((int)((c) >> 16))
+#define MAKE_CURSOR(index, step) ((index) | ((uint32_t)(step) << 16))
+#define STEP_DONE                -1
+
+struct metric_value
+{
+ const char *name;
+ const char *help;
+ char labels[METRICS_LABELS_SIZE];
+ std::atomic<uint32_t> value;
+};
+
+struct metric_histogram
+{
+ const char *name;
+ const char *help;
+ uint32_t bounds[METRICS_MAX_BUCKETS];
+ int bound_count;
+ std::atomic<uint32_t> buckets[METRICS_MAX_BUCKETS + 1];   // Last bucket is +Inf.
+ std::atomic<uint32_t> sum;
+ std::atomic<uint32_t> count;
+};
+
+// The first counter counts the registrations that did not fit, so a
+// table that is too small shows in the export.
+
+#define DROPPED_COUNTER 0
+
+static struct metric_value counters[METRICS_MAX_COUNTERS] =
+{
+ { "cws_metrics_dropped_registrations_total", "Metrics not registered, their table was full.", "", { 0 } }
+};
+static struct metric_value gauges[METRICS_MAX_GAUGES];
+static struct metric_histogram histograms[METRICS_MAX_HISTOGRAMS];
+
+static int counter_count = 1;
+static int gauge_count;
+static int histogram_count;
+
+/*!
+* \brief Finds or adds an entry in a counter or gauge table.
+*
+* \return int. Index of the entry, or METRICS_NONE if the table is full.
+*/
+
+static int register_value(struct metric_value *table, int *table_count, int table_size,
+                          const char *name, const char *labels, const char *help)
+{
+ if (labels == NULL)
+  labels = "";
+
+ for (int i = 0; i < *table_count; i++)
+ {
+  if ((strcmp(table[i].name, name) == 0) && (strcmp(table[i].labels, labels) == 0))
+   return i;
+ }
+
+ if (*table_count >= table_size)
+ {
+  metrics_inc(DROPPED_COUNTER);
+  return METRICS_NONE;
+ }
+
+ struct metric_value *entry = &table[*table_count];
+
+ entry->name = name;
+ entry->help = help;
+ tiny_format(entry->labels, sizeof(entry->labels), "%s", labels);
+ entry->value.store(0, std::memory_order_relaxed);
+
+ return (*table_count)++;
+}
+
+/*!
+* \brief Registers a counter.
+*
+* \param name Metric name, static string.
+* \param labels Label text without braces, copied. NULL or "" for none.
+* \param help Help text, static string.
+* \return int. Counter id, or METRICS_NONE if the table is full.
+*/
+
+int metrics_counter(const char *name, const char *labels, const char *help)
+{
+ return register_value(counters, &counter_count, METRICS_MAX_COUNTERS, name, labels, help);
+}
+
+/*!
+* \brief Registers a gauge.
+*
+* \param name Metric name, static string.
+* \param labels Label text without braces, copied. NULL or "" for none.
+* \param help Help text, static string.
+* \return int. Gauge id, or METRICS_NONE if the table is full.
+*/
+
+int metrics_gauge(const char *name, const char *labels, const char *help)
+{
+ return register_value(gauges, &gauge_count, METRICS_MAX_GAUGES, name, labels, help);
+}
+
+/*!
+* \brief Registers a histogram.
+*
+* \param name Metric name, static string.
+* \param help Help text, static string.
+* \param bounds Upper bounds of the buckets, ascending, copied.
+* \param bound_count Number of bounds, at most METRICS_MAX_BUCKETS.
+* \return int. Histogram id, or METRICS_NONE if the table is full.
+*/
+
+int metrics_histogram(const char *name, const char *help, const uint32_t *bounds, int bound_count)
+{
+ for (int i = 0; i < histogram_count; i++)
+ {
+  if (strcmp(histograms[i].name, name) == 0)
+   return i;
+ }
+
+ if ((histogram_count >= METRICS_MAX_HISTOGRAMS) || (bound_count > METRICS_MAX_BUCKETS))
+ {
+  metrics_inc(DROPPED_COUNTER);
+  return METRICS_NONE;
+ }
+
+ struct metric_histogram *entry = &histograms[histogram_count];
+
+ entry->name = name;
+ entry->help = help;
+ entry->bound_count = bound_count;
+ memcpy(entry->bounds, bounds, bound_count * sizeof(uint32_t));
+
+ return histogram_count++;
+}
+
+/*!
+* \brief Adds to a counter.
+*
+* \param counter Counter id.
+* \param count
+*/
+
+void RAM_FUNC(metrics_add)(int counter, uint32_t count)
+{
+ if ((counter < 0) || (counter >= counter_count))
+  return;
+
+ std::atomic<uint32_t> *value = &counters[counter].value;
+
+ value->store(value->load(std::memory_order_relaxed) + count, std::memory_order_relaxed);
+}
+
+/*!
+* \brief Increments a counter.
+*
+* \param counter Counter id.
+*/
+
+void RAM_FUNC(metrics_inc)(int counter)
+{
+ metrics_add(counter, 1);
+}
+
+/*!
+* \brief Sets a gauge.
+*
+* \param gauge Gauge id.
+* \param value
+*/
+
+void RAM_FUNC(metrics_set)(int gauge, int32_t value)
+{
+ if ((gauge < 0) || (gauge >= gauge_count))
+  return;
+
+ gauges[gauge].value.store((uint32_t)value, std::memory_order_relaxed);
+}
+
+/*!
+* \brief Records a value in a histogram.
+*
+* The sum is 32 bits and wraps, like a counter reset, after 2^32 units.
+*
+* \param histogram Histogram id.
+* \param value
+*/
+
+void RAM_FUNC(metrics_observe)(int histogram, uint32_t value)
+{
+ if ((histogram < 0) || (histogram >= histogram_count))
+  return;
+
+ struct metric_histogram *entry = &histograms[histogram];
+ int bucket = 0;
+
+ while ((bucket < entry->bound_count) && (value > entry->bounds[bucket]))
+  bucket++;
+
+ entry->buckets[bucket].store(entry->buckets[bucket].load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+ entry->sum.store(entry->sum.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+ entry->count.store(entry->count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+/*!
+* \brief Gets a counter's value.
+*
+* \param counter Counter id.
+* \return uint32_t. 0 for an unknown id.
+*/
+
+uint32_t RAM_FUNC(metrics_get)(int counter)
+{
+ if ((counter < 0) || (counter >= counter_count))
+  return 0;
+
+ return counters[counter].value.load(std::memory_order_relaxed);
+}
+
+// Render helpers. Text is appended at *len; on overflow *is_full is set
+// and the caller discards the partly written block.
+
+static void render_text(char *buf, int size, int *len, bool *is_full, const char *fmt, ...)
+{
+ va_list args;
+ int count;
+
+ if (*is_full == true)
+  return;
+
+ va_start(args, fmt);
+ count = tiny_vformat(&buf[*len], size - *len, fmt, args);
+ va_end(args);
+
+ if (*len + count >= size)
+  *is_full = true;
+ else
+  *len += count;
+}
+
+// A family is rendered in steps, each one small enough for any buffer
+// that holds a line: step 0 is the HELP/TYPE header, step n + 1 the
+// series in table[n].
+
+static int render_family_step(char *buf, int size, int *len, bool *is_full,
+                              const struct metric_value *table, int table_count, int first, int step,
+                              const char *type, bool is_signed)
+{
+ const char *name = table[first].name;
+
+ if (step == 0)
+ {
+  render_text(buf, size, len, is_full, "# HELP %s %s\n# TYPE %s %s\n", name, table[first].help, name, type);
+  return first + 1;
+ }
+
+ int i = step - 1;
+ uint32_t value = table[i].value.load(std::memory_order_relaxed);
+
+ if (table[i].labels[0] != 0)
+  render_text(buf, size, len, is_full, "%s{%s} ", name, table[i].labels);
+ else
+  render_text(buf, size, len, is_full, "%s ", name);
+
+ render_text(buf, size, len, is_full, is_signed ? "%d\n" : "%u\n", value);
+
+// Next series of the family.
+
+ for (i++; i < table_count; i++)
+ {
+  if (strcmp(table[i].name, name) == 0)
+   return i + 1;
+ }
+
+ return STEP_DONE;
+}
+
+// Step 0 is the header, step n + 1 bucket n, and the last step the +Inf
+// bucket with the sum and count, kept together so they agree.
+
+static int render_histogram_step(char *buf, int size, int *len, bool *is_full,
+                                 const struct metric_histogram *entry, int step)
+{
+ uint32_t cumulative = 0;
+
+ if (step == 0)
+ {
+  render_text(buf, size, len, is_full, "# HELP %s %s\n# TYPE %s histogram\n", entry->name, entry->help, entry->name);
+  return 1;
+ }
+
+ if (step <= entry->bound_count)
+ {
+  for (int i = 0; i < step; i++)
+   cumulative += entry->buckets[i].load(std::memory_order_relaxed);
+
+  render_text(buf, size, len, is_full, "%s_bucket{le=\"%u\"} %u\n", entry->name, entry->bounds[step - 1], cumulative);
+  return step + 1;
+ }
+
+ for (int i = 0; i <= entry->bound_count; i++)
+  cumulative += entry->buckets[i].load(std::memory_order_relaxed);
+
+ render_text(buf, size, len, is_full, "%s_bucket{le=\"+Inf\"} %u\n%s_sum %u\n%s_count %u\n",
+             entry->name, cumulative,
+             entry->name, entry->sum.load(std::memory_order_relaxed),
+             entry->name, cumulative);
+
+ return STEP_DONE;
+}
+
+// True if table[index] is the first entry of its family.
+
+static bool is_family_start(const struct metric_value *table, int index)
+{
+ for (int i = 0; i < index; i++)
+ {
+  if (strcmp(table[i].name, table[index].name) == 0)
+   return false;
+ }
+
+ return true;
+}
+
+/*!
+* \brief Renders metrics in the Prometheus text format.
+*
+* Writes from *cursor on as much as fits in buf, a whole line at a time,
+* and advances *cursor past it; a family may continue in the next buffer.
+* Start with *cursor = 0; when everything has been rendered *cursor is
+* METRICS_RENDER_DONE. The output is not terminated.
+*
+* \param buf Destination buffer.
+* \param size Size of buf.
+* \param cursor Export position, updated.
+* \return int. Bytes written. 0 with *cursor != METRICS_RENDER_DONE means
+*              the next line does not fit in size bytes.
+*/
+
+int metrics_render(char *buf, int size, uint32_t *cursor)
+{
+ int len = 0;
+
+ while (CURSOR_INDEX(*cursor) < CURSOR_END)
+ {
+  int block_start = len;
+  bool is_full = false;
+  uint32_t c = CURSOR_INDEX(*cursor);
+  int step = CURSOR_STEP(*cursor);
+
+  if (c < CURSOR_GAUGES)
+  {
+   if (c >= (uint32_t)counter_count)
+   {
+    *cursor = CURSOR_GAUGES;
+    continue;
+   }
+
+   if ((step > 0) || (is_family_start(counters, c) == true))
+    step = render_family_step(buf, size, &len, &is_full, counters, counter_count, c, step, "counter", false);
+   else
+    step = STEP_DONE;
+  }
+  else if (c < CURSOR_HISTOGRAMS)
+  {
+   c -= CURSOR_GAUGES;
+
+   if (c >= (uint32_t)gauge_count)
+   {
+    *cursor = CURSOR_HISTOGRAMS;
+    continue;
+   }
+
+   if ((step > 0) || (is_family_start(gauges, c) == true))
+    step = render_family_step(buf, size, &len, &is_full, gauges, gauge_count, c, step, "gauge", true);
+   else
+    step = STEP_DONE;
+  }
+  else
+  {
+   c -= CURSOR_HISTOGRAMS;
+
+   if (c >= (uint32_t)histogram_count)
+   {
+    *cursor = CURSOR_END;
+    continue;
+   }
+
+   step = render_histogram_step(buf, size, &len, &is_full, &histograms[c], step);
+  }
+
+  if (is_full == true)
+  {
+   len = block_start;  // Send this line with the next buffer.
+   break;
+  }
+
+  if (step == STEP_DONE)
+   *cursor = CURSOR_INDEX(*cursor) + 1;
+  else
+   *cursor = MAKE_CURSOR(CURSOR_INDEX(*cursor), step);
+ }
+
+ if (CURSOR_INDEX(*cursor) >= CURSOR_END)
+  *cursor = METRICS_RENDER_DONE;
+
+ return len;
+}
@@ -0,0 +1,293 @@
+/*!
+ * @file
+ * Rendered page cache.
+ */
+
+/*
+ * Copyright (c) 2023, FAV Software Limited. All rights reserved.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * File:   page_cache.cpp
+ * Author: busdev
+ *
+ * Created on 19 October 2026
+ * Updated on 19 October 2026
+ */
+
+#include <cstring>
+
+#include "page_cache.h"
+#include "metrics.h"
+#include "ram_code.h"
+
+Page_Cache::Page_Cache():
+ use_count(0)
+ {
+  for (int i = 0; i < PAGE_CACHE_SLOTS; i++)
+  {
+   slots[i].route = PAGE_CACHE_NONE;
+   slots[i].generation = 0;
+   slots[i].etag = 0;
+   slots[i].last_use = 0;
+   slots[i].pins = 0;
+   slots[i].length = 0;
+  }
+
+  for (int i = 0; i < PAGE_CACHE_PINS; i++)
+  {
+   pins[i].pcb = NULL;
+   pins[i].slot = PAGE_CACHE_NONE;
+   pins[i].start_us = 0;
+  }
+
+  hits_metric = metrics_counter("cws_page_cache_hits_total", NULL, "Pages sent from the page cache.");
+  misses_metric = metrics_counter("cws_page_cache_misses_total", NULL, "Cacheable pages rendered.");
+  bytes_saved_metric = metrics_counter("cws_page_cache_bytes_saved_total", NULL, "Response bytes sent from the page cache instead of rendered.");
+  hit_ratio_metric = metrics_gauge("cws_page_cache_hit_ratio_percent", NULL, "Page cache hits per 100 lookups.");
+ }
+
+Page_Cache::~Page_Cache()
+{ }
+
+/*!
+* \brief Finds the rendered response of a route.
+*
+* Counts a hit or a miss.
+*
+* \param route Route number, chosen by the caller.
+* \param generation The caller's current generation.
+* \return int. Slot, or PAGE_CACHE_NONE.
+*/
+
+int RAM_FUNC(Page_Cache::find)(int route, uint32_t generation)
+{
+ for (int i = 0; i < PAGE_CACHE_SLOTS; i++)
+ {
+  if ((slots[i].route == route) && (slots[i].generation == generation))
+  {
+   slots[i].last_use = ++use_count;
+   metrics_inc(hits_metric);
+   metrics_add(bytes_saved_metric, slots[i].length);
+   update_hit_ratio();
+   return i;
+  }
+ }
+
+ metrics_inc(misses_metric);
+ update_hit_ratio();
+
+ return PAGE_CACHE_NONE;
+}
+
+/*!
+* \brief Stores the rendered response of a route.
+*
+* Replaces the route's older generation, if there is one, otherwise
+* takes an empty or the least recently used slot. Pinned slots are
+* never taken.
+*
+* \param route Route number.
+* \param generation Generation the page was rendered from.
+* \param etag Entity tag of the page, kept for conditional requests.
+* \param header HTTP header.
+* \param header_len Length of the header.
+* \param page Page contents.
+* \param page_len Length of the page.
+* \param now_us time_us_32(), to expire pins.
+* \return int. Slot, or PAGE_CACHE_NONE if the response is too large or
+*              every usable slot is pinned.
+*/
+
+int Page_Cache::store(int route, uint32_t generation, uint32_t etag, const char *header, int header_len, const char *page, int page_len, uint32_t now_us)
+{
+ int slot = PAGE_CACHE_NONE;
+
+ if ((!header) || (!page) || (header_len < 0) || (page_len < 0) || (header_len + page_len > PAGE_CACHE_SLOT_SIZE))
+  return PAGE_CACHE_NONE;
+
+ expire_pins(now_us);
+
+ for (int i = 0; i < PAGE_CACHE_SLOTS; i++)
+ {
+  if (slots[i].route == route)
+  {
+   if (slots[i].pins > 0)
+    return PAGE_CACHE_NONE;  // Keep one slot per route.
+
+   slot = i;
+   break;
+  }
+
+  if (slots[i].pins > 0)
+   continue;
+
+  if ((slot == PAGE_CACHE_NONE) || (slots[i].route == PAGE_CACHE_NONE) ||
+      ((slots[slot].route != PAGE_CACHE_NONE) && (slots[i].last_use < slots[slot].last_use)))
+   slot = i;
+ }
+
+ if (slot == PAGE_CACHE_NONE)
+  return PAGE_CACHE_NONE;
+
+ memcpy(slots[slot].data, header, header_len);
+ memcpy(slots[slot].data + header_len, page, page_len);
+
+ slots[slot].route = route;
+ slots[slot].generation = generation;
+ slots[slot].etag = etag;
+ slots[slot].last_use = ++use_count;
+ slots[slot].length = header_len + page_len;
+
+ return slot;
+}
+
+/*!
+* \brief Returns the response held in a slot.
+*
+* \param slot Slot from find() or store().
+* \return const char *. The response, get_length() bytes, not terminated.
+*/
+
+const char *RAM_FUNC(Page_Cache::get_data)(int slot)
+{
+ return slots[slot].data;
+}
+
+/*!
+* \brief Returns the length of the response held in a slot.
+*
+* \param slot Slot from find() or store().
+* \return int. Bytes.
+*/
+
+int RAM_FUNC(Page_Cache::get_length)(int slot)
+{
+ return slots[slot].length;
+}
+
+/*!
+* \brief Returns the entity tag of the page held in a slot.
+*
+* \param slot Slot from find() or store().
+* \return uint32_t. Entity tag.
+*/
+
+uint32_t RAM_FUNC(Page_Cache::get_etag)(int slot)
+{
+ return slots[slot].etag;
+}
+
+/*!
+* \brief Keeps a slot unchanged while a connection sends from it.
+*
+* \param slot Slot from find() or store().
+* \param pcb Connection.
+* \param now_us time_us_32().
+* \return bool. false if there is no free pin; the caller must then
+*               send a copy.
+*/
+
+bool RAM_FUNC(Page_Cache::pin)(int slot, const struct tcp_pcb *pcb, uint32_t now_us)
+{
+ expire_pins(now_us);
+
+ for (int i = 0; i < PAGE_CACHE_PINS; i++)
+ {
+  if (pins[i].pcb == NULL)
+  {
+   pins[i].pcb = pcb;
+   pins[i].arg = pcb->callback_arg;
+   pins[i].slot = slot;
+   pins[i].start_us = now_us;
+   slots[slot].pins++;
+   return true;
+  }
+ }
+
+ return false;
+}
+
+/*!
+* \brief Releases the slots a connection was sending from.
+*
+* Call once lwIP no longer holds the data: everything acknowledged, or
+* the connection gone.
+*
+* \param pcb Connection.
+*/
+
+void RAM_FUNC(Page_Cache::unpin)(const struct tcp_pcb *pcb)
+{
+ for (int i = 0; i < PAGE_CACHE_PINS; i++)
+ {
+  if ((pins[i].pcb != NULL) && (pins[i].pcb == pcb))
+  {
+   slots[pins[i].slot].pins--;
+   pins[i].pcb = NULL;
+  }
+ }
+}
+
+/*!
+* \brief Releases the slots of a connection lwIP has freed.
+*
+* For the tcp_err() callback, which has only the callback argument: the
+* pcb has been freed and may already be reused by a new connection.
+*
+* \param arg The connection's callback argument.
+*/
+
+void RAM_FUNC(Page_Cache::unpin_freed)(const void *arg)
+{
+ for (int i = 0; i < PAGE_CACHE_PINS; i++)
+ {
+  if ((pins[i].pcb != NULL) && (pins[i].arg == arg))
+  {
+   slots[pins[i].slot].pins--;
+   pins[i].pcb = NULL;
+  }
+ }
+}
+
+/*!
+* \brief Releases pins older than PAGE_CACHE_PIN_TIMEOUT_US.
+*
+* \param now_us time_us_32().
+*/
+
+void RAM_FUNC(Page_Cache::expire_pins)(uint32_t now_us)
+{
+ for (int i = 0; i < PAGE_CACHE_PINS; i++)
+ {
+  if ((pins[i].pcb != NULL) && ((now_us - pins[i].start_us) > PAGE_CACHE_PIN_TIMEOUT_US))
+  {
+   slots[pins[i].slot].pins--;
+   pins[i].pcb = NULL;
+  }
+ }
+}
+
+/*!
+* \brief Sets cws_page_cache_hit_ratio_percent from the counters.
+*/
+
+void RAM_FUNC(Page_Cache::update_hit_ratio)(void)
+{
+ uint32_t hits = metrics_get(hits_metric);
+ uint32_t lookups = hits + metrics_get(misses_metric);
+
+ metrics_set(hit_ratio_metric, (int32_t)(((uint64_t)hits * 100) / lookups));
+}
@@ -0,0 +1,270 @@
+/*!
+ * @file
+ * PC sampling profiler.
+ */
+
+/*
+ * Copyright (c) 2023, FAV Software Limited. All rights reserved.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+// The sampler owns a hardware alarm and installs its own handler on the
+// alarm's interrupt, rather than using the SDK alarm callbacks, because it
+// needs the exception stack frame: the handler finds the frame from the
+// stack pointer in use when the interrupt was taken (EXC_RETURN bit 2)
+// and passes it to record_sample(). The stacked PC and LR are entries 6
+// and 5 of the frame.
+//
+// The handler and record_sample() run from RAM so that sampling does not
+// disturb the XIP cache it is measuring.
+//
+// Only the interrupt writes the table while a window is running; the
+// main loop reads it while rendering, and clears it only with the
+// interrupt disabled.
+
+/*
+ * File:   pc_sampler.cpp
+ * Author: busdev
+ *
+ * Created on 19 October 2026
+ * Updated on 19 October 2026
+ */
+
+#include <cstring>
+
+#include "pico/stdlib.h"
+#include "hardware/timer.h"
+#include "hardware/irq.h"
+#include "pc_sampler.h"
+#include "tiny_format.h"
+
+#if PC_SAMPLER_ENABLED
+
+#define FRAME_LR 5
+#define FRAME_PC 6
+
+struct pc_sample
+{
+ uint32_t pc;                     // 0 for an empty slot.
+ uint32_t lr;
+ uint32_t count;
+};
+
+static struct pc_sample table[PC_SAMPLER_SLOTS];
+static int alarm_num = -1;
+static volatile bool is_running;
+static uint32_t period_us;
+static uint32_t rate_hz;
+static uint32_t window_ms;
+static uint64_t end_us;
+static volatile uint32_t sample_count;
+static volatile uint32_t dropped_count;
+
+extern "C" void record_sample(uint32_t *frame);
+
+/*!
+* \brief Alarm interrupt entry, tail calls record_sample(frame).
+*/
+
+static void __attribute__((naked)) __not_in_flash_func(sampler_irq_handler)(void)
+{
+ __asm volatile(
+  "movs r0, #4      \n"
+  "mov r1, lr       \n"
+  "tst r0, r1       \n"
+  "beq 1f           \n"
+  "mrs r0, psp      \n"
+  "b 2f             \n"
+  "1: mrs r0, msp   \n"
+  "2: ldr r1, =record_sample \n"
+  "bx r1            \n"
+ );
+}
+
+/*!
+* \brief Records the interrupted PC and LR and re-arms the alarm.
+*
+* \param frame Exception stack frame of the interrupted code.
+*/
+
+extern "C" void __not_in_flash_func(record_sample)(uint32_t *frame)
+{
+ timer_hw->intr = 1u << alarm_num;
+
+ if (is_running == false)
+  return;
+
+ if (time_us_64() >= end_us)
+ {
+  is_running = false;
+  hw_clear_bits(&timer_hw->inte, 1u << alarm_num);
+  return;
+ }
+
+ timer_hw->alarm[alarm_num] = timer_hw->timerawl + period_us;
+
+ uint32_t pc = frame[FRAME_PC];
+#if PC_SAMPLER_RECORD_LR
+ uint32_t lr = frame[FRAME_LR];
+#else
+ uint32_t lr = 0;
+#endif
+ uint32_t slot = ((pc ^ lr) * 2654435761u) >> 16;
+
+// Linear probe from the hashed slot; a full table drops the sample.
+
+ for (int i = 0; i < PC_SAMPLER_SLOTS; i++)
+ {
+  struct pc_sample *sample = &table[(slot + i) & (PC_SAMPLER_SLOTS - 1)];
+
+  if ((sample->pc == pc) && (sample->lr == lr))
+  {
+   sample->count++;
+   sample_count++;
+   return;
+  }
+
+  if (sample->pc == 0)
+  {
+   sample->pc = pc;
+   sample->lr = lr;
+   sample->count = 1;
+   sample_count++;
+   return;
+  }
+ }
+
+ dropped_count++;
+}
+
+/*!
+* \brief Clears the table and starts a sampling window.
+*
+* A window already running is restarted.
+*
+* \param window Window length in ms, 0 for PC_SAMPLER_DEFAULT_WINDOW_MS.
+* \param rate Samples per second, 0 for PC_SAMPLER_DEFAULT_HZ.
+* \return int. 0, or -1 if no hardware alarm is free.
+*/
+
+int pc_sampler_start(uint32_t window, uint32_t rate)
+{
+ if (alarm_num < 0)
+ {
+  alarm_num = hardware_alarm_claim_unused(false);
+
+  if (alarm_num < 0)
+   return -1;
+
+  irq_set_exclusive_handler(TIMER_IRQ_0 + alarm_num, sampler_irq_handler);
+  irq_set_priority(TIMER_IRQ_0 + alarm_num, PICO_HIGHEST_IRQ_PRIORITY);  // Sample inside other handlers too.
+ }
+
+ pc_sampler_stop();
+
+ window_ms = (window == 0) ? PC_SAMPLER_DEFAULT_WINDOW_MS : window;
+ rate_hz = (rate == 0) ? PC_SAMPLER_DEFAULT_HZ : rate;
+
+ if (window_ms > PC_SAMPLER_MAX_WINDOW_MS)
+  window_ms = PC_SAMPLER_MAX_WINDOW_MS;
+
+ if (rate_hz > PC_SAMPLER_MAX_HZ)
+  rate_hz = PC_SAMPLER_MAX_HZ;
+
+ memset(table, 0, sizeof(table));
+ sample_count = 0;
+ dropped_count = 0;
+ period_us = 1000000 / rate_hz;
+ end_us = time_us_64() + ((uint64_t)window_ms * 1000);
+ is_running = true;
+
+ timer_hw->alarm[alarm_num] = timer_hw->timerawl + period_us;
+ hw_set_bits(&timer_hw->inte, 1u << alarm_num);
+ irq_set_enabled(TIMER_IRQ_0 + alarm_num, true);
+
+ return 0;
+}
+
+/*!
+* \brief Ends the sampling window early.
+*/
+
+void pc_sampler_stop(void)
+{
+ if (alarm_num < 0)
+  return;
+
+ irq_set_enabled(TIMER_IRQ_0 + alarm_num, false);
+ hw_clear_bits(&timer_hw->inte, 1u << alarm_num);
+ timer_hw->intr = 1u << alarm_num;
+ is_running = false;
+}
+
+/*!
+* \brief Writes the next lines of the sample table into buf.
+*
+* Start with *cursor = 0 and call again until *cursor is
+* PC_SAMPLER_RENDER_DONE. Only whole lines are written.
+*
+* \param buf Destination buffer.
+* \param size Size of buf.
+* \param cursor Render position, updated.
+* \return int. Bytes written, excluding the terminating NUL.
+*/
+
+int pc_sampler_render(char *buf, int size, uint32_t *cursor)
+{
+ int len = 0;
+ int line_len;
+
+ while (*cursor != PC_SAMPLER_RENDER_DONE)
+ {
+  if (*cursor == 0)
+  {
+   line_len = tiny_format(&buf[len], size - len, "# pc_sampler state %s rate_hz %u window_ms %u samples %u dropped %u\n",
+                          (is_running == true) ? "running" : "done", rate_hz, window_ms, sample_count, dropped_count);
+  }
+  else if (*cursor <= PC_SAMPLER_SLOTS)
+  {
+   struct pc_sample sample = table[*cursor - 1];
+
+   if (sample.pc == 0)
+   {
+    (*cursor)++;
+    continue;
+   }
+
+   line_len = tiny_format(&buf[len], size - len, "%08x %08x %u\n", sample.pc, sample.lr, sample.count);
+  }
+  else
+  {
+   *cursor = PC_SAMPLER_RENDER_DONE;
+   break;
+  }
+
+  if (len + line_len >= size)
+  {
+   buf[len] = '\0';
+   break;  // Does not fit, write it next time.
+  }
+
+  len += line_len;
+  (*cursor)++;
+ }
+
+ return len;
+}
+
+#endif
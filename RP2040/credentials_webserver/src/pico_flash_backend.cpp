@@ -0,0 +1,129 @@
+/*!
+ * @file
+ * pico_flash_backend class.
+ */
+
+/*
+ * Copyright (c) 2023, FAV Software Limited. All rights reserved.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+//
+// Pico Flash Backend.
+//
+// Flash_Backend implementation using the Pico SDK flash routines.
+// Reads go through the XIP window, erase and program go through the
+// boot ROM with interrupts disabled (flash is not executable while
+// an erase or program is in progress).
+//
+
+/*
+ * File:   pico_flash_backend.cpp
+ * Author: busdev
+ *
+ * Created on 19 October 2026
+ * Updated on 19 October 2026
+ */
+
+#include <cstring>
+
+#include "pico_flash_backend.h"
+#include "ram_code.h"
+
+Pico_Flash_Backend::Pico_Flash_Backend()
+{ }
+
+Pico_Flash_Backend::~Pico_Flash_Backend()
+{ }
+
+/*!
+* \brief Reads bytes from flash through the XIP window.
+*
+* \param offset Offset from the start of flash.
+* \param data Destination buffer.
+* \param count Number of bytes to read.
+* \return int. FLASH_OK or FLASH_RANGE_ERR.
+*/
+
+int Pico_Flash_Backend::read(uint32_t offset, uint8_t *data, uint32_t count)
+{
+ if ((offset > PICO_FLASH_SIZE_BYTES) || (count > PICO_FLASH_SIZE_BYTES - offset))
+  return FLASH_RANGE_ERR;
+
+ memcpy(data, (const uint8_t*)(XIP_BASE + offset), count);
+
+ return FLASH_OK;
+}
+
+/*!
+* \brief Erases whole sectors.
+*
+* \param offset Offset from the start of flash, sector aligned.
+* \param count Number of bytes to erase, multiple of FLASH_SECTOR_SIZE.
+* \return int. FLASH_OK, FLASH_RANGE_ERR or FLASH_ALIGNMENT_ERR.
+*/
+
+int RAM_FUNC(Pico_Flash_Backend::erase)(uint32_t offset, uint32_t count)
+{
+ uint32_t irq_enabled_status;
+
+ if ((offset > PICO_FLASH_SIZE_BYTES) || (count > PICO_FLASH_SIZE_BYTES - offset))
+  return FLASH_RANGE_ERR;
+
+ if ((offset % FLASH_SECTOR_SIZE) || (count % FLASH_SECTOR_SIZE))
+  return FLASH_ALIGNMENT_ERR;
+
+ irq_enabled_status = save_and_disable_interrupts();
+ flash_range_erase(offset, count);
+ restore_interrupts(irq_enabled_status);
+
+ return FLASH_OK;
+}
+
+/*!
+* \brief Programs whole pages.
+*
+* \param offset Offset from the start of flash, page aligned.
+* \param data Data to be written.
+* \param count Number of bytes to write, multiple of FLASH_PAGE_SIZE.
+* \return int. FLASH_OK, FLASH_RANGE_ERR or FLASH_ALIGNMENT_ERR.
+*/
+
+int RAM_FUNC(Pico_Flash_Backend::program)(uint32_t offset, const uint8_t *data, uint32_t count)
+{
+ uint32_t irq_enabled_status;
+
+ if ((offset > PICO_FLASH_SIZE_BYTES) || (count > PICO_FLASH_SIZE_BYTES - offset))
+  return FLASH_RANGE_ERR;
+
+ if ((offset % FLASH_PAGE_SIZE) || (count % FLASH_PAGE_SIZE))
+  return FLASH_ALIGNMENT_ERR;
+
+ irq_enabled_status = save_and_disable_interrupts();
+ flash_range_program(offset, data, count);
+ restore_interrupts(irq_enabled_status);
+
+ return FLASH_OK;
+}
+
+/*!
+* \brief Creates the flash backend for the device build.
+*
+* \return Flash_Backend*
+*/
+
+Flash_Backend *create_flash_backend(void)
+{
+ return new Pico_Flash_Backend();
+}
@@ -0,0 +1,461 @@
+/*!
+ * @file
+ * Factory provisioning session.
+ */
+
+/*
+ * Copyright (c) 2023, FAV Software Limited. All rights reserved.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * File:   provisioning.cpp
+ * Author: busdev
+ *
+ * Created on 19 October 2026
+ * Updated on 19 October 2026
+ */
+
+#include <cstdint>
+#include <cstring>
+
+#include "provisioning.h"
+#include "http_utils.h"
+#include "tiny_format.h"
+
+#define REPLY_PAYLOAD 4   // Offset of the payload in reply, framed in place.
+
+/*!
+* \brief Constructor.
+*
+* \param sh Storage holding the settings.
+*/
+
+Provisioning::Provisioning(Storage_Handler *sh) :
+ sh(sh),
+ reply_len(0),
+ last_sequence(0),
+ last_crc(0),
+ is_session_open(false),
+ is_done(false)
+{
+ prov_decoder_init(&decoder);
+ read_settings(&staged);
+}
+
+/*!
+* \brief Adds a byte received from the host.
+*
+* \param c Received byte.
+* \return bool. true when a request has been answered; the reply frame
+* is then get_reply(), get_reply_length() bytes, to send as it is.
+*/
+
+bool Provisioning::receive(uint8_t c)
+{
+ if (prov_decode(&decoder, c) != PROV_DECODE_FRAME)
+  return false;
+
+ process_request();
+
+ return reply_len > 0;
+}
+
+/*!
+* \brief Gets the reply frame to the last request.
+*
+* \return const uint8_t*. The frame.
+*/
+
+const uint8_t *Provisioning::get_reply(void)
+{
+ return reply;
+}
+
+/*!
+* \brief Gets the length of the reply frame.
+*
+* \return int. Length, 0 if there is none.
+*/
+
+int Provisioning::get_reply_length(void)
+{
+ return reply_len;
+}
+
+/*!
+* \brief Returns whether a host has sent a valid request.
+*
+* \return bool.
+*/
+
+bool Provisioning::get_is_session_open(void)
+{
+ return is_session_open;
+}
+
+/*!
+* \brief Returns whether the host has ended the session.
+*
+* \return bool.
+*/
+
+bool Provisioning::get_is_done(void)
+{
+ return is_done;
+}
+
+/*!
+* \brief Gets the number of requests received with a good CRC.
+*
+* \return uint32_t.
+*/
+
+uint32_t Provisioning::get_frame_count(void)
+{
+ return decoder.frames;
+}
+
+/*!
+* \brief Gets the number of frames dropped, for a CRC or length error.
+*
+* \return uint32_t.
+*/
+
+uint32_t Provisioning::get_error_count(void)
+{
+ return decoder.errors;
+}
+
+/*!
+* \brief Checks a command before any command of the batch is run.
+*
+* Settings are checked as the web forms check them; an empty setting
+* clears it.
+*
+* \param command
+* \return uint8_t. PROV_OK, or why the command cannot be run.
+*/
+
+uint8_t Provisioning::check_command(const struct prov_record *command)
+{
+ const char *value = (const char *)command->value;
+ int len = command->value_len;
+
+ switch (command->op)
+ {
+  case PROV_OP_INFO:
+  case PROV_OP_GET_SSID:
+  case PROV_OP_GET_PASSWORD:
+  case PROV_OP_GET_URL:
+  case PROV_OP_COMMIT:
+  case PROV_OP_EXIT:
+   return (len == 0) ? PROV_OK : PROV_ERROR_FORMAT;
+
+  case PROV_OP_SET_SSID:
+   if (len > WIFI_SSID_LENGTH - 1)
+    return PROV_ERROR_FORMAT;
+
+   return ((len == 0) || (is_valid_wifi_ssid(value, len) == true)) ? PROV_OK : PROV_ERROR_VALUE;
+
+  case PROV_OP_SET_PASSWORD:
+   if (len > WIFI_PASSWORD_LENGTH - 1)
+    return PROV_ERROR_FORMAT;
+
+   return ((len == 0) || (is_valid_wifi_password(value, len) == true)) ? PROV_OK : PROV_ERROR_VALUE;
+
+  case PROV_OP_SET_URL:
+   if (len > IMAGE_SERVER_URL_LENGTH - 1)
+    return PROV_ERROR_FORMAT;
+
+   return ((len == 0) || (is_valid_image_server_url(value, len) == true)) ? PROV_OK : PROV_ERROR_VALUE;
+
+  default:
+   return PROV_ERROR_OP;
+ }
+}
+
+/*!
+* \brief Appends the result of a GET to the reply.
+*
+* \param len Length of the reply payload so far.
+* \param op
+* \param value Terminated setting.
+* \return int. The new length, or -1 if it does not fit.
+*/
+
+int Provisioning::add_setting(int len, uint8_t op, const char *value)
+{
+ return prov_add_record(reply + REPLY_PAYLOAD, PROV_MAX_PAYLOAD, len, op, PROV_OK, value, strlen(value));
+}
+
+/*!
+* \brief Stages a setting.
+*
+* \param field Staged setting.
+* \param field_size Size of field.
+* \param value Value, not terminated, shorter than field_size.
+* \param len Length of value.
+*/
+
+void Provisioning::stage(char *field, int field_size, const uint8_t *value, int len)
+{
+ memset(field, 0, field_size);
+ memcpy(field, value, len);
+}
+
+/*!
+* \brief Copies the settings from the Storage_Handler.
+*
+* \param settings
+*/
+
+void Provisioning::read_settings(struct settings *settings)
+{
+ tiny_format(settings->ssid, sizeof(settings->ssid), "%s", sh->get_wifi_ssid());
+ tiny_format(settings->password, sizeof(settings->password), "%s", sh->get_wifi_password());
+ tiny_format(settings->url, sizeof(settings->url), "%s", sh->get_image_server_url());
+}
+
+/*!
+* \brief Sets the settings in the Storage_Handler.
+*
+* \param settings
+*/
+
+void Provisioning::apply_settings(const struct settings *settings)
+{
+ sh->set_wifi_ssid(settings->ssid);
+ sh->set_wifi_password(settings->password);
+ sh->set_image_server_url(settings->url);
+}
+
+/*!
+* \brief Writes the staged settings to flash and reads them back.
+*
+* The storage state follows the settings, as for the web forms: set when
+* all three are valid, otherwise setting. Flash that already holds the
+* settings is not written again. If the write or the read back fails,
+* the Storage_Handler's settings and state are put back as they were
+* before the commit, the staged settings are kept, and the host is told;
+* it may commit again, or the unit is rejected.
+*
+* \return uint8_t. PROV_OK, PROV_ERROR_STORAGE or PROV_ERROR_VERIFY.
+*/
+
+uint8_t Provisioning::commit(void)
+{
+ uint8_t previous_status = sh->get_epd_status();
+ int ssid_len = strlen(staged.ssid);
+ int pass_len = strlen(staged.password);
+ int server_len = strlen(staged.url);
+ uint8_t result;
+
+ read_settings(&previous);
+ apply_settings(&staged);
+
+ if ((ssid_len > 0) && (is_valid_wifi_ssid(staged.ssid, ssid_len) == true) &&
+     (pass_len > 0) && (is_valid_wifi_password(staged.password, pass_len) == true) &&
+     (server_len > 0) && (is_valid_image_server_url(staged.url, server_len) == true))
+ {
+  sh->set_epd_status(EPD_STORE_CREDENTIALS_SET);
+ }
+ else
+ {
+  sh->set_epd_status(EPD_STORE_SETTING_CREDENTIALS);
+ }
+
+ if (sh->verify_data_in_store() == SH_OK)
+  return PROV_OK;  // Unchanged.
+
+ if (sh->write_data_to_store() != SH_OK)
+  result = PROV_ERROR_STORAGE;
+ else if (sh->verify_data_in_store() != SH_OK)
+  result = PROV_ERROR_VERIFY;
+ else
+  return PROV_OK;
+
+// Not in flash, so not in use either.
+
+ apply_settings(&previous);
+ sh->set_epd_status(previous_status);
+
+ return result;
+}
+
+/*!
+* \brief Runs a checked command and appends its result to the reply.
+*
+* \param command
+* \param len Length of the reply payload so far, updated.
+* \return uint8_t. PROV_OK, or the error of the result.
+*/
+
+uint8_t Provisioning::run_command(const struct prov_record *command, int *len)
+{
+ uint8_t *payload = reply + REPLY_PAYLOAD;
+ uint8_t info[4];
+ uint8_t status = PROV_OK;
+ int result = 0;   // New length after a result with a value, -1 if the value did not fit.
+
+ switch (command->op)
+ {
+  case PROV_OP_INFO:
+   info[0] = PROV_VERSION;
+   info[1] = sh->get_epd_status();
+   info[2] = (uint8_t)PROV_MAX_PAYLOAD;
+   info[3] = (uint8_t)(PROV_MAX_PAYLOAD >> 8);
+   result = prov_add_record(payload, PROV_MAX_PAYLOAD, *len, command->op, PROV_OK, info, sizeof(info));
+   break;
+
+  case PROV_OP_SET_SSID:
+   stage(staged.ssid, sizeof(staged.ssid), command->value, command->value_len);
+   break;
+
+  case PROV_OP_SET_PASSWORD:
+   stage(staged.password, sizeof(staged.password), command->value, command->value_len);
+   break;
+
+  case PROV_OP_SET_URL:
+   stage(staged.url, sizeof(staged.url), command->value, command->value_len);
+   break;
+
+  case PROV_OP_GET_SSID:
+   result = add_setting(*len, command->op, staged.ssid);
+   break;
+
+  case PROV_OP_GET_PASSWORD:
+   result = add_setting(*len, command->op, staged.password);
+   break;
+
+  case PROV_OP_GET_URL:
+   result = add_setting(*len, command->op, staged.url);
+   break;
+
+  case PROV_OP_COMMIT:
+   status = commit();
+   break;
+
+  case PROV_OP_EXIT:
+   is_done = true;
+   break;
+ }
+
+// Results without a value, and values that did not fit.
+
+ if (result < 0)
+  status = PROV_ERROR_SIZE;
+
+ if (result <= 0)
+  result = prov_add_record(payload, PROV_MAX_PAYLOAD, *len, command->op, status, NULL, 0);
+
+ if (result < 0)
+  return PROV_ERROR_SIZE;  // Not even the status fits, the reply is cut short.
+
+ *len = result;
+
+ return status;
+}
+
+/*!
+* \brief Answers the request in the decoder.
+*
+* The batch is checked, then run in order until a command fails; the
+* commands after it are answered PROV_SKIPPED. A batch that fails the
+* check is not run at all: the failing command gets the error, the
+* others PROV_SKIPPED, and a truncated record a PROV_ERROR_FORMAT result
+* with op 0.
+*/
+
+void Provisioning::process_request(void)
+{
+ uint8_t *payload = reply + REPLY_PAYLOAD;
+ uint8_t sequence = decoder.payload[0];
+ uint16_t crc = prov_crc16(0xffff, decoder.payload, decoder.length);
+ struct prov_record command;
+ uint8_t status = PROV_OK;
+ int failed_index = -1;
+ int index;
+ int cursor;
+ int result;
+ int len;
+
+ if ((is_session_open == true) && (reply_len > 0) && (sequence == last_sequence) && (crc == last_crc))
+  return;  // The reply was lost, send it again.
+
+ is_session_open = true;
+ last_sequence = sequence;
+ last_crc = crc;
+
+// Check the whole batch before running any of it.
+
+ cursor = 1;
+ index = 0;
+
+ while ((result = prov_next_record(decoder.payload, decoder.length, &cursor, &command)) == PROV_RECORD)
+ {
+  status = check_command(&command);
+
+  if (status != PROV_OK)
+  {
+   failed_index = index;
+   break;
+  }
+
+  index++;
+ }
+
+ if (result == PROV_ERROR)
+ {
+  status = PROV_ERROR_FORMAT;
+  failed_index = index;
+ }
+
+// Run it, or answer why not.
+
+ payload[0] = sequence;
+ len = 1;
+ cursor = 1;
+ index = 0;
+
+ while ((result = prov_next_record(decoder.payload, decoder.length, &cursor, &command)) == PROV_RECORD)
+ {
+  if (failed_index < 0)
+  {
+   if (run_command(&command, &len) != PROV_OK)
+    failed_index = index;
+  }
+  else
+  {
+   result = prov_add_record(payload, PROV_MAX_PAYLOAD, len, command.op, (index == failed_index) ? status : PROV_SKIPPED, NULL, 0);
+
+   if (result < 0)
+    break;
+
+   len = result;
+  }
+
+  index++;
+ }
+
+ if ((result == PROV_ERROR) && (failed_index == index))
+ {
+  result = prov_add_record(payload, PROV_MAX_PAYLOAD, len, 0, PROV_ERROR_FORMAT, NULL, 0);
+
+  if (result > 0)
+   len = result;
+ }
+
+ reply_len = prov_encode(reply, sizeof(reply), payload, len);
+}
@@ -0,0 +1,274 @@
+/*!
+ * @file
+ * Factory provisioning protocol frames.
+ */
+
+/*
+ * Copyright (c) 2023, FAV Software Limited. All rights reserved.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * File:   provisioning_frame.cpp
+ * Author: busdev
+ *
+ * Created on 19 October 2026
+ * Updated on 19 October 2026
+ */
+
+#include <cstdint>
+#include <cstring>
+
+#include "provisioning_frame.h"
+
+// Decoder states.
+
+#define STATE_SYNC_1   0
+#define STATE_SYNC_2   1
+#define STATE_LENGTH_1 2
+#define STATE_LENGTH_2 3
+#define STATE_PAYLOAD  4
+#define STATE_CRC_1    5
+#define STATE_CRC_2    6
+
+// CRC-16/CCITT-FALSE (polynomial 0x1021), four bits at a time.
+
+static const uint16_t crc16_nibble[16] =
+{
+ 0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50a5, 0x60c6, 0x70e7,
+ 0x8108, 0x9129, 0xa14a, 0xb16b, 0xc18c, 0xd1ad, 0xe1ce, 0xf1ef
+};
+
+/*!
+* \brief Updates a CRC-16/CCITT-FALSE.
+*
+* Start with 0xffff.
+*
+* \param crc CRC so far.
+* \param data Bytes to add.
+* \param len Number of bytes.
+* \return uint16_t. The updated CRC.
+*/
+
+uint16_t prov_crc16(uint16_t crc, const uint8_t *data, int len)
+{
+ for (int i = 0; i < len; i++)
+ {
+  crc = (uint16_t)((crc << 4) ^ crc16_nibble[(crc >> 12) ^ (data[i] >> 4)]);
+  crc = (uint16_t)((crc << 4) ^ crc16_nibble[(crc >> 12) ^ (data[i] & 0x0f)]);
+ }
+
+ return crc;
+}
+
+/*!
+* \brief Resets a decoder, ready for the sync bytes of a frame.
+*
+* \param decoder
+*/
+
+void prov_decoder_init(struct prov_decoder *decoder)
+{
+ decoder->state = STATE_SYNC_1;
+ decoder->length = 0;
+ decoder->count = 0;
+ decoder->crc = 0xffff;
+ decoder->frames = 0;
+ decoder->errors = 0;
+}
+
+/*!
+* \brief Adds a received byte to a decoder.
+*
+* On PROV_DECODE_FRAME the payload is in decoder->payload, length
+* decoder->length, until the next call.
+*
+* \param decoder
+* \param c Received byte.
+* \return int. PROV_DECODE_FRAME when a frame is complete and its CRC is
+* correct, PROV_DECODE_ERROR when a frame was dropped, otherwise
+* PROV_DECODE_MORE.
+*/
+
+int prov_decode(struct prov_decoder *decoder, uint8_t c)
+{
+ switch (decoder->state)
+ {
+  case STATE_SYNC_1:
+   if (c == PROV_SYNC_BYTE_1)
+    decoder->state = STATE_SYNC_2;
+   break;
+
+  case STATE_SYNC_2:
+   if (c == PROV_SYNC_BYTE_2)
+   {
+    decoder->crc = 0xffff;
+    decoder->state = STATE_LENGTH_1;
+   }
+   else if (c != PROV_SYNC_BYTE_1)
+   {
+    decoder->state = STATE_SYNC_1;
+   }
+   break;
+
+  case STATE_LENGTH_1:
+   decoder->length = c;
+   decoder->crc = prov_crc16(decoder->crc, &c, 1);
+   decoder->state = STATE_LENGTH_2;
+   break;
+
+  case STATE_LENGTH_2:
+   decoder->length |= (uint16_t)(c << 8);
+   decoder->crc = prov_crc16(decoder->crc, &c, 1);
+   decoder->count = 0;
+
+   if ((decoder->length == 0) || (decoder->length > PROV_MAX_PAYLOAD))
+   {
+    decoder->errors++;
+    decoder->state = STATE_SYNC_1;
+    return PROV_DECODE_ERROR;
+   }
+
+   decoder->state = STATE_PAYLOAD;
+   break;
+
+  case STATE_PAYLOAD:
+   decoder->payload[decoder->count++] = c;
+
+   if (decoder->count == decoder->length)
+   {
+    decoder->crc = prov_crc16(decoder->crc, decoder->payload, decoder->length);
+    decoder->state = STATE_CRC_1;
+   }
+   break;
+
+  case STATE_CRC_1:
+   decoder->crc ^= c;
+   decoder->state = STATE_CRC_2;
+   break;
+
+  case STATE_CRC_2:
+   decoder->crc ^= (uint16_t)(c << 8);
+   decoder->state = STATE_SYNC_1;
+
+   if (decoder->crc != 0)
+   {
+    decoder->errors++;
+    return PROV_DECODE_ERROR;
+   }
+
+   decoder->frames++;
+   return PROV_DECODE_FRAME;
+
+  default:
+   decoder->state = STATE_SYNC_1;
+   break;
+ }
+
+ return PROV_DECODE_MORE;
+}
+
+/*!
+* \brief Frames a payload.
+*
+* \param frame Output buffer.
+* \param size Size of frame, at least len + PROV_FRAME_OVERHEAD.
+* \param payload Payload.
+* \param len Length of payload, 1 to PROV_MAX_PAYLOAD.
+* \return int. Length of the frame, or -1 if it does not fit.
+*/
+
+int prov_encode(uint8_t *frame, int size, const uint8_t *payload, int len)
+{
+ uint16_t crc;
+
+ if ((len <= 0) || (len > PROV_MAX_PAYLOAD) || (size < len + PROV_FRAME_OVERHEAD))
+  return -1;
+
+ frame[0] = PROV_SYNC_BYTE_1;
+ frame[1] = PROV_SYNC_BYTE_2;
+ frame[2] = (uint8_t)len;
+ frame[3] = (uint8_t)(len >> 8);
+ memmove(frame + 4, payload, len);  // The payload may already be in place.
+
+ crc = prov_crc16(0xffff, frame + 2, len + 2);
+ frame[len + 4] = (uint8_t)crc;
+ frame[len + 5] = (uint8_t)(crc >> 8);
+
+ return len + PROV_FRAME_OVERHEAD;
+}
+
+/*!
+* \brief Reads the next record of a payload.
+*
+* \param payload Payload.
+* \param len Length of payload.
+* \param cursor Offset of the record, 1 (after the sequence number) for
+* the first. Advanced past the record.
+* \param record Set to the record; value points into payload.
+* \return int. PROV_RECORD, PROV_END after the last record, or PROV_ERROR
+* if a record runs past the end of the payload.
+*/
+
+int prov_next_record(const uint8_t *payload, int len, int *cursor, struct prov_record *record)
+{
+ int offset = *cursor;
+
+ if (offset >= len)
+  return PROV_END;
+
+ if (len - offset < PROV_RECORD_HEADER)
+  return PROV_ERROR;
+
+ record->op = payload[offset];
+ record->status = payload[offset + 1];
+ record->value_len = payload[offset + 2] | (payload[offset + 3] << 8);
+ record->value = payload + offset + PROV_RECORD_HEADER;
+
+ if (record->value_len > len - offset - PROV_RECORD_HEADER)
+  return PROV_ERROR;
+
+ *cursor = offset + PROV_RECORD_HEADER + record->value_len;
+
+ return PROV_RECORD;
+}
+
+/*!
+* \brief Appends a record to a payload.
+*
+* \param payload Payload.
+* \param size Size of payload.
+* \param len Length of payload so far.
+* \param op PROV_OP_...
+* \param status PROV_OK ..., 0 in a request.
+* \param value Value, may be NULL if value_len is 0.
+* \param value_len Length of value.
+* \return int. The new length of payload, or -1 if the record does not fit.
+*/
+
+int prov_add_record(uint8_t *payload, int size, int len, uint8_t op, uint8_t status, const void *value, int value_len)
+{
+ if ((len < 0) || (value_len < 0) || (value_len > size - len - PROV_RECORD_HEADER))
+  return -1;
+
+ payload[len] = op;
+ payload[len + 1] = status;
+ payload[len + 2] = (uint8_t)value_len;
+ payload[len + 3] = (uint8_t)(value_len >> 8);
+
+ if (value_len > 0)
+  memcpy(payload + len + PROV_RECORD_HEADER, value, value_len);
+
+ return len + PROV_RECORD_HEADER + value_len;
+}
@@ -37,21 +37,24 @@
  * Author: busdev
  *
  * Created on 28 January 2023
- * Updated on 14 February 2023
+ * Updated on 19 October 2026
  */
 
 #include "storage_handler.h"
+#include "ram_code.h"
 
 // PICO_FLASH_SIZE_BYTES # The total size of the RP2040 flash, in bytes
 // FLASH_SECTOR_SIZE     # The size of one sector, in bytes (the minimum amount you can erase)
 // FLASH_PAGE_SIZE       # The size of one page, in bytes (the mimimum amount you can write)
 
-Storage_Handler::Storage_Handler():
- ssid(""),
- pass(""),
- server(""),
+Storage_Handler::Storage_Handler(Flash_Backend *flash):
+ flash(flash),
  epd_status(EPD_STORE_UNITIALISED)
  {
+  static const uint32_t commit_bounds_us[] = { 10000, 20000, 50000, 100000, 200000, 500000 };
+
+  commit_metric = metrics_histogram("cws_flash_commit_duration_us", "Time to erase and program the data store.",
+                                    commit_bounds_us, sizeof(commit_bounds_us) / sizeof(commit_bounds_us[0]));
   initialise_storage();
  }
 
@@ -62,8 +65,7 @@ Storage_Handler::~Storage_Handler()
 * \brief Initialises the non-volatile storage area for persistent application variables.
 * 
 * The last sector of flash memory is used to store the persistent application variables.
-* The address of the start of the last sector is STORAGE_ADDR_START.
-* Flash erase and write operations use STORAGE_OFFSET.
+* Flash read, erase and write operations go through the Flash_Backend using STORAGE_OFFSET.
 *
 * A structure, store, holds the following variables:
 *
@@ -76,9 +78,9 @@ Storage_Handler::~Storage_Handler()
 *
 * Note: the strings have an extra byte for a trailing null terminator.
 *
-* Existing values are read as offsets from STORAGE_ADDR_START using the store fields.
-* Both the instance variables: (ssid, pass, server, epd_status) and the new_store fields
-* are set.
+* Existing values are read from STORAGE_OFFSET into the new_store structure.
+* The instance variable epd_status is then set from it; the strings are
+* read directly from new_store by the getters.
 *
 * New values are written to the new_store structure. 
 * Then, the last sector is erased. 
@@ -88,16 +90,16 @@ Storage_Handler::~Storage_Handler()
 
 void Storage_Handler::initialise_storage(void)
 {
- uint32_t irq_enabled_status;
+ if (flash->read(STORAGE_OFFSET, (uint8_t*)&new_store, STORAGE_SIZE) != FLASH_OK)  // Existing storage variables in flash.
+ {
+  new_store.status = EPD_STORE_UNITIALISED;
+ }
 
- store = (struct store*)(STORAGE_ADDR_START);  // Existing storage variables in flash.
- epd_status = store->status;
- new_store.status = epd_status;
+ epd_status = new_store.status;
 
  if ((epd_status == EPD_STORE_UNITIALISED) || (epd_status > EPD_STORE_CREDENTIALS_SET))
  {
-  irq_enabled_status = save_and_disable_interrupts();
-  flash_range_erase(STORAGE_OFFSET, FLASH_SECTOR_SIZE);
+  flash->erase(STORAGE_OFFSET, FLASH_SECTOR_SIZE);
 
   epd_status = EPD_STORE_FORMATTED;
   new_store.status = epd_status;
@@ -108,72 +110,108 @@ void Storage_Handler::initialise_storage(void)
   memset(new_store.wifi_password,0,WIFI_PASSWORD_LENGTH);
   memset(new_store.image_server_url,0,IMAGE_SERVER_URL_LENGTH);
 
-  flash_range_program(STORAGE_OFFSET, (const uint8_t*)&new_store, STORAGE_SIZE);
+  flash->program(STORAGE_OFFSET, (const uint8_t*)&new_store, STORAGE_SIZE);
 
   epd_status = EPD_STORE_DEFAULT_VALUES;
   new_store.status = epd_status;
-
-  restore_interrupts(irq_enabled_status);  // Enable interrupts.
  }
- else  // Read storage variables from flash into local variables and the new_store.
+ else  // Terminate the strings, in case the sector was only partially written.
  {
-  ssid.assign((const char*)store->wifi_ssid);
-  pass.assign((const char*)store->wifi_password);
-  server.assign((const char*)store->image_server_url);
-
-  strcpy((char*)new_store.wifi_ssid, (const char*)store->wifi_ssid);
-  strcpy((char*)new_store.wifi_password, (const char*)store->wifi_password);
-  strcpy((char*)new_store.image_server_url, (const char*)store->image_server_url);
+  new_store.wifi_ssid[WIFI_SSID_LENGTH - 1] = 0;
+  new_store.wifi_password[WIFI_PASSWORD_LENGTH - 1] = 0;
+  new_store.image_server_url[IMAGE_SERVER_URL_LENGTH - 1] = 0;
  }
 }
   
 
+/*!
+* \brief Copies a string into a new_store field.
+*
+* The field is zeroed first, the copy is cut to field_size - 1
+* characters so that the field is always terminated.
+*
+* \param field
+* \param field_size
+* \param value
+* \param len Length of value, which need not be terminated.
+*/
+
+void Storage_Handler::set_store_string(uint8_t *field, int field_size, const char *value, int len)
+{
+ if (len > field_size - 1)
+  len = field_size - 1;
+
+ memset(field, 0, field_size);
+ memcpy(field, value, len);
+}
+
 /*!
 * \brief Sets WiFi SSID.
 *
-* Assigns instance variable ssid.
-* Initialise to zeros first.
+* \param wifi_ssid
+*/
+
+void Storage_Handler::set_wifi_ssid(const char *wifi_ssid)
+{
+ set_store_string(new_store.wifi_ssid, WIFI_SSID_LENGTH, wifi_ssid, strlen(wifi_ssid));
+}
+
+/*!
+* \brief Sets WiFi SSID from a value that need not be terminated.
 *
 * \param wifi_ssid
+* \param len
 */
 
-void Storage_Handler::set_wifi_ssid(string wifi_ssid)
+void Storage_Handler::set_wifi_ssid(const char *wifi_ssid, int len)
 {
- memset(new_store.wifi_ssid,0,WIFI_SSID_LENGTH);
- memcpy(new_store.wifi_ssid, wifi_ssid.c_str(), wifi_ssid.length());
- ssid = wifi_ssid;
+ set_store_string(new_store.wifi_ssid, WIFI_SSID_LENGTH, wifi_ssid, len);
 }
 
 /*!
 * \brief Sets WiFi password.
 *
-* Assigns instance variable pass.
-* Initialise to zeros first.
+* \param wifi_pswd
+*/
+
+void Storage_Handler::set_wifi_password(const char *wifi_pswd)
+{
+ set_store_string(new_store.wifi_password, WIFI_PASSWORD_LENGTH, wifi_pswd, strlen(wifi_pswd));
+}
+
+/*!
+* \brief Sets WiFi password from a value that need not be terminated.
 *
 * \param wifi_pswd
+* \param len
 */
 
-void Storage_Handler::set_wifi_password(string wifi_pswd)
+void Storage_Handler::set_wifi_password(const char *wifi_pswd, int len)
 {
- memset(new_store.wifi_password,0,WIFI_PASSWORD_LENGTH);
- memcpy(new_store.wifi_password, wifi_pswd.c_str(), wifi_pswd.length());
- pass = wifi_pswd;
+ set_store_string(new_store.wifi_password, WIFI_PASSWORD_LENGTH, wifi_pswd, len);
 }
 
 /*!
 * \brief Sets image server's URL.
 *
-* Assigns instance variable server_url.
-* Initialise to zeros first.
+* \param server_url
+*/
+
+void Storage_Handler::set_image_server_url(const char *server_url)
+{
+ set_store_string(new_store.image_server_url, IMAGE_SERVER_URL_LENGTH, server_url, strlen(server_url));
+}
+
+/*!
+* \brief Sets image server's URL from a value that need not be terminated.
 *
 * \param server_url
+* \param len
 */
 
-void Storage_Handler::set_image_server_url(string server_url)
+void Storage_Handler::set_image_server_url(const char *server_url, int len)
 {
- memset(new_store.image_server_url,0,IMAGE_SERVER_URL_LENGTH);
- memcpy(new_store.image_server_url, server_url.c_str(), server_url.length());
- server = server_url;
+ set_store_string(new_store.image_server_url, IMAGE_SERVER_URL_LENGTH, server_url, len);
 }
   
 /*!
@@ -193,34 +231,34 @@ void Storage_Handler::set_epd_status(uint8_t status)
 /*!
 * \brief Gets WiFi network's SSID.
 *
-* \return string WiFi SSID.
+* \return const char* WiFi SSID.
 */
 
-string Storage_Handler::get_wifi_ssid(void)
+const char *Storage_Handler::get_wifi_ssid(void)
 {
- return ssid;
+ return (const char*)new_store.wifi_ssid;
 }
 
 /*!
 * \brief Gets WiFi network's password.
 *
-* \return string WiFi password.
+* \return const char* WiFi password.
 */
 
-string Storage_Handler::get_wifi_password(void)
+const char *Storage_Handler::get_wifi_password(void)
 {
- return pass;
+ return (const char*)new_store.wifi_password;
 }
 
 /*!
 * \brief Gets image server's URL.
 *
-* \return string server.
+* \return const char* server.
 */
 
-string Storage_Handler::get_image_server_url(void)
+const char *Storage_Handler::get_image_server_url(void)
 {
- return server;
+ return (const char*)new_store.image_server_url;
 }
 
 /*!
@@ -240,20 +278,52 @@ uint8_t Storage_Handler::get_epd_status(void)
 * The offset relative to the start of the flash memory is STORAGE_OFFSET.
 * Flash erase and write operations use STORAGE_OFFSET.
 *
-* Interrupts are disabled during flash erase and write operations.
 * The last sector of flash is erased.
 * The contents of the structure, new_store, are written to flash. 
 * The number of bytes written must be a multiple of the page size (256 bytes).
-* Once the flash operations are complete, interrupts are enabled.
+* The flash backend disables interrupts during the erase and write operations.
+*
+* The duration of successful commits is recorded in cws_flash_commit_duration_us.
+*
+* \return int. SH_OK, or SH_ERROR if the erase or write failed.
+*/
+
+int RAM_FUNC(Storage_Handler::write_data_to_store)(void)
+{
+ uint32_t start_us = time_us_32();
+
+ if (flash->erase(STORAGE_OFFSET, FLASH_SECTOR_SIZE) != FLASH_OK)
+  return SH_ERROR;
+
+ if (flash->program(STORAGE_OFFSET, (const uint8_t*)&new_store, STORAGE_SIZE) != FLASH_OK)
+  return SH_ERROR;
+
+ metrics_observe(commit_metric, time_us_32() - start_us);
+
+ return SH_OK;
+}
+
+/*!
+* \brief Reads the data store back from flash and compares it with new_store.
+*
+* Done after write_data_to_store() when the write must be known good,
+* as in factory provisioning. The sector is read a page at a time.
 *
+* \return int. SH_OK if flash holds new_store, SH_ERROR otherwise.
 */
 
-void Storage_Handler::write_data_to_store(void)
+int Storage_Handler::verify_data_in_store(void)
 {
- uint32_t irq_enabled_status;
+ uint8_t page[FLASH_PAGE_SIZE];
+
+ for (uint32_t offset = 0; offset < STORAGE_SIZE; offset += FLASH_PAGE_SIZE)
+ {
+  if (flash->read(STORAGE_OFFSET + offset, page, FLASH_PAGE_SIZE) != FLASH_OK)
+   return SH_ERROR;
+
+  if (memcmp(page, (const uint8_t*)&new_store + offset, FLASH_PAGE_SIZE) != 0)
+   return SH_ERROR;
+ }
 
- irq_enabled_status = save_and_disable_interrupts();
- flash_range_erase(STORAGE_OFFSET, FLASH_SECTOR_SIZE);
- flash_range_program(STORAGE_OFFSET, (const uint8_t*)&new_store, STORAGE_SIZE);
- restore_interrupts(irq_enabled_status);
+ return SH_OK;
 }
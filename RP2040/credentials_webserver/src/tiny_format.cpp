@@ -0,0 +1,247 @@
+/*!
+ * @file
+ * tiny_format functions.
+ */
+
+/*
+ * Copyright (c) 2023, FAV Software Limited. All rights reserved.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * File:   tiny_format.cpp
+ * Author: busdev
+ *
+ * Created on 19 October 2026
+ * Updated on 19 October 2026
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "tiny_format.h"
+
+#define TINY_FORMAT_NUMBER_SIZE 12   // Digits of a 32 bit number, plus sign.
+
+// Output state. Characters past the end of buf are counted but not stored.
+
+struct tiny_output
+{
+ char *buf;
+ int size;
+ int count;
+};
+
+static void put_char(struct tiny_output *out, char c)
+{
+ if (out->count < out->size - 1)
+  out->buf[out->count] = c;
+
+ out->count++;
+}
+
+static void put_padding(struct tiny_output *out, char pad, int count)
+{
+ while (count-- > 0)
+  put_char(out, pad);
+}
+
+static void put_field(struct tiny_output *out, const char *str, int len, int width, bool is_left, char pad)
+{
+ if (is_left == false)
+  put_padding(out, pad, width - len);
+
+ for (int i = 0; i < len; i++)
+  put_char(out, str[i]);
+
+ if (is_left == true)
+  put_padding(out, ' ', width - len);
+}
+
+/*!
+* \brief Converts an unsigned number to text, most significant digit first.
+*
+* \param digits Destination, at least TINY_FORMAT_NUMBER_SIZE bytes.
+* \return int. Number of characters.
+*/
+
+static int number_to_text(char *digits, uint32_t value, uint32_t base, bool is_upper)
+{
+ const char *hex = is_upper ? "0123456789ABCDEF" : "0123456789abcdef";
+ char reversed[TINY_FORMAT_NUMBER_SIZE];
+ int len = 0;
+
+ do
+ {
+  reversed[len++] = hex[value % base];
+  value /= base;
+ } while (value != 0);
+
+ for (int i = 0; i < len; i++)
+  digits[i] = reversed[len - 1 - i];
+
+ return len;
+}
+
+/*!
+* \brief Formats into buf, see tiny_format.h.
+*
+* \param buf Destination buffer.
+* \param size Size of buf, including the terminator.
+* \param fmt Format string.
+* \param args Arguments.
+* \return int. Length of the untruncated output.
+*/
+
+int tiny_vformat(char *buf, int size, const char *fmt, va_list args)
+{
+ struct tiny_output out = { buf, size, 0 };
+ char digits[TINY_FORMAT_NUMBER_SIZE];
+
+ while (*fmt != 0)
+ {
+  if (*fmt != '%')
+  {
+   put_char(&out, *fmt++);
+   continue;
+  }
+
+  fmt++;
+
+  bool is_left = false;
+  char pad = ' ';
+  int width = 0;
+  int len;
+
+  for (; (*fmt == '-') || (*fmt == '0'); fmt++)
+  {
+   if (*fmt == '-')
+    is_left = true;
+   else
+    pad = '0';
+  }
+
+  while ((*fmt >= '0') && (*fmt <= '9'))
+   width = (width * 10) + (*fmt++ - '0');
+
+  while (*fmt == 'l')
+   fmt++;
+
+  switch (*fmt)
+  {
+   case 's':
+   {
+    const char *str = va_arg(args, const char*);
+
+    if (str == NULL)
+     str = "(null)";
+
+    for (len = 0; str[len] != 0; len++);
+
+    put_field(&out, str, len, width, is_left, ' ');
+    break;
+   }
+
+   case 'c':
+    digits[0] = (char)va_arg(args, int);
+    put_field(&out, digits, 1, width, is_left, ' ');
+    break;
+
+   case 'd':
+   case 'i':
+   {
+    int32_t value = va_arg(args, int32_t);
+    uint32_t magnitude = (value < 0) ? (0u - (uint32_t)value) : (uint32_t)value;
+
+    if (value < 0)
+    {
+     digits[0] = '-';
+     len = 1 + number_to_text(&digits[1], magnitude, 10, false);
+    }
+    else
+    {
+     len = number_to_text(digits, magnitude, 10, false);
+    }
+
+    if ((value < 0) && (pad == '0') && (is_left == false))  // Sign goes before the zeros.
+    {
+     put_char(&out, '-');
+     put_field(&out, &digits[1], len - 1, width - 1, false, '0');
+    }
+    else
+    {
+     put_field(&out, digits, len, width, is_left, pad);
+    }
+    break;
+   }
+
+   case 'u':
+    len = number_to_text(digits, va_arg(args, uint32_t), 10, false);
+    put_field(&out, digits, len, width, is_left, pad);
+    break;
+
+   case 'x':
+   case 'X':
+    len = number_to_text(digits, va_arg(args, uint32_t), 16, (*fmt == 'X'));
+    put_field(&out, digits, len, width, is_left, pad);
+    break;
+
+   case 'p':
+    put_char(&out, '0');
+    put_char(&out, 'x');
+    len = number_to_text(digits, (uint32_t)(uintptr_t)va_arg(args, void*), 16, false);
+    put_field(&out, digits, len, width, is_left, pad);
+    break;
+
+   case '%':
+    put_char(&out, '%');
+    break;
+
+   case 0:  // Format ends with '%'.
+    continue;
+
+   default:  // Unsupported conversion, output it as is.
+    put_char(&out, '%');
+    put_char(&out, *fmt);
+  }
+
+  fmt++;
+ }
+
+ if (size > 0)
+  buf[(out.count < size) ? out.count : (size - 1)] = 0;
+
+ return out.count;
+}
+
+/*!
+* \brief Formats into buf, see tiny_format.h.
+*
+* \param buf Destination buffer.
+* \param size Size of buf, including the terminator.
+* \param fmt Format string.
+* \return int. Length of the untruncated output.
+*/
+
+int tiny_format(char *buf, int size, const char *fmt, ...)
+{
+ va_list args;
+ int count;
+
+ va_start(args, fmt);
+ count = tiny_vformat(buf, size, fmt, args);
+ va_end(args);
+
+ return count;
+}
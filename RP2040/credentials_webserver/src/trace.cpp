@@ -0,0 +1,135 @@
+/*!
+ * @file
+ * trace functions.
+ */
+
+/*
+ * Copyright (c) 2023, FAV Software Limited. All rights reserved.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+// Records are written only from the main loop (the lwIP callbacks), so
+// the ring needs no locking. While a dump is in progress recording is
+// paused, so the dump is a consistent snapshot even when it is streamed
+// over several TCP sent callbacks.
+
+/*
+ * File:   trace.cpp
+ * Author: busdev
+ *
+ * Created on 19 October 2026
+ * Updated on 19 October 2026
+ */
+
+#include <cstring>
+
+#include "pico/stdlib.h"
+#include "trace.h"
+
+#if TRACE_ENABLED
+
+static struct trace_record ring[TRACE_RING_SIZE];
+static uint32_t head;             // Records written since boot.
+static uint64_t last_time_us;
+static bool is_paused;
+
+/*!
+* \brief Adds a record to the ring.
+*
+* \param event TRACE_xxx.
+* \param conn Connection id.
+*/
+
+void trace_add(uint16_t event, uint16_t conn)
+{
+ if (is_paused == true)
+  return;
+
+ uint64_t now_us = time_us_64();
+ uint64_t delta_us = (head == 0) ? 0 : (now_us - last_time_us);
+ struct trace_record *record = &ring[head & (TRACE_RING_SIZE - 1)];
+
+ record->delta_us = (delta_us > 0xffffffff) ? 0xffffffff : (uint32_t)delta_us;
+ record->event = event;
+ record->conn = conn;
+
+ last_time_us = now_us;
+ head++;
+}
+
+/*!
+* \brief Copies the next part of the dump into buf.
+*
+* Start with *cursor = 0: the header is written first and recording is
+* paused until the dump completes, when *cursor becomes TRACE_DUMP_DONE.
+* Only whole records are written.
+*
+* \param buf Destination buffer.
+* \param size Size of buf, at least sizeof(struct trace_header).
+* \param cursor Dump position, updated.
+* \return int. Bytes written.
+*/
+
+int trace_dump(char *buf, int size, uint32_t *cursor)
+{
+ uint32_t count = (head < TRACE_RING_SIZE) ? head : TRACE_RING_SIZE;
+ uint32_t first = head - count;
+ int len = 0;
+
+ if (*cursor == 0)
+ {
+  struct trace_header header;
+
+  if (size < (int)sizeof(header))
+   return 0;
+
+  memcpy(header.magic, TRACE_MAGIC, sizeof(header.magic));
+  header.record_size = sizeof(struct trace_record);
+  header.record_count = count;
+  header.last_time_us = last_time_us;
+
+  memcpy(buf, &header, sizeof(header));
+  len = sizeof(header);
+  is_paused = true;
+  *cursor = 1;
+ }
+
+// Cursor n > 0 is record n - 1, counted from the oldest.
+
+ while ((*cursor <= count) && (len + (int)sizeof(struct trace_record) <= size))
+ {
+  memcpy(&buf[len], &ring[(first + *cursor - 1) & (TRACE_RING_SIZE - 1)], sizeof(struct trace_record));
+  len += sizeof(struct trace_record);
+  (*cursor)++;
+ }
+
+ if (*cursor > count)
+ {
+  *cursor = TRACE_DUMP_DONE;
+  is_paused = false;
+ }
+
+ return len;
+}
+
+/*!
+* \brief Ends a dump that will not be completed, resuming recording.
+*/
+
+void trace_dump_abort(void)
+{
+ is_paused = false;
+}
+
+#endif
@@ -0,0 +1,164 @@
+/*!
+ * @file
+ * uart_dma_log_sink class.
+ */
+
+/*
+ * Copyright (c) 2023, FAV Software Limited. All rights reserved.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+//
+// UART DMA Log Sink.
+//
+// Drains the log sink ring to the UART by DMA, paced by the UART's TX
+// DREQ. At 115200 baud a byte takes about 87us on the wire; with the
+// blocking stdio UART driver every printf waited for that. Here the CPU
+// only copies into the ring and (re)starts the DMA channel.
+//
+// The sink can be installed as a stdio driver, so that printf from any
+// module (including dhcpserver.c) goes through it. The SDK's stdio_uart
+// must then be disabled (pico_enable_stdio_uart FALSE) so that output is
+// not sent twice.
+//
+
+/*
+ * File:   uart_dma_log_sink.cpp
+ * Author: busdev
+ *
+ * Created on 19 October 2026
+ * Updated on 19 October 2026
+ */
+
+#include "pico/stdio.h"
+#include "pico/stdio/driver.h"
+#include "hardware/gpio.h"
+
+#include "uart_dma_log_sink.h"
+
+static Uart_Dma_Log_Sink *stdio_sink;
+static stdio_driver_t log_sink_stdio_driver;
+
+Uart_Dma_Log_Sink::Uart_Dma_Log_Sink(uart_inst_t *uart, uint tx_pin, uint rx_pin, uint baud_rate):
+ uart(uart),
+ dma_channel(-1),
+ transfer_count(0)
+ {
+  dma_channel_config config;
+
+  uart_init(uart, baud_rate);
+  gpio_set_function(tx_pin, GPIO_FUNC_UART);
+  gpio_set_function(rx_pin, GPIO_FUNC_UART);
+
+  dma_channel = dma_claim_unused_channel(true);
+
+  config = dma_channel_get_default_config(dma_channel);
+  channel_config_set_transfer_data_size(&config, DMA_SIZE_8);
+  channel_config_set_read_increment(&config, true);
+  channel_config_set_write_increment(&config, false);
+  channel_config_set_dreq(&config, uart_get_dreq(uart, true));
+
+  dma_channel_configure(dma_channel, &config, &uart_get_hw(uart)->dr, NULL, 0, false);
+ }
+
+Uart_Dma_Log_Sink::~Uart_Dma_Log_Sink()
+{
+ flush();
+ dma_channel_unclaim(dma_channel);
+}
+
+/*!
+* \brief Retires the finished DMA transfer and starts the next one.
+*
+* Called from write() and from the main loop. Each transfer covers the
+* contiguous block at the tail of the ring.
+*/
+
+void Uart_Dma_Log_Sink::poll(void)
+{
+ const uint8_t *data;
+ int count;
+
+ if (dma_channel_is_busy(dma_channel))
+  return;
+
+ if (transfer_count > 0)
+ {
+  consume(transfer_count);
+  transfer_count = 0;
+ }
+
+ count = get_pending(&data);
+
+ if (count > 0)
+ {
+  transfer_count = count;
+  dma_channel_transfer_from_buffer_now(dma_channel, data, count);
+ }
+}
+
+/*!
+* \brief Reads received bytes without blocking.
+*
+* \param data Destination buffer.
+* \param len Size of buffer.
+* \return int. Number of bytes read, or PICO_ERROR_NO_DATA.
+*/
+
+int Uart_Dma_Log_Sink::read(char *data, int len)
+{
+ int count = 0;
+
+ while ((count < len) && uart_is_readable(uart))
+ {
+  data[count++] = uart_getc(uart);
+ }
+
+ return (count > 0) ? count : PICO_ERROR_NO_DATA;
+}
+
+// stdio driver callbacks.
+
+static void log_sink_out_chars(const char *buf, int len)
+{
+ stdio_sink->write(buf, len);
+}
+
+static void log_sink_out_flush(void)
+{
+ stdio_sink->poll();  // Never block here, Log_Sink::flush() is for shutdown only.
+}
+
+static int log_sink_in_chars(char *buf, int len)
+{
+ return stdio_sink->read(buf, len);
+}
+
+/*!
+* \brief Routes stdio (printf, putchar, getchar) through this sink.
+*/
+
+void Uart_Dma_Log_Sink::install_stdio_driver(void)
+{
+ stdio_sink = this;
+
+ log_sink_stdio_driver.out_chars = log_sink_out_chars;
+ log_sink_stdio_driver.out_flush = log_sink_out_flush;
+ log_sink_stdio_driver.in_chars = log_sink_in_chars;
+#if PICO_STDIO_ENABLE_CRLF_SUPPORT
+ log_sink_stdio_driver.crlf_enabled = PICO_STDIO_DEFAULT_CRLF;
+#endif
+
+ stdio_set_driver_enabled(&log_sink_stdio_driver, true);
+}
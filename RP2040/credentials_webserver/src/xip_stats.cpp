@@ -0,0 +1,95 @@
+/*!
+ * @file
+ * XIP cache statistics.
+ */
+
+/*
+ * Copyright (c) 2023, FAV Software Limited. All rights reserved.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/*
+ * File:   xip_stats.cpp
+ * Author: busdev
+ *
+ * Created on 19 October 2026
+ * Updated on 19 October 2026
+ */
+
+#include "pico/stdlib.h"
+#include "hardware/structs/xip_ctrl.h"
+#include "xip_stats.h"
+#include "metrics.h"
+#include "tiny_format.h"
+
+static int hit_metric = METRICS_NONE;
+static int miss_metric = METRICS_NONE;
+
+static uint32_t window_start_us;
+static uint32_t window_accesses;
+static uint32_t window_hits;
+
+/*!
+* \brief Registers the metrics and starts the first window.
+*/
+
+void xip_stats_init(void)
+{
+ hit_metric = metrics_gauge("cws_xip_cache_hit_permille", NULL, "XIP cache hits per thousand accesses, last second.");
+ miss_metric = metrics_gauge("cws_xip_cache_misses", NULL, "XIP cache misses, last second.");
+
+ xip_ctrl_hw->ctr_acc = 0;   // Any write clears.
+ xip_ctrl_hw->ctr_hit = 0;
+ window_start_us = time_us_32();
+}
+
+/*!
+* \brief Closes the window once XIP_STATS_WINDOW_US has passed.
+*/
+
+void xip_stats_poll(void)
+{
+ uint32_t now_us = time_us_32();
+
+ if ((now_us - window_start_us) < XIP_STATS_WINDOW_US)
+  return;
+
+ window_accesses = xip_ctrl_hw->ctr_acc;
+ window_hits = xip_ctrl_hw->ctr_hit;
+ xip_ctrl_hw->ctr_acc = 0;
+ xip_ctrl_hw->ctr_hit = 0;
+ window_start_us = now_us;
+
+ if (window_accesses != 0)
+  metrics_set(hit_metric, (uint32_t)(((uint64_t)window_hits * 1000) / window_accesses));
+
+ metrics_set(miss_metric, window_accesses - window_hits);
+}
+
+/*!
+* \brief Writes a summary of the last window into buf.
+*
+* \param buf Destination buffer.
+* \param size Size of buf.
+* \return int. Length of the summary, truncated if >= size.
+*/
+
+int xip_stats_render(char *buf, int size)
+{
+ uint32_t permille = (window_accesses == 0) ? 0 : (uint32_t)(((uint64_t)window_hits * 1000) / window_accesses);
+
+ return tiny_format(buf, size, "xip cache accesses %u, misses %u, hits %u.%u%%",
+                    window_accesses, window_accesses - window_hits, permille / 10, permille % 10);
+}
@@ -0,0 +1,96 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2023, FAV Software Limited. All rights reserved.
+#
+# File:   log_decode.py
+# Author: busdev
+#
+# Created on 19 October 2026
+# Updated on 19 October 2026
+#
+# Decodes the binary log records written by the Log class when the
+# firmware is built with LOG_BINARY_OUTPUT=1.
+#
+# Each record is preceded by the sync bytes 0xa5 0x5a and is 16 bytes,
+# little endian (see struct log_record in include/log.h):
+#
+#   uint32 timestamp_us, uint8 type, uint8 level, uint16 code, uint32 args[2]
+#
+# The message texts are read from include/log.h, so they never go out of
+# step with the firmware.
+#
+# Usage: log_decode.py [capture file | serial device]   (default stdin)
+#
+
+import os
+import re
+import struct
+import sys
+
+SYNC = b"\xa5\x5a"
+RECORD = struct.Struct("<IBBHII")
+LOG_TYPE_ERROR = 0
+LEVELS = "-EWID"
+
+LOG_H = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "include", "log.h")
+
+
+def load_messages(path):
+    """Returns ({error code: text}, {log code: text}) parsed from log.h."""
+    defines = {}
+    with open(path) as f:
+        for line in f:
+            m = re.match(r'#define\s+(\w+)\s+(.+?)\s*(//.*)?$', line)
+            if m:
+                defines[m.group(1)] = m.group(2)
+
+    errors, logs = {}, {}
+    in_errors = True
+    with open(path) as f:
+        for line in f:
+            if line.startswith("// Log Codes."):
+                in_errors = False
+            m = re.match(r'#define\s+(\w+)\s+(\d+)\s*$', line)
+            if m and (m.group(1) + "_MSG") in defines:
+                text = defines[m.group(1) + "_MSG"].strip('"')
+                (errors if in_errors else logs)[int(m.group(2))] = text
+    return errors, logs
+
+
+def format_record(record, errors, logs):
+    timestamp_us, rtype, level, code, arg0, arg1 = record
+    table = errors if rtype == LOG_TYPE_ERROR else logs
+    text = table.get(code, "Undefined code.")
+    args = (arg0, arg1)[:text.count("%u")]
+    level_char = LEVELS[level] if level < len(LEVELS) else "?"
+    return "[%10u] %c%02u %s" % (timestamp_us, level_char, code, text.replace("%u", "%d") % args)
+
+
+def decode(stream, errors, logs):
+    buf = b""
+    while True:
+        chunk = stream.read(256)
+        if not chunk:
+            break
+        buf += chunk
+        while True:
+            start = buf.find(SYNC)
+            if start < 0 or len(buf) - start < len(SYNC) + RECORD.size:
+                buf = buf[start:] if start >= 0 else buf[-1:]
+                break
+            body = buf[start + len(SYNC):start + len(SYNC) + RECORD.size]
+            print(format_record(RECORD.unpack(body), errors, logs), flush=True)
+            buf = buf[start + len(SYNC) + RECORD.size:]
+
+
+def main():
+    errors, logs = load_messages(LOG_H)
+    if len(sys.argv) > 1:
+        with open(sys.argv[1], "rb", buffering=0) as stream:
+            decode(stream, errors, logs)
+    else:
+        decode(sys.stdin.buffer, errors, logs)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,79 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2023, FAV Software Limited. All rights reserved.
+#
+# File:   make_ui_bundle.py
+# Author: busdev
+#
+# Created on 19 October 2026
+# Updated on 19 October 2026
+#
+# Compresses the single page UI (ui/app.html) and writes it as a C array
+# to include/ui_bundle.h, which the web server sends from flash at /app
+# with Content-Encoding: gzip.
+#
+# The gzip header carries no name or time, so the same source always
+# gives the same bundle (and entity tag). Indentation and comments are
+# dropped before compressing; the script is not otherwise minified.
+#
+# Usage: make_ui_bundle.py [--source ui/app.html] [--output include/ui_bundle.h]
+#
+
+import argparse
+import gzip
+import os
+import re
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+ROOT = os.path.dirname(HERE)
+
+HEADER = """/*
+ * File:   ui_bundle.h
+ * Author: busdev
+ *
+ * Generated by tools/make_ui_bundle.py from ui/app.html, do not edit.
+ */
+
+#ifndef __UI_BUNDLE_H__
+#define __UI_BUNDLE_H__
+
+#include <stdint.h>
+
+#define UI_BUNDLE_SOURCE_LENGTH {source_length}    // Bytes before compressing.
+
+static const uint8_t ui_bundle[{length}] =
+{{
+{data}
+}};
+
+#endif
+"""
+
+
+def strip(html):
+    """Drops comments, indentation and blank lines."""
+    html = re.sub(r"<!--.*?-->\n?", "", html, flags=re.S)
+    lines = (line.strip() for line in html.splitlines())
+    return "\n".join(line for line in lines if line) + "\n"
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Build include/ui_bundle.h from ui/app.html.")
+    parser.add_argument("--source", default=os.path.join(ROOT, "ui", "app.html"))
+    parser.add_argument("--output", default=os.path.join(ROOT, "include", "ui_bundle.h"))
+    args = parser.parse_args()
+
+    with open(args.source, encoding="utf-8") as f:
+        source = strip(f.read()).encode("utf-8")
+
+    bundle = gzip.compress(source, compresslevel=9, mtime=0)
+    rows = [", ".join("0x%02x" % b for b in bundle[i:i + 16]) for i in range(0, len(bundle), 16)]
+
+    with open(args.output, "w") as f:
+        f.write(HEADER.format(source_length=len(source), length=len(bundle), data=",\n".join(" " + row for row in rows)))
+
+    print("%s: %d bytes, %d gzipped" % (os.path.relpath(args.output), len(source), len(bundle)))
+
+
+if __name__ == "__main__":
+    main()
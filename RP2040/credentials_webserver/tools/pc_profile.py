@@ -0,0 +1,139 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2023, FAV Software Limited. All rights reserved.
+#
+# File:   pc_profile.py
+# Author: busdev
+#
+# Created on 19 October 2026
+# Updated on 19 October 2026
+#
+# Symbolizes a PC sampling profile (GET /profile, firmware built with
+# CWS_PC_SAMPLER) against credentials_webserver.elf and prints a flat
+# profile by function and, when the LR was recorded, the top callers.
+#
+# The profile is text, see include/pc_sampler.h:
+#
+#   # pc_sampler state done rate_hz 997 window_ms 5000 samples 4985 dropped 0
+#   <pc hex> <lr hex> <count>
+#
+# Functions are found from the ELF symbol table (nm), so no debug
+# information is needed; --lines adds file:line for the hottest PCs from
+# addr2line. PCs in the boot ROM (below 0x10000000) are shown as [rom].
+#
+# Usage: pc_profile.py [--nm-tool T] [--addr2line-tool T] [--top N] [--lines]
+#                      elf profile.txt|http://192.168.4.1/profile
+#
+
+import argparse
+import bisect
+import collections
+import subprocess
+import sys
+import urllib.request
+
+ROM_END = 0x10000000
+
+
+class Symbols:
+    """Function address lookup from nm output."""
+
+    def __init__(self, nm_tool, elf):
+        out = subprocess.run([nm_tool, "-C", "-n", "-S", "--defined-only", elf],
+                             check=True, capture_output=True, text=True).stdout
+        self.starts, self.entries = [], []
+        for line in out.splitlines():
+            parts = line.split(None, 3)
+            if (len(parts) == 4) and (parts[2] in "tTwW"):
+                start = int(parts[0], 16) & ~1
+                self.starts.append(start)
+                self.entries.append((start, int(parts[1], 16), parts[3]))
+
+    def name(self, address):
+        if address < ROM_END:
+            return "[rom]"
+        address &= ~1
+        i = bisect.bisect_right(self.starts, address) - 1
+        if i >= 0:
+            start, size, name = self.entries[i]
+            if address < start + max(size, 1):
+                return name
+        return "[0x%08x]" % address
+
+
+def read_profile(source):
+    """Returns (header line, [(pc, lr, count)])."""
+    if source.startswith("http://"):
+        text = urllib.request.urlopen(source).read().decode()
+    else:
+        with open(source) as f:
+            text = f.read()
+    header, samples = "", []
+    for line in text.splitlines():
+        if line.startswith("#"):
+            header = line[1:].strip()
+        elif line.strip():
+            pc, lr, count = line.split()
+            samples.append((int(pc, 16), int(lr, 16), int(count)))
+    return header, samples
+
+
+def source_lines(addr2line_tool, elf, pcs):
+    """Returns {pc: 'file:line'}."""
+    if not pcs:
+        return {}
+    out = subprocess.run([addr2line_tool, "-e", elf] + ["0x%x" % pc for pc in pcs],
+                         check=True, capture_output=True, text=True).stdout
+    return dict(zip(pcs, out.splitlines()))
+
+
+def print_table(title, counter, total, top):
+    print("\n%s" % title)
+    print(" %8s %6s  %s" % ("samples", "%", "function"))
+    for name, count in counter.most_common(top):
+        print(" %8d %5.1f%%  %s" % (count, 100.0 * count / total, name))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Symbolize a PC sampling profile.")
+    parser.add_argument("elf")
+    parser.add_argument("profile", help="file saved from /profile, or its URL")
+    parser.add_argument("--nm-tool", default="arm-none-eabi-nm")
+    parser.add_argument("--addr2line-tool", default="arm-none-eabi-addr2line")
+    parser.add_argument("--top", type=int, default=25)
+    parser.add_argument("--lines", action="store_true", help="show file:line of the hottest PCs")
+    args = parser.parse_args()
+
+    header, samples = read_profile(args.profile)
+    total = sum(count for pc, lr, count in samples)
+    if total == 0:
+        sys.exit("No samples. %s" % header)
+
+    symbols = Symbols(args.nm_tool, args.elf)
+    functions = collections.Counter()
+    callers = collections.Counter()
+    pcs = collections.Counter()
+    has_lr = any(lr != 0 for pc, lr, count in samples)
+
+    for pc, lr, count in samples:
+        function = symbols.name(pc)
+        functions[function] += count
+        pcs[pc] += count
+        if has_lr:
+            callers["%s <- %s" % (function, symbols.name(lr))] += count
+
+    print(header)
+    print_table("By function", functions, total, args.top)
+    if has_lr:
+        print_table("By function <- caller (interrupted LR)", callers, total, args.top)
+
+    if args.lines:
+        hottest = [pc for pc, count in pcs.most_common(args.top) if pc >= ROM_END]
+        lines = source_lines(args.addr2line_tool, args.elf, hottest)
+        print("\nHottest PCs")
+        for pc in hottest:
+            print(" %8d 0x%08x %s %s" % (pcs[pc], pc, symbols.name(pc), lines.get(pc, "")))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,127 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2023, FAV Software Limited. All rights reserved.
+#
+# File:   size_report.py
+# Author: busdev
+#
+# Created on 19 October 2026
+# Updated on 19 October 2026
+#
+# Reports the flash and RAM footprint of credentials_webserver.elf and,
+# given a captured boot log, the time to main() since the timer started.
+#
+# The timer is reset by runtime init and counts from clocks_init(), so
+# this leaves out the boot ROM, boot2 and the early runtime init; it
+# compares builds, but is not the time from reset (see README.md,
+# Footprint, for timing that with BOOT_MARKER_GPIO).
+#
+#   text  flash: code, read only data and the data section's load image
+#   data  RAM initialised from flash at boot
+#   bss   RAM zeroed at boot
+#
+# Also lists the C++ library symbols (std::, __gnu_cxx::, __cxa_*) left
+# in the image, the largest of the usual footprint suspects.
+#
+# The results can be saved as a baseline and later builds compared
+# against it, e.g. build the old tree with --save-baseline, then the new
+# tree without.
+#
+# Usage: size_report.py [--size-tool T] [--nm-tool T] [--log boot.log]
+#                       [--baseline file] [--save-baseline] elf
+#
+
+import argparse
+import json
+import os
+import re
+import subprocess
+import sys
+
+MAIN_SINCE_TIMER_START = re.compile(r"Reached main (\d+) us since timer start")
+LIBRARY_SYMBOL = re.compile(r"(std::|__gnu_cxx::|__cxa_|__cxxabiv1)")
+TOP_SYMBOLS = 10
+
+
+def section_sizes(size_tool, elf):
+    """Returns {'text', 'data', 'bss'} from the Berkeley format of size."""
+    out = subprocess.run([size_tool, "-B", elf], check=True, capture_output=True, text=True).stdout
+    fields = out.splitlines()[1].split()
+    return {"text": int(fields[0]), "data": int(fields[1]), "bss": int(fields[2])}
+
+
+def library_symbols(nm_tool, elf):
+    """Returns [(size, name)] of the C++ library symbols, largest first."""
+    out = subprocess.run([nm_tool, "-C", "-S", "--size-sort", elf], check=True, capture_output=True, text=True).stdout
+    symbols = []
+    for line in out.splitlines():
+        parts = line.split(None, 3)
+        if (len(parts) == 4) and LIBRARY_SYMBOL.search(parts[3]):
+            symbols.append((int(parts[1], 16), parts[3]))
+    return sorted(symbols, reverse=True)
+
+
+def main_since_timer_start(log_path):
+    """Returns the last time to main since timer start in a boot log, or None."""
+    result = None
+    with open(log_path, errors="replace") as f:
+        for line in f:
+            m = MAIN_SINCE_TIMER_START.search(line)
+            if m:
+                result = int(m.group(1))
+    return result
+
+
+def print_row(name, value, baseline):
+    if value is None:
+        return
+    if (baseline is None) or (baseline.get(name) is None):
+        print(" %-22s %9d" % (name, value))
+    else:
+        before = baseline[name]
+        change = (100.0 * (value - before) / before) if before else 0.0
+        print(" %-22s %9d %9d %+9d %+7.1f%%" % (name, before, value, value - before, change))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Footprint and boot time report.")
+    parser.add_argument("elf")
+    parser.add_argument("--size-tool", default="arm-none-eabi-size")
+    parser.add_argument("--nm-tool", default="arm-none-eabi-nm")
+    parser.add_argument("--log", help="captured UART output containing the MAIN_SINCE_TIMER_START record")
+    parser.add_argument("--baseline", help="baseline JSON file to compare with, or to save to")
+    parser.add_argument("--save-baseline", action="store_true")
+    args = parser.parse_args()
+
+    result = section_sizes(args.size_tool, args.elf)
+    symbols = library_symbols(args.nm_tool, args.elf)
+    result["library_symbols"] = len(symbols)
+    result["library_bytes"] = sum(size for size, name in symbols)
+    result["main_since_timer_us"] = main_since_timer_start(args.log) if args.log else None
+
+    if args.save_baseline:
+        if not args.baseline:
+            sys.exit("--save-baseline needs --baseline")
+        with open(args.baseline, "w") as f:
+            json.dump(result, f, indent=1)
+        print("Baseline saved to %s" % args.baseline)
+
+    baseline = None
+    if args.baseline and not args.save_baseline and os.path.exists(args.baseline):
+        with open(args.baseline) as f:
+            baseline = json.load(f)
+
+    print(os.path.basename(args.elf))
+    if baseline is not None:
+        print(" %-22s %9s %9s %9s %8s" % ("", "before", "after", "change", ""))
+    for name in ("text", "data", "bss", "library_symbols", "library_bytes", "main_since_timer_us"):
+        print_row(name, result[name], baseline)
+
+    if symbols:
+        print("\nLargest C++ library symbols:")
+        for size, name in symbols[:TOP_SYMBOLS]:
+            print(" %7d %s" % (size, name))
+
+
+if __name__ == "__main__":
+    main()
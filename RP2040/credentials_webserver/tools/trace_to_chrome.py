@@ -0,0 +1,108 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2023, FAV Software Limited. All rights reserved.
+#
+# File:   trace_to_chrome.py
+# Author: busdev
+#
+# Created on 19 October 2026
+# Updated on 19 October 2026
+#
+# Converts a trace dump (GET /trace, or the UART dump requested with 'T')
+# to the Chrome trace event JSON format, for chrome://tracing or Perfetto.
+#
+# The dump is a 16 byte header followed by the records, oldest first,
+# little endian (see include/trace.h):
+#
+#   header: char magic[4] "CWTR", uint16 record_size, uint16 record_count,
+#           uint64 last_time_us
+#   record: uint32 delta_us, uint16 event, uint16 conn
+#
+# The input is scanned for the magic, so a UART capture with log output
+# before the dump can be given as is. Each connection is shown as its own
+# thread. The event names are read from include/trace.h.
+#
+# Usage: trace_to_chrome.py dump [output.json]   (default stdout)
+#
+
+import json
+import os
+import re
+import struct
+import sys
+
+MAGIC = b"CWTR"
+HEADER = struct.Struct("<4sHHQ")
+RECORD = struct.Struct("<IHH")
+
+TRACE_H = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "include", "trace.h")
+
+
+def load_events(path):
+    """Returns {event code: (name, phase)} parsed from trace.h."""
+    events = {}
+    with open(path) as f:
+        for line in f:
+            m = re.match(r'#define\s+TRACE_(\w+?)(_BEGIN|_END)?\s+(\d+)\s*//\s*([BEI])\s+(\w+)', line)
+            if m:
+                events[int(m.group(3))] = (m.group(5), m.group(4))
+    return events
+
+
+def parse_dump(data):
+    """Returns [(time_us, event, conn)], oldest first."""
+    start = data.find(MAGIC)
+    if start < 0:
+        sys.exit("No trace dump found.")
+    magic, record_size, record_count, last_time_us = HEADER.unpack_from(data, start)
+    if record_size != RECORD.size:
+        sys.exit("Unexpected record size %d." % record_size)
+
+    records = []
+    offset = start + HEADER.size
+    for i in range(record_count):
+        if offset + RECORD.size > len(data):
+            print("Dump truncated after %d of %d records." % (i, record_count), file=sys.stderr)
+            break
+        records.append(RECORD.unpack_from(data, offset))
+        offset += RECORD.size
+
+# Each delta is the time since the previous record, so the absolute times
+# are rebuilt backwards from the newest.
+
+    result = []
+    time_us = last_time_us
+    for delta_us, event, conn in reversed(records):
+        result.append((time_us, event, conn))
+        time_us -= delta_us
+    result.reverse()
+    return result
+
+
+def to_chrome(records, events):
+    trace_events = []
+    for time_us, event, conn in records:
+        name, phase = events.get(event, ("event %d" % event, "I"))
+        entry = {"name": name, "ph": phase, "ts": time_us, "pid": 0, "tid": conn}
+        if phase == "I":
+            entry["s"] = "t"
+        trace_events.append(entry)
+    return {"traceEvents": trace_events, "displayTimeUnit": "ms"}
+
+
+def main():
+    if len(sys.argv) < 2:
+        sys.exit("Usage: trace_to_chrome.py dump [output.json]")
+    with open(sys.argv[1], "rb") as f:
+        data = f.read()
+    result = to_chrome(parse_dump(data), load_events(TRACE_H))
+    if len(sys.argv) > 2:
+        with open(sys.argv[2], "w") as f:
+            json.dump(result, f)
+    else:
+        json.dump(result, sys.stdout)
+        print()
+
+
+if __name__ == "__main__":
+    main()